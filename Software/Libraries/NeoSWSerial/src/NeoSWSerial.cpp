@@ -435,11 +435,16 @@ void NeoSWSerial::rxChar( uint8_t c )
   // This handy PCINT code for different boards is based on PinChangeInterrupt.*
   // from the excellent Cosa project: http://github.com/mikaelpatel/Cosa
 
+  // Optional client hook (see header); null unless defined elsewhere.
+  extern "C" void neoswserial_isr_hook( uint8_t exiting ) __attribute__((weak));
+
   #define PCINT_ISR(vec,pin)		\
   extern "C" { \
   ISR(PCINT ## vec ## _vect)		\
   {								              \
+    if (neoswserial_isr_hook) neoswserial_isr_hook(0); \
     NeoSWSerial::rxISR(pin);	  \
+    if (neoswserial_isr_hook) neoswserial_isr_hook(1); \
   } }
 
   #if defined(__AVR_ATtiny261__) | \
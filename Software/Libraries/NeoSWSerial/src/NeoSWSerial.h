@@ -39,6 +39,10 @@
 // In such case client code should call NeoSWSerial::rxISR(PINB) (assuming
 // that receivePin is on PORT B)
 //
+// The built-in handlers call neoswserial_isr_hook(0) on entry and
+// neoswserial_isr_hook(1) on exit if client code defines that function
+// (weak symbol; e.g. for ISR timing traces).  Otherwise it is skipped.
+//
 // Supported baud rates are 9600 (default), 19200 and 38400.
 // The baud rate is selectable at run time.
 //
@@ -42,6 +42,11 @@
 #include "pod_sensors.h"
 #include "pod_network.h"
 #include "pod_logging.h"
+#include "pod_trace.h"
+#include "pod_stats.h"
+#include "pod_ota.h"
+#include "pod_remote.h"
+#include "pod_status.h"
 
 //--------------------------------------------------------------------------------------------- [Default Configs and Variables]
 
@@ -67,6 +72,11 @@ void setup() {
   testClock(-1,1000);
   #endif
 
+  #ifdef BENCHMARK_TESTING
+  Wire.begin();
+  runBenchmarks();
+  #endif
+
   #ifdef SENSOR_TESTING
   Serial.println(F("######## DEBUG: HIGHER SOUND SAMPLING RATE ########"));
   Wire.begin();
@@ -173,6 +183,11 @@ void setup() {
   // so we do not do this every time).
   if (podRatesChanged()) savePodRates();
   
+  // Role-specific state, allocated only for the role in use.
+  initConfigPush();
+  initFirmwareUpdate();
+  initStatusTables();
+
   // Begin background process to pull data from the XBee for later
   // processing.  Used by coordinator to buffer packets arriving from
   // other nodes until they can be sent to the database over the internet.
@@ -243,11 +258,22 @@ void setup() {
 
 //--------------------------------------------------------------------------------------------- [loop]
 void loop() {
+  unsigned long t0 = micros();
+  TRACE_BEGIN(TRACE_LOOP);
+
   // Check ethernet connection.  Reinitialize if necessary.
   if(getModeCoord()) {
+    TRACE_BEGIN(TRACE_ETHERNET);
     ethernetMaintain();
+    TRACE_END(TRACE_ETHERNET);
   }
 
   // Sample sensors, log data to SD, upload to server, etc.
   handleLoopLogging();
+
+  TRACE_END(TRACE_LOOP);
+  countLoop(micros() - t0);
+
+  // Statistics/trace commands over USB serial
+  handleRuntimeCommands();
 }
@@ -27,6 +27,7 @@
 
 #include "pod_clock.h"
 #include "pod_eeprom.h"
+#include "pod_util.h"
 
 #include <ctype.h>
 #include <Time.h>
@@ -54,22 +55,57 @@ const uint16_t MONTH_DOLY[] = {0,31,60,91,121,152,182,213,244,274,305,335};
 // DS3234 RTC register addresses
 #define DS3234_TIME_ADDR 0x00
 #define DS3234_TIME_LEN 7
+#define DS3234_AGING_ADDR 0x10
 #define DS3234_TEMP_ADDR 0x11
 #define DS3234_TEMP_LEN 2
+#define DS3234_CONTROL_ADDR 0x0E
+#define DS3234_CONTROL_CONV 0x20
+
+// Software clock.
+// The RTC is read once and the millis() timer is used to count time
+// from there, so getUTC() does not need an SPI transaction on every
+// call.  The clock is anchored at the UTC time and millis() value of
+// the start of an RTC second; clockValid indicates an anchor exists.
+// Every CLOCK_RESYNC_INTERVAL seconds the RTC is read again and the
+// anchor nudged by the minimum amount needed to agree with it, which
+// tracks the drift between the two oscillators.
+#define CLOCK_RESYNC_INTERVAL 600
+bool clockValid = false;
+time_t rtcPhaseUTC = 0;
+unsigned long rtcPhaseMillis = 0;
+// Whether the anchor was locked exactly to an RTC tick (or set), and
+// when; nudges keep an anchor consistent with the RTC but can leave
+// its sub-second phase uncertain.
+bool rtcPhaseLocked = false;
+unsigned long rtcPhaseLockMillis = 0;
+// Last resync time (millis) and last time returned by getUTC(), used
+// to keep getUTC() monotonic across nudges.
+unsigned long clockResyncMillis = 0;
+time_t clockLastUTC = 0;
+// Resync statistics: adjustments are in ms (positive: software clock
+// moved forward, i.e. millis() running slow relative to the RTC).
+struct ClockStats {
+  uint32_t resyncs = 0;
+  uint32_t adjustments = 0;
+  int32_t adjustTotal = 0;
+  uint16_t adjustMax = 0;
+  unsigned long startMillis = 0;
+} clockStats;
 
 // SPI settings for RTC communication
 SPISettings rtcSPISettings(4000000, MSBFIRST, SPI_MODE3);
 
-// Clock configuration.
-// Contains a version number used for EEPROM storage checking
-// and two labels representing the timezones without and with
+// Clock configuration (EEPROM record, see pod_eeprom.h).
+// Contains two labels representing the timezones without and with
 // daylight saving time, respectively.
-#define CLOCK_CONFIG_VERSION 10000
+#define CLOCK_CONFIG_SCHEMA 1
 struct ClockConfig {
-  uint16_t version;
   char label1[6],label2[6];
 };
-ClockConfig clockConfig {CLOCK_CONFIG_VERSION,"",""};
+ClockConfig clockConfig {"",""};
+// Older firmware stored the labels at EEPROM_CLOCK_ADDR, after this
+// version number.
+#define CLOCK_CONFIG_LEGACY_VERSION 10000
 
 // Timezone settings
 //TimeChangeRule usPST = {"PST", First, Sun, Nov, 2, -480};
@@ -84,8 +120,30 @@ ClockConfig clockConfig {CLOCK_CONFIG_VERSION,"",""};
 //Timezone usMountain(usMST,usMDT);
 //Timezone usCentral(usCST,usCDT);
 //Timezone usEastern(usEST,usEDT);
-Timezone timezone((TimeChangeRule){"PST",First,Sun,Nov,2,-480},
-                  (TimeChangeRule){"PDT",Second,Sun,Mar,2,-420});
+// Copies of the two rules handed to the Timezone object (it does not
+// expose its rules or transition times).
+TimeChangeRule timezoneRules[2] = {{"PST",First,Sun,Nov,2,-480},
+                                   {"PDT",Second,Sun,Mar,2,-420}};
+Timezone timezone(timezoneRules[0],timezoneRules[1]);
+
+// Cached local time conversion: the UTC interval [start,end) over which
+// the current timezone offset applies.  Timezone::toLocal() breaks down
+// the year on every call, so it is only used when leaving this window
+// (three times a year with DST).  An end of zero marks the window as
+// invalid.
+struct LocalTimeWindow {
+  time_t start = 0;
+  time_t end = 0;
+  int32_t offset = 0;  // [s]
+  TimeChangeRule *rule = NULL;
+} localTimeWindow;
+
+// Last database date/time string, reused for readings taken within
+// the same second.  Time of zero marks the cache as invalid.
+struct DBDateTimeCache {
+  time_t t = 0;
+  char str[CLOCK_DATETIME_LEN];
+} dbDateTimeCache;
 
 
 
@@ -96,6 +154,11 @@ Timezone timezone((TimeChangeRule){"PST",First,Sun,Nov,2,-480},
 void initRTC() {
   // Initialize communication with DS3234 RTC
   initDS3234();
+  // Start software clock from RTC.  TimeLib's now() is left counting
+  // from startup: TimeAlarms fires a timer only once now() reaches its
+  // trigger time, so stepping now() back would stall every timer by
+  // the size of the step.
+  if (!lockRTCPhase()) resyncClock();
   // Load local timezone from non-volatile memory if available
   // or set to default (Pacific).
   initTimezone();
@@ -114,16 +177,121 @@ bool probeRTC() {
    at 00:00:00 UTC.  Backed by RTC.  As a safety measure, time will not be
    set if t < 1000000000 (~ 2001-09-09). */
 void setUTC(time_t t) {
+  if (t < UTC_CUTOFF) return;
   setDS3234Time(t);
+  // Writing the seconds register resets the RTC's sub-second
+  // countdown, so the new second starts now.
+  rtcPhaseUTC = t;
+  rtcPhaseMillis = millis();
+  rtcPhaseLocked = true;
+  rtcPhaseLockMillis = rtcPhaseMillis;
+  clockValid = true;
+  clockResyncMillis = rtcPhaseMillis;
+  clockLastUTC = t;
 }
 
 
 //------------------------------------------------------------------------------
 /* Get the current time as unix time: number of seconds since 1970-01-01
-   at 00:00:00 UTC.  Backed by RTC.  Returns 0 if failed to extract time
-   from RTC. */
+   at 00:00:00 UTC.  Backed by RTC through the software clock, which
+   re-reads the RTC only periodically.  Never decreases unless the clock
+   is set.  Returns 0 if failed to extract time from RTC. */
 time_t getUTC() {
-  return getDS3234Time();
+  if (!clockValid || (millis() - clockResyncMillis >= 1000ul*CLOCK_RESYNC_INTERVAL)) {
+    resyncClock();
+  }
+  if (!clockValid) return 0;
+  time_t t = rtcPhaseUTC + (millis() - rtcPhaseMillis)/1000;
+  if (t < clockLastUTC) t = clockLastUTC;
+  clockLastUTC = t;
+  return t;
+}
+
+
+//------------------------------------------------------------------------------
+/* Compares the software clock against the RTC and nudges it by the
+   minimum amount needed to agree with the RTC's current second.
+   Re-anchors outright if the two disagree by more than a second
+   (e.g. RTC set externally).  Also rebases the anchor so millis()
+   differences stay small. */
+void resyncClock() {
+  clockResyncMillis = millis();
+  time_t trtc = getDS3234Time();
+  unsigned long now = millis();
+  // RTC unavailable: keep counting from last anchor (if any)
+  if (trtc < UTC_CUTOFF) return;
+  clockStats.resyncs++;
+  // First anchor: sub-second phase unknown, assume mid-second.
+  if (!clockValid) {
+    rtcPhaseUTC = trtc;
+    rtcPhaseMillis = now - 500;
+    clockValid = true;
+    clockStats.startMillis = now;
+    return;
+  }
+  // Rebase anchor to the current second
+  unsigned long dt = now - rtcPhaseMillis;
+  rtcPhaseUTC += dt/1000;
+  rtcPhaseMillis += 1000*(dt/1000);
+  unsigned long frac = now - rtcPhaseMillis;
+  long diff = (long)(trtc - rtcPhaseUTC);
+  int32_t adjust;
+  if (diff == 0) {
+    return;
+  } else if (diff == 1) {
+    // RTC already ticked: software clock is late by at least this
+    adjust = 1000 - frac;
+    rtcPhaseUTC = trtc;
+    rtcPhaseMillis = now;
+  } else if (diff == -1) {
+    // RTC has not yet ticked: software clock is early by at least this
+    adjust = -(int32_t)(frac + 1);
+    rtcPhaseUTC = trtc;
+    rtcPhaseMillis = now - 999;
+  } else {
+    // Large disagreement: not drift, so re-anchor without statistics
+    rtcPhaseUTC = trtc;
+    rtcPhaseMillis = now - 500;
+    rtcPhaseLocked = false;
+    clockLastUTC = 0;
+    return;
+  }
+  clockStats.adjustments++;
+  clockStats.adjustTotal += adjust;
+  uint16_t a = (adjust < 0) ? -adjust : adjust;
+  if (a > clockStats.adjustMax) clockStats.adjustMax = a;
+}
+
+
+//------------------------------------------------------------------------------
+/* Estimated drift of the millis() timer relative to the RTC [ppm], from
+   the software clock adjustments made so far (positive: millis() is
+   slow).  Resolution improves with run time. */
+float getClockDrift() {
+  if (!clockValid || (clockStats.adjustments == 0)) return 0;
+  unsigned long elapsed = millis() - clockStats.startMillis;
+  if (elapsed == 0) return 0;
+  return 1e6 * (float)clockStats.adjustTotal / (float)elapsed;
+}
+
+
+//------------------------------------------------------------------------------
+/* Prints software clock resync statistics to serial. */
+void printClockStats() {
+  Serial.println(F("Software clock statistics:"));
+  Serial.print(F("  RTC reads:    "));
+  Serial.print(clockStats.resyncs);
+  Serial.print(F(" ("));
+  Serial.print(clockStats.adjustments);
+  Serial.println(F(" adjustments)"));
+  Serial.print(F("  Adjustments:  net "));
+  Serial.print(clockStats.adjustTotal);
+  Serial.print(F(" ms, max "));
+  Serial.print(clockStats.adjustMax);
+  Serial.println(F(" ms"));
+  Serial.print(F("  Drift:        "));
+  Serial.print(getClockDrift(),1);
+  Serial.println(F(" ppm"));
 }
 
 
@@ -135,7 +303,197 @@ time_t getUTC() {
 time_t getLocalTime() {
   time_t t = getUTC();
   if (t == 0) return 0;
-  return timezone.toLocal(t);
+  return toLocalTime(t);
+}
+
+
+//------------------------------------------------------------------------------
+/* Local time of the given timezone rule's transition in the given year.
+   Same calculation as the (private) Timezone::toTime_t(). */
+time_t timezoneRuleTime(const TimeChangeRule &r, int yr) {
+  uint8_t m = r.month;
+  uint8_t w = r.week;
+  // "Last" week rules: first week of the next month, less 7 days below
+  if (w == 0) {
+    if (++m > 12) {
+      m = 1;
+      ++yr;
+    }
+    w = 1;
+  }
+  tmElements_t tm;
+  tm.Hour = r.hour;
+  tm.Minute = 0;
+  tm.Second = 0;
+  tm.Day = 1;
+  tm.Month = m;
+  tm.Year = yr - 1970;
+  time_t t = makeTime(tm);
+  t += ((r.dow - weekday(t) + 7) % 7 + (w - 1) * 7) * SECS_PER_DAY;
+  if (r.week == 0) t -= 7 * SECS_PER_DAY;
+  return t;
+}
+
+
+//------------------------------------------------------------------------------
+/* Recomputes the cached local time window around the given UTC time.
+   The offset and rule come from Timezone itself; the window is bounded
+   by the two rule transitions and the start/end of the (UTC) year, as
+   the Timezone library recalculates its transitions yearly. */
+void updateLocalTimeWindow(time_t utc) {
+  TimeChangeRule *rule;
+  time_t tloc = timezone.toLocal(utc,&rule);
+  localTimeWindow.offset = (int32_t)(tloc - utc);
+  localTimeWindow.rule = rule;
+  
+  int yr = year(utc);
+  tmElements_t tm;
+  tm.Hour = 0;
+  tm.Minute = 0;
+  tm.Second = 0;
+  tm.Day = 1;
+  tm.Month = 1;
+  tm.Year = yr - 1970;
+  time_t ystart = makeTime(tm);
+  tm.Year++;
+  time_t yend = makeTime(tm);
+  
+  // Transition into each rule occurs at a local time of the other rule
+  const TimeChangeRule &r1 = timezoneRules[0];
+  const TimeChangeRule &r2 = timezoneRules[1];
+  time_t c1 = timezoneRuleTime(r1,yr) - (int32_t)r2.offset * 60;
+  time_t c2 = timezoneRuleTime(r2,yr) - (int32_t)r1.offset * 60;
+  if (c2 < c1) {
+    time_t c = c1;
+    c1 = c2;
+    c2 = c;
+  }
+  
+  localTimeWindow.start = ystart;
+  localTimeWindow.end = yend;
+  if (utc < c1) {
+    if (c1 > ystart) localTimeWindow.end = c1;
+  } else if (utc < c2) {
+    localTimeWindow.start = c1;
+    localTimeWindow.end = c2;
+  } else {
+    if (c2 < yend) localTimeWindow.start = c2;
+  }
+}
+
+
+//------------------------------------------------------------------------------
+/* Converts the given UTC unix time to local time, optionally returning
+   the applicable timezone rule.  Uses the cached timezone offset while
+   the time lies in the current DST/standard time window. */
+time_t toLocalTime(time_t utc, TimeChangeRule **rule) {
+  if ((localTimeWindow.end == 0) || (utc < localTimeWindow.start)
+      || (utc >= localTimeWindow.end)) {
+    updateLocalTimeWindow(utc);
+  }
+  if (rule != NULL) *rule = localTimeWindow.rule;
+  return utc + localTimeWindow.offset;
+}
+time_t toLocalTime(time_t utc) {
+  return toLocalTime(utc,NULL);
+}
+
+
+
+// Sub-second Time Functions ===================================================
+
+//------------------------------------------------------------------------------
+/* Locks the millis() timer to the RTC's seconds rollover by polling the
+   RTC seconds register until it changes.  Blocks for up to ~1 second.
+   Returns false if the RTC did not tick (not present or not running). */
+bool lockRTCPhase() {
+  uint8_t s0,s;
+  readDS3234Byte(DS3234_TIME_ADDR,s0);
+  unsigned long t0 = millis();
+  do {
+    readDS3234Byte(DS3234_TIME_ADDR,s);
+    if (s != s0) {
+      unsigned long tick = millis();
+      time_t t = getDS3234Time();
+      if (t < UTC_CUTOFF) return false;
+      rtcPhaseUTC = t;
+      rtcPhaseMillis = tick;
+      rtcPhaseLocked = true;
+      rtcPhaseLockMillis = tick;
+      clockValid = true;
+      clockResyncMillis = tick;
+      if (clockStats.startMillis == 0) clockStats.startMillis = tick;
+      return true;
+    }
+  } while (millis() - t0 < 1100);
+  return false;
+}
+
+
+//------------------------------------------------------------------------------
+/* Re-locks the millis() timer to the RTC if there is no lock or the
+   existing lock is more than maxAge seconds old.  The millis() timer
+   and RTC oscillators drift apart (tens of ppm), so the lock should
+   be refreshed regularly when sub-second accuracy matters. */
+bool refreshRTCPhase(unsigned long maxAge) {
+  if (rtcPhaseLocked && (millis() - rtcPhaseLockMillis < 1000*maxAge)) return true;
+  return lockRTCPhase();
+}
+
+
+//------------------------------------------------------------------------------
+/* Get the current UTC time to millisecond resolution by extrapolating
+   from the software clock anchor.  Accurate to a few milliseconds
+   shortly after a lock (see refreshRTCPhase()).  Returns false if the
+   clock has not been set from the RTC. */
+bool getUTCPrecise(time_t &t, uint16_t &ms) {
+  if (!clockValid) return false;
+  unsigned long dt = millis() - rtcPhaseMillis;
+  t = rtcPhaseUTC + dt/1000;
+  ms = dt % 1000;
+  return true;
+}
+
+
+//------------------------------------------------------------------------------
+/* Set the RTC to the given UTC time with millisecond alignment.  Since
+   the RTC can only be set to whole seconds, this waits until the given
+   time reaches the next whole second before writing.  Blocks for up to
+   one second, or does nothing and returns false if the wait would be
+   longer than maxWait [ms]. */
+bool setUTCPrecise(time_t t, uint16_t ms, unsigned long maxWait) {
+  if (ms > 0) {
+    if (1000ul - ms > maxWait) return false;
+    unsigned long t0 = millis();
+    delay(1000 - ms);
+    // Account for any overshoot of the delay
+    shiftUTCPrecise(t,ms,millis() - t0);
+  }
+  setUTC(t);
+  rtcPhaseMillis -= ms;
+  return true;
+}
+
+
+//------------------------------------------------------------------------------
+/* Difference (t2 - t1) in milliseconds between two sub-second times. */
+int32_t diffUTCPrecise(time_t t2, uint16_t ms2, time_t t1, uint16_t ms1) {
+  return 1000*(int32_t)(t2 - t1) + ((int32_t)ms2 - (int32_t)ms1);
+}
+
+
+//------------------------------------------------------------------------------
+/* Shifts a sub-second time by the given number of milliseconds. */
+void shiftUTCPrecise(time_t &t, uint16_t &ms, int32_t dms) {
+  int32_t v = (int32_t)ms + dms;
+  int32_t ds = v / 1000;
+  v %= 1000;
+  if (v < 0) {
+    v += 1000;
+    ds--;
+  }
+  t += ds;
+  ms = v;
 }
 
 
@@ -146,13 +504,22 @@ time_t getLocalTime() {
 /* Loads timezone information from EEPROM if available, otherwise sets to
    Pacific timezone with DST. */
 void initTimezone() {
-  // Load clock config from EEPROM
-  for (size_t k = 0; k < sizeof(clockConfig); k++) {
-      *((char*)&clockConfig + k) = EEPROM.read(EEPROM_CLOCK_ADDR + k);
+  // Load clock config from EEPROM, or from where older firmware saved
+  // it (moved to the EEPROM record by setTimezone() below)
+  uint8_t schema;
+  bool valid = (loadEEPROMRecord(EEPROM_RECORD_CLOCK,&clockConfig,sizeof(clockConfig),schema) > 0);
+  if (!valid) {
+    uint16_t version;
+    EEPROM.get(EEPROM_CLOCK_ADDR,version);
+    if (version == CLOCK_CONFIG_LEGACY_VERSION) {
+      EEPROM.get(EEPROM_CLOCK_ADDR + sizeof(version),clockConfig);
+      valid = true;
+    }
   }
+  clockConfig.label1[sizeof(clockConfig.label1)-1] = '\0';
+  clockConfig.label2[sizeof(clockConfig.label2)-1] = '\0';
 
-  // Check if loaded data is valid
-  if (clockConfig.version == CLOCK_CONFIG_VERSION) {
+  if (valid) {
     setTimezone(clockConfig.label1,clockConfig.label2);
   // Default to Pacific time (will be saved to EEPROM)
   } else {
@@ -196,17 +563,14 @@ TimeChangeRule timezoneRuleByLabel(String label) {
    Currently implemented labels: EST, EDT, CST, CDT, MST, MDT, PST, PDT,
    UTC.  Unrecognized labels will be set to UTC.  */
 void setTimezone(String tz, String dtz) {
-  if (dtz.equals("")) {
-    TimeChangeRule rule1 = timezoneRuleByLabel(tz);
-    timezone.setRules(rule1,rule1);
-  } else {
-    TimeChangeRule rule1 = timezoneRuleByLabel(tz);
-    TimeChangeRule rule2 = timezoneRuleByLabel(dtz);
-    timezone.setRules(rule1,rule2);
-  }
+  timezoneRules[0] = timezoneRuleByLabel(tz);
+  timezoneRules[1] = dtz.equals("") ? timezoneRules[0] : timezoneRuleByLabel(dtz);
+  timezone.setRules(timezoneRules[0],timezoneRules[1]);
+  // Invalidate cached conversions
+  localTimeWindow.end = 0;
+  dbDateTimeCache.t = 0;
 
   // Update clock config structure and save to EEPROM
-  clockConfig.version = CLOCK_CONFIG_VERSION;
   //clockConfig.label1 = tz;
   //clockConfig.label2 = (dtz.equals("")) ? tz : dtz;
   tz.toCharArray(clockConfig.label1,6);
@@ -215,12 +579,9 @@ void setTimezone(String tz, String dtz) {
   } else {
     dtz.toCharArray(clockConfig.label2,6);
   }
-  for (size_t k = 0; k < sizeof(clockConfig); k++) {
-    // Put only writes byte if different from current EEPROM value
-    // (reduces EEPROM wear).  If configuration hasn't changed,
-    // this will not actually write anything.
-    EEPROM.put(EEPROM_CLOCK_ADDR + k, *((char*)&clockConfig + k));
-  }
+  // If configuration hasn't changed, this will not actually write
+  // anything.
+  saveEEPROMRecord(EEPROM_RECORD_CLOCK,&clockConfig,sizeof(clockConfig),CLOCK_CONFIG_SCHEMA);
 }
 
 
@@ -230,7 +591,7 @@ void setTimezone(String tz, String dtz) {
 String getTimezoneLabel(time_t t) {
   if (t == 0) t = getUTC();
   TimeChangeRule *rule;
-  timezone.toLocal(t,&rule);
+  toLocalTime(t,&rule);
   return rule -> abbrev;
 }
 
@@ -246,131 +607,147 @@ String getDaylightSavingTimezoneLabel() {return clockConfig.label2;}
 
 // Date/Time Format Functions ==================================================
 
+// The format* routines write into a caller-provided buffer (of at least
+// the CLOCK_*_LEN size noted in the header) and return it, avoiding the
+// heap allocations of the String versions.  The String versions are
+// wrappers around these.
+
 //------------------------------------------------------------------------------
-/* Converts the given local time (in seconds since 1970-01-01 00:00:00) to a 
-   date string.  Unlike other routines, this time argument is relative to the
-   local time, not UTC. */
-String getDateString(time_t t) {
-  tmElements_t tm;
-  breakTime(t,tm);
-  char sbuffer[16];
-  sprintf(sbuffer,"%4d-%02d-%02d",1970+tm.Year,tm.Month,tm.Day);
-  return sbuffer;
+/* Writes the given value as a fixed number of zero-padded decimal digits,
+   returning the position after the last digit. */
+char* formatDigits(char *p, uint16_t v, uint8_t n) {
+  for (uint8_t k = n; k > 0; k--) {
+    p[k-1] = '0' + (v % 10);
+    v /= 10;
+  }
+  return p + n;
 }
 
 
 //------------------------------------------------------------------------------
-/* Converts the given local time (in seconds since 1970-01-01 00:00:00) to a 
-   time string.  Unlike other routines, this time argument is relative to the
-   local time, not UTC. */
-String getTimeString(time_t t) {
-  tmElements_t tm;
-  breakTime(t,tm);
-  char sbuffer[16];
-  sprintf(sbuffer,"%02d:%02d:%02d",tm.Hour,tm.Minute,tm.Second);
-  return sbuffer;
+/* Writes the date (YYYY-MM-DD) of the given broken-down time, returning
+   the position after the last character (not null-terminated). */
+char* formatDateElements(char *p, const tmElements_t &tm) {
+  p = formatDigits(p,1970+tm.Year,4);
+  *p++ = '-';
+  p = formatDigits(p,tm.Month,2);
+  *p++ = '-';
+  return formatDigits(p,tm.Day,2);
 }
 
 
 //------------------------------------------------------------------------------
-/* Converts the given unix time (in seconds since 1970-01-01 00:00:00 UTC) 
-   to a date string for the local timezone.  Current time will be used if
-   the argument is zero. */
-String getLocalDateString(time_t t) {
-  if (t == 0) t = getUTC();
-  // If t = 0, did not retrieve time from RTC (do not convert)
-  time_t tloc = (t > 0) ? timezone.toLocal(t) : 0;
-  return getDateString(tloc);
+/* Writes the time (hh:mm:ss) of the given broken-down time, returning
+   the position after the last character (not null-terminated). */
+char* formatTimeElements(char *p, const tmElements_t &tm) {
+  p = formatDigits(p,tm.Hour,2);
+  *p++ = ':';
+  p = formatDigits(p,tm.Minute,2);
+  *p++ = ':';
+  return formatDigits(p,tm.Second,2);
 }
 
 
 //------------------------------------------------------------------------------
-/* Converts the given unix time (in seconds since 1970-01-01 00:00:00 UTC) 
-   to a time string for the local timezone.  Current time will be used if
-   the argument is zero. */
-String getLocalTimeString(time_t t) {
-  if (t == 0) t = getUTC();
-  // If t = 0, did not retrieve time from RTC (do not convert)
-  time_t tloc = (t > 0) ? timezone.toLocal(t) : 0;
-  return getTimeString(tloc);
+/* Converts the given time (in seconds since 1970-01-01 00:00:00) to a
+   date, time, or date & time string without any timezone conversion.
+   A non-null label is appended to the date & time string. */
+char* formatDate(char *buff, time_t t) {
+  tmElements_t tm;
+  breakTime(t,tm);
+  *formatDateElements(buff,tm) = '\0';
+  return buff;
+}
+char* formatTime(char *buff, time_t t) {
+  tmElements_t tm;
+  breakTime(t,tm);
+  *formatTimeElements(buff,tm) = '\0';
+  return buff;
+}
+char* formatDateTime(char *buff, time_t t, const char *label) {
+  tmElements_t tm;
+  breakTime(t,tm);
+  char *p = formatDateElements(buff,tm);
+  *p++ = ' ';
+  p = formatTimeElements(p,tm);
+  if (label != NULL) {
+    *p++ = ' ';
+    strncpy(p,label,CLOCK_DATETIME_TZ_LEN - CLOCK_DATETIME_LEN - 1);
+    p[CLOCK_DATETIME_TZ_LEN - CLOCK_DATETIME_LEN - 1] = '\0';
+  } else {
+    *p = '\0';
+  }
+  return buff;
 }
 
 
 //------------------------------------------------------------------------------
 /* Converts the given unix time (in seconds since 1970-01-01 00:00:00 UTC) 
-   to a date & time string for the local timezone.  Current time will be used
-   if the argument is zero. */
-String getLocalDateTimeString(time_t t) {
+   to date and/or time strings for the local timezone.  Current time will
+   be used if the argument is zero (no conversion if the time could not
+   be retrieved from the RTC). */
+char* formatLocalDate(char *buff, time_t t) {
+  if (t == 0) t = getUTC();
+  return formatDate(buff,(t > 0) ? toLocalTime(t) : 0);
+}
+char* formatLocalTime(char *buff, time_t t) {
+  if (t == 0) t = getUTC();
+  return formatTime(buff,(t > 0) ? toLocalTime(t) : 0);
+}
+char* formatLocalDateTime(char *buff, time_t t) {
   if (t == 0) t = getUTC();
   TimeChangeRule *rule;
-  time_t tloc = timezone.toLocal(t,&rule);
+  time_t tloc = toLocalTime(t,&rule);
   // If t = 0, did not retrieve time from RTC (reset to 0).
   // Above still needed to retrieve timezone label.
   if (t == 0) tloc = 0;
-  return getDateString(tloc) + " " + getTimeString(tloc) + " " + String(rule->abbrev);
+  return formatDateTime(buff,tloc,rule->abbrev);
 }
 
 
 //------------------------------------------------------------------------------
 /* Converts the given unix time (in seconds since 1970-01-01 00:00:00 UTC) 
-   to a UTC date string.  Current time will be used if the argument is zero. */
-String getUTCDateString(time_t t) {
+   to UTC date and/or time strings.  Current time will be used if the
+   argument is zero. */
+char* formatUTCDate(char *buff, time_t t) {
   if (t == 0) t = getUTC();
-  return getDateString(t);
+  return formatDate(buff,t);
 }
-
-
-//------------------------------------------------------------------------------
-/* Converts the given unix time (in seconds since 1970-01-01 00:00:00 UTC) 
-   to a UTC time string.  Current time will be used if the argument is zero. */
-String getUTCTimeString(time_t t) {
+char* formatUTCTime(char *buff, time_t t) {
   if (t == 0) t = getUTC();
-  return getTimeString(t);
+  return formatTime(buff,t);
 }
-
-
-//------------------------------------------------------------------------------
-/* Converts the given unix time (in seconds since 1970-01-01 00:00:00 UTC) 
-   to a UTC date & time string.  Current time will be used if the argument is
-   zero. */
-String getUTCDateTimeString(time_t t) {
+char* formatUTCDateTime(char *buff, time_t t) {
   if (t == 0) t = getUTC();
-  return getDateString(t) + " " + getTimeString(t) + " UTC";
+  return formatDateTime(buff,t,"UTC");
 }
 
 
 //------------------------------------------------------------------------------
 /* Converts the given unix time (in seconds since 1970-01-01 00:00:00 UTC) 
-   to a date string intended for database uploads.  Current time will
-   be used if the argument is zero. */
-String getDBDateString(time_t t) {
-  //return getUTCDateString(t);
-  return getLocalDateString(t);
+   to date and/or time strings intended for database uploads.  Current
+   time will be used if the argument is zero. */
+char* formatDBDate(char *buff, time_t t) {
+  //return formatUTCDate(buff,t);
+  return formatLocalDate(buff,t);
 }
-
-
-//------------------------------------------------------------------------------
-/* Converts the given unix time (in seconds since 1970-01-01 00:00:00 UTC) 
-   to a time string intended for database uploads.  Current time will
-   be used if the argument is zero. */
-String getDBTimeString(time_t t) {
-  //return getUTCTimeString(t);
-  return getLocalTimeString(t);
+char* formatDBTime(char *buff, time_t t) {
+  //return formatUTCTime(buff,t);
+  return formatLocalTime(buff,t);
 }
-
-
-//------------------------------------------------------------------------------
-/* Converts the given unix time (in seconds since 1970-01-01 00:00:00 UTC) 
-   to a date & time string intended for database uploads.  Current time will
-   be used if the argument is zero. */
-String getDBDateTimeString(time_t t) {
+char* formatDBDateTime(char *buff, time_t t) {
   if (t == 0) t = getUTC();
-  // MySQL: cannot directly submit ISO 8601 formatted datetime strings.
-  // Just submit and store a MySQL-compatible UTC datetime string.
-  //return getDateString(t) + " " + getTimeString(t);
-  // Use local time instead (if we also send the unix time)
-  time_t tloc = (t != 0) ? timezone.toLocal(t) : 0;
-  return getDateString(tloc) + " " + getTimeString(tloc);
+  // Every reading taken within the same second shares this string
+  if ((t == 0) || (t != dbDateTimeCache.t)) {
+    // MySQL: cannot directly submit ISO 8601 formatted datetime strings.
+    // Just submit and store a MySQL-compatible UTC datetime string.
+    //formatDateTime(dbDateTimeCache.str,t,NULL);
+    // Use local time instead (if we also send the unix time)
+    formatDateTime(dbDateTimeCache.str,(t != 0) ? toLocalTime(t) : 0,NULL);
+    dbDateTimeCache.t = t;
+  }
+  strcpy(buff,dbDateTimeCache.str);
+  return buff;
   
   // ISO 8601 formats:
   //   YYYY-MM-DDThh:mm:ss
@@ -404,6 +781,56 @@ String getDBDateTimeString(time_t t) {
 }
 
 
+//------------------------------------------------------------------------------
+/* String versions of the above.  The date/time strings without a
+   "Local", "UTC" or "DB" qualifier take a local time argument (no
+   timezone conversion). */
+String getDateString(time_t t) {
+  char buff[CLOCK_DATE_LEN];
+  return formatDate(buff,t);
+}
+String getTimeString(time_t t) {
+  char buff[CLOCK_TIME_LEN];
+  return formatTime(buff,t);
+}
+String getLocalDateString(time_t t) {
+  char buff[CLOCK_DATE_LEN];
+  return formatLocalDate(buff,t);
+}
+String getLocalTimeString(time_t t) {
+  char buff[CLOCK_TIME_LEN];
+  return formatLocalTime(buff,t);
+}
+String getLocalDateTimeString(time_t t) {
+  char buff[CLOCK_DATETIME_TZ_LEN];
+  return formatLocalDateTime(buff,t);
+}
+String getUTCDateString(time_t t) {
+  char buff[CLOCK_DATE_LEN];
+  return formatUTCDate(buff,t);
+}
+String getUTCTimeString(time_t t) {
+  char buff[CLOCK_TIME_LEN];
+  return formatUTCTime(buff,t);
+}
+String getUTCDateTimeString(time_t t) {
+  char buff[CLOCK_DATETIME_TZ_LEN];
+  return formatUTCDateTime(buff,t);
+}
+String getDBDateString(time_t t) {
+  char buff[CLOCK_DATE_LEN];
+  return formatDBDate(buff,t);
+}
+String getDBTimeString(time_t t) {
+  char buff[CLOCK_TIME_LEN];
+  return formatDBTime(buff,t);
+}
+String getDBDateTimeString(time_t t) {
+  char buff[CLOCK_DATETIME_LEN];
+  return formatDBDateTime(buff,t);
+}
+
+
 
 // Testing Functions ===========================================================
 
@@ -476,6 +903,38 @@ void testClock(unsigned long cycles, unsigned long interval) {
 //<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
 
+//------------------------------------------------------------------------------
+/* Clock routine benchmarks (see runBenchmarks()).  The RTC registers
+   are decoded from fixed values with the most BCD digits set
+   (2099-12-31 23:59:59); the full RTC read includes the SPI transfer.
+   Date/time formatting is timed both for a new second and for a
+   repeated one (cached). */
+// Benchmark testing >>>>>>>>>>>>>>>>>>>
+#ifdef BENCHMARK_TESTING
+uint8_t benchDS3234Regs[DS3234_TIME_LEN] = {0x59,0x59,0x23,0x05,0x31,0x12,0x99};
+time_t benchClockTime = 1600000000;
+volatile time_t benchClockSink;
+char benchClockBuff[CLOCK_DATETIME_TZ_LEN];
+void benchDecodeDS3234Time() {benchClockSink = decodeDS3234Time(benchDS3234Regs);}
+void benchGetDS3234Time() {benchClockSink = getDS3234Time();}
+void benchToLocalTime() {benchClockSink = toLocalTime(++benchClockTime);}
+void benchFormatDBDateTime() {formatDBDateTime(benchClockBuff,++benchClockTime);}
+void benchFormatDBDateTimeCached() {formatDBDateTime(benchClockBuff,benchClockTime);}
+void benchFormatLocalDateTime() {formatLocalDateTime(benchClockBuff,benchClockTime);}
+
+void benchmarkClock() {
+  initDS3234();
+  runBenchmark(F("decodeDS3234Time"),benchDecodeDS3234Time,64);
+  runBenchmark(F("getDS3234Time"),benchGetDS3234Time,64);
+  runBenchmark(F("toLocalTime"),benchToLocalTime,64);
+  runBenchmark(F("formatDBDateTime"),benchFormatDBDateTime,64);
+  runBenchmark(F("formatDBDateTime (cached)"),benchFormatDBDateTimeCached,64);
+  runBenchmark(F("formatLocalDateTime"),benchFormatLocalDateTime,64);
+}
+#endif
+//<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
 
 // Helper Functions ============================================================
 
@@ -562,6 +1021,14 @@ time_t getDS3234Time() {
   // Get data from RTC in byte array.
   uint8_t v[DS3234_TIME_LEN];
   readDS3234Bytes(DS3234_TIME_ADDR, v, DS3234_TIME_LEN);
+  return decodeDS3234Time(v);
+}
+
+
+//------------------------------------------------------------------------------
+/* Converts the DS3234 time registers (seconds through year, in BCD) to
+   unix time.  Returns 0 if the register values are invalid. */
+time_t decodeDS3234Time(const uint8_t *v) {
   /*
   for (int k = 0; k < DS3234_TIME_LEN; k++) {
     Serial.print(" ");
@@ -678,6 +1145,25 @@ void setDS3234Time(const time_t t) {
 }
 
 
+//------------------------------------------------------------------------------
+/* Get/set the DS3234 crystal aging offset (two's complement, ~0.1 ppm
+   per step at 25 C; positive values slow the oscillator).  The new
+   offset takes effect at the next temperature conversion, which is
+   forced here rather than waiting up to 64 seconds. */
+int8_t getDS3234AgingOffset() {
+  uint8_t v;
+  readDS3234Byte(DS3234_AGING_ADDR, v);
+  return (int8_t)v;
+}
+
+void setDS3234AgingOffset(const int8_t v) {
+  writeDS3234Byte(DS3234_AGING_ADDR, (uint8_t)v);
+  uint8_t control;
+  readDS3234Byte(DS3234_CONTROL_ADDR, control);
+  writeDS3234Byte(DS3234_CONTROL_ADDR, control | DS3234_CONTROL_CONV);
+}
+
+
 //------------------------------------------------------------------------------
 /* Read a single byte from the given register of the DS3234 RTC. */
 void readDS3234Byte(const uint8_t reg, uint8_t &v) {
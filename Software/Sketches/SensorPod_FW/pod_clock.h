@@ -48,6 +48,13 @@
 
 // Constants/global variables ==================================================
 
+// Buffer sizes (including terminating null) for the format* routines
+// below.
+#define CLOCK_DATE_LEN 11          // YYYY-MM-DD
+#define CLOCK_TIME_LEN 9           // hh:mm:ss
+#define CLOCK_DATETIME_LEN 20      // YYYY-MM-DD hh:mm:ss
+#define CLOCK_DATETIME_TZ_LEN 26   // YYYY-MM-DD hh:mm:ss TZLBL
+
 
 // Functions ===================================================================
 
@@ -57,13 +64,47 @@ void initRTC();
 bool probeRTC();
 
 // Set or get the time using unix time: number of seconds since 1970-01-01
-// at 00:00:00 UTC.  Backed by RTC.
+// at 00:00:00 UTC.  Backed by RTC, but read from a millis()-based
+// software clock that re-reads the RTC only every ten minutes.
+// TimeLib's now() (and TimeAlarms) is not tied to this clock, so
+// setting it never disturbs the alarms.
 // As a safety measure, time will not be set if t < 1000000000.
 void setUTC(time_t t);
 time_t getUTC();
 
+// Re-reads the RTC and adjusts the software clock to match (done
+// automatically by getUTC()).
+void resyncClock();
+// Software clock drift relative to RTC [ppm] and resync statistics.
+float getClockDrift();
+void printClockStats();
+
 // Number of seconds since 1970-01-01 at 00:00:00 in configured timezone.
 time_t getLocalTime();
+// Converts the given UTC unix time to local time.  The offset is cached
+// until the next DST transition, so repeated conversions are cheap.
+time_t toLocalTime(time_t utc);
+
+// Sub-second UTC time.  The DS3234 only reports whole seconds (and its
+// square-wave output is not wired), so the millis() timer is locked to
+// the RTC's seconds rollover and used to extrapolate between seconds.
+// The lock is re-established whenever the RTC is set.
+// lockRTCPhase() waits for the next RTC tick (up to ~1 second);
+// refreshRTCPhase() does so only if the lock is older than the given
+// age [s].  getUTCPrecise() returns false if there is no lock.
+bool lockRTCPhase();
+bool refreshRTCPhase(unsigned long maxAge);
+bool getUTCPrecise(time_t &t, uint16_t &ms);
+// Sets the RTC to the given time with millisecond alignment: waits
+// until the next whole second (up to ~1 second) before writing.
+// If that wait would exceed maxWait [ms], the clock is not set and
+// false is returned (useful for non-blocking callers that can retry).
+bool setUTCPrecise(time_t t, uint16_t ms, unsigned long maxWait=1000);
+// Difference (t2 - t1) in milliseconds between two sub-second times.
+// Only valid for differences within ~24 days.
+int32_t diffUTCPrecise(time_t t2, uint16_t ms2, time_t t1, uint16_t ms1);
+// Shifts a sub-second time by the given number of milliseconds.
+void shiftUTCPrecise(time_t &t, uint16_t &ms, int32_t dms);
 
 // Same as above, but using a structure with date/time elements.
 // Note the year field in this structure is numbers of years since 1970
@@ -109,6 +150,19 @@ String getDBDateString(time_t t=0);
 String getDBTimeString(time_t t=0);
 String getDBDateTimeString(time_t t=0);
 
+// Allocation-free versions of the above: write into the given buffer
+// (sized per CLOCK_*_LEN) and return it.  The DB date/time string is
+// cached, so repeated calls within the same second only copy it.
+char* formatLocalDate(char *buff, time_t t=0);        // CLOCK_DATE_LEN
+char* formatLocalTime(char *buff, time_t t=0);        // CLOCK_TIME_LEN
+char* formatLocalDateTime(char *buff, time_t t=0);    // CLOCK_DATETIME_TZ_LEN
+char* formatUTCDate(char *buff, time_t t=0);          // CLOCK_DATE_LEN
+char* formatUTCTime(char *buff, time_t t=0);          // CLOCK_TIME_LEN
+char* formatUTCDateTime(char *buff, time_t t=0);      // CLOCK_DATETIME_TZ_LEN
+char* formatDBDate(char *buff, time_t t=0);           // CLOCK_DATE_LEN
+char* formatDBTime(char *buff, time_t t=0);           // CLOCK_TIME_LEN
+char* formatDBDateTime(char *buff, time_t t=0);       // CLOCK_DATETIME_LEN
+
 // Clock testing routine.
 // Number of cycles (-1 for infinite) and interval between cycles.
 #ifdef CLOCK_TESTING
@@ -119,7 +173,12 @@ void testClock(unsigned long cycles = -1, unsigned long interval = 1000);
 void initDS3234();
 bool probeDS3234();
 time_t getDS3234Time();
+time_t decodeDS3234Time(const uint8_t *v);
 void setDS3234Time(const time_t t);
+// Crystal aging offset trim: each step is ~0.1 ppm at 25 C, with
+// positive values slowing the oscillator.
+int8_t getDS3234AgingOffset();
+void setDS3234AgingOffset(const int8_t v);
 void readDS3234Byte(const uint8_t reg, uint8_t &v);
 void readDS3234Bytes(const uint8_t reg, uint8_t *v, const uint8_t len);
 void writeDS3234Byte(const uint8_t reg, const uint8_t v);
@@ -40,10 +40,18 @@ PodConfigStruct storage = {
   network_default,
   'N',
   upload_default,
-  lightT_default, humidityT_default, tempT_default, soundT_default, co2T_default, pmT_default, coT_default
+  lightT_default, humidityT_default, tempT_default, soundT_default, co2T_default, pmT_default, coT_default,
+  CONFIG_EXT_VERSION,
+  heartbeatT_default, {}, {},
+  {}, {},
+  pmSettleT_default, pmAverageT_default,
+  0
 };
 bool configChanged = false;
 
+static_assert(sizeof(PodConfigStruct) <= EEPROM_RECORD_MAX(EEPROM_CONFIG_SLOT_SIZE),
+              "Configuration does not fit in its EEPROM slots");
+
 bool ratesChanged = false;
 
 bool debugMode = false;
@@ -56,13 +64,7 @@ void savePodConfig() { // Save configuration to SD, EEPROM, and DB.
   String Datetime = getDBDateTimeString();
   Datetime.toCharArray(storage.lastUpdate, 20);
   
-  // Save to EEPROM
-  for (unsigned int t=0; t<sizeof(storage); t++) {
-    //EEPROM.write(EEPROM_CONFIG_ADDR + t, *((char*)&storage + t));
-    // Put only writes byte if different from current EEPROM value
-    // (reduces EEPROM wear).
-    EEPROM.put(EEPROM_CONFIG_ADDR + t, *((char*)&storage + t));
-  }
+  storePodConfig();
   
   if (storage.coord == 'Y') {
     writeSDConfig(storage.devid, storage.room, "Coordinator", storage.project, storage.uploadT, storage.setupD, storage.teardownD, Datetime, storage.networkID);
@@ -78,15 +80,78 @@ void savePodConfig() { // Save configuration to SD, EEPROM, and DB.
   clearPodConfigChanged();
 }
 
-void loadPodConfig() {
+bool storePodConfig() {
+  // Only bytes that differ are written, to the older of the two
+  // copies; nothing is written if the configuration hasn't changed.
+  return saveEEPROMRecord(EEPROM_RECORD_CONFIG,&storage,sizeof(storage),CONFIG_EXT_VERSION);
+}
+
+/* Loads the configuration saved by firmware that predates the EEPROM
+   records, if any.  Returns its extension version (see below), or -1
+   if none found. */
+static int loadLegacyPodConfig() {
   // To make sure there are settings, and they are YOURS!
-  // If nothing is found it will use the default settings.
-  if (EEPROM.read(EEPROM_CONFIG_ADDR + 0) == CONFIG_VERSION[0] &&
-      EEPROM.read(EEPROM_CONFIG_ADDR + 1) == CONFIG_VERSION[1] &&
-      EEPROM.read(EEPROM_CONFIG_ADDR + 2) == CONFIG_VERSION[2] &&
-      EEPROM.read(EEPROM_CONFIG_ADDR + 3) == CONFIG_VERSION[3])
-    for (unsigned int t=0; t<sizeof(storage); t++)
-      *((char*)&storage + t) = EEPROM.read(EEPROM_CONFIG_ADDR + t);
+  if (EEPROM.read(EEPROM_CONFIG_ADDR + 0) != CONFIG_VERSION[0] ||
+      EEPROM.read(EEPROM_CONFIG_ADDR + 1) != CONFIG_VERSION[1] ||
+      EEPROM.read(EEPROM_CONFIG_ADDR + 2) != CONFIG_VERSION[2] ||
+      EEPROM.read(EEPROM_CONFIG_ADDR + 3) != CONFIG_VERSION[3]) return -1;
+  for (unsigned int t=0; t<sizeof(storage); t++)
+    *((char*)&storage + t) = EEPROM.read(EEPROM_CONFIG_ADDR + t);
+  // EEPROM beyond an older configuration is usually 0xFF, hence the
+  // range check on the version.
+  return (storage.extVersion <= CONFIG_EXT_VERSION) ? storage.extVersion : 0;
+}
+
+void loadPodConfig() {
+  // If nothing is found it will use the default settings.  Fields
+  // missing from a record saved by older firmware keep their defaults.
+  uint8_t schema = 0;
+  int ext = -1;
+  bool migrate = false;
+  if (loadEEPROMRecord(EEPROM_RECORD_CONFIG,&storage,sizeof(storage),schema) > 0) {
+    ext = schema;
+    migrate = (ext < CONFIG_EXT_VERSION);
+  } else {
+    ext = loadLegacyPodConfig();
+    migrate = (ext >= 0);
+  }
+  if (ext > CONFIG_EXT_VERSION) ext = CONFIG_EXT_VERSION;
+
+  // Appended settings missing (older configuration) or invalid: use
+  // defaults.
+  // Report-by-exception
+  bool valid = (ext >= 1) && (storage.heartbeatT >= 0);
+  for (uint8_t k = 0; valid && (k < READING_SD_COUNT); k++) {
+    if (!(storage.deadbandAbs[k] >= 0) || !(storage.deadbandRel[k] >= 0)) valid = false;
+  }
+  if (!valid) {
+    storage.heartbeatT = heartbeatT_default;
+    for (uint8_t k = 0; k < READING_SD_COUNT; k++) {
+      storage.deadbandAbs[k] = 0;
+      storage.deadbandRel[k] = 0;
+    }
+  }
+  // Adaptive sampling
+  valid = (ext >= 2);
+  for (uint8_t k = 0; valid && (k < SENSOR_CHANNEL_COUNT); k++) {
+    if ((storage.adaptMinT[k] < 0) || !(storage.adaptThreshold[k] >= 0)) valid = false;
+  }
+  if (!valid) {
+    for (uint8_t k = 0; k < SENSOR_CHANNEL_COUNT; k++) {
+      storage.adaptMinT[k] = 0;
+      storage.adaptThreshold[k] = 0;
+    }
+  }
+  // Particulate matter settle/averaging times
+  if ((ext < 3) || (storage.pmSettleT < 0) || (storage.pmAverageT <= 0)) {
+    storage.pmSettleT = pmSettleT_default;
+    storage.pmAverageT = pmAverageT_default;
+  }
+  // Pushed settings
+  if (ext < 4) storage.pushVersion = 0;
+  storage.extVersion = CONFIG_EXT_VERSION;
+  // Settings from older firmware are moved to the current record
+  if (migrate) storePodConfig();
 }
 
 PodConfigStruct& getPodConfig() {
@@ -200,6 +265,56 @@ int getRateCO() {
   return storage.coT;
 }
 
+int getRate(const SensorChannel ch) {
+  switch (ch) {
+    case SENSOR_LIGHT:     return storage.lightT;
+    case SENSOR_RH:        return storage.humidityT;
+    case SENSOR_GLOBETEMP: return storage.tempT;
+    case SENSOR_SOUND:     return storage.soundT;
+    case SENSOR_CO2:       return storage.co2T;
+    case SENSOR_PM:        return storage.pmT;
+    case SENSOR_CO:        return storage.coT;
+    default:               return 0;
+  }
+}
+
+void setRate(const SensorChannel ch, const int rate) {
+  switch (ch) {
+    case SENSOR_LIGHT:     storage.lightT = rate;     break;
+    case SENSOR_RH:        storage.humidityT = rate;  break;
+    case SENSOR_GLOBETEMP: storage.tempT = rate;      break;
+    case SENSOR_SOUND:     storage.soundT = rate;     break;
+    case SENSOR_CO2:       storage.co2T = rate;       break;
+    case SENSOR_PM:        storage.pmT = rate;        break;
+    case SENSOR_CO:        storage.coT = rate;        break;
+    default:               break;
+  }
+}
+
+int getHeartbeat() {
+  return storage.heartbeatT;
+}
+float getDeadbandAbs(const ReadingType type) {
+  return (type < READING_SD_COUNT) ? storage.deadbandAbs[type] : 0;
+}
+float getDeadbandRel(const ReadingType type) {
+  return (type < READING_SD_COUNT) ? storage.deadbandRel[type] : 0;
+}
+
+int getAdaptiveMin(const SensorChannel ch) {
+  return (ch < SENSOR_CHANNEL_COUNT) ? storage.adaptMinT[ch] : 0;
+}
+float getAdaptiveThreshold(const SensorChannel ch) {
+  return (ch < SENSOR_CHANNEL_COUNT) ? storage.adaptThreshold[ch] : 0;
+}
+
+int getPMSettleTime() {
+  return storage.pmSettleT;
+}
+int getPMAverageTime() {
+  return storage.pmAverageT;
+}
+
 char * getNetID() {
   return storage.networkID;
 }
@@ -12,12 +12,13 @@
 #define POD_CONFIG_H
 
 #include "Arduino.h"
+#include "pod_network.h"
 
 
 //--------------------------------------------------------------------------------------------- [Intro and Setup]
 
 #define setupTimeout 60000 // 60000ms = 1 min
-#define CONFIG_VERSION "demo" // contains extra "\0" character on end.
+#define CONFIG_VERSION "demo" // contains extra "\0" character on end; only checked in settings from older firmware
 //#define CONFIG_START 32
 
 #define lightT_default 60
@@ -26,6 +27,8 @@
 #define soundT_default 60
 #define co2T_default 60
 #define pmT_default 600 //Takes two minutes to warm up and settle down
+#define pmSettleT_default 120
+#define pmAverageT_default 10
 #define coT_default 60
 #define DeviceID "DEFAULT_DEVICEID"
 #define project_default "Demonstration"
@@ -35,16 +38,63 @@
 #define upload_default 3600
 #define update_default "1970-01-01 00:00:00"
 #define network_default "ABCD"
+#define heartbeatT_default 3600
+
+// Version of the fields appended to the original structure below
+// (extVersion), also the schema version of the EEPROM record (see
+// pod_eeprom.h).  Configurations saved by older firmware lack some or
+// all of them; the missing ones are given defaults when loaded.
+// Fields are only ever appended, so a record saved by newer firmware
+// can still be loaded (its extra fields are ignored).
+//   1: report-by-exception (deadbands and heartbeat)
+//   2: adaptive sampling
+//   3: particulate matter sensor settle/averaging times
+//   4: version of the settings pushed by the coordinator
+#define CONFIG_EXT_VERSION 4
+
+// Sensors with separately configured sampling intervals (see the
+// ...T interval fields below).
+enum SensorChannel : uint8_t {
+  SENSOR_LIGHT, SENSOR_RH, SENSOR_GLOBETEMP, SENSOR_SOUND, SENSOR_CO2,
+  SENSOR_PM, SENSOR_CO,
+  SENSOR_CHANNEL_COUNT
+};
 
 struct PodConfigStruct {
   char pod_version[5], server[61], devid[17], project [17], room[17], setupD[11], teardownD[11], lastUpdate[20], networkID[5];
   char coord; // 
   int uploadT,lightT,humidityT,tempT,soundT,co2T,pmT,coT;
+  uint8_t extVersion;
+  // Report-by-exception: a reading is uploaded/sent only if it differs
+  // from the last one sent by more than the absolute deadband (reading
+  // units) or the relative deadband (fraction of the last value), or if
+  // heartbeatT seconds have passed since then.  Types with both
+  // deadbands zero send every reading.  All readings are logged to SD.
+  int heartbeatT;
+  float deadbandAbs[READING_SD_COUNT];
+  float deadbandRel[READING_SD_COUNT];
+  // Adaptive sampling: for sensors with a minimum interval (0 to
+  // disable) below the configured interval, the interval is shortened
+  // while the reading changes faster than the threshold [units/minute]
+  // and lengthened back to the configured interval when it is stable.
+  int adaptMinT[SENSOR_CHANNEL_COUNT];
+  float adaptThreshold[SENSOR_CHANNEL_COUNT];
+  // Particulate matter sensor: time the sensor runs before its readings
+  // are trusted, followed by the window over which its 1 Hz readings
+  // are averaged into each reported value [s] (see pod_pmplan.h).
+  int pmSettleT;
+  int pmAverageT;
+  // Version of the last settings push applied (drones; 0 if none, see
+  // pod_remote.h).
+  uint16_t pushVersion;
 };
 
 
 void loadPodConfig();
 void savePodConfig();
+// Saves the configuration to EEPROM only (savePodConfig() also writes
+// it to the SD card and sends it to the server).
+bool storePodConfig();
 PodConfigStruct& getPodConfig();
 bool podConfigChanged();
 void setPodConfigChanged();
@@ -77,5 +127,17 @@ int getRateSound();
 int getRateCO2();
 int getRatePM();
 int getRateCO();
+int getRate(const SensorChannel ch);
+void setRate(const SensorChannel ch, const int rate);
+
+int getHeartbeat();
+float getDeadbandAbs(const ReadingType type);
+float getDeadbandRel(const ReadingType type);
+
+int getAdaptiveMin(const SensorChannel ch);
+float getAdaptiveThreshold(const SensorChannel ch);
+
+int getPMSettleTime();
+int getPMAverageTime();
 
 #endif
@@ -0,0 +1,235 @@
+/*==============================================================================
+  Various eeprom-related constants and functions.
+
+  This file is part of the LMN PODD distribution:
+    https://github.com/lmnts/PODD
+
+  CONTRIBUTORS:
+    PODD contributors (2026)
+
+  COPYRIGHT/LICENSE:
+  Copyright (c) 2026 LMN Architects
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Affero General Public License as
+  published by the Free Software Foundation, either version 3 of the
+  License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Affero General Public License for more details.
+
+  You should have received a copy of the GNU Affero General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+==============================================================================*/
+
+#include "pod_eeprom.h"
+#include "pod_util.h"
+
+#include <EEPROM.h>
+
+
+// Global variables ============================================================
+
+// Slot locations of each record.
+struct EEPROMSlots {
+  uint16_t addr;    // first slot; the second follows it
+  uint16_t size;    // size of each slot, header included
+};
+static const EEPROMSlots EEPROM_SLOTS[EEPROM_RECORD_COUNT] PROGMEM = {
+  {EEPROM_CONFIG_SLOT_ADDR,  EEPROM_CONFIG_SLOT_SIZE},
+  {EEPROM_CLOCK_SLOT_ADDR,   EEPROM_CLOCK_SLOT_SIZE},
+  {EEPROM_NETWORK_SLOT_ADDR, EEPROM_NETWORK_SLOT_SIZE},
+  {EEPROM_PUSH_SLOT_ADDR,    EEPROM_PUSH_SLOT_SIZE},
+  {EEPROM_FIRMWARE_SLOT_ADDR, EEPROM_FIRMWARE_SLOT_SIZE}
+};
+
+// Record names for status output.
+static const char EEPROM_NAME_CONFIG[] PROGMEM  = "config";
+static const char EEPROM_NAME_CLOCK[] PROGMEM   = "clock";
+static const char EEPROM_NAME_NETWORK[] PROGMEM = "network";
+static const char EEPROM_NAME_PUSH[] PROGMEM    = "push";
+static const char EEPROM_NAME_FIRMWARE[] PROGMEM = "firmware";
+static const char * const EEPROM_NAMES[EEPROM_RECORD_COUNT] PROGMEM = {
+  EEPROM_NAME_CONFIG, EEPROM_NAME_CLOCK, EEPROM_NAME_NETWORK,
+  EEPROM_NAME_PUSH, EEPROM_NAME_FIRMWARE
+};
+
+// Header bytes covered by the CRC (all but the CRC itself).
+#define EEPROM_HEADER_CRC_LEN offsetof(EEPROMRecordHeader,crc)
+
+// Current copy of each record, found by checking both of its slots the
+// first time the record is accessed.
+struct EEPROMRecordState {
+  bool scanned;
+  int8_t slot;                  // current slot (-1 if none valid)
+  EEPROMRecordHeader header;    // header of the current slot
+  uint8_t valid;                // bit k: slot k valid
+};
+EEPROMRecordState eepromState[EEPROM_RECORD_COUNT];
+
+// Bytes actually written since startup (unchanged bytes are skipped).
+uint32_t eepromBytesWritten = 0;
+
+
+// Functions ===================================================================
+
+/* CRC-16/CCITT (polynomial 0x1021), one byte at a time. */
+static uint16_t crc16Update(uint16_t crc, const uint8_t b) {
+  crc ^= (uint16_t)b << 8;
+  for (uint8_t k = 0; k < 8; k++) {
+    crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : (crc << 1);
+  }
+  return crc;
+}
+
+
+uint16_t crc16(uint16_t crc, const void *data, const uint16_t len) {
+  for (uint16_t k = 0; k < len; k++) crc = crc16Update(crc,((const uint8_t*)data)[k]);
+  return crc;
+}
+
+
+/* Address of the given slot of the given record. */
+static uint16_t slotAddress(const EEPROMRecord rec, const uint8_t slot) {
+  return pgm_read_word(&EEPROM_SLOTS[rec].addr)
+         + slot * pgm_read_word(&EEPROM_SLOTS[rec].size);
+}
+
+
+static void readEEPROM(const uint16_t addr, void *data, const uint16_t len) {
+  for (uint16_t k = 0; k < len; k++) ((uint8_t*)data)[k] = EEPROM.read(addr + k);
+}
+
+
+/* Writes only the bytes that differ from the EEPROM's contents. */
+static void updateEEPROM(const uint16_t addr, const void *data, const uint16_t len) {
+  for (uint16_t k = 0; k < len; k++) {
+    const uint8_t b = ((const uint8_t*)data)[k];
+    if (EEPROM.read(addr + k) == b) continue;
+    EEPROM.write(addr + k,b);
+    eepromBytesWritten++;
+  }
+}
+
+
+/* Reads the header of the given slot and checks its CRC against the
+   slot's data, read straight from the EEPROM. */
+static bool checkSlot(const EEPROMRecord rec, const uint8_t slot,
+                      EEPROMRecordHeader &h) {
+  const uint16_t addr = slotAddress(rec,slot);
+  readEEPROM(addr,&h,sizeof(h));
+  if (h.id != (EEPROM_RECORD_ID | rec)) return false;
+  if (h.length > EEPROM_RECORD_MAX(pgm_read_word(&EEPROM_SLOTS[rec].size))) return false;
+  uint16_t crc = crc16(0xFFFF,&h,EEPROM_HEADER_CRC_LEN);
+  for (uint16_t k = 0; k < h.length; k++) {
+    crc = crc16Update(crc,EEPROM.read(addr + sizeof(h) + k));
+  }
+  return (crc == h.crc);
+}
+
+
+/* Finds the current copy of the given record. */
+static EEPROMRecordState& scanRecord(const EEPROMRecord rec) {
+  EEPROMRecordState &s = eepromState[rec];
+  if (s.scanned) return s;
+  s.scanned = true;
+  s.slot = -1;
+  s.valid = 0;
+  for (uint8_t k = 0; k < 2; k++) {
+    EEPROMRecordHeader h;
+    if (!checkSlot(rec,k,h)) continue;
+    s.valid |= (1 << k);
+    // Sequence numbers wrap around: the newer is ahead by less than half
+    if ((s.slot < 0) || ((int16_t)(h.seq - s.header.seq) > 0)) {
+      s.slot = k;
+      s.header = h;
+    }
+  }
+  return s;
+}
+
+
+uint16_t loadEEPROMRecord(const EEPROMRecord rec, void *data,
+                          const uint16_t size, uint8_t &schema) {
+  if (rec >= EEPROM_RECORD_COUNT) return 0;
+  const EEPROMRecordState &s = scanRecord(rec);
+  if (s.slot < 0) return 0;
+  const uint16_t len = min(size,s.header.length);
+  readEEPROM(slotAddress(rec,s.slot) + sizeof(EEPROMRecordHeader),data,len);
+  schema = s.header.schema;
+  return s.header.length;
+}
+
+
+bool saveEEPROMRecord(const EEPROMRecord rec, const void *data,
+                      const uint16_t length, const uint8_t schema) {
+  if (rec >= EEPROM_RECORD_COUNT) return false;
+  if (length > EEPROM_RECORD_MAX(pgm_read_word(&EEPROM_SLOTS[rec].size))) return false;
+  EEPROMRecordState &s = scanRecord(rec);
+
+  // Nothing to do if the current copy is the same
+  if ((s.slot >= 0) && (s.header.schema == schema) && (s.header.length == length)) {
+    const uint16_t addr = slotAddress(rec,s.slot) + sizeof(EEPROMRecordHeader);
+    uint16_t k = 0;
+    while ((k < length) && (EEPROM.read(addr + k) == ((const uint8_t*)data)[k])) k++;
+    if (k == length) return true;
+  }
+
+  // The data is written before the header, but the CRC covers both, so
+  // a partly written slot is never taken for the current one.
+  const uint8_t slot = (s.slot < 0) ? 0 : 1 - s.slot;
+  EEPROMRecordHeader h;
+  h.id = EEPROM_RECORD_ID | rec;
+  h.schema = schema;
+  h.seq = (s.slot < 0) ? 0 : s.header.seq + 1;
+  h.length = length;
+  h.crc = crc16(crc16(0xFFFF,&h,EEPROM_HEADER_CRC_LEN),data,length);
+  const uint16_t addr = slotAddress(rec,slot);
+  updateEEPROM(addr + sizeof(h),data,length);
+  updateEEPROM(addr,&h,sizeof(h));
+
+  // Verify
+  EEPROMRecordHeader check;
+  if (!checkSlot(rec,slot,check) || (check.crc != h.crc)) {
+    s.valid &= ~(1 << slot);
+    Serial.print(F("WARNING: Failed to save "));
+    Serial.print((FType)pgm_read_word(&EEPROM_NAMES[rec]));
+    Serial.println(F(" settings to EEPROM."));
+    return false;
+  }
+  s.valid |= (1 << slot);
+  s.slot = slot;
+  s.header = h;
+  return true;
+}
+
+
+//------------------------------------------------------------------------------
+// Prints the slots of each record to serial.
+//
+void printEEPROMStatus() {
+  char buff[48];
+  Serial.println(F("EEPROM records:  slot     seq  schema  length  copies"));
+  for (uint8_t k = 0; k < EEPROM_RECORD_COUNT; k++) {
+    const EEPROMRecordState &s = scanRecord((EEPROMRecord)k);
+    PGM_P name = (PGM_P)pgm_read_word(&EEPROM_NAMES[k]);
+    Serial.print(F("  "));
+    Serial.print((FType)name);
+    for (size_t j = strlen_P(name); j < 14; j++) Serial.print(' ');
+    if (s.slot < 0) {
+      Serial.println(F("   -       -       -       -       0"));
+      continue;
+    }
+    sprintf(buff,"%4d  %6u  %6u  %6u  %6u",s.slot,s.header.seq,s.header.schema,
+            s.header.length,(s.valid & 1) + (s.valid >> 1));
+    Serial.println(buff);
+  }
+  Serial.print(F("  Bytes written since startup: "));
+  Serial.println(eepromBytesWritten);
+}
+
+
+//==============================================================================
@@ -1,6 +1,13 @@
 /*==============================================================================
   Various eeprom-related constants and functions.
 
+  Settings are stored as records, each with two slots that are written
+  alternately.  A slot holds a header (record ID, schema version,
+  sequence number, length and CRC) followed by the record's data.  The
+  valid slot with the higher sequence number is the current copy, so a
+  write cut short by a power loss leaves the previous copy in place.
+  Only bytes that differ from the slot's old contents are written.
+
   This file is part of the LMN PODD distribution:
     https://github.com/lmnts/PODD
 
@@ -29,7 +36,7 @@
 
 // Standard libraries
 // Contributed libraries
-//#include <Arduino.h>
+#include <Arduino.h>
 //#include <EEPROM.h>
 // Local headers
 
@@ -49,21 +56,83 @@
 // clashing.  Teensy++ 2.0 has 4096 bytes of EEPROM [0x0000 - 0x0FFF].
 // Constants below are for starting address of memory blocks.
 
-// Location of configuration data [0x0020 - 0x01FF].
-// Currently uses ~ 200 bytes, but leaving space for future
-// expansion.
+// Locations of settings saved by older firmware, read only to migrate
+// them to the records below (and left in place so older firmware can
+// still be loaded).
+// Configuration data [0x0020 - 0x01FF].
 #define EEPROM_CONFIG_ADDR 0x0020
-// Location of clock data [0x0400 - 0x0479].
-// Currently contains timezone information.
+// Clock data [0x0400 - 0x0479]: timezone information.
 #define EEPROM_CLOCK_ADDR 0x0400
-// Location of network configuration data [0x0500 - 0x0579].
-// Currently contains timezone information.
+// Network configuration data [0x0500 - 0x0579].
 #define EEPROM_NETWORK_ADDR 0x0500
 
+// Record slots: two of the given size for each record, one after the
+// other from the given address.
+// Configuration data [0x0600 - 0x09FF].
+// Currently uses ~ 320 bytes, but leaving space for future
+// expansion.
+#define EEPROM_CONFIG_SLOT_ADDR 0x0600
+#define EEPROM_CONFIG_SLOT_SIZE 0x0200
+// Clock data [0x0A00 - 0x0A7F]: timezone information.
+#define EEPROM_CLOCK_SLOT_ADDR 0x0A00
+#define EEPROM_CLOCK_SLOT_SIZE 0x0040
+// Network configuration data [0x0A80 - 0x0AFF].
+#define EEPROM_NETWORK_SLOT_ADDR 0x0A80
+#define EEPROM_NETWORK_SLOT_SIZE 0x0040
+// Settings pushed to drones [0x0B00 - 0x0BFF] (coordinator).
+#define EEPROM_PUSH_SLOT_ADDR 0x0B00
+#define EEPROM_PUSH_SLOT_SIZE 0x0080
+// Firmware image handoff to the bootloader [0x0C00 - 0x0C7F] (see
+// pod_ota.h).  Kept at this address for the bootloader's sake.
+#define EEPROM_FIRMWARE_SLOT_ADDR 0x0C00
+#define EEPROM_FIRMWARE_SLOT_SIZE 0x0040
+
+// Stored records.
+enum EEPROMRecord : uint8_t {
+  EEPROM_RECORD_CONFIG,
+  EEPROM_RECORD_CLOCK,
+  EEPROM_RECORD_NETWORK,
+  EEPROM_RECORD_PUSH,
+  EEPROM_RECORD_FIRMWARE,
+  EEPROM_RECORD_COUNT
+};
+
+// Header at the start of each record slot.  The CRC (CRC-16/CCITT)
+// covers the rest of the header and the data.
+struct EEPROMRecordHeader {
+  uint8_t id;         // EEPROM_RECORD_ID | record
+  uint8_t schema;     // version of the record's data layout
+  uint16_t seq;       // incremented on each write
+  uint16_t length;    // data length [bytes]
+  uint16_t crc;
+};
+#define EEPROM_RECORD_ID 0xA0
+
+// Largest data length of each record.
+#define EEPROM_RECORD_MAX(size) ((size) - sizeof(EEPROMRecordHeader))
+
 
 // Functions ===================================================================
 
-// No functions
+// CRC-16/CCITT of the given data, continuing from the given CRC (start
+// with 0xFFFF).  Also used to check settings packets sent over XBee.
+uint16_t crc16(uint16_t crc, const void *data, const uint16_t len);
+
+// Loads the current copy of the given record into the buffer (up to
+// size bytes; the rest of the buffer is left as is, so fields appended
+// since the record was written keep the values they had).  Returns the
+// stored data length, or 0 if neither slot holds a valid copy.  The
+// schema version the record was written with is returned in schema.
+uint16_t loadEEPROMRecord(const EEPROMRecord rec, void *data,
+                          const uint16_t size, uint8_t &schema);
+// Saves the given record to its older slot, unless the current copy is
+// identical.  Returns false if the data does not fit or the write
+// could not be verified (the previous copy stays current).
+bool saveEEPROMRecord(const EEPROMRecord rec, const void *data,
+                      const uint16_t length, const uint8_t schema);
+
+// Prints the slots of each record to serial.
+void printEEPROMStatus();
 
 
 //==============================================================================
@@ -0,0 +1,282 @@
+/*==============================================================================
+  Sensor health tracking and recovery.
+
+  This file is part of the LMN PODD distribution:
+    https://github.com/lmnts/PODD
+
+  CONTRIBUTORS:
+    PODD contributors (2026)
+
+  COPYRIGHT/LICENSE:
+  Copyright (c) 2026 LMN Architects
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Affero General Public License as
+  published by the Free Software Foundation, either version 3 of the
+  License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Affero General Public License for more details.
+
+  You should have received a copy of the GNU Affero General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+==============================================================================*/
+
+#include "pod_health.h"
+#include "pod_quality.h"
+#include "pod_sampling.h"
+#include "pod_sensors.h"
+#include "pod_stats.h"
+#include "pod_util.h"
+
+
+// Global variables ============================================================
+
+// Health state of each sensor.  Times are millis() values.
+struct HealthState {
+  SensorHealth health;
+  uint8_t faults;         // faults in a row (up to 255)
+  unsigned long since;    // first fault in a row, or when failed
+  uint16_t backoff;       // time from failure to next retry [s]
+  uint16_t reinits;       // driver re-initializations
+  uint16_t retries;       // retries of a failed sensor
+  uint32_t skipped;       // reads skipped while failed
+};
+HealthState healthState[SENSOR_CHANNEL_COUNT];
+
+// Health state names for status output.
+static const char HEALTH_NAME_OK[] PROGMEM       = "healthy";
+static const char HEALTH_NAME_DEGRADED[] PROGMEM = "degraded";
+static const char HEALTH_NAME_FAILED[] PROGMEM   = "failed";
+static const char HEALTH_NAME_RETRYING[] PROGMEM = "retrying";
+static const char * const HEALTH_NAMES[] PROGMEM = {
+  HEALTH_NAME_OK, HEALTH_NAME_DEGRADED, HEALTH_NAME_FAILED,
+  HEALTH_NAME_RETRYING
+};
+
+
+// Functions ===================================================================
+
+/* Re-initializes the driver of the given sensor and starts the
+   statistics of its readings over. */
+static void reinitSensor(const SensorChannel ch) {
+  healthState[ch].reinits++;
+  switch (ch) {
+    case SENSOR_LIGHT:
+      initLightSensor();
+      break;
+    case SENSOR_RH:
+      initTemperatureSensor();
+      break;
+    case SENSOR_GLOBETEMP:
+      initGlobeTemperatureSensor();
+      break;
+    case SENSOR_SOUND: {
+      const bool sampling = isSoundSampling();
+      initSoundSensor();
+      if (sampling) startSoundSampling();
+      break;
+    }
+    case SENSOR_CO2:
+      initCO2Sensor();
+      break;
+    case SENSOR_PM:
+      // Power cycle a running sensor.  A duty-cycled sensor is powered
+      // off by the planner after each reading in any case.
+      if (isPMSensorRunning()) {
+        powerOffPMSensor();
+        powerOnPMSensor();
+        startPMSensor();
+      }
+      break;
+    case SENSOR_CO:
+      initCOSensor();
+      break;
+    default:
+      break;
+  }
+  resetQualityState(ch);
+}
+
+
+/* Tests communication with the given sensor, as at startup.  Sensors
+   that cannot be probed (sound, CO) are assumed present; their next
+   reading decides.  The particulate matter sensor is left powered and
+   measuring if present, and powered off otherwise. */
+static bool probeSensor(const SensorChannel ch) {
+  switch (ch) {
+    case SENSOR_LIGHT:
+      return probeLightSensor();
+    case SENSOR_RH:
+      return probeTemperatureSensor();
+    case SENSOR_GLOBETEMP:
+      return probeGlobeTemperatureSensor();
+    case SENSOR_CO2:
+      // Communication sometimes fails intermittently
+      for (int k = 0; k < 3; k++) {
+        delay(10);
+        if (probeCO2Sensor()) return true;
+      }
+      return false;
+    case SENSOR_PM:
+      powerOnPMSensor();
+      delay(10);
+      startPMSensor();
+      delay(10);
+      if (probePMSensor()) return true;
+      stopPMSensor();
+      powerOffPMSensor();
+      return false;
+    default:
+      return true;
+  }
+}
+
+
+/* Marks the given sensor as failed, with the given time [s] until it
+   is retried. */
+static void failSensor(const SensorChannel ch, const uint16_t backoff) {
+  HealthState &h = healthState[ch];
+  h.health = HEALTH_FAILED;
+  h.since = millis();
+  h.backoff = backoff;
+  Serial.print(F("WARNING: "));
+  Serial.print((FType)getSensorName(ch));
+  Serial.print(F(" sensor not working: readings suspended, retrying in "));
+  Serial.print(backoff);
+  Serial.println(F(" s."));
+}
+
+
+void initSensorHealth(const SensorChannel ch, const bool present) {
+  if (ch >= SENSOR_CHANNEL_COUNT) return;
+  HealthState &h = healthState[ch];
+  h.health = HEALTH_OK;
+  h.faults = 0;
+  if (!present) failSensor(ch,HEALTH_BACKOFF_MIN);
+}
+
+
+bool isSensorReadable(const SensorChannel ch) {
+  if (ch >= SENSOR_CHANNEL_COUNT) return true;
+  HealthState &h = healthState[ch];
+  if (h.health != HEALTH_FAILED) return true;
+  if (millis() - h.since < 1000UL * h.backoff) {
+    h.skipped++;
+    return false;
+  }
+  h.retries++;
+  Serial.print(F("Retrying "));
+  Serial.print((FType)getSensorName(ch));
+  Serial.println(F(" sensor..."));
+  reinitSensor(ch);
+  if (!probeSensor(ch)) {
+    h.skipped++;
+    failSensor(ch,min(2*(uint32_t)h.backoff,(uint32_t)HEALTH_BACKOFF_MAX));
+    return false;
+  }
+  h.health = HEALTH_RETRYING;
+  h.faults = 0;
+  return true;
+}
+
+
+void reportSensorResult(const ReadingType type, const bool fault) {
+  const SensorChannel ch = getReadingChannel(type);
+  if (ch >= SENSOR_CHANNEL_COUNT) return;
+  HealthState &h = healthState[ch];
+  if (!fault) {
+    if (h.health == HEALTH_RETRYING) {
+      Serial.print((FType)getSensorName(ch));
+      Serial.println(F(" sensor recovered."));
+    }
+    h.health = HEALTH_OK;
+    h.faults = 0;
+    return;
+  }
+
+  if (h.faults < 255) h.faults++;
+  switch (h.health) {
+    case HEALTH_OK:
+      h.health = HEALTH_DEGRADED;
+      h.since = millis();
+      // Fall through (a single fault may be enough)
+    case HEALTH_DEGRADED:
+      if ((h.faults >= HEALTH_FAIL_FAULTS)
+          || (millis() - h.since >= 1000UL * HEALTH_DEGRADED_TIME)) {
+        failSensor(ch,HEALTH_BACKOFF_MIN);
+      } else if (h.faults == HEALTH_REINIT_FAULTS) {
+        Serial.print(F("Re-initializing "));
+        Serial.print((FType)getSensorName(ch));
+        Serial.println(F(" sensor."));
+        reinitSensor(ch);
+      }
+      break;
+    case HEALTH_RETRYING:
+      failSensor(ch,min(2*(uint32_t)h.backoff,(uint32_t)HEALTH_BACKOFF_MAX));
+      break;
+    default:
+      break;
+  }
+}
+
+
+void reportReadFailure(const ReadingType type) {
+  countReadFailure(type);
+  reportSensorResult(type,true);
+}
+
+
+SensorHealth getSensorHealth(const SensorChannel ch) {
+  if (ch >= SENSOR_CHANNEL_COUNT) return HEALTH_OK;
+  return healthState[ch].health;
+}
+
+
+uint32_t getSensorReinits() {
+  uint32_t n = 0;
+  for (uint8_t k = 0; k < SENSOR_CHANNEL_COUNT; k++) n += healthState[k].reinits;
+  return n;
+}
+
+
+uint32_t getSensorReadsSkipped() {
+  uint32_t n = 0;
+  for (uint8_t k = 0; k < SENSOR_CHANNEL_COUNT; k++) n += healthState[k].skipped;
+  return n;
+}
+
+
+//------------------------------------------------------------------------------
+// Prints the health of each sensor in use to serial.
+//
+void printSensorHealth() {
+  char buff[48];
+  Serial.println(F("Sensor health:        state     faults  reinits  retries  skipped"));
+  for (uint8_t k = 0; k < SENSOR_CHANNEL_COUNT; k++) {
+    const SensorChannel ch = (SensorChannel)k;
+    if (getSamplingInterval(ch) == 0) continue;
+    const HealthState &h = healthState[k];
+    PGM_P name = getSensorName(ch);
+    Serial.print(F("  "));
+    Serial.print((FType)name);
+    for (size_t j = strlen_P(name); j < 20; j++) Serial.print(' ');
+    Serial.print((FType)pgm_read_word(&HEALTH_NAMES[h.health]));
+    for (size_t j = strlen_P((PGM_P)pgm_read_word(&HEALTH_NAMES[h.health])); j < 8; j++) Serial.print(' ');
+    sprintf(buff," %8u %8u %8u %8lu",h.faults,h.reinits,h.retries,(unsigned long)h.skipped);
+    Serial.print(buff);
+    if (h.health == HEALTH_FAILED) {
+      const unsigned long elapsed = (millis() - h.since) / 1000;
+      Serial.print(F("  (retry in "));
+      Serial.print((elapsed < h.backoff) ? h.backoff - elapsed : 0);
+      Serial.print(F(" s)"));
+    }
+    Serial.println();
+  }
+}
+
+
+//==============================================================================
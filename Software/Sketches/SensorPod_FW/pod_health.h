@@ -0,0 +1,99 @@
+/*==============================================================================
+  Sensor health tracking and recovery.
+
+  This file is part of the LMN PODD distribution:
+    https://github.com/lmnts/PODD
+
+  CONTRIBUTORS:
+    PODD contributors (2026)
+
+  COPYRIGHT/LICENSE:
+  Copyright (c) 2026 LMN Architects
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Affero General Public License as
+  published by the Free Software Foundation, either version 3 of the
+  License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Affero General Public License for more details.
+
+  You should have received a copy of the GNU Affero General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+==============================================================================*/
+
+#pragma once
+
+// Standard libraries
+// Contributed libraries
+#include <Arduino.h>
+// Local headers
+#include "pod_config.h"
+#include "pod_network.h"
+
+
+// Constants/global variables ==================================================
+
+// Health of a sensor.  Each sensor result (a reading, or a failure to
+// read) is good or a fault: a failed read, or a range/stuck/invalid
+// reading (see pod_quality.h).
+//   healthy:  last result good
+//   degraded: faults in a row, still read; the driver is re-initialized
+//             after HEALTH_REINIT_FAULTS of them
+//   failed:   given up on after HEALTH_FAIL_FAULTS faults in a row, or
+//             faults for longer than HEALTH_DEGRADED_TIME; not read at
+//             all (no time lost to driver timeouts) until a retry is due
+//   retrying: re-initialized and probed successfully after the backoff
+//             time; healthy again on the next good result, otherwise
+//             failed with twice the backoff time (up to the maximum)
+// A sensor found missing at startup starts out failed.
+enum SensorHealth : uint8_t {
+  HEALTH_OK,
+  HEALTH_DEGRADED,
+  HEALTH_FAILED,
+  HEALTH_RETRYING
+};
+
+// Faults in a row after which a degraded sensor is re-initialized.
+#define HEALTH_REINIT_FAULTS 3
+// Faults in a row after which a sensor is failed.
+#define HEALTH_FAIL_FAULTS 6
+// Longest time [s] a sensor may give only faults before it is failed
+// (sensors with long intervals fail before HEALTH_FAIL_FAULTS).
+#define HEALTH_DEGRADED_TIME 900
+// Time [s] before the first retry of a failed sensor, and the longest
+// time between retries.  Retries happen when the sensor is next due to
+// be read after this time.
+#define HEALTH_BACKOFF_MIN 60
+#define HEALTH_BACKOFF_MAX 3600
+
+
+// Functions ===================================================================
+
+// Sets the initial health of a sensor at startup from its probe result.
+void initSensorHealth(const SensorChannel ch, const bool present);
+// Indicates if the given sensor should be read now.  Sensor read
+// routines should return without reading if not.  For a failed sensor
+// with a retry due, the sensor is first re-initialized and probed.
+bool isSensorReadable(const SensorChannel ch);
+// Records a good or faulty result from the sensor that produces the
+// given reading type.
+void reportSensorResult(const ReadingType type, const bool fault);
+// Records a failed attempt to read the sensor for the given reading
+// type (counted as a read failure and as a sensor fault).
+void reportReadFailure(const ReadingType type);
+
+// Current health of the given sensor.
+SensorHealth getSensorHealth(const SensorChannel ch);
+// Total driver re-initializations and reads skipped since startup.
+uint32_t getSensorReinits();
+uint32_t getSensorReadsSkipped();
+
+// Prints the health of each sensor in use to serial.
+void printSensorHealth();
+
+
+//==============================================================================
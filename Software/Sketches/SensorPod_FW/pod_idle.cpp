@@ -0,0 +1,166 @@
+/*==============================================================================
+  Low-power idling between scheduled events.
+
+  This file is part of the LMN PODD distribution:
+    https://github.com/lmnts/PODD
+
+  CONTRIBUTORS:
+    PODD contributors (2026)
+
+  COPYRIGHT/LICENSE:
+  Copyright (c) 2026 LMN Architects
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Affero General Public License as
+  published by the Free Software Foundation, either version 3 of the
+  License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Affero General Public License for more details.
+
+  You should have received a copy of the GNU Affero General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+==============================================================================*/
+
+#include "pod_idle.h"
+#include "pod_network.h"
+#include "pod_ota.h"
+#include "pod_pmplan.h"
+#include "pod_remote.h"
+#include "pod_util.h"
+
+#include <avr/sleep.h>
+#include <TimeAlarms.h>
+
+
+// Global variables ============================================================
+
+// Idle statistics since startup.  Each wake is one interrupt that
+// interrupted a sleep; most are timer ticks that find nothing to do.
+struct IdleStats {
+  uint32_t periods;
+  uint32_t wakes;
+  uint32_t idleMillis;
+  uint32_t endedBy[IDLE_WAKE_COUNT];
+};
+IdleStats idleStats = {};
+
+// Names for the IdleWake reasons, for status output.
+static const char IDLE_WAKE_NAME_TIMEOUT[] PROGMEM = "timeout";
+static const char IDLE_WAKE_NAME_ALARM[] PROGMEM   = "alarm";
+static const char IDLE_WAKE_NAME_PM[] PROGMEM      = "PM sensor";
+static const char IDLE_WAKE_NAME_XBEE[] PROGMEM    = "XBee";
+static const char IDLE_WAKE_NAME_SERIAL[] PROGMEM  = "serial";
+static const char IDLE_WAKE_NAME_ANSWER[] PROGMEM  = "answer";
+static const char * const IDLE_WAKE_NAMES[IDLE_WAKE_COUNT] PROGMEM = {
+  IDLE_WAKE_NAME_TIMEOUT, IDLE_WAKE_NAME_ALARM, IDLE_WAKE_NAME_PM,
+  IDLE_WAKE_NAME_XBEE, IDLE_WAKE_NAME_SERIAL, IDLE_WAKE_NAME_ANSWER
+};
+
+
+// Functions ===================================================================
+
+/* Number of bytes the XBee ISR has received so far. */
+static uint32_t xbeeReceivedCount() {
+  uint32_t received, overrun, parsed;
+  getXBeeCounters(received,overrun,parsed);
+  return received;
+}
+
+
+void idleUntilNextEvent() {
+  const unsigned long start = millis();
+  unsigned long limit = IDLE_MAX_TIME;
+  IdleWake reason = IDLE_WAKE_TIMEOUT;
+
+  // The PM planner's next step and delayed answers are known in
+  // milliseconds; alarms are scheduled in whole seconds, so are
+  // checked against now() below.
+  const unsigned long pmTime = getPMPlannerIdleTime();
+  if (pmTime < limit) {
+    limit = pmTime;
+    reason = IDLE_WAKE_PM;
+  }
+  const unsigned long ackTime = getConfigPushIdleTime();
+  if (ackTime < limit) {
+    limit = ackTime;
+    reason = IDLE_WAKE_ANSWER;
+  }
+  const unsigned long otaTime = getFirmwareUpdateIdleTime();
+  if (otaTime < limit) {
+    limit = otaTime;
+    reason = IDLE_WAKE_ANSWER;
+  }
+  const time_t nextAlarm = Alarm.getNextTrigger();
+  const uint32_t received = xbeeReceivedCount();
+
+  #ifdef IDLE_SLEEP
+  set_sleep_mode(SLEEP_MODE_IDLE);
+  #endif
+  while (true) {
+    if (millis() - start >= limit) break;
+    if ((nextAlarm != 0) && (now() >= nextAlarm)) {
+      reason = IDLE_WAKE_ALARM;
+      break;
+    }
+    if (xbeeReceivedCount() != received) {
+      reason = IDLE_WAKE_XBEE;
+      break;
+    }
+    if (Serial.available()) {
+      reason = IDLE_WAKE_SERIAL;
+      break;
+    }
+    #ifdef IDLE_SLEEP
+    // Interrupts are enabled by sei() only after the following
+    // instruction, so an interrupt cannot slip in between the two and
+    // leave the CPU asleep with nothing left to wake it.
+    cli();
+    sleep_enable();
+    sei();
+    sleep_cpu();
+    sleep_disable();
+    idleStats.wakes++;
+    #endif
+  }
+
+  idleStats.periods++;
+  idleStats.idleMillis += millis() - start;
+  idleStats.endedBy[reason]++;
+  Alarm.delay(0);
+}
+
+
+//------------------------------------------------------------------------------
+// Prints idle time and wake statistics to serial.
+// 
+void printIdleStats() {
+  const unsigned long t = millis();
+  Serial.print(F("  Idle:           "));
+  Serial.print((t > 0) ? 100.0 * idleStats.idleMillis / t : 0.0,1);
+  Serial.print(F("% of uptime in "));
+  Serial.print(idleStats.periods);
+  Serial.print(F(" periods"));
+  #ifdef IDLE_SLEEP
+  Serial.print(F(", "));
+  Serial.print(idleStats.wakes);
+  Serial.print(F(" wakes ("));
+  Serial.print((idleStats.idleMillis > 0) ? 1000.0 * idleStats.wakes / idleStats.idleMillis : 0.0,0);
+  Serial.print(F("/s)"));
+  #endif
+  Serial.println();
+  Serial.print(F("    ended by"));
+  for (uint8_t k = 0; k < IDLE_WAKE_COUNT; k++) {
+    Serial.print((k > 0) ? F(", ") : F(" "));
+    Serial.print((FType)pgm_read_word(&IDLE_WAKE_NAMES[k]));
+    Serial.print(' ');
+    Serial.print(idleStats.endedBy[k]);
+  }
+  Serial.println();
+}
+
+
+//==============================================================================
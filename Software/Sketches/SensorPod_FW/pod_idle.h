@@ -0,0 +1,76 @@
+/*==============================================================================
+  Low-power idling between scheduled events.
+
+  This file is part of the LMN PODD distribution:
+    https://github.com/lmnts/PODD
+
+  CONTRIBUTORS:
+    PODD contributors (2026)
+
+  COPYRIGHT/LICENSE:
+  Copyright (c) 2026 LMN Architects
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Affero General Public License as
+  published by the Free Software Foundation, either version 3 of the
+  License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Affero General Public License for more details.
+
+  You should have received a copy of the GNU Affero General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+==============================================================================*/
+
+#pragma once
+
+// Standard libraries
+// Contributed libraries
+#include <Arduino.h>
+// Local headers
+
+// Comment out to busy-wait between events instead of sleeping (as
+// older firmware did), e.g. when measuring loop timing.
+#define IDLE_SLEEP
+
+
+// Constants/global variables ==================================================
+
+// Longest single idle period [ms].  The loop's own housekeeping (time
+// sync, statistics, etc.) is polled at least this often.
+#define IDLE_MAX_TIME 1000
+
+// Why an idle period ended.
+enum IdleWake : uint8_t {
+  IDLE_WAKE_TIMEOUT,    // nothing happened within the allowed time
+  IDLE_WAKE_ALARM,      // a TimeAlarms alarm/timer is due
+  IDLE_WAKE_PM,         // the particulate matter planner is due
+  IDLE_WAKE_XBEE,       // XBee data received
+  IDLE_WAKE_SERIAL,     // USB serial command received
+  IDLE_WAKE_ANSWER,     // a delayed answer to the coordinator (settings
+                        // push or firmware update), or firmware staging
+                        // work, is due
+  IDLE_WAKE_COUNT
+};
+
+
+// Functions ===================================================================
+
+// Waits until the next scheduled event (alarm, particulate matter
+// planner step, delayed answer), incoming XBee or serial data, or
+// IDLE_MAX_TIME, whichever comes first, servicing due alarms before
+// returning.
+// With IDLE_SLEEP, the CPU sleeps in between: AVR idle mode stops only
+// the CPU clock, so Timer0 (millis), Timer1 (XBee ISR), Timer3 (sound
+// ISR), the UARTs and the pin change interrupt (CO2 sensor serial)
+// keep running and any of their interrupts wakes it briefly.
+void idleUntilNextEvent();
+
+// Prints idle time and wake statistics to serial.
+void printIdleStats();
+
+
+//==============================================================================
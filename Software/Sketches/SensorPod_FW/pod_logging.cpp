@@ -18,6 +18,15 @@
 #include "pod_config.h"
 #include "pod_network.h"
 #include "pod_sensors.h"
+#include "pod_trace.h"
+#include "pod_stats.h"
+#include "pod_sampling.h"
+#include "pod_pmplan.h"
+#include "pod_idle.h"
+#include "pod_health.h"
+#include "pod_remote.h"
+#include "pod_ota.h"
+#include "pod_status.h"
 
 #include <SD.h>
 
@@ -26,12 +35,14 @@
 // should allow for 10-12).
 #include <TimeAlarms.h>
 
-// Frequencies at which to poll NTP server for current time
-// and at which to broadcast the current time to other nodes;
-// both apply only to the coordinator node.  Intervals are in
-// seconds.
-#define NTP_POLL_INTERVAL 3600
-#define CLOCK_BROADCAST_INTERVAL 60
+// Frequency at which to broadcast the current time to other
+// nodes; applies only to the coordinator node.  Interval is in
+// seconds.  Drones keep their clocks aligned through a two-way
+// time sync exchange (see maintainTimeSync()), so the broadcast
+// only serves as a coarse fallback.  The coordinator's own NTP
+// polling is run from the main loop with an adaptive interval
+// (see maintainNTP()).
+#define CLOCK_BROADCAST_INTERVAL 900
 
 // Frequency at which to broadcast the coordinator's address.
 // Needed by drones to permit unicast addressing, which reduces
@@ -43,6 +54,21 @@
 // to update their destination if the coordinator node changes.
 #define ADDRESS_BROADCAST_INTERVAL 60
 
+// Interval [s] at which memory usage (see getMemoryStats()) is
+// appended to the SD card diagnostics file PODMEM.CSV.  Define
+// MEMORY_UPLOAD to also upload the worst-case free memory and
+// largest free heap block as "MemFree"/"MemLargest" readings.
+#define MEMORY_LOG_INTERVAL 3600
+//#define MEMORY_UPLOAD
+
+// Interval [s] at which the runtime counters (see pod_stats.h) are
+// appended to the SD card diagnostics file PODSTATS.CSV.  Define
+// STATS_UPLOAD to also upload a health record: loop rate and totals
+// of sensor read failures, dropped XBee packets and failed POSTs
+// ("LoopRate"/"ReadFail"/"PktDrop"/"PostFail" readings).
+#define STATS_LOG_INTERVAL 3600
+//#define STATS_UPLOAD
+
 #define logint 01 // whenever seconds hit 01 (RTC)
 //SET START MONTH, DAY, HOUR, AND MINUTE.
 int startMonth = 0, startDay = 0, startHr = 0, startMinute = 0;
@@ -59,6 +85,14 @@ char timestamp[30];
 File logFile;
 #endif
 
+// Memory diagnostics logging
+bool memoryLogged = false;
+unsigned long memoryLogMillis = 0;
+
+// Runtime counters logging
+bool statsLogged = false;
+unsigned long statsLogMillis = 0;
+
 
 //----------------------------------------------------------------------
 
@@ -111,7 +145,7 @@ void setupSDLogging() {
 
   Serial.print(exists ? F("Logging to existing file: ") :  F("Logging to new file: "));
   Serial.println(filename);
-  String header = F("Timestamp, Date/Time, Light, RH, Air Temp (F), Globe Temp, Sound (dB), CO2 (PPM), PM 2.5, PM 10, CO_SpecSensor"); // FILE HEADER
+  String header = F("Timestamp, Date/Time, Light, RH, Air Temp (F), Globe Temp, Sound (dB), CO2 (PPM), PM 2.5, PM 10, CO_SpecSensor, Interval (s), Quality"); // FILE HEADER
   if (!exists) {
     dataFile.println(header);
   }
@@ -128,6 +162,40 @@ void logDataSD(String sensorData) {
   dataFile.flush();
 }
 
+// Writes one data row for the given readings: unix timestamp, local
+// date/time, one column per sensor type (empty if not among the
+// readings), the sampling interval in effect for the sensor and the
+// quality flags of the readings (combined; 0 if none).
+// Written piecewise to avoid building the row in memory.
+void logReadingsSD(const Reading *r, const uint8_t n) {
+  if (n == 0) return;
+  #ifdef DEBUG
+  writeDebugLog(F("Fxn: logReadingsSD"));
+  #endif
+  char buff[CLOCK_DATETIME_LEN];
+  size_t bytes = dataFile.print((unsigned long)r[0].utc);
+  bytes += dataFile.print(F(", "));
+  bytes += dataFile.print(formatDBDateTime(buff,r[0].utc));
+  for (uint8_t type = 0; type < READING_SD_COUNT; type++) {
+    bytes += dataFile.print(F(", "));
+    for (uint8_t k = 0; k < n; k++) {
+      if (r[k].type != type) continue;
+      char vbuff[READING_VALUE_LEN];
+      bytes += dataFile.print(formatReadingValue(vbuff,r[k]));
+      break;
+    }
+  }
+  bytes += dataFile.print(F(", "));
+  bytes += dataFile.print(getSamplingInterval(getReadingChannel(r[0].type)));
+  uint8_t quality = 0;
+  for (uint8_t k = 0; k < n; k++) quality |= r[k].quality;
+  bytes += dataFile.print(F(", "));
+  bytes += dataFile.print(quality);
+  bytes += dataFile.println();
+  dataFile.flush();
+  countSDWrite(bytes);
+}
+
 void writeSDConfig(String DID, String Location, String Coordinator, String Project, String Rate, String Setup, String Teardown, String Datetime, String NetID) {
   char setname[] = "PODSET.CSV";
   SdFile::dateTimeCallback(sdDateTime);
@@ -167,14 +235,55 @@ void writeSDConfig(String DID, String Location, String Coordinator, String Proje
 
 void handleLoopLogging() {
   // do any tasks required by the config in loop
+  TRACE_BEGIN(TRACE_MEMORY);
+  maintainMemoryStats();
+  TRACE_END(TRACE_MEMORY);
+  maintainPodStats();
   if(getModeCoord()) {
+    TRACE_BEGIN(TRACE_ALARMS);
     Alarm.delay(0);
+    TRACE_END(TRACE_ALARMS);
+    TRACE_BEGIN(TRACE_XBEE);
     processXBee();
+    TRACE_END(TRACE_XBEE);
+    TRACE_BEGIN(TRACE_NTP);
+    maintainNTP();
+    TRACE_END(TRACE_NTP);
+    maintainConfigPush();
+    maintainFirmwareUpdate();
+    maintainStatusServer();
   }
   else {
-    Alarm.delay(250); // Checks all alarm.timerRepeat events from setup()
+    TRACE_BEGIN(TRACE_ALARMS);
+    // Idles (sleeping, if enabled) until the next alarm or other event
+    // is due, then checks all alarm.timerRepeat events from setup()
+    idleUntilNextEvent();
+    TRACE_END(TRACE_ALARMS);
+    TRACE_BEGIN(TRACE_XBEE);
     processXBee();
+    TRACE_END(TRACE_XBEE);
+    TRACE_BEGIN(TRACE_TIMESYNC);
+    maintainTimeSync();
+    TRACE_END(TRACE_TIMESYNC);
+    maintainConfigPush();
+    maintainFirmwareUpdate();
   }
+  TRACE_BEGIN(TRACE_PM);
+  maintainPMPlanner();
+  TRACE_END(TRACE_PM);
+}
+
+/* Checks if the particulate matter sensor is available, leaving it
+   powered and measuring if so and powered off if not. */
+static bool probePM() {
+  powerOnPMSensor();
+  delay(10);
+  startPMSensor();
+  delay(10);
+  if (probePMSensor()) return true;
+  stopPMSensor();
+  powerOffPMSensor();
+  return false;
 }
 
 void setupSensorTimers() {
@@ -187,21 +296,21 @@ void setupSensorTimers() {
   // NOTE: Delay in XBee sensor reading upload routine prevents pileup.
   const int init_delay = 0;
 
+  // Sensors that fail their probe here are still scheduled: they
+  // start out failed and are retried with a backoff (see pod_health.h).
+
   // Illuminance
   if(getRateLight() > 0) {
-    if (probeLightSensor()) {
-      Alarm.timerRepeat(getRateLight(),lightLog);
-      delay(init_delay);
-    } else {
-      Serial.println(F("WARNING: Failed to communicate with light sensor."));
-      Serial.println(F("         No readings will be performed."));
-    }
+    initSensorHealth(SENSOR_LIGHT,probeLightSensor());
+    registerSamplingAlarm(SENSOR_LIGHT,Alarm.timerRepeat(getRateLight(),lightLog));
+    delay(init_delay);
   }
 
   // Sound: turn off background sampling if not needed
   if(getRateSound() > 0) {
     startSoundSampling();
-    Alarm.timerRepeat(getRateSound(),soundLog);
+    initSensorHealth(SENSOR_SOUND,true);
+    registerSamplingAlarm(SENSOR_SOUND,Alarm.timerRepeat(getRateSound(),soundLog));
     delay(init_delay);
   } else {
     stopSoundSampling();
@@ -209,18 +318,15 @@ void setupSensorTimers() {
 
   // Humidity/temperature
   if(getRateRH() > 0) {
-    if (probeTemperatureSensor()) {
-      Alarm.timerRepeat(getRateRH(),humidityLog);
-      delay(init_delay);
-    } else {
-      Serial.println(F("WARNING: Failed to communicate with temperature/humidity sensor."));
-      Serial.println(F("         No readings will be performed."));
-    }
+    initSensorHealth(SENSOR_RH,probeTemperatureSensor());
+    registerSamplingAlarm(SENSOR_RH,Alarm.timerRepeat(getRateRH(),humidityLog));
+    delay(init_delay);
   }
 
   // Radiant temperature
   if(getRateGlobeTemp() > 0) {
-    Alarm.timerRepeat(getRateGlobeTemp(),tempLog);
+    initSensorHealth(SENSOR_GLOBETEMP,true);
+    registerSamplingAlarm(SENSOR_GLOBETEMP,Alarm.timerRepeat(getRateGlobeTemp(),tempLog));
     delay(init_delay);
   }
 
@@ -228,69 +334,74 @@ void setupSensorTimers() {
   if(getRateCO2()> 0) {
     // Communication with CO2 sensor sometimes intermittently fails:
     // try a few times to ensure sensor really unavailable before
-    // disabling measurements.
+    // suspending measurements.
     bool b = false;
     for (int k = 0; k < 3; k++) {
       delay(10);
       b = probeCO2Sensor();
       if (b) break;
     }
-    if (b) {
-      Alarm.timerRepeat(getRateCO2(),co2Log);
-      delay(init_delay);
-    } else {
-      Serial.println(F("WARNING: Failed to communicate with CO2 sensor."));
-      Serial.println(F("         No readings will be performed."));
-    }
+    initSensorHealth(SENSOR_CO2,b);
+    registerSamplingAlarm(SENSOR_CO2,Alarm.timerRepeat(getRateCO2(),co2Log));
+    delay(init_delay);
   }
   
   // CO sensor
   if(getRateCO() > 0) {
-    Alarm.timerRepeat(getRateCO(),coLog);  
+    initSensorHealth(SENSOR_CO,true);
+    registerSamplingAlarm(SENSOR_CO,Alarm.timerRepeat(getRateCO(),coLog));  
     delay(init_delay);
   }
 
-  // Particulate matter sensor: turn off if not using
-  // or if long time between measurements.
+  // Particulate matter sensor: the planner powers it on only as
+  // needed to take (averaged) readings at the configured interval,
+  // or turns it off if not using.
   // First check if sensor is available.
-  bool pmAvailable = false;
-  if (getRatePM() > 0) {
-    powerOnPMSensor();
-    delay(10);
-    startPMSensor();
-    delay(10);
-    pmAvailable = probePMSensor();
-    if (!pmAvailable) {
-      Serial.println(F("WARNING: Failed to communicate with particulate matter sensor."));
-      Serial.println(F("         No readings will be performed."));
+  if (getRatePM() > 0) initSensorHealth(SENSOR_PM,probePM());
+  startPMPlanner(getRatePM());
+  printPMPlan();
+}
+
+/* Applies changed sensor intervals (e.g. pushed by the coordinator)
+   without a restart.  Sensors enabled (again) get a new alarm here;
+   disabled ones free theirs. */
+void updateSensorTimers() {
+  static const OnTick_t LOG_FUNCTIONS[SENSOR_CHANNEL_COUNT] = {
+    lightLog, humidityLog, tempLog, soundLog, co2Log, NULL, coLog
+  };
+  for (uint8_t k = 0; k < SENSOR_CHANNEL_COUNT; k++) {
+    const SensorChannel ch = (SensorChannel)k;
+    if (LOG_FUNCTIONS[k] == NULL) continue;
+    const int rate = getRate(ch);
+    const bool enabled = (getSamplingInterval(ch) > 0);
+    if (!setSamplingRate(ch,rate) && (rate > 0)) {
+      registerSamplingAlarm(ch,Alarm.timerRepeat(rate,LOG_FUNCTIONS[k]));
     }
+    if (!enabled && (rate > 0)) initSensorHealth(ch,true);
   }
-  if (!pmAvailable) {
-    stopPMSensor();
-    powerOffPMSensor();
-  } else if(getRatePM() > 120) {
-    stopPMSensor();
-    powerOffPMSensor();
-    Alarm.timerRepeat(getRatePM(), particleWarmup);
-    delay(init_delay);
-  } else if(getRatePM() > 0){
-    powerOnPMSensor();
-    delay(10);
-    startPMSensor();
-    Alarm.timerRepeat(getRatePM(), particleLog);
-    delay(init_delay);
-  } else {
-    stopPMSensor();
-    powerOffPMSensor();
+
+  // Sound: background sampling only if needed
+  if ((getRateSound() > 0) && !isSoundSampling()) {
+    startSoundSampling();
+  } else if (getRateSound() <= 0) {
+    stopSoundSampling();
+  }
+
+  // Particulate matter sensor: new plan
+  if (getRatePM() != getPMPlan().interval) {
+    if ((getRatePM() > 0) && (getPMPlan().interval == 0)) {
+      initSensorHealth(SENSOR_PM,probePM());
+    }
+    startPMPlanner(getRatePM());
+    printPMPlan();
   }
 }
 
-/* Set up timers for network-related tasks, like updating the
-   time from NTP, broadcasting the time across XBee network,
-   and broadcasting the coordinator's address. */
+/* Set up timers for network-related tasks, like broadcasting
+   the time across XBee network and broadcasting the coordinator's
+   address. */
 void setupNetworkTimers() {
   if (getModeCoord()) {
-    Alarm.timerRepeat(NTP_POLL_INTERVAL,updateClockFromNTP);
     Alarm.timerRepeat(CLOCK_BROADCAST_INTERVAL,broadcastClock);
     Alarm.timerRepeat(ADDRESS_BROADCAST_INTERVAL,broadcastCoordinatorAddress);
   }
@@ -301,8 +412,10 @@ void setupNetworkTimers() {
 // sensor logging functions
 
 void humidityLog() {
+  if (!isSensorReadable(SENSOR_RH)) return;
   if (!retrieveTemperatureData()) {
     Serial.println(F("Failed to retrieve temperature/humidity data."));
+    reportReadFailure(READING_HUMIDITY);
     return;
   }
   float AirTemp = getTemperature();
@@ -314,115 +427,246 @@ void humidityLog() {
   //Serial.print(AirTemp * 1.8 + 32);
   Serial.print(AirTemp);
   Serial.println(F(" °F"));
-  String RHstr(RH);
-  String AirTempstr(AirTemp);
-  saveReading("", RHstr, AirTempstr, "", "", "", "", "", "");
+  time_t utc = getUTC();
+  Reading readings[2] = {{utc, RH, READING_HUMIDITY},
+                         {utc, AirTemp, READING_AIRTEMP}};
+  saveReadings(readings, 2);
 }
 
 void lightLog() {
+  if (!isSensorReadable(SENSOR_LIGHT)) return;
   float light = getLight();
   if (isnan(light)) {
     Serial.println(F("Failed to retrieve light data."));
+    reportReadFailure(READING_LIGHT);
     return;
   }
   Serial.print(F("Light: "));
   Serial.print(light);
   Serial.println(F(" lux"));
-  String lightstr(light);
-  saveReading(lightstr, "", "", "", "", "", "", "", "");
+  Reading reading = {getUTC(), light, READING_LIGHT};
+  saveReading(reading);
 }
 
 void tempLog() {
+  if (!isSensorReadable(SENSOR_GLOBETEMP)) return;
   float T = getGlobeTemperature();
   if (isnan(T)) {
     Serial.println(F("Failed to retrieve globe temperature."));
+    reportReadFailure(READING_GLOBETEMP);
     return;
   }
   Serial.print(F("TempG: "));
   Serial.print(T);
   Serial.println(F(" °F"));
-  String GTempstr(T);
-  saveReading("", "", "", GTempstr, "", "", "", "", "");
+  Reading reading = {getUTC(), T, READING_GLOBETEMP};
+  saveReading(reading);
 }
 
 void soundLog() {
+  if (!isSensorReadable(SENSOR_SOUND)) return;
   float sound_amp = getSound();
   if (isnan(sound_amp)) {
     Serial.println(F("Failed to retrieve sound level."));
+    reportReadFailure(READING_SOUND);
     return;
   }
   Serial.print(F("Sound: "));
   Serial.print(sound_amp);
   Serial.println(F(" [arb]"));
-  String Soundstr(sound_amp);
-  saveReading("", "", "", "", Soundstr, "", "", "", "");
+  Reading reading = {getUTC(), sound_amp, READING_SOUND};
+  saveReading(reading);
 }
 
 void co2Log() {
+  if (!isSensorReadable(SENSOR_CO2)) return;
   int co2 = getCO2();
   if (co2 < 0) {
     Serial.println(F("Failed to retrieve CO2 level."));
+    reportReadFailure(READING_CO2);
     return;
   }
   Serial.print(F("CO2: "));
   Serial.print(co2);
   Serial.println(F(" ppm"));
-  String CO2str(co2);
-  saveReading("", "", "", "", "", CO2str, "", "", "");
+  Reading reading = {getUTC(), (float)co2, READING_CO2};
+  saveReading(reading);
 }
 
 void coLog() {
+  if (!isSensorReadable(SENSOR_CO)) return;
   float CoSpecRaw = getCO();
   Serial.print(F("CO: "));
   Serial.print(CoSpecRaw);
   Serial.println(F(" [arb]"));
-  String CoSpecRawstr(CoSpecRaw);
-  saveReading("", "", "", "", "", "", "", "", CoSpecRawstr);
+  Reading reading = {getUTC(), CoSpecRaw, READING_CO};
+  saveReading(reading);
 }
 
 
-void particleWarmup() {
-  powerOnPMSensor();
-  delay(10);
-  startPMSensor();
-  // Sensor does not return data for ~ 5 seconds,
-  // but takes 80-120 seconds for measurements to
-  // settle down (initially very inaccurate).
-  Alarm.timerOnce(120,particleLog);
-  Serial.println(F("Warming up particulate matter sensor."));
+//------------------------------------------------------------------------------
+// Samples memory usage and periodically writes it to SD (and uploads
+// it, if enabled).  The first entry is written shortly after startup,
+// which also marks resets in the diagnostics file.
+void maintainMemoryStats() {
+  updateMemoryStats();
+  if (memoryLogged && (millis() - memoryLogMillis < 1000UL * MEMORY_LOG_INTERVAL)) return;
+  memoryLogged = true;
+  memoryLogMillis = millis();
+  logMemoryStatsSD();
+  #ifdef MEMORY_UPLOAD
+  const MemoryStats &w = getMemoryStatsWorst();
+  time_t utc = getUTC();
+  Reading readings[2] = {{utc, (float)w.stackUnused, READING_MEM_FREE},
+                         {utc, (float)w.largestFree, READING_MEM_LARGEST}};
+  postReading(readings[0]);
+  postReading(readings[1]);
+  #endif
 }
 
-void particleLog() {
-  //updatePM();
-  if (retrievePMData()) {
-    double c2_5 = getPM2_5();
-    double c10 = getPM10();
-    if (isnan(c2_5) || (c2_5 < 0) || isnan(c10) || (c10 < 0)) {
-      Serial.println(F("Failed to retrieve particle meter data."));
-      if(getRatePM() > 120) {
-        powerOffPMSensor();
-      }
-      return;
+// Appends current and worst-case memory usage to PODMEM.CSV, along
+// with the peak XBee receive buffer use.
+void logMemoryStatsSD() {
+  char memname[] = "PODMEM.CSV";
+  SdFile::dateTimeCallback(sdDateTime);
+  bool exists = SD.exists(memname);
+  File memFile = SD.open(memname, FILE_WRITE);
+  if (!memFile) {
+    Serial.print(F("\nError opening "));
+    Serial.print(memname);
+    Serial.println("!");
+    countSDWrite(0);
+    return;
+  }
+  if (!exists) {
+    memFile.println(F("Timestamp, Date/Time, Uptime [s], Free RAM, Free RAM min, Stack peak, Never used min, Heap size max, Heap free list, Largest free, Largest free min, XBee buffer peak"));
+  }
+  
+  MemoryStats stats;
+  getMemoryStats(stats);
+  const MemoryStats &w = getMemoryStatsWorst();
+  time_t utc = getUTC();
+  char buff[CLOCK_DATETIME_LEN];
+  size_t bytes = memFile.print((unsigned long)utc);
+  bytes += memFile.print(F(", "));
+  bytes += memFile.print(formatDBDateTime(buff,utc));
+  const unsigned long values[] = {millis()/1000, stats.freeRAM, w.freeRAM,
+                                  w.stackPeak, w.stackUnused, w.heapSize,
+                                  stats.heapFree, stats.largestFree,
+                                  w.largestFree, getXBeeBufferHighWater()};
+  for (uint8_t k = 0; k < sizeof(values)/sizeof(values[0]); k++) {
+    bytes += memFile.print(F(", "));
+    bytes += memFile.print(values[k]);
+  }
+  bytes += memFile.println();
+  memFile.close();
+  countSDWrite(bytes);
+}
+
+
+//------------------------------------------------------------------------------
+// Periodically writes the runtime counters to SD (and uploads a health
+// record, if enabled).  As with the memory statistics, the first entry
+// is written shortly after startup.
+void maintainPodStats() {
+  if (statsLogged && (millis() - statsLogMillis < 1000UL * STATS_LOG_INTERVAL)) return;
+  statsLogged = true;
+  statsLogMillis = millis();
+  logPodStatsSD();
+  #ifdef STATS_UPLOAD
+  const PodStats &stats = getPodStats();
+  time_t utc = getUTC();
+  Reading readings[4] = {{utc, stats.loopRate, READING_LOOP_RATE},
+                         {utc, (float)getReadFailures(), READING_READ_FAILURES},
+                         {utc, (float)getPacketsDropped(), READING_PACKET_DROPS},
+                         {utc, (float)stats.postFailures, READING_POST_FAILURES}};
+  for (uint8_t k = 0; k < 4; k++) {
+    postReading(readings[k]);
+  }
+  #endif
+}
+
+// Appends the runtime counters (totals since startup) to PODSTATS.CSV.
+void logPodStatsSD() {
+  char statsname[] = "PODSTATS.CSV";
+  SdFile::dateTimeCallback(sdDateTime);
+  bool exists = SD.exists(statsname);
+  File statsFile = SD.open(statsname, FILE_WRITE);
+  if (!statsFile) {
+    Serial.print(F("\nError opening "));
+    Serial.print(statsname);
+    Serial.println("!");
+    countSDWrite(0);
+    return;
+  }
+  if (!exists) {
+    statsFile.print(F("Timestamp, Date/Time, Uptime [s], Loops, Loop rate [1/s], Loop max [us]"));
+    char name[READING_NAME_LEN];
+    for (uint8_t type = 0; type < READING_SD_COUNT; type++) {
+      formatReadingName(name,(ReadingType)type);
+      statsFile.print(F(", "));
+      statsFile.print(name);
+      statsFile.print(F(", "));
+      statsFile.print(name);
+      statsFile.print(F(" fail"));
     }
-    
-    Serial.print(F("PM_2.5: "));
-    Serial.print(c2_5);
-    Serial.println(F(" ug/m^3"));
-    Serial.print(F("PM_10:  "));
-    Serial.print(c10);
-    Serial.println(F(" ug/m^3"));
-    String PM2_5str(c2_5);
-    String PM10str(c10);
-    saveReading("", "", "", "", "", "", PM2_5str, PM10str, "");
-  } else {
-    Serial.println(F("Failed to retrieve particle meter data."));
+    statsFile.println(F(", SD bytes, SD flushes, SD errors, XBee bytes in, XBee overrun, XBee bytes out, XBee packets out, Packets parsed, Dropped truncated, Dropped empty, Dropped no length, Dropped bad length, Dropped malformed, Dropped unknown, POST sent, POST no response, POST failed, POST total [ms], POST max [ms], Readings not sent, Flagged range, Flagged spike, Flagged stuck, Flagged invalid, Sensor reinits, Sensor reads skipped"));
   }
 
-  if(getRatePM() > 120) {
-    powerOffPMSensor();
+  const PodStats &s = getPodStats();
+  uint32_t xbeeIn, xbeeOverrun, packetsParsed;
+  getXBeeCounters(xbeeIn,xbeeOverrun,packetsParsed);
+  time_t utc = getUTC();
+  char buff[CLOCK_DATETIME_LEN];
+  size_t bytes = statsFile.print((unsigned long)utc);
+  bytes += statsFile.print(F(", "));
+  bytes += statsFile.print(formatDBDateTime(buff,utc));
+  bytes += statsFile.print(F(", "));
+  bytes += statsFile.print(millis()/1000);
+  bytes += statsFile.print(F(", "));
+  bytes += statsFile.print(s.loops);
+  bytes += statsFile.print(F(", "));
+  bytes += statsFile.print(s.loopRate);
+  bytes += statsFile.print(F(", "));
+  bytes += statsFile.print(s.loopTimeMax);
+  for (uint8_t type = 0; type < READING_SD_COUNT; type++) {
+    bytes += statsFile.print(F(", "));
+    bytes += statsFile.print(s.readings[type]);
+    bytes += statsFile.print(F(", "));
+    bytes += statsFile.print(s.readFailures[type]);
+  }
+  const unsigned long values[] = {s.sdBytes, s.sdFlushes, s.sdErrors,
+                                  xbeeIn, xbeeOverrun, s.xbeeBytesOut,
+                                  s.xbeePacketsOut, packetsParsed};
+  for (uint8_t k = 0; k < sizeof(values)/sizeof(values[0]); k++) {
+    bytes += statsFile.print(F(", "));
+    bytes += statsFile.print(values[k]);
+  }
+  for (uint8_t k = 0; k < PACKET_DROP_REASON_COUNT; k++) {
+    bytes += statsFile.print(F(", "));
+    bytes += statsFile.print(s.packetsDropped[k]);
   }
+  const unsigned long totals[] = {s.postSuccesses, s.postTimeouts,
+                                  s.postFailures, s.postTimeTotal,
+                                  s.postTimeMax, s.readingsSuppressed};
+  for (uint8_t k = 0; k < sizeof(totals)/sizeof(totals[0]); k++) {
+    bytes += statsFile.print(F(", "));
+    bytes += statsFile.print(totals[k]);
+  }
+  for (uint8_t k = 0; k < QUALITY_FLAG_COUNT; k++) {
+    bytes += statsFile.print(F(", "));
+    bytes += statsFile.print(s.qualityFlags[k]);
+  }
+  bytes += statsFile.print(F(", "));
+  bytes += statsFile.print(getSensorReinits());
+  bytes += statsFile.print(F(", "));
+  bytes += statsFile.print(getSensorReadsSkipped());
+  bytes += statsFile.println();
+  statsFile.close();
+  countSDWrite(bytes);
 }
 
+
 //------------------------------------------------------------------------------
 // call back for file timestamps
 void sdDateTime(uint16_t* date, uint16_t* time) {
@@ -464,7 +708,8 @@ void writeDebugLog(String message) {
   time_t utc = getUTC();
   String logData = "";
   String TS(utc);
-  String DT = getDBDateTimeString(utc);
+  char dtbuff[CLOCK_DATETIME_LEN];
+  String DT(formatDBDateTime(dtbuff,utc));
   logData = (TS + ", " + DT + ", " + message + ", " + freeRAM());
   logFile.println(logData);
   logFile.close();
@@ -11,6 +11,7 @@
 #define POD_LOGGING_H
 
 #include "Arduino.h"
+#include "pod_network.h"
 
 #ifdef DEBUG
 void writeDebugLog(String message);
@@ -20,11 +21,17 @@ void setupRTC();
 void setupPodSD();
 void setupSDLogging();
 void logDataSD(String sensorData);
+void logReadingsSD(const Reading *r, const uint8_t n);
 void writeSDConfig(String DID, String Location, String Coordinator, String Project, String Rate, String Setup, String Teardown, String Datetime, String NetID);
 void sdDateTime(uint16_t* date, uint16_t* time);
 void setupSensorTimers();
+void updateSensorTimers();
 void setupNetworkTimers();
 void handleLoopLogging();
+void maintainMemoryStats();
+void logMemoryStatsSD();
+void maintainPodStats();
+void logPodStatsSD();
 
 // log readings
 void humidityLog();
@@ -33,7 +40,5 @@ void tempLog();
 void soundLog();
 void co2Log();
 void coLog();
-void particleWarmup();
-void particleLog();
 
 #endif
@@ -33,6 +33,17 @@
 #include "pod_network.h"
 #include "pod_logging.h"
 #include "pod_sensors.h"
+#include "pod_trace.h"
+#include "pod_stats.h"
+#include "pod_sampling.h"
+#include "pod_pmplan.h"
+#include "pod_idle.h"
+#include "pod_quality.h"
+#include "pod_health.h"
+#include "pod_eeprom.h"
+#include "pod_remote.h"
+#include "pod_ota.h"
+#include "pod_status.h"
 
 #include <Ethernet.h>
 
@@ -85,6 +96,36 @@ void interactivePrompt(unsigned long timeout) {
 }
 
 
+//------------------------------------------------------------------------------
+/* Handles single-key commands over the serial interface while running
+   in automated mode, as the menu is only available at startup:
+     S  runtime statistics
+     M  memory usage
+   along with the trace commands (see handleTraceCommand()) if tracing
+   is enabled.  Other input is ignored.  Called from the main loop. */
+void handleRuntimeCommands() {
+  while (Serial.available() > 0) {
+    char c = Serial.read();
+    switch (c) {
+      case 'S':
+      case 's':
+        showRuntimeStats();
+        break;
+      case 'M':
+      case 'm':
+        printMemoryStats();
+        Serial.println();
+        break;
+      default:
+        #ifdef PODD_TRACE
+        handleTraceCommand(c);
+        #endif
+        break;
+    }
+  }
+}
+
+
 //------------------------------------------------------------------------------
 /* Main menu for interactive mode.  Will continue to be shown until
    an appropriate selection is made. */
@@ -113,6 +154,9 @@ void mainMenu() {
     Serial.println(F("  (3) Sensor timing"));
     showMenuSensorTimingSettings();
     Serial.println(F("  (4) Sensor configuration/testing"));
+    // Report-by-exception settings
+    Serial.println(F("  (R) Reporting deadbands"));
+    showMenuReportingSettings();
     // Ethernet settings
     Serial.println(F("  (N) Network settings"));
     showMenuNetworkSettings();
@@ -122,8 +166,20 @@ void mainMenu() {
     // RTC time/settings
     Serial.println(F("  (C) Clock settings"));
     showMenuClockSettings();
+    // Push settings to drones over XBee
+    if (getModeCoord()) Serial.println(F("  (P) Push settings to drones"));
+    // Send a firmware image to drones over XBee
+    if (getModeCoord()) Serial.println(F("  (U) Update drone firmware"));
     // Show compilation info
     Serial.println(F("  (I) Compilation info"));
+    // Show memory usage
+    Serial.println(F("  (M) Memory usage"));
+    // Show runtime counters
+    Serial.println(F("  (S) Runtime statistics"));
+    #ifdef PODD_TRACE
+    // Dump ISR/loop timing trace
+    Serial.println(F("  (T) Timing trace dump"));
+    #endif
     // Enable or disable debug mode
     if (getDebugMode()) {
       Serial.println(F("  (D) Disable debug mode"));
@@ -167,6 +223,10 @@ void mainMenu() {
         sensorMenu();
         showContinuePrompt = false;
         break;
+      case 'R':
+      case 'r':
+        configureReportingSettings();
+        break;
       //case '5':
       //  Serial.println(F("<option not yet implemented>"));
       //  break;
@@ -182,12 +242,36 @@ void mainMenu() {
       case 'c':
         configureClockSettings();
         break;
+      case 'P':
+      case 'p':
+        if (getModeCoord()) configurePushSettings();
+        break;
+      case 'U':
+      case 'u':
+        if (getModeCoord()) configureFirmwareUpdate();
+        break;
       case 'I':
       case 'i':
         Serial.println(F("  Firmware version:    " CONFIG_VERSION));
         printCompilationInfo("  ","");
         Serial.println();
         break;
+      case 'M':
+      case 'm':
+        printMemoryStats();
+        Serial.println();
+        break;
+      case 'S':
+      case 's':
+        showRuntimeStats();
+        break;
+      #ifdef PODD_TRACE
+      case 'T':
+      case 't':
+        dumpTrace();
+        Serial.println();
+        break;
+      #endif
       case 'D':
       case 'd':
         configureDebugSettings();
@@ -248,8 +332,9 @@ void showMenuNodeSettings() {
 
 //----------------------------------------------
 /* Prints to serial a single sensor timing setting.
-   Intended to be used just below menu's sensor timing settings entry. */
-void showMenuSensorTimingEntry(String s, int v) {
+   Intended to be used just below menu's sensor timing settings entry.
+   A minimum interval below v indicates adaptive sampling. */
+void showMenuSensorTimingEntry(String s, int v, int vmin) {
   //return String((FType)MENU_INDENT2) + s + " " + ((v > 0) ? (String(v) + " s") : "(disabled)");
   Serial.print((FType)MENU_INDENT2);
   Serial.print(s + F(": "));
@@ -258,6 +343,11 @@ void showMenuSensorTimingEntry(String s, int v) {
     char buff[8];
     sprintf(buff,"%5d s",v);
     Serial.print(buff);
+    if ((vmin > 0) && (vmin < v)) {
+      Serial.print(F("  (adaptive, min "));
+      Serial.print(vmin);
+      Serial.print(F(" s)"));
+    }
   } else {
     Serial.print(F("(disabled)"));
   }
@@ -269,17 +359,50 @@ void showMenuSensorTimingEntry(String s, int v) {
 /* Prints to serial various sensor timing settings.
    Intended to be used just below menu's sensor timing settings entry. */
 void showMenuSensorTimingSettings() {
-  showMenuSensorTimingEntry(F("Temperature/humidity"),(getPodConfig().humidityT));
-  showMenuSensorTimingEntry(F("Radiant temperature"),(getPodConfig().tempT));
-  showMenuSensorTimingEntry(F("Light"),(getPodConfig().lightT));
-  showMenuSensorTimingEntry(F("Sound level"),(getPodConfig().soundT));
+  showMenuSensorTimingEntry(F("Temperature/humidity"),(getPodConfig().humidityT),getAdaptiveMin(SENSOR_RH));
+  showMenuSensorTimingEntry(F("Radiant temperature"),(getPodConfig().tempT),getAdaptiveMin(SENSOR_GLOBETEMP));
+  showMenuSensorTimingEntry(F("Light"),(getPodConfig().lightT),getAdaptiveMin(SENSOR_LIGHT));
+  showMenuSensorTimingEntry(F("Sound level"),(getPodConfig().soundT),getAdaptiveMin(SENSOR_SOUND));
   showMenuSensorTimingEntry(F("Particulate matter"),(getPodConfig().pmT));
-  showMenuSensorTimingEntry(F("Carbon dioxide"),(getPodConfig().co2T));
-  showMenuSensorTimingEntry(F("Carbon monoxide"),(getPodConfig().coT));
+  showMenuSensorTimingEntry(F("Carbon dioxide"),(getPodConfig().co2T),getAdaptiveMin(SENSOR_CO2));
+  showMenuSensorTimingEntry(F("Carbon monoxide"),(getPodConfig().coT),getAdaptiveMin(SENSOR_CO));
   //showMenuSensorTimingEntry(F("Data upload interval"),(getPodConfig().uploadT));
 }
 
 
+//----------------------------------------------
+/* Prints to serial the report-by-exception settings.
+   Intended to be used just below menu's reporting entry. */
+void showMenuReportingSettings() {
+  Serial.print((FType)MENU_INDENT2);
+  Serial.print(F("Heartbeat: "));
+  if (getHeartbeat() > 0) {
+    Serial.print(getHeartbeat());
+    Serial.println(F(" s"));
+  } else {
+    Serial.println(F("(none)"));
+  }
+  bool any = false;
+  for (uint8_t k = 0; k < READING_SD_COUNT; k++) {
+    const ReadingType type = (ReadingType)k;
+    if ((getDeadbandAbs(type) <= 0) && (getDeadbandRel(type) <= 0)) continue;
+    char name[READING_NAME_LEN];
+    Serial.print((FType)MENU_INDENT2);
+    Serial.print(formatReadingName(name,type));
+    Serial.print(F(": "));
+    Serial.print(getDeadbandAbs(type));
+    Serial.print(F(" / "));
+    Serial.print(100*getDeadbandRel(type));
+    Serial.println(F("%"));
+    any = true;
+  }
+  if (!any) {
+    Serial.print((FType)MENU_INDENT2);
+    Serial.println(F("Deadbands: (none, all readings sent)"));
+  }
+}
+
+
 //----------------------------------------------
 /* Prints to serial various network settings.
    Intended to be used just below menu's network settings entry. */
@@ -364,6 +487,25 @@ void showMenuClockSettings() {
 }
 
 
+//----------------------------------------------
+/* Prints to serial the runtime counters, along with the XBee data
+   path statistics on the coordinator. */
+void showRuntimeStats() {
+  printPodStats();
+  printQualityStatus();
+  printSensorHealth();
+  printEEPROMStatus();
+  if (!getModeCoord()) printIdleStats();
+  printSamplingStatus();
+  printPMPlan();
+  if (getModeCoord()) printXBeePipelineStats();
+  if (getModeCoord()) printConfigPushStatus();
+  if (getModeCoord()) printStatusServerStats();
+  printFirmwareUpdateStatus();
+  Serial.println();
+}
+
+
 //------------------------------------------------------------------------------
 /* Prompt the user to update project settings over the serial interface. */
 void configureProjectSettings() {
@@ -462,10 +604,127 @@ void configureSensorTimingSettings() {
   updateSensorTime(F("Light"),&(getPodConfig().lightT));
   updateSensorTime(F("Sound level"),&(getPodConfig().soundT));
   updateSensorTime(F("Particulate matter"),&(getPodConfig().pmT));
+  if (getPodConfig().pmT > 0) configurePMTiming();
   updateSensorTime(F("Carbon dioxide"),&(getPodConfig().co2T));
   updateSensorTime(F("Carbon monoxide"),&(getPodConfig().coT));
   //updateSensorTime(F("Data upload interval"),&(getPodConfig().uploadT));
   
+  Serial.println();
+  if (serialYesNoPrompt(F("Configure adaptive sampling (y/n)"),true,false)) {
+    configureAdaptiveSampling();
+  }
+}
+
+
+//------------------------------------------------------------------------------
+/* Prompts the user for the particulate matter sensor's settle time
+   and averaging window and shows the resulting measurement plan. */
+void configurePMTiming() {
+  PodConfigStruct &config = getPodConfig();
+  int i = serialIntegerPrompt(F("  Particulate matter settle time [s]"),true,config.pmSettleT);
+  if (i < 0) i = 0;
+  if (i != config.pmSettleT) {
+    setPodConfigChanged();
+    config.pmSettleT = i;
+  }
+  i = serialIntegerPrompt(F("  Particulate matter averaging window [s]"),true,config.pmAverageT);
+  if (i < 1) i = 1;
+  if (i != config.pmAverageT) {
+    setPodConfigChanged();
+    config.pmAverageT = i;
+  }
+  const PMPlan plan = planPMSensor(config.pmT,config.pmSettleT,config.pmAverageT);
+  Serial.print(plan.dutyCycled ? F("  Duty-cycled: powered ") : F("  Continuous: powered "));
+  Serial.print(plan.onTime);
+  Serial.print(F(" s and ~"));
+  Serial.print(plan.energy,1);
+  Serial.println(F(" J per reading."));
+}
+
+
+//------------------------------------------------------------------------------
+/* Prompt the user to update adaptive sampling settings (minimum
+   interval and rate-of-change threshold for each sensor) over the
+   serial interface. */
+void configureAdaptiveSampling() {
+  Serial.println();
+  Serial.println(F("With adaptive sampling, a sensor is read more often (down to the"));
+  Serial.println(F("minimum interval) while its reading changes faster than the threshold"));
+  Serial.println(F("[units per minute], returning to the interval above once it is"));
+  Serial.println(F("stable.  Use a minimum interval of '0' to sample at a fixed rate."));
+  Serial.println(F("Not available for the particulate matter sensor."));
+  Serial.println();
+
+  updateAdaptiveSampling(F("Temperature/humidity [%RH]"),SENSOR_RH);
+  updateAdaptiveSampling(F("Radiant temperature [F]"),SENSOR_GLOBETEMP);
+  updateAdaptiveSampling(F("Light [lux]"),SENSOR_LIGHT);
+  updateAdaptiveSampling(F("Sound level"),SENSOR_SOUND);
+  updateAdaptiveSampling(F("Carbon dioxide [ppm]"),SENSOR_CO2);
+  updateAdaptiveSampling(F("Carbon monoxide"),SENSOR_CO);
+
+  Serial.println();
+}
+
+
+/* Prompts the user to change the adaptive sampling settings of the
+   given sensor and flags a configuration change. */
+void updateAdaptiveSampling(String label, const SensorChannel ch) {
+  PodConfigStruct &config = getPodConfig();
+  int i = serialIntegerPrompt(label + F(" minimum interval [s]"),true,config.adaptMinT[ch]);
+  if (i < 0) i = 0;
+  if (i != config.adaptMinT[ch]) {
+    setPodConfigChanged();
+    config.adaptMinT[ch] = i;
+  }
+  if (i == 0) return;
+  float v = serialFloatPrompt(label + F(" threshold [/min]"),true,config.adaptThreshold[ch]);
+  if (!(v >= 0)) v = 0;
+  if (v != config.adaptThreshold[ch]) {
+    setPodConfigChanged();
+    config.adaptThreshold[ch] = v;
+  }
+}
+
+
+//------------------------------------------------------------------------------
+/* Prompt the user to update report-by-exception settings over the
+   serial interface. */
+void configureReportingSettings() {
+  PodConfigStruct &config = getPodConfig();
+  Serial.println();
+  Serial.println(F("Readings are always logged to SD, but are only uploaded (or sent to"));
+  Serial.println(F("the coordinator) if they differ from the last value sent by more"));
+  Serial.println(F("than an absolute deadband (in reading units) or a relative deadband"));
+  Serial.println(F("(percentage of the last value), or if the heartbeat interval has"));
+  Serial.println(F("passed.  Use '0' for both deadbands to send every reading.  Current"));
+  Serial.println(F("settings are shown in square brackets (press enter to keep the"));
+  Serial.println(F("current setting)."));
+  Serial.println();
+
+  int i = serialIntegerPrompt(F("Heartbeat interval [s] (0 for none)"),true,config.heartbeatT);
+  if (i < 0) i = 0;
+  if (i != config.heartbeatT) {
+    setPodConfigChanged();
+    config.heartbeatT = i;
+  }
+
+  for (uint8_t k = 0; k < READING_SD_COUNT; k++) {
+    char name[READING_NAME_LEN];
+    formatReadingName(name,(ReadingType)k);
+    float v = serialFloatPrompt(String(name) + F(" absolute deadband"),true,config.deadbandAbs[k]);
+    if (!(v >= 0)) v = 0;
+    if (v != config.deadbandAbs[k]) {
+      setPodConfigChanged();
+      config.deadbandAbs[k] = v;
+    }
+    v = serialFloatPrompt(String(name) + F(" relative deadband [%]"),true,100*config.deadbandRel[k]);
+    if (!(v >= 0)) v = 0;
+    if (v != 100*config.deadbandRel[k]) {
+      setPodConfigChanged();
+      config.deadbandRel[k] = v/100;
+    }
+  }
+
   Serial.println();
 }
 
@@ -729,6 +988,113 @@ void configureClockSettings() {
 }
 
 
+//------------------------------------------------------------------------------
+/* Prompts for a sensor interval to push to drones, with this
+   coordinator's interval as the default. */
+static void promptPushRate(ConfigPush &push, String label, const SensorChannel ch) {
+  int i = serialIntegerPrompt(label + F(" [s]"),true,getRate(ch));
+  push.rates[ch] = (i < 0) ? 0 : i;
+  push.fields |= (PUSH_RATE_FIRST << ch);
+}
+
+
+//------------------------------------------------------------------------------
+/* Prompt the user for settings to push to drones over XBee (see
+   pod_remote.h).  The push is sent once the XBee network is running. */
+void configurePushSettings() {
+  ConfigPush push;
+  memset(&push,0,sizeof(push));
+  String s;
+
+  Serial.println();
+  printConfigPushStatus();
+  Serial.println();
+  Serial.println(F("Settings are sent to drones, and repeated until each drone"));
+  Serial.println(F("answers.  Only the settings selected are sent.  This node's"));
+  Serial.println(F("settings are shown in square brackets."));
+  Serial.println();
+
+  s = serialStringPrompt(F("Drone device ID, or '*' for all drones"),"*");
+  s.toCharArray(push.target,sizeof(push.target));
+  const bool all = (strcmp(push.target,"*") == 0);
+
+  if (serialYesNoPrompt(F("Send sensor intervals (y/n)"),true,false)) {
+    Serial.println(F("  Enter the number of seconds between measurements, or '0' to"));
+    Serial.println(F("  disable the sensor."));
+    promptPushRate(push,F("  Temperature/humidity"),SENSOR_RH);
+    promptPushRate(push,F("  Radiant temperature"),SENSOR_GLOBETEMP);
+    promptPushRate(push,F("  Light"),SENSOR_LIGHT);
+    promptPushRate(push,F("  Sound level"),SENSOR_SOUND);
+    promptPushRate(push,F("  Particulate matter"),SENSOR_PM);
+    promptPushRate(push,F("  Carbon dioxide"),SENSOR_CO2);
+    promptPushRate(push,F("  Carbon monoxide"),SENSOR_CO);
+    int i = serialIntegerPrompt(F("  Data upload interval [s]"),true,getRateUpload());
+    push.uploadT = (i < 0) ? 0 : i;
+    push.fields |= PUSH_UPLOAD;
+  }
+
+  if (serialYesNoPrompt(F("Send project name (y/n)"),true,false)) {
+    s = serialStringPrompt(F("  Project name (max 16 characters)"),getPodConfig().project);
+    s.toCharArray(push.project,sizeof(push.project));
+    push.fields |= PUSH_PROJECT;
+  }
+
+  // Only meaningful for a single drone
+  if (!all && serialYesNoPrompt(F("Send room/location (y/n)"),true,false)) {
+    s = serialStringPrompt(F("  Room/location (max 16 characters)"),"");
+    s.toCharArray(push.room,sizeof(push.room));
+    push.fields |= PUSH_ROOM;
+  }
+
+  if (serialYesNoPrompt(F("Send network ID (y/n)"),true,false)) {
+    s = serialStringPrompt(F("  Network ID"),getPodConfig().networkID);
+    s.toCharArray(push.networkID,sizeof(push.networkID));
+    push.fields |= PUSH_NETID;
+  }
+
+  if (serialYesNoPrompt(F("Send timezone (y/n)"),true,false)) {
+    s = serialStringPrompt(F("  Standard timezone label (e.g. PST)"),getStandardTimezoneLabel());
+    s.toCharArray(push.timezone[0],sizeof(push.timezone[0]));
+    s = serialStringPrompt(F("  Daylight saving timezone label (e.g. PDT)"),getDaylightSavingTimezoneLabel());
+    s.toCharArray(push.timezone[1],sizeof(push.timezone[1]));
+    push.fields |= PUSH_TIMEZONE;
+  }
+
+  Serial.println();
+  if (push.fields == 0) {
+    Serial.println(F("  No settings selected: nothing pushed."));
+  } else if (!startConfigPush(push)) {
+    Serial.println(F("  Settings cannot contain commas or '/': nothing pushed."));
+  } else {
+    printConfigPushStatus();
+  }
+  Serial.println();
+}
+
+
+//------------------------------------------------------------------------------
+/* Prompt the user to send a firmware image to drones over XBee (see
+   pod_ota.h).  The transfer runs once the XBee network is running. */
+void configureFirmwareUpdate() {
+  Serial.println();
+  printFirmwareUpdateStatus();
+  Serial.println();
+  Serial.println(F("The firmware image " OTA_IMAGE_FILE " on the SD card is sent to all"));
+  Serial.println(F("drones, which store it on their own SD card and check it.  The"));
+  Serial.println(F("image is only staged: drones keep running their current firmware."));
+  Serial.println();
+
+  if (serialYesNoPrompt(F("Send " OTA_IMAGE_FILE " to drones (y/n)"),true,false)) {
+    if (startFirmwareDistribution()) {
+      Serial.println(F("  Image found: transfer starts once the XBee is running."));
+    } else {
+      Serial.println(F("  No valid " OTA_IMAGE_FILE " on the SD card: nothing sent."));
+    }
+  }
+  Serial.println();
+}
+
+
 //------------------------------------------------------------------------------
 /* Prompt the user to update debugging settings over the serial interface. */
 void configureDebugSettings() {
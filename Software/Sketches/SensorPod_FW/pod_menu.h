@@ -31,6 +31,7 @@
 // Contributed libraries
 #include <Arduino.h>
 // Local headers
+#include "pod_config.h"
 
 // Define DEBUG, PODD_DEBUG, or PODD_MENU_DEBUG to enable
 // debug statements below
@@ -50,25 +51,35 @@
 // Provides countdown to entering automatic running mode over serial
 // interface; enters interactive menu if interrupted by user response.
 void interactivePrompt(unsigned long timeout=30000);
+// Handles single-key commands (statistics, etc.) while running.
+void handleRuntimeCommands();
 
 // Main PODD menu
 void mainMenu();
 // Routines to show information within the main menu
 void showMenuProjectSettings();
 void showMenuNodeSettings();
-void showMenuSensorTimingEntry(String s, int v);
+void showMenuSensorTimingEntry(String s, int v, int vmin=0);
 void showMenuSensorTimingSettings();
+void showMenuReportingSettings();
 void showMenuNetworkSettings();
 void showMenuXBeeSettings();
 void showMenuClockSettings();
+void showRuntimeStats();
 
 // Interactive prompts to configure various settings
 void configureProjectSettings();
 void configureNodeSettings();
 void configureSensorTimingSettings();
+void configurePMTiming();
+void configureAdaptiveSampling();
+void updateAdaptiveSampling(String label, const SensorChannel ch);
+void configureReportingSettings();
 void configureNetworkSettings();
 void configureXBeeSettings();
 void configureClockSettings();
+void configurePushSettings();
+void configureFirmwareUpdate();
 void configureDebugSettings();
 
 // Sensor menu
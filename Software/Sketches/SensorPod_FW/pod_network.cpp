@@ -15,6 +15,13 @@
 #include "pod_logging.h"
 #include "pod_util.h"
 #include "pod_clock.h"
+#include "pod_trace.h"
+#include "pod_stats.h"
+#include "pod_sampling.h"
+#include "pod_quality.h"
+#include "pod_remote.h"
+#include "pod_ota.h"
+#include "pod_status.h"
 
 #include <EEPROM.h>
 #include <SPI.h>
@@ -34,6 +41,26 @@ volatile size_t xbeeBufferHead = 0;
 volatile size_t xbeeBufferElements = 0;
 volatile size_t xbeeBufferOverrun = 0;
 volatile bool xbeeBufferHold = false;
+// Ring buffer (receive stage) statistics: total bytes pulled from the
+// serial interface, peak buffer occupancy, and running total of
+// bytes lost to overruns.  The first two are updated within the read
+// ISR.  Packets dropped as invalid are counted by reason in pod_stats.
+volatile uint32_t xbeeBufferReceived = 0;
+volatile size_t xbeeBufferHighWater = 0;
+uint32_t xbeeBufferOverrunTotal = 0;
+// Position within the packet currently being received (bytes since
+// start token) and its packet type character, tracked by the read
+// ISR so time sync packets can be timestamped on arrival.
+volatile uint8_t xbeePacketPos = 0;
+volatile char xbeePacketType = '\0';
+// Arrival time (millis) of the most recent time sync packet and a
+// count of such arrivals; the count lets the parser detect when the
+// timestamp is ambiguous (several sync packets buffered at once).
+volatile unsigned long xbeeSyncArrivalMillis = 0;
+volatile uint8_t xbeeSyncArrivals = 0;
+uint8_t xbeeSyncConsumed = 0;
+// Random answer delays (getXBeeAnswerDelay()) seeded yet?
+bool xbeeRandomSeeded = false;
 
 // Use ASCII "start of text" and "end of text" control characters
 // to mark the start and end of packets.  The use of both allows
@@ -66,6 +93,132 @@ volatile bool xbeeBufferHold = false;
 // read ISR run time must be shorter than that so it does not interfere
 // with the Serial1 ISR timing.
 
+// Coordinator XBee data path is split into three stages so radio
+// reception is never stalled behind a (slow) web upload:
+//   1. receive: the read ISR above moves serial data into the ring
+//      buffer, and keeps doing so while an HTTP request is in flight;
+//   2. parse: complete packets are pulled from the ring buffer and
+//      sensor readings are decoded into fixed-size records placed in
+//      a bounded queue;
+//   3. upload: queued records are posted to the server in batches.
+// When the reading queue is full, the parse stage stops pulling
+// packets so the backlog stays in the ring buffer (backpressure).
+// Each record is ~80 bytes, so the queue is kept short; increase it
+// if there is spare dynamic memory and uploads are bursty.
+#define XBEE_READING_QUEUE_SIZE 4
+// Maximum number of queued readings to upload per processXBee() call.
+// Each upload can take up to HTTP_POST_TIMEOUT (or longer if the
+// connection fails), so this bounds the time spent away from the
+// alarm/sensor routines.
+#define XBEE_UPLOAD_BATCH_SIZE 2
+// Interval [ms] at which pipeline statistics are printed to serial
+// when debug mode is enabled.
+#define XBEE_STATS_INTERVAL 300000
+
+// Sensor reading received from a drone, as decoded from a 'V' packet
+// (V,DID,ST,R,TS,DT[,Q]).  Field sizes match the configuration/upload
+// formats: device IDs are at most 16 characters, the longest sensor
+// type is "GlobeTemp", timestamps are 10-digit unix times, and
+// date/times are "YYYY-MM-DD HH:MM:SS".  The quality flags (decimal)
+// are only sent if not zero.
+struct XBeeReadingRecord {
+  char devid[17];
+  char sensor[12];
+  char value[16];
+  char timestamp[12];
+  char datetime[20];
+  char quality[4];
+};
+
+// Bounded FIFO queue between the parse and upload stages.
+// Only accessed from the main thread.
+XBeeReadingRecord xbeeReadingQueue[XBEE_READING_QUEUE_SIZE];
+uint8_t xbeeReadingQueueHead = 0;
+uint8_t xbeeReadingQueueElements = 0;
+
+// Parse and upload stage statistics.
+struct XBeePipelineStats {
+  // Parse stage
+  uint32_t packetsParsed = 0;     // valid packets taken from ring buffer
+  uint32_t readingsQueued = 0;    // readings placed in upload queue
+  uint32_t queueFullStalls = 0;   // parse passes halted by full queue
+  uint8_t queueHighWater = 0;     // peak upload queue occupancy
+  // Upload stage
+  uint32_t readingsUploaded = 0;  // successful reading uploads
+  uint32_t uploadFailures = 0;    // failed reading uploads (dropped)
+  uint32_t uploadBatches = 0;     // upload passes with at least one record
+  unsigned long uploadTimeMax = 0;    // longest single upload [ms]
+  unsigned long uploadTimeTotal = 0;  // cumulative upload time [ms]
+} xbeeStats;
+unsigned long xbeeStatsLastPrint = 0;
+
+// Two-way XBee time synchronization (drones).
+// Drones periodically send a request stamped with their own time (t1);
+// the coordinator notes the request's arrival time (t2) and replies
+// with t1, t2 and the reply's send time (t3); the drone notes the
+// reply's arrival time (t4).  As with NTP, the drone's clock offset is
+//   ((t2 - t1) + (t3 - t4))/2
+// and the round-trip network delay is
+//   (t4 - t1) - (t3 - t2).
+// Arrival times are taken in the XBee read ISR, so their resolution
+// is XBEE_READ_INTERVAL.  Request and reply packets have the same
+// length so serial/radio transmission times cancel.  The offset
+// history gives an estimate of the drone RTC's drift, which is
+// corrected between exchanges.  The exchange interval doubles while
+// the clock stays aligned, up to the maximum below.
+// Time sync exchange interval limits [s].
+#define TIMESYNC_INTERVAL_MIN 60
+#define TIMESYNC_INTERVAL_MAX 14400
+// Maximum time to wait for a reply [ms].
+#define TIMESYNC_REPLY_TIMEOUT 5000
+// Samples with a larger round-trip delay are discarded [ms].
+#define TIMESYNC_MAX_DELAY 2000
+// Offsets below this are left uncorrected (near the measurement
+// resolution) [ms].
+#define TIMESYNC_STEP_THRESHOLD 20
+// Offsets below this are considered aligned, allowing the exchange
+// interval to grow [ms].
+#define TIMESYNC_ALIGNED_OFFSET 50
+// Accumulated drift at which the clock is corrected between exchanges [ms].
+#define TIMESYNC_DRIFT_STEP 100
+// Maximum age of the millis()/RTC lock used for timestamps [s].
+#define TIMESYNC_PHASE_MAX_AGE 300
+// Define to also trim the drone DS3234's aging offset register from
+// the drift estimate (persists in the battery-backed RTC).
+//#define TIMESYNC_TRIM_AGING
+// Minimum drift samples and drift [ppm] before trimming aging offset.
+#define TIMESYNC_TRIM_MIN_SAMPLES 3
+#define TIMESYNC_TRIM_MIN_DRIFT 0.5
+// Sync packet: type character followed by three 13-digit timestamps
+// (10-digit unix time and 3-digit milliseconds).
+#define TIMESYNC_TIMESTAMP_LEN 13
+#define TIMESYNC_PACKET_LEN (1 + 3*TIMESYNC_TIMESTAMP_LEN)
+
+// Drone time sync state and statistics.
+struct TimeSyncState {
+  // Outstanding request
+  bool pending = false;
+  time_t t1 = 0;
+  uint16_t t1ms = 0;
+  unsigned long requestMillis = 0;
+  // Last successful exchange
+  bool synced = false;
+  unsigned long syncMillis = 0;
+  int32_t offset = 0;     // coordinator - drone [ms]
+  int32_t roundTrip = 0;  // network round trip delay [ms]
+  int32_t residual = 0;   // drone - coordinator left uncorrected [ms]
+  unsigned long interval = TIMESYNC_INTERVAL_MIN;  // [s]
+  // Drift of drone clock (positive: running fast) [ppm] and
+  // corrections applied for it since last exchange [ms].
+  float drift = 0;
+  uint8_t driftSamples = 0;
+  int32_t driftCorrection = 0;
+  // Counters
+  uint32_t requests = 0;
+  uint32_t replies = 0;
+  uint32_t rejected = 0;
+} timeSync;
+
 // MOVED XBEE VALUES TO STRUCTURE BELOW.
 // The XBee's serial number.  To be extracted from XBee.
 //uint64_t xbeeSerialNumber = 0;
@@ -113,13 +266,11 @@ uint8_t xbeeGroup = 0;
 String set1;
 String set2;
 
-// Network configuration.
-// Contains a version number used for EEPROM storage checking,
-// a flag indicating network connection type (static vs dynamic),
-// a static IP address, and a DNS server IP address.
-#define NETWORK_CONFIG_VERSION 10000
+// Network configuration (EEPROM record, see pod_eeprom.h).
+// Contains a flag indicating network connection type (static vs
+// dynamic), a static IP address, and a DNS server IP address.
+#define NETWORK_CONFIG_SCHEMA 1
 struct NetworkConfig {
-  uint16_t version;
   uint8_t flags;  // Bit 1: whether static (1) or dynamic (0) IP address used
   // Static configuration quantities (not used with DHCP)
   uint32_t staticIP;
@@ -127,7 +278,18 @@ struct NetworkConfig {
   uint32_t subnet;
   uint32_t dnsIP;
 };
-NetworkConfig networkConfig {NETWORK_CONFIG_VERSION,0x00,0,0,0,0x08080808};
+NetworkConfig networkConfig {0x00,0,0,0,0x08080808};
+// Network configuration as stored at EEPROM_NETWORK_ADDR by older
+// firmware, with a version number for storage checking.
+#define NETWORK_CONFIG_LEGACY_VERSION 10000
+struct LegacyNetworkConfig {
+  uint16_t version;
+  uint8_t flags;
+  uint32_t staticIP;
+  uint32_t gatewayIP;
+  uint32_t subnet;
+  uint32_t dnsIP;
+};
 
 // Ethernet connection settings
 #define WIZ812MJ_ES_PIN 20 // WIZnet SPI chip-select pin
@@ -152,6 +314,15 @@ const char SERVER_PAGE_NAME[] = "/LMNSensePod.php"; // Name of submission page.
 //#define ETHERNET_DHCP_TIMEOUT 30000
 //#define ETHERNET_DHCP_RESPONSE_TIMEOUT 10000
 
+// Last value sent (uploaded or passed to the coordinator) for each
+// reading type, for report-by-exception (see isReadingReportable()).
+struct ReportState {
+  float value;
+  time_t utc;
+  bool valid;
+};
+ReportState reportState[READING_SD_COUNT];
+
 // Number of packets uploaded to server (successfully or unsuccessfully)
 unsigned long packetsUploaded = 0;
 
@@ -167,6 +338,72 @@ unsigned long packetsUploaded = 0;
 #define NTP_SERVER "time.nist.gov"
 #define NTP_PORT 123
 #define NTP_PACKET_SIZE 48
+// Seconds between NTP (1900) and unix (1970) epochs
+#define NTP_UNIX_OFFSET 2208988800ul
+
+// The NTP client runs in the background from the main loop.  Each
+// poll sends a short burst of requests and keeps the sample with the
+// smallest round-trip delay (least affected by network and loop
+// latency).  Small offsets are slewed out in steps too small to
+// matter to timestamps; large ones step the clock.  The poll interval
+// doubles while the offset stays small, and the offsets between polls
+// give an estimate of the RTC's drift.
+// Poll interval limits [s].
+#define NTP_POLL_INTERVAL_MIN 900
+#define NTP_POLL_INTERVAL_MAX 14400
+// Requests per burst and spacing between them [ms].  NIST servers
+// refuse clients that query more often than once every 4 seconds.
+#define NTP_BURST_SIZE 4
+#define NTP_BURST_SPACING 4000
+// Maximum time to wait for each reply [ms].
+#define NTP_REPLY_TIMEOUT 1000
+// Offsets larger than this step the clock; smaller ones are slewed [ms].
+#define NTP_STEP_THRESHOLD 1000
+// Slewing: maximum correction per step and time between steps [ms].
+#define NTP_SLEW_STEP 20
+#define NTP_SLEW_INTERVAL 1000
+// Offsets below this are considered stable, allowing the poll
+// interval to grow [ms].
+#define NTP_STABLE_OFFSET 100
+// Define to trim the DS3234's aging offset register from the drift
+// estimate (persists in the battery-backed RTC).
+//#define NTP_TRIM_AGING
+// Minimum drift samples and drift [ppm] before trimming aging offset.
+#define NTP_TRIM_MIN_SAMPLES 3
+#define NTP_TRIM_MIN_DRIFT 0.5
+
+// NTP client state and statistics.
+struct NTPState {
+  // Current burst
+  uint8_t burstRemaining = 0;
+  bool waiting = false;
+  byte origin[8];  // transmit timestamp of outstanding request
+  time_t t1 = 0;
+  uint16_t t1ms = 0;
+  unsigned long sendMillis = 0;
+  bool stepped = false;  // clock was set directly (far off/unset)
+  bool haveSample = false;
+  int32_t bestOffset = 0;  // server - local [ms]
+  int32_t bestDelay = 0;   // round trip [ms]
+  // Polling
+  bool polled = false;
+  unsigned long pollMillis = 0;
+  unsigned long pollInterval = NTP_POLL_INTERVAL_MIN;  // [s]
+  // Previous poll (for drift estimate)
+  bool havePrevious = false;
+  unsigned long previousMillis = 0;
+  // Outstanding slew correction [ms]
+  int32_t slewRemaining = 0;
+  unsigned long slewMillis = 0;
+  // Drift of local clock (positive: running fast) [ppm]
+  float drift = 0;
+  uint8_t driftSamples = 0;
+  // Counters
+  uint32_t requests = 0;
+  uint32_t replies = 0;
+  uint32_t steps = 0;
+} ntpState;
+EthernetUDP ntpUdp;
 
 
 
@@ -588,10 +825,13 @@ void readXBeeISR() {
   // Avoid modifying the buffer if currently in use by main thread
   // routines (which should set this flag).  Allows this routine
   // to be safely interrupt-driven.
-  if (xbeeBufferHold) return;
-  //Serial.print(F("readXBeeISR: "));
-  //Serial.println(millis());
-  readXBee();
+  TRACE_BEGIN(TRACE_ISR_XBEE);
+  if (!xbeeBufferHold) {
+    //Serial.print(F("readXBeeISR: "));
+    //Serial.println(millis());
+    readXBee();
+  }
+  TRACE_END(TRACE_ISR_XBEE);
 }
 
 
@@ -629,10 +869,7 @@ void readXBee() {
 #endif
       return;
     } else {
-      xbeeBuffer[xbeeBufferHead] = xbee.read();
-      //Serial.print(xbeeBuffer[xbeeBufferHead]);
-      xbeeBufferHead = (xbeeBufferHead + 1) % XBEE_BUFFER_SIZE;
-      xbeeBufferElements++;
+      storeXBeeByte(xbee.read());
     }
   }
 #if defined(XBEE_DEBUG)
@@ -641,10 +878,36 @@ void readXBee() {
 }
 
 
+/* Appends a received byte to the XBee circular buffer (which must not
+   be full), timestamping the arrival of time sync packets.  Called
+   from readXBee() (ISR context). */
+void storeXBeeByte(const char c) {
+  xbeeBuffer[xbeeBufferHead] = c;
+  //Serial.print(xbeeBuffer[xbeeBufferHead]);
+  // Timestamp arrival of time sync packets.  Type character
+  // follows start token and two-character length.
+  if (c == PACKET_START_TOKEN) {
+    xbeePacketPos = 0;
+  } else if (xbeePacketPos < 0xFF) {
+    xbeePacketPos++;
+    if (xbeePacketPos == 3) xbeePacketType = c;
+  }
+  if ((c == PACKET_END_TOKEN) && ((xbeePacketType == 'Q') || (xbeePacketType == 'P'))) {
+    xbeeSyncArrivalMillis = millis();
+    xbeeSyncArrivals++;
+    xbeePacketType = '\0';
+  }
+  xbeeBufferHead = (xbeeBufferHead + 1) % XBEE_BUFFER_SIZE;
+  xbeeBufferElements++;
+  xbeeBufferReceived++;
+  if (xbeeBufferElements > xbeeBufferHighWater) xbeeBufferHighWater = xbeeBufferElements;
+}
+
+
 /* Send the given packet over the XBee network to the coordinator.
    Adds start & stop tokens and 2-digit packet hex length prefix to
    help coordinator with packet parsing. */
-void sendXBee(const String packet)
+void sendXBee(const char *packet)
 {
   // Serial output should be flushed here as activity may
   // interfere with XBee communication.
@@ -653,8 +916,9 @@ void sendXBee(const String packet)
   Serial.flush();
   
   // Length of packet, in 2-digit hex (mod 256)
+  const size_t packetLength = strlen(packet);
   char lbuf[3];
-  sprintf(lbuf,"%02X",(uint8_t)(packet.length() % 256));
+  sprintf(lbuf,"%02X",(uint8_t)(packetLength % 256));
   lbuf[2] = '\0';
   
   // Would probably work...
@@ -670,14 +934,15 @@ void sendXBee(const String packet)
   // without activity.
   // Note we omit null-termination character.
   //size_t bufLength = packet.length() + 2;
-  size_t bufLength = packet.length() + 4;
+  size_t bufLength = packetLength + 4;
   char buf[bufLength];
   //strcpy(&buf[1], packet.c_str());
   strcpy(&buf[1], lbuf);
-  strcpy(&buf[3], packet.c_str());
+  strcpy(&buf[3], packet);
   buf[0] = PACKET_START_TOKEN;
   buf[bufLength - 1] = PACKET_END_TOKEN;
-  xbee.write(buf);
+  xbee.write((const uint8_t*)buf,bufLength);
+  countXBeeSent(bufLength);
 
   // Hardware serial interface is operated through ISRs.
   // Give dedicated time here for those ISRs to run as any
@@ -694,6 +959,23 @@ void sendXBee(const String packet)
   xbee.flush();
   delay(100);
 }
+void sendXBee(const String packet)
+{
+  sendXBee(packet.c_str());
+}
+
+
+/* Random delay [ms], up to spread, before a drone answers a packet
+   the coordinator broadcast, so that the drones answering it do not
+   all transmit at once.  Seeded from the device ID on first use. */
+unsigned long getXBeeAnswerDelay(const unsigned long spread) {
+  if (!xbeeRandomSeeded) {
+    const char *devid = getDevID();
+    randomSeed(crc16(0xFFFF,devid,strlen(devid)) ^ micros());
+    xbeeRandomSeeded = true;
+  }
+  return random(spread);
+}
 
 
 /* Prevent the XBee buffer from being modified by ISR.
@@ -813,6 +1095,7 @@ String getXBeeBufferPacket() {
     if (startLoc != (xbeeBufferHead - xbeeBufferElements) % XBEE_BUFFER_SIZE) {
       xbeeBufferElements = (xbeeBufferHead - startLoc) % XBEE_BUFFER_SIZE;
       Serial.println(F("Warning: Invalid XBee data dropped (possible buffer overrun)."));
+      countPacketDropped(PACKET_DROP_TRUNCATED);
     }
 
     // At this point, startLoc should point to start token, endLoc points
@@ -823,6 +1106,7 @@ String getXBeeBufferPacket() {
     if ((endLoc - startLoc) % XBEE_BUFFER_SIZE <= 2) {
       xbeeBufferElements = (xbeeBufferHead - endLoc + 1) % XBEE_BUFFER_SIZE;
       Serial.println(F("Warning: Dropped empty XBee packet."));
+      countPacketDropped(PACKET_DROP_EMPTY);
       continue;
     }
     
@@ -830,6 +1114,7 @@ String getXBeeBufferPacket() {
     if ((endLoc - startLoc) % XBEE_BUFFER_SIZE <= 4) {
       xbeeBufferElements = (xbeeBufferHead - endLoc + 1) % XBEE_BUFFER_SIZE;
       Serial.println(F("Warning: Dropped invalid XBee packet."));
+      countPacketDropped(PACKET_DROP_NO_LENGTH);
       continue;
     }
     
@@ -843,6 +1128,7 @@ String getXBeeBufferPacket() {
         || (xbeeBuffer[(startLoc + 2) % XBEE_BUFFER_SIZE] != lbuf[1])) {
       xbeeBufferElements = (xbeeBufferHead - endLoc + 1) % XBEE_BUFFER_SIZE;
       Serial.println(F("Warning: Dropped invalid XBee packet (length mismatch)."));
+      countPacketDropped(PACKET_DROP_LENGTH);
       continue;
     }
     
@@ -865,10 +1151,12 @@ String getXBeeBufferPacket() {
 }
 
 
-/* Retrieves the next available XBee packet and processes it: packet
-   data is extracted and then passed on the the remote database.
-   If a full packet is not currently available, this function returns
-   immediately. */
+/* Retrieves available XBee packets and processes them.  Runs the
+   parse and (on the coordinator) upload stages of the XBee data path:
+   sensor readings are queued and then uploaded to the remote database
+   in small batches, while other packets are handled as they are
+   parsed.  If no full packet is currently available and there are no
+   queued readings, this function returns immediately. */
 void processXBee() {
   // Prevent buffer from being altered by ISR
   holdXBeeBuffer();
@@ -885,6 +1173,7 @@ void processXBee() {
     Serial.println(" bytes.  Some data lost.");
     Serial.flush();
     cleanXBeeBuffer(true, true);
+    xbeeBufferOverrunTotal += xbeeBufferOverrun;
     xbeeBufferOverrun = 0;
   }
 
@@ -894,18 +1183,49 @@ void processXBee() {
   // getXBeeBufferPacket() is ISR-safe.
   releaseXBeeBuffer();
 
-  // Cycle over packets until we find a valid one.
-  String packet;
+  // Parse stage: move complete packets out of the ring buffer.
+  parseXBeePackets();
+
+  // Upload stage: only the coordinator queues readings.
+  if (getModeCoord()) {
+    uploadXBeeReadings(XBEE_UPLOAD_BATCH_SIZE);
+    if (getDebugMode() && (millis() - xbeeStatsLastPrint >= XBEE_STATS_INTERVAL)) {
+      printXBeePipelineStats();
+      xbeeStatsLastPrint = millis();
+    }
+  }
+}
+
+
+/* Parse stage of the XBee data path.  Pulls valid packets from the
+   XBee ring buffer: sensor readings are decoded into the upload
+   queue, while other packets are acted on immediately.  Stops when
+   no complete packet remains, when the reading queue is full (the
+   remaining packets wait in the ring buffer), or after a packet that
+   required an immediate upload.  Returns the number of packets
+   taken from the ring buffer. */
+size_t parseXBeePackets() {
+  size_t nparsed = 0;
   size_t nuploaded = 0;
-  while ((packet = getXBeeBufferPacket()).length() > 0) {
+  while (true) {
+    // Backpressure: leave packets in the ring buffer until the
+    // upload stage frees space in the queue.  Drones do not queue.
+    if (getModeCoord() && (xbeeReadingQueueElements >= XBEE_READING_QUEUE_SIZE)) {
+      // Unguarded read of the ring occupancy is fine for a statistic.
+      if (xbeeBufferElements > 0) xbeeStats.queueFullStalls++;
+      break;
+    }
+    String packet = getXBeeBufferPacket();
+    if (packet.length() == 0) break;
+    nparsed++;
+    xbeeStats.packetsParsed++;
     Serial.print(F("XBee packet: "));
     Serial.println(packet);
     Serial.flush();
     switch (packet.charAt(0)) {
       case 'V':
         if (!getModeCoord()) break;
-        xbeeReading(packet);
-        nuploaded++;
+        queueXBeeReading(packet);
         break;
       case 'R':
         if (!getModeCoord()) break;
@@ -938,21 +1258,204 @@ void processXBee() {
       case 'D':
         if (!getModeCoord()) processDestinationPacket(packet);
         break;
+      // Time sync packets: those not meant for this node must still
+      // be accounted for against the ISR's arrival timestamps.
+      case 'Q':
+        if (getModeCoord()) {
+          processTimeSyncRequest(packet);
+        } else {
+          unsigned long arrival;
+          getXBeeSyncArrival(arrival);
+        }
+        break;
+      case 'P':
+        if (!getModeCoord()) {
+          processTimeSyncReply(packet);
+        } else {
+          unsigned long arrival;
+          getXBeeSyncArrival(arrival);
+        }
+        break;
+      // Settings pushed by the coordinator, and drones' answers
+      case 'K':
+        if (!getModeCoord()) processConfigPushPacket(packet);
+        break;
+      case 'A':
+        if (getModeCoord()) processConfigAckPacket(packet);
+        break;
+      // Firmware image transfer (both directions)
+      case 'F':
+        processFirmwarePacket(packet);
+        break;
       // Invalid packet: do nothing
       default:
+        countPacketDropped(PACKET_DROP_UNKNOWN);
         break;
     }
-    // If a packet was uploaded, do not parse another one in this
-    // function call to avoid spending an extended time in this
-    // routine.  Note if XBee packets come in faster than they can
-    // be uploaded to the server, we can get stuck in this loop
-    // indefinitely without forcing a break.  If delays are caused
-    // by a bad network connection, the network maintenance/restart
-    // routines would then never get called...
+    // Rate and configuration packets are still uploaded as they are
+    // parsed.  If one was uploaded, do not parse another one in this
+    // call to avoid spending an extended time in this routine.
     if (nuploaded >= 1) break;
-    // Use below to avoid compiler warning if above commented...
-    //(void)nuploaded;
   }
+  return nparsed;
+}
+
+
+/* Copies the comma-delimited packet field starting at src into dest
+   (of the given size, including null terminator).  Returns a pointer
+   to the start of the following field, or NULL if the field does not
+   fit or if a non-final field is not followed by a comma. */
+const char* copyXBeePacketField(const char *src, char *dest, const size_t size, const bool last) {
+  size_t k = 0;
+  while ((*src != '\0') && (*src != ',')) {
+    if (k + 1 >= size) return NULL;
+    dest[k++] = *src++;
+  }
+  dest[k] = '\0';
+  if (last) return src;
+  if (*src != ',') return NULL;
+  return src + 1;
+}
+
+
+/* Decodes a sensor reading packet (V,DID,ST,R,TS,DT[,Q]) into a record
+   at the end of the upload queue.  Returns false if the queue is
+   full or the packet is malformed (in which case it is dropped). */
+bool queueXBeeReading(const String &packet) {
+  if (xbeeReadingQueueElements >= XBEE_READING_QUEUE_SIZE) return false;
+  XBeeReadingRecord &rec = xbeeReadingQueue[(xbeeReadingQueueHead + xbeeReadingQueueElements) % XBEE_READING_QUEUE_SIZE];
+  const char *p = packet.c_str();
+  rec.quality[0] = '\0';
+  if ((p[0] != 'V') || (p[1] != ',')
+      || ((p = copyXBeePacketField(p + 2, rec.devid, sizeof(rec.devid), false)) == NULL)
+      || ((p = copyXBeePacketField(p, rec.sensor, sizeof(rec.sensor), false)) == NULL)
+      || ((p = copyXBeePacketField(p, rec.value, sizeof(rec.value), false)) == NULL)
+      || ((p = copyXBeePacketField(p, rec.timestamp, sizeof(rec.timestamp), false)) == NULL)
+      || ((p = copyXBeePacketField(p, rec.datetime, sizeof(rec.datetime), true)) == NULL)
+      || ((*p == ',') && (copyXBeePacketField(p + 1, rec.quality, sizeof(rec.quality), true) == NULL))) {
+    countPacketDropped(PACKET_DROP_MALFORMED);
+    Serial.println(F("Warning: Dropped malformed XBee sensor reading."));
+    return false;
+  }
+  noteConfigPushDrone(rec.devid);
+  updateDroneStatus(rec.devid,rec.sensor,rec.value,rec.timestamp,rec.quality);
+  xbeeReadingQueueElements++;
+  xbeeStats.readingsQueued++;
+  if (xbeeReadingQueueElements > xbeeStats.queueHighWater) xbeeStats.queueHighWater = xbeeReadingQueueElements;
+  return true;
+}
+
+
+/* Upload stage of the XBee data path.  Posts up to maxCount queued
+   sensor readings to the remote database, oldest first.  Readings are
+   removed from the queue whether or not the upload succeeds (they are
+   still available in the drone's SD log).  The parse stage is run
+   after each upload so packets that arrived while the request was in
+   flight are moved out of the ring buffer promptly.  Returns the
+   number of readings posted. */
+size_t uploadXBeeReadings(const size_t maxCount) {
+  size_t n = 0;
+  while ((n < maxCount) && (xbeeReadingQueueElements > 0)) {
+    const XBeeReadingRecord &rec = xbeeReadingQueue[xbeeReadingQueueHead];
+    unsigned long t0 = millis();
+    bool success = postReading(rec.devid, rec.sensor, rec.value, rec.timestamp, rec.datetime, rec.quality);
+    unsigned long dt = millis() - t0;
+    xbeeReadingQueueHead = (xbeeReadingQueueHead + 1) % XBEE_READING_QUEUE_SIZE;
+    xbeeReadingQueueElements--;
+    if (success) {
+      xbeeStats.readingsUploaded++;
+    } else {
+      xbeeStats.uploadFailures++;
+    }
+    xbeeStats.uploadTimeTotal += dt;
+    if (dt > xbeeStats.uploadTimeMax) xbeeStats.uploadTimeMax = dt;
+    n++;
+    parseXBeePackets();
+  }
+  if (n > 0) xbeeStats.uploadBatches++;
+  return n;
+}
+
+
+/* Peak number of bytes held in the XBee receive ring buffer
+   (XBEE_BUFFER_SIZE) since startup. */
+size_t getXBeeBufferHighWater() {
+  uint8_t oldSREG = SREG;  // Save interrupt status (among other things)
+  cli();  // Disable interrupts
+  size_t highWater = xbeeBufferHighWater;
+  SREG = oldSREG;  // Restore interrupt status
+  return highWater;
+}
+
+
+/* Receive and parse stage totals: bytes pulled from the serial
+   interface, bytes lost to overruns (including any not yet handled
+   by processXBee()), and valid packets parsed. */
+void getXBeeCounters(uint32_t &received, uint32_t &overrun, uint32_t &parsed) {
+  uint8_t oldSREG = SREG;  // Save interrupt status (among other things)
+  cli();  // Disable interrupts
+  received = xbeeBufferReceived;
+  overrun = xbeeBufferOverrunTotal + xbeeBufferOverrun;
+  SREG = oldSREG;  // Restore interrupt status
+  parsed = xbeeStats.packetsParsed;
+}
+
+
+/* Prints per-stage XBee data path counters and high-water marks to
+   serial.  Comparing stages indicates where a bottleneck lies: a
+   ring buffer near capacity or with overruns points to the parse
+   stage not being called often enough, while a full reading queue
+   with stalls points to slow uploads. */
+void printXBeePipelineStats() {
+  uint8_t oldSREG = SREG;  // Save interrupt status (among other things)
+  cli();  // Disable interrupts
+  uint32_t received = xbeeBufferReceived;
+  size_t highWater = xbeeBufferHighWater;
+  size_t elements = xbeeBufferElements;
+  SREG = oldSREG;  // Restore interrupt status
+
+  Serial.println(F("XBee data path statistics:"));
+  Serial.print(F("  Receive:  "));
+  Serial.print(received);
+  Serial.print(F(" bytes, buffer "));
+  Serial.print(elements);
+  Serial.print(F("/"));
+  Serial.print(XBEE_BUFFER_SIZE);
+  Serial.print(F(" (peak "));
+  Serial.print(highWater);
+  Serial.print(F("), overrun "));
+  Serial.print(xbeeBufferOverrunTotal);
+  Serial.print(F(" bytes, dropped "));
+  const PodStats &stats = getPodStats();
+  Serial.print(getPacketsDropped() - stats.packetsDropped[PACKET_DROP_MALFORMED]
+               - stats.packetsDropped[PACKET_DROP_UNKNOWN]);
+  Serial.println(F(" packets"));
+  Serial.print(F("  Parse:    "));
+  Serial.print(xbeeStats.packetsParsed);
+  Serial.print(F(" packets, "));
+  Serial.print(xbeeStats.readingsQueued);
+  Serial.print(F(" readings queued, "));
+  Serial.print(stats.packetsDropped[PACKET_DROP_MALFORMED]);
+  Serial.print(F(" malformed, queue "));
+  Serial.print(xbeeReadingQueueElements);
+  Serial.print(F("/"));
+  Serial.print(XBEE_READING_QUEUE_SIZE);
+  Serial.print(F(" (peak "));
+  Serial.print(xbeeStats.queueHighWater);
+  Serial.print(F("), "));
+  Serial.print(xbeeStats.queueFullStalls);
+  Serial.println(F(" stalls"));
+  Serial.print(F("  Upload:   "));
+  Serial.print(xbeeStats.readingsUploaded);
+  Serial.print(F(" uploaded, "));
+  Serial.print(xbeeStats.uploadFailures);
+  Serial.print(F(" failed, "));
+  Serial.print(xbeeStats.uploadBatches);
+  Serial.print(F(" batches, max "));
+  Serial.print(xbeeStats.uploadTimeMax);
+  Serial.print(F(" ms, total "));
+  Serial.print(xbeeStats.uploadTimeTotal);
+  Serial.println(F(" ms"));
 }
 
 
@@ -1005,30 +1508,6 @@ void xbeeSettings(String incoming, String incoming2) {
   updateConfig(did, location, coordinator, project, rate, build, teardown, datetime, netid);
 }
 
-void xbeeReading(String incoming) {
-  String did, sensor, val, timestamp, datetime;
-  int one, two, three, four, five;
-
-  one = incoming.indexOf(',') + 1;
-  two = incoming.indexOf(',', one) + 1;
-  three = incoming.indexOf(',', two) + 1;
-  four = incoming.indexOf(',', three) + 1;
-  five = incoming.indexOf(',', four) + 1;
-  did = incoming.substring(one, two - 1);
-  sensor = incoming.substring(two, three - 1);
-  val = incoming.substring(three, four - 1);
-  timestamp = incoming.substring(four, five - 1);
-  datetime = incoming.substring(five);
-  //Serial.println(one);
-  //Serial.println(two);
-  //Serial.println(three);
-  //Serial.println(did);
-  //Serial.println(sensor);
-  //Serial.println(val);
-  //Serial.println(datetime);
-  postReading(did, sensor, val, timestamp, datetime);
-}
-
 
 /* Broadcast the coordinator's address over the XBee network,
    to be used as the destination address by other XBees.
@@ -1092,17 +1571,22 @@ void processDestinationPacket(const String packet) {
 /* Loads network configuration information from EEPROM if available, 
    otherwise sets default values. */
 void loadNetworkConfig() {
-  // Check config version
-  uint16_t version = (((uint16_t)EEPROM.read(EEPROM_NETWORK_ADDR + 0)) << 0)
-                     + (((uint16_t)EEPROM.read(EEPROM_NETWORK_ADDR + 1)) << 8);
-
-  // Load data if valid
-  if (version == NETWORK_CONFIG_VERSION) {
-    for (size_t k = 0; k < sizeof(networkConfig); k++) {
-      *((char*)&networkConfig + k) = EEPROM.read(EEPROM_NETWORK_ADDR + k);
-    }
+  uint8_t schema;
+  if (loadEEPROMRecord(EEPROM_RECORD_NETWORK,&networkConfig,sizeof(networkConfig),schema) > 0) {
+    return;
+  }
+
+  // Configuration saved by older firmware: moved to the EEPROM record
+  LegacyNetworkConfig legacy;
+  EEPROM.get(EEPROM_NETWORK_ADDR,legacy);
+  if (legacy.version == NETWORK_CONFIG_LEGACY_VERSION) {
+    networkConfig.flags = legacy.flags;
+    networkConfig.staticIP = legacy.staticIP;
+    networkConfig.gatewayIP = legacy.gatewayIP;
+    networkConfig.subnet = legacy.subnet;
+    networkConfig.dnsIP = legacy.dnsIP;
+    saveNetworkConfig();
   } else {
-    networkConfig.version = NETWORK_CONFIG_VERSION;
     networkConfig.flags = 0x00;
     networkConfig.staticIP = 0;
     networkConfig.dnsIP = 0x08080808;  // Google DNS: 8.8.8.8
@@ -1115,12 +1599,9 @@ void loadNetworkConfig() {
 
 /* Saves network configuration information to EEPROM. */
 void saveNetworkConfig() {
-  for (size_t k = 0; k < sizeof(networkConfig); k++) {
-    // Put only writes byte if different from current EEPROM value
-    // (reduces EEPROM wear).  If configuration hasn't changed,
-    // this will not actually write anything.
-    EEPROM.put(EEPROM_NETWORK_ADDR + k, *((char*)&networkConfig + k));
-  }
+  // If configuration hasn't changed, this will not actually write
+  // anything.
+  saveEEPROMRecord(EEPROM_RECORD_NETWORK,&networkConfig,sizeof(networkConfig),NETWORK_CONFIG_SCHEMA);
 }
 
 
@@ -1419,61 +1900,205 @@ void ethernetMaintain() {
   }
 }
 
-void saveReading(String lstr, String rstr, String atstr, String gtstr, String sstr, String c2str, String p1str, String p2str, String cstr) {
-  time_t utc = getUTC();
-  String TS(utc);
-  String DT = getDBDateTimeString(utc);
-  // Use local time in log file, but also include unix timestamp
-  String sensorData = (TS + ", " + DT + ", " + lstr + ", " + rstr + ", " + atstr + ", " + gtstr + ", " + sstr + ", " + c2str + ", " + p1str + ", " + p2str + ", " + cstr);
-  logDataSD(sensorData);
-
-  if (lstr != "")
-    postReading(getDevID(), "Light", lstr, TS, DT);
-  if (rstr != "")
-    postReading(getDevID(), "Humidity", rstr, TS, DT);
-  if (atstr != "")
-    postReading(getDevID(), "AirTemp", atstr, TS, DT);
-  if (gtstr != "")
-    postReading(getDevID(), "GlobeTemp", gtstr, TS, DT);
-  if (sstr != "")
-    postReading(getDevID(), "Sound", sstr, TS, DT);
-  if (c2str != "")
-    postReading(getDevID(), "CO2", c2str, TS, DT);
-  if (p1str != "")
-    postReading(getDevID(), "PM_2.5", p1str, TS, DT);
-  if (p2str != "")
-    postReading(getDevID(), "PM_10", p2str, TS, DT);
-  if (cstr != "")
-    postReading(getDevID(), "CO", cstr, TS, DT);
-}
-
-void postReading(String DID, String ST, String R, String TS, String DT)
+// Sensor type names used in uploads, indexed by ReadingType.
+static const char READING_NAME_LIGHT[] PROGMEM     = "Light";
+static const char READING_NAME_HUMIDITY[] PROGMEM  = "Humidity";
+static const char READING_NAME_AIRTEMP[] PROGMEM   = "AirTemp";
+static const char READING_NAME_GLOBETEMP[] PROGMEM = "GlobeTemp";
+static const char READING_NAME_SOUND[] PROGMEM     = "Sound";
+static const char READING_NAME_CO2[] PROGMEM       = "CO2";
+static const char READING_NAME_PM2_5[] PROGMEM     = "PM_2.5";
+static const char READING_NAME_PM10[] PROGMEM      = "PM_10";
+static const char READING_NAME_CO[] PROGMEM        = "CO";
+static const char READING_NAME_MEM_FREE[] PROGMEM  = "MemFree";
+static const char READING_NAME_MEM_LARGEST[] PROGMEM = "MemLargest";
+static const char READING_NAME_LOOP_RATE[] PROGMEM = "LoopRate";
+static const char READING_NAME_READ_FAILURES[] PROGMEM = "ReadFail";
+static const char READING_NAME_PACKET_DROPS[] PROGMEM = "PktDrop";
+static const char READING_NAME_POST_FAILURES[] PROGMEM = "PostFail";
+static const char * const READING_NAMES[READING_TYPE_COUNT] PROGMEM = {
+  READING_NAME_LIGHT, READING_NAME_HUMIDITY, READING_NAME_AIRTEMP,
+  READING_NAME_GLOBETEMP, READING_NAME_SOUND, READING_NAME_CO2,
+  READING_NAME_PM2_5, READING_NAME_PM10, READING_NAME_CO,
+  READING_NAME_MEM_FREE, READING_NAME_MEM_LARGEST, READING_NAME_LOOP_RATE,
+  READING_NAME_READ_FAILURES, READING_NAME_PACKET_DROPS,
+  READING_NAME_POST_FAILURES
+};
+static_assert(sizeof(READING_NAME_MEM_LARGEST) <= READING_NAME_LEN,
+              "Longest reading name does not fit in READING_NAME_LEN");
+
+/* Writes the upload name of the given reading type to the buffer
+   (at least READING_NAME_LEN long) and returns it. */
+char* formatReadingName(char *buff, const ReadingType type) {
+  if (type >= READING_TYPE_COUNT) {
+    buff[0] = '\0';
+    return buff;
+  }
+  strcpy_P(buff, (PGM_P)pgm_read_word(&READING_NAMES[type]));
+  return buff;
+}
+
+
+/* Looks up the reading type with the given upload name (the reverse
+   of formatReadingName).  Returns false if there is none. */
+bool parseReadingName(const char *name, ReadingType &type) {
+  for (uint8_t k = 0; k < READING_TYPE_COUNT; k++) {
+    if (strcmp_P(name, (PGM_P)pgm_read_word(&READING_NAMES[k])) == 0) {
+      type = (ReadingType)k;
+      return true;
+    }
+  }
+  return false;
+}
+
+
+/* Writes the reading value as text to the buffer (at least
+   READING_VALUE_LEN long) and returns it.  Values are written with
+   two decimal places, except CO2 [ppm] and the diagnostics (memory
+   [bytes] and runtime counters), which are integers. */
+char* formatReadingValue(char *buff, const Reading &r) {
+  // Keep (unexpectedly) large values from overrunning the buffer
+  if (fabs(r.value) >= 1e9) {
+    strcpy(buff,"nan");
+    return buff;
+  }
+  const bool integer = (r.type == READING_CO2) || (r.type >= READING_SD_COUNT);
+  dtostrf(r.value,1,integer ? 0 : 2,buff);
+  return buff;
+}
+
+
+/* Sets the quality flags of the given reading(s), logs them to a
+   single SD data row and uploads (coordinator) or sends to the
+   coordinator (drone) each of them that passes the report-by-exception
+   check.  Readings in one call should come from one sensor and share
+   the same time. */
+void saveReading(Reading &r) {
+  saveReadings(&r,1);
+}
+void saveReadings(Reading *r, const uint8_t n) {
+  if (n == 0) return;
+  for (uint8_t k = 0; k < n; k++) {
+    countReading(r[k].type);
+  }
+  checkReadings(r,n);
+  logReadingsSD(r,n);
+  adaptSampling(r,n);
+  for (uint8_t k = 0; k < n; k++) {
+    if (isReadingReportable(r[k])) {
+      if (postReading(r[k])) noteReadingReported(r[k]);
+    } else {
+      countReadingSuppressed();
+    }
+  }
+}
+
+
+/* Report-by-exception check: indicates if the given reading should be
+   sent, i.e. if it differs from the last value sent by more than the
+   configured absolute or relative deadband, or if the heartbeat
+   interval has passed since.  The first reading of each type, invalid
+   or flagged values, and types without deadbands are always sent.  The
+   reference value only moves once a reading has actually been sent
+   (see noteReadingReported()), so changes are not lost to a failed
+   upload. */
+bool isReadingReportable(const Reading &r) {
+  if (r.type >= READING_SD_COUNT) return true;
+  ReportState &last = reportState[r.type];
+  const float dabs = getDeadbandAbs(r.type);
+  const float drel = getDeadbandRel(r.type);
+  const int heartbeat = getHeartbeat();
+  bool report = (dabs <= 0) && (drel <= 0);
+  if (!report) report = !last.valid || isnan(r.value) || isnan(last.value) || (r.quality != 0);
+  if (!report) report = (heartbeat > 0) && (r.utc - last.utc >= (time_t)heartbeat);
+  if (!report) {
+    const float diff = fabs(r.value - last.value);
+    report = ((dabs > 0) && (diff > dabs))
+             || ((drel > 0) && (diff > drel * fabs(last.value)));
+  }
+  return report;
+}
+
+
+/* Makes the given reading, once sent, the reference value for the
+   report-by-exception check. */
+void noteReadingReported(const Reading &r) {
+  if (r.type >= READING_SD_COUNT) return;
+  ReportState &last = reportState[r.type];
+  last.value = r.value;
+  last.utc = r.utc;
+  last.valid = true;
+}
+
+
+/* Uploads (coordinator) or sends to the coordinator (drone) the given
+   reading, formatting its fields into stack buffers. */
+bool postReading(const Reading &r) {
+  char ST[READING_NAME_LEN];
+  char R[READING_VALUE_LEN];
+  char TS[12];
+  char DT[CLOCK_DATETIME_LEN];
+  char Q[4] = "";
+  formatReadingName(ST,r.type);
+  formatReadingValue(R,r);
+  sprintf(TS,"%lu",(unsigned long)r.utc);
+  formatDBDateTime(DT,r.utc);
+  if (r.quality != 0) sprintf(Q,"%u",r.quality);
+  return postReading(getDevID(),ST,R,TS,DT,Q);
+}
+
+
+/* Writes the HTTP form data for uploading a reading given as text
+   fields (see below) and returns its length.  The quality field is
+   left out if empty. */
+size_t formatReadingPost(char *buff, const size_t len, const char *DID, const char *ST, const char *R, const char *TS, const char *DT, const char *Q) {
+  int n = snprintf(buff,len,
+                   "DeviceID=%s&SensorType=%s&Reading=%s&TimeStamp=%s&ReadTime=%s%s%s",
+                   DID,ST,R,TS,DT,(Q[0] != '\0') ? "&Quality=" : "",Q);
+  return (n < 0) ? 0 : ((size_t)n < len ? n : len - 1);
+}
+
+
+/* Uploads (coordinator) or sends to the coordinator (drone) a reading
+   given as text fields: device ID, sensor type, value, unix timestamp,
+   database date/time string and quality flags (empty if none).  Also
+   used to relay drone readings. */
+bool postReading(const char *DID, const char *ST, const char *R, const char *TS, const char *DT, const char *Q)
 {
   #ifdef DEBUG
   writeDebugLog(ST);
   #endif
   if (getModeCoord()) {
-    // String in temp string is data to be submitted to MySQL
-    String amp = "&";
-    String content = "DeviceID=" + DID + amp + "SensorType=" + ST + amp + "Reading=" + R + amp + "TimeStamp=" + TS + amp + "ReadTime=" + DT;
-    //char p[200];
-    //content.toCharArray(p, 200);
-    //if (!postPage(getServer(), SERVER_PORT, SERVER_PAGE_NAME, p)) {
-    if (!postPage(getServer(), SERVER_PORT, SERVER_PAGE_NAME, content.c_str())) {
-      Serial.print("[" + String(packetsUploaded) + "] ");
+    // Data to be submitted to MySQL
+    char content[READING_POST_LEN];
+    formatReadingPost(content,sizeof(content),DID,ST,R,TS,DT,Q);
+    if (!postPage(getServer(), SERVER_PORT, SERVER_PAGE_NAME, content)) {
+      Serial.print('[');
+      Serial.print(packetsUploaded);
+      Serial.print(F("] "));
       Serial.println(F("Failed to upload sensor reading to remote."));
       #ifdef DEBUG
       writeDebugLog(F("Failed to upload sensor reading to remote. \n"));
       #endif
+      return false;
     } else {
-      Serial.print("[" + String(packetsUploaded) + "] ");
-      Serial.println(F("Uploaded sensor reading (") + ST + F(" @ ") + DID + F(")."));
+      Serial.print('[');
+      Serial.print(packetsUploaded);
+      Serial.print(F("] "));
+      Serial.print(F("Uploaded sensor reading ("));
+      Serial.print(ST);
+      Serial.print(F(" @ "));
+      Serial.print(DID);
+      Serial.println(F(")."));
     }
   } else {
-    String message = "V," + DID + "," + ST + "," + R + "," + TS + "," + DT;
+    char message[88];
+    snprintf(message,sizeof(message),"V,%s,%s,%s,%s,%s%s%s",DID,ST,R,TS,DT,
+             (Q[0] != '\0') ? "," : "",Q);
     sendXBee(message);
     delay(1000);
   }
+  return true;
 }
 
 void updateRate(String DID, String ST, String R, String DT)
@@ -1521,7 +2146,17 @@ void updateConfig(String DID, String Location, String Coordinator, String Projec
 }
 
 // postPage is function that performs POST request and prints results.
+// Request counts and durations are recorded in the runtime statistics.
 byte postPage(const char* domainBuffer, int thisPort, const char* page, const char* thisData)
+{
+  unsigned long t0 = millis();
+  byte result = sendPostRequest(domainBuffer,thisPort,page,thisData);
+  countPost(result != 0,millis() - t0);
+  return result;
+}
+
+// Performs the POST request for postPage().
+byte sendPostRequest(const char* domainBuffer, int thisPort, const char* page, const char* thisData)
 {
   // Keep track of POST attempts (successful or not)
   packetsUploaded++;
@@ -1584,6 +2219,7 @@ byte postPage(const char* domainBuffer, int thisPort, const char* page, const ch
     //Serial.println(client.available());
     if (!client.available()) {
       Serial.println(F("Warning: Server did not respond before timeout.  Data upload may have failed."));
+      countPostTimeout();
       // May not want to flag this: probably a server issue, not
       // an ethernet connection issue.
       //ethStatus.failed();
@@ -1661,10 +2297,80 @@ byte postPage(const char* domainBuffer, int thisPort, const char* page, const ch
 
 //--------------------------------------------------------------------------------------------- [Upload Support]
 
-/* Attempt to update the RTC with the current time from an NTP server. */
+/* Attempt to update the RTC with the current time from an NTP server.
+   Unlike the background NTP client, this blocks (for up to about a
+   second) and uses a single request; intended for startup, where the
+   clock may be far off and should be set before anything else. */
 void updateClockFromNTP() {
   Serial.println(F("Retrieving NTP data...."));
+  if (!startNTPPoll(1)) return;
+  while (ntpState.burstRemaining > 0 || ntpState.waiting) {
+    delay(10);
+    maintainNTP();
+  }
+  if (!ntpState.haveSample && !ntpState.stepped) return;
+  // Apply any small correction immediately rather than slewing
+  if (ntpState.slewRemaining != 0) {
+    time_t t;
+    uint16_t ms;
+    getUTCPrecise(t,ms);
+    shiftUTCPrecise(t,ms,ntpState.slewRemaining);
+    setUTCPrecise(t,ms);
+    ntpState.slewRemaining = 0;
+  }
+
+  time_t utc0 = getUTC();
+  Serial.println(F("RTC updated.  New time:"));
+  Serial.print(F("  Universal time: "));
+  Serial.println(getUTCDateTimeString(utc0));
+  Serial.print(F("  Local time:     "));
+  Serial.println(getLocalDateTimeString(utc0));
+  Serial.print(F("  Unix timestamp: "));
+  Serial.println(utc0);
+}
+
+
+/* Begins an NTP poll consisting of a burst of the given number of
+   requests, which are then processed in the background by
+   maintainNTP().  Returns false if the poll could not be started. */
+bool startNTPPoll(const uint8_t burst) {
+  ntpState.polled = true;
+  ntpState.pollMillis = millis();
+  ntpState.haveSample = false;
+  ntpState.stepped = false;
+  
+  // If we do not have IP address, we will be unable to connect to
+  // NTP server.  The ethernetMaintain() routine should eventually
+  // try to reconnect.
+  if (!ethernetHasIPAddress()) {
+    // Flag bad ethernet connection
+    ethStatus.failed();
+    Serial.println(F("Warning: Failed to connect to NTP server (no internet connection)."));
+    return false;
+  }
   
+  // Timestamps need the millis() timer locked to the RTC.  Without
+  // a lock (e.g. RTC time unset), the server time is taken directly.
+  refreshRTCPhase(0);
+  
+  // Open port to receive UDP response packets.
+  if (!ntpUdp.begin(LOCAL_PORT)) {
+    // Flag bad ethernet connection
+    ethStatus.failed();
+    Serial.println(F("Warning: Failed to open port to receive NTP response."));
+    ntpUdp.stop();
+    return false;
+  }
+  ntpState.burstRemaining = burst;
+  ntpState.waiting = false;
+  ntpState.sendMillis = millis() - NTP_BURST_SPACING;
+  return true;
+}
+
+
+/* Sends a single NTP request, stamped with the local transmit time
+   (t1), which the server echoes back as the originate timestamp. */
+bool sendNTPRequest() {
   // Build NTP request packet
   byte packet[NTP_PACKET_SIZE];
   memset(packet,0,NTP_PACKET_SIZE);
@@ -1678,95 +2384,281 @@ void updateClockFromNTP() {
   packet[14] = 49;
   packet[15] = 52;
   
-  // Open port to receive UDP response packet.
-  EthernetUDP Udp;
-  if (!Udp.begin(LOCAL_PORT)) {
-    // Flag bad ethernet connection
-    ethStatus.failed();
-    Serial.println(F("Warning: Failed to open port to receive NTP response."));
-    Udp.stop();
-    return;
-  }
-  
-  // If we do not have IP address, we will be unable to connect to
-  // NTP server.  The ethernetMaintain() routine should eventually
-  // try to reconnect.
-  if (!ethernetHasIPAddress()) {
-    // Flag bad ethernet connection
-    ethStatus.failed();
-    Serial.println(F("Warning: Failed to connect to NTP server (no internet connection)."));
-    Udp.stop();
-    return;
-  }
-  
   // Send request packet to NTP server.  Do nothing if cannot connect.
-  if (!Udp.beginPacket(NTP_SERVER,NTP_PORT)) {
+  // Note the server name lookup happens here, so the transmit time is
+  // taken afterwards.
+  if (!ntpUdp.beginPacket(NTP_SERVER,NTP_PORT)) {
     // Flag bad ethernet connection
     ethStatus.failed();
     Serial.println(F("Warning: Failed to connect to NTP server."));
-    Udp.stop();
-    return;
+    return false;
   }
-  Udp.write(packet,NTP_PACKET_SIZE);
-  if (!Udp.endPacket()) {
+  if (getUTCPrecise(ntpState.t1,ntpState.t1ms)) {
+    writeNTPTimestamp(&packet[40],ntpState.t1,ntpState.t1ms);
+  } else {
+    // No local time: any unique value will do for matching replies
+    ntpState.t1 = 0;
+    ntpState.t1ms = 0;
+    uint32_t m = millis();
+    memcpy(&packet[40],&m,sizeof(m));
+  }
+  memcpy(ntpState.origin,&packet[40],8);
+  ntpUdp.write(packet,NTP_PACKET_SIZE);
+  if (!ntpUdp.endPacket()) {
     Serial.println(F("Warning: Failed to connect to NTP server."));
     // Flag bad ethernet connection
     ethStatus.failed();
-    return;
+    return false;
   }
+  ntpState.requests++;
+  return true;
+}
+
+
+/* Reads/writes an NTP timestamp (seconds since 1900 and 32-bit
+   binary fraction) as unix time and milliseconds. */
+void readNTPTimestamp(const byte *b, time_t &t, uint16_t &ms) {
+  uint32_t s = ((uint32_t)b[0] << 24) | ((uint32_t)b[1] << 16)
+             | ((uint32_t)b[2] <<  8) | ((uint32_t)b[3] <<  0);
+  uint32_t f = ((uint32_t)b[4] << 24) | ((uint32_t)b[5] << 16)
+             | ((uint32_t)b[6] <<  8) | ((uint32_t)b[7] <<  0);
+  t = s - NTP_UNIX_OFFSET;
+  ms = ((uint64_t)f * 1000) >> 32;
+}
+
+void writeNTPTimestamp(byte *b, const time_t t, const uint16_t ms) {
+  uint32_t s = t + NTP_UNIX_OFFSET;
+  // Round up so the fraction reads back as the same millisecond
+  uint32_t f = (((uint64_t)ms << 32) + 999) / 1000;
+  for (int k = 0; k < 4; k++) {
+    b[k]   = (s >> (24 - 8*k)) & 0xFF;
+    b[4+k] = (f >> (24 - 8*k)) & 0xFF;
+  }
+}
+
+
+/* Handles a received NTP reply: computes clock offset and round-trip
+   delay, keeping the minimum-delay sample of the current burst. */
+void processNTPReply() {
+  time_t t4;
+  uint16_t t4ms;
+  bool locked = getUTCPrecise(t4,t4ms);
   
-  // Wait for reply.
-  unsigned long t0 = millis();
-  do {
-    delay(50);
-  } while ((millis() - t0 < 1000) && (Udp.parsePacket() == 0));
-  if (Udp.available() != NTP_PACKET_SIZE) {
+  // Get returned packet contents.
+  byte packet[NTP_PACKET_SIZE];
+  if (ntpUdp.available() != NTP_PACKET_SIZE) {
+    ntpUdp.flush();
     Serial.println(F("Warning: Failed to retrieve NTP data."));
-    Udp.stop();
     return;
   }
+  ntpUdp.read(packet,NTP_PACKET_SIZE);
   
   // Successfully connected to NTP server:
   // clear bad ethernet connection flags
   ethStatus.succeeded();
   
-  // Get returned packet contents and release incoming port.
-  Udp.read(packet,NTP_PACKET_SIZE);
-  Udp.stop();
-  
-  // Extract timestamp from packet bytes 40-43.
-  unsigned long tntp = (((unsigned long)packet[40]) << 24)
-                     | (((unsigned long)packet[41]) << 16)
-                     | (((unsigned long)packet[42]) <<  8)
-                     | (((unsigned long)packet[43]) <<  0);
-
-  // NTP time is seconds since 1900-01-01 00:00:00 UTC.
-  // Unix time is seconds since 1970-01-01 00:00:00 UTC.
-  const time_t NTP1970 = 2208988800ul;
-  time_t utc = tntp - NTP1970;
-  Serial.print(F("  Retrieved NTP timestamp:  "));
-  Serial.println(tntp);
-  //Serial.print(F("  Unix timestamp: "));
-  //Serial.println(utc);
+  // Reply must echo this request's transmit time (originate
+  // timestamp, bytes 24-31), otherwise it is stale or spurious.
+  if (memcmp(&packet[24],ntpState.origin,8) != 0) {
+    Serial.println(F("Warning: Unexpected NTP reply (ignoring)."));
+    return;
+  }
+  ntpState.waiting = false;
+  ntpState.replies++;
+  time_t t1,t2,t3;
+  uint16_t t1ms,t2ms,t3ms;
+  t1 = ntpState.t1;
+  t1ms = ntpState.t1ms;
+  readNTPTimestamp(&packet[32],t2,t2ms);
+  readNTPTimestamp(&packet[40],t3,t3ms);
   
   // Update RTC only if time is recent (otherwise, ntp
-  // data must be invalid).
+  // data must be invalid).  Also reject kiss-o'-death
+  // (stratum 0) replies.
   //const time_t UTC2000 = 946684800ul;
   const time_t UTC2019 = 1546300800ul;
-  if (utc < UTC2019) {
+  if ((t3 < UTC2019) || (packet[1] == 0)) {
     Serial.println(F("Warning: Invalid NTP data (ignoring)."));
     return;
   }
-  setUTC(utc);
+  
+  // A clock that is unset or far off would overflow the millisecond
+  // arithmetic below: take the server time directly.  Any further
+  // requests in the burst then refine it.
+  if (!locked || (t1 == 0) || (t3 > t4 + 86400ul) || (t4 > t3 + 86400ul)) {
+    setUTCPrecise(t3,t3ms);
+    ntpState.stepped = true;
+    ntpState.steps++;
+    ntpState.slewRemaining = 0;
+    ntpState.havePrevious = false;
+    return;
+  }
+  int32_t offset = (diffUTCPrecise(t2,t2ms,t1,t1ms) + diffUTCPrecise(t3,t3ms,t4,t4ms)) / 2;
+  int32_t roundTrip = diffUTCPrecise(t4,t4ms,t1,t1ms) - diffUTCPrecise(t3,t3ms,t2,t2ms);
+  if (getDebugMode()) {
+    Serial.print(F("  NTP sample: offset "));
+    Serial.print(offset);
+    Serial.print(F(" ms, delay "));
+    Serial.print(roundTrip);
+    Serial.println(F(" ms"));
+  }
+  if (roundTrip < 0) return;
+  if (!ntpState.haveSample || (roundTrip < ntpState.bestDelay)) {
+    ntpState.haveSample = true;
+    ntpState.bestOffset = offset;
+    ntpState.bestDelay = roundTrip;
+  }
+}
 
-  time_t utc0 = getUTC();
-  Serial.println(F("RTC updated.  New time:"));
-  Serial.print(F("  Universal time: "));
-  Serial.println(getUTCDateTimeString(utc0));
-  Serial.print(F("  Local time:     "));
-  Serial.println(getLocalDateTimeString(utc0));
-  Serial.print(F("  Unix timestamp: "));
-  Serial.println(utc0);
+
+/* Applies the best sample of a completed burst: steps or slews the
+   clock, updates the drift estimate and adapts the poll interval. */
+void finishNTPPoll() {
+  ntpUdp.stop();
+  if (!ntpState.haveSample) {
+    if (!ntpState.stepped) Serial.println(F("Warning: Failed to retrieve NTP data."));
+    ntpState.pollInterval = NTP_POLL_INTERVAL_MIN;
+    return;
+  }
+  int32_t offset = ntpState.bestOffset;
+  bool step = (offset >= NTP_STEP_THRESHOLD) || (offset <= -NTP_STEP_THRESHOLD);
+  
+  // Drift estimate from offset accumulated since the previous poll
+  // (earlier corrections have been applied or are still being slewed).
+  // A step indicates something other than drift (e.g. clock reset).
+  if (ntpState.havePrevious && !step) {
+    unsigned long elapsed = ntpState.pollMillis - ntpState.previousMillis;
+    float sample = -1e6 * (float)(offset - ntpState.slewRemaining) / (float)elapsed;
+    if (ntpState.driftSamples == 0) {
+      ntpState.drift = sample;
+    } else {
+      ntpState.drift += 0.25 * (sample - ntpState.drift);
+    }
+    if (ntpState.driftSamples < 0xFF) ntpState.driftSamples++;
+  }
+  ntpState.previousMillis = ntpState.pollMillis;
+  ntpState.havePrevious = !step;
+  
+  // Large offsets step the clock; smaller ones are slewed out
+  // gradually by maintainNTP().
+  if (step) {
+    time_t t;
+    uint16_t ms;
+    getUTCPrecise(t,ms);
+    shiftUTCPrecise(t,ms,offset);
+    setUTCPrecise(t,ms);
+    ntpState.slewRemaining = 0;
+    ntpState.steps++;
+  } else {
+    ntpState.slewRemaining = offset;
+  }
+  
+  // Adapt poll interval: back off while offset is small
+  if ((offset < NTP_STABLE_OFFSET) && (offset > -NTP_STABLE_OFFSET)) {
+    ntpState.pollInterval = min(2*ntpState.pollInterval,(unsigned long)NTP_POLL_INTERVAL_MAX);
+  } else {
+    ntpState.pollInterval = NTP_POLL_INTERVAL_MIN;
+  }
+
+#if defined(NTP_TRIM_AGING)
+  // Move a persistent drift into the RTC's aging offset; the
+  // oscillator has then changed, so restart the drift estimate.
+  if ((ntpState.driftSamples >= NTP_TRIM_MIN_SAMPLES)
+      && (fabs(ntpState.drift) >= NTP_TRIM_MIN_DRIFT)) {
+    int aging = getDS3234AgingOffset() + (int)lround(ntpState.drift / 0.1);
+    aging = constrain(aging,-127,127);
+    setDS3234AgingOffset((int8_t)aging);
+    Serial.print(F("RTC aging offset trimmed to "));
+    Serial.println(aging);
+    ntpState.drift = 0;
+    ntpState.driftSamples = 0;
+  }
+#endif
+
+  if (getDebugMode()) printNTPStats();
+}
+
+
+/* Runs the background NTP client: starts polls at the adaptive poll
+   interval, sends burst requests, collects replies without blocking
+   and slews out small corrections.  Should be called regularly from
+   the coordinator's main loop. */
+void maintainNTP() {
+  unsigned long now = millis();
+  
+  // Collect reply to outstanding request
+  if (ntpState.waiting) {
+    if (ntpUdp.parsePacket() > 0) {
+      processNTPReply();
+    } else if (now - ntpState.sendMillis >= NTP_REPLY_TIMEOUT) {
+      ntpState.waiting = false;
+    }
+    if (ntpState.waiting) return;
+    if (ntpState.burstRemaining == 0) finishNTPPoll();
+    return;
+  }
+  
+  // Next request in burst
+  if (ntpState.burstRemaining > 0) {
+    if (now - ntpState.sendMillis < NTP_BURST_SPACING) return;
+    ntpState.burstRemaining--;
+    ntpState.sendMillis = now;
+    if (sendNTPRequest()) {
+      ntpState.waiting = true;
+    } else if (ntpState.burstRemaining == 0) {
+      finishNTPPoll();
+    }
+    return;
+  }
+  
+  // Slew: apply small pieces of the outstanding correction, only
+  // when close enough to a second boundary to not block for long.
+  if ((ntpState.slewRemaining != 0) && (now - ntpState.slewMillis >= NTP_SLEW_INTERVAL)) {
+    int32_t step = constrain(ntpState.slewRemaining,-NTP_SLEW_STEP,NTP_SLEW_STEP);
+    time_t t;
+    uint16_t ms;
+    if (getUTCPrecise(t,ms)) {
+      shiftUTCPrecise(t,ms,step);
+      if (setUTCPrecise(t,ms,50)) {
+        ntpState.slewRemaining -= step;
+        ntpState.slewMillis = millis();
+      }
+    }
+    return;
+  }
+  
+  // Start a new poll when due
+  if (!ntpState.polled || (now - ntpState.pollMillis >= 1000*ntpState.pollInterval)) {
+    if (getDebugMode()) Serial.println(F("Starting NTP poll...."));
+    if (!startNTPPoll(NTP_BURST_SIZE)) ntpState.pollInterval = NTP_POLL_INTERVAL_MIN;
+  }
+}
+
+
+/* Prints NTP client status and statistics to serial. */
+void printNTPStats() {
+  Serial.println(F("NTP statistics:"));
+  Serial.print(F("  Last offset:  "));
+  Serial.print(ntpState.bestOffset);
+  Serial.print(F(" ms (delay "));
+  Serial.print(ntpState.bestDelay);
+  Serial.println(F(" ms)"));
+  Serial.print(F("  Drift:        "));
+  Serial.print(ntpState.drift,2);
+  Serial.print(F(" ppm ("));
+  Serial.print(ntpState.driftSamples);
+  Serial.println(F(" samples)"));
+  Serial.print(F("  Poll:         "));
+  Serial.print(ntpState.pollInterval);
+  Serial.println(F(" s"));
+  Serial.print(F("  Exchanges:    "));
+  Serial.print(ntpState.requests);
+  Serial.print(F(" requests, "));
+  Serial.print(ntpState.replies);
+  Serial.print(F(" replies, "));
+  Serial.print(ntpState.steps);
+  Serial.println(F(" clock steps"));
+  printClockStats();
 }
 
 
@@ -1823,6 +2715,13 @@ void processClockPacket(const String packet) {
     Serial.println(F("Warning: Received invalid clock broadcast (ignoring)."));
     return;
   }
+  // Broadcast has only one-second resolution and no latency
+  // compensation: do not let it undo a two-way time sync unless
+  // the clocks have clearly diverged.
+  if (timeSync.synced) {
+    long diff = (long)(utc - getUTC());
+    if ((diff >= -1) && (diff <= 1)) return;
+  }
   setUTC(utc);
 
   time_t utc0 = getUTC();
@@ -1834,3 +2733,370 @@ void processClockPacket(const String packet) {
   Serial.print(F("  Unix timestamp: "));
   Serial.println(utc0);
 }
+
+
+/* Retrieves the arrival time (millis) of the time sync packet being
+   processed, as recorded by the XBee read ISR.  Returns false if the
+   arrival time is ambiguous (more than one sync packet arrived since
+   the last one was processed, or an arrival was missed). */
+bool getXBeeSyncArrival(unsigned long &arrival) {
+  uint8_t oldSREG = SREG;  // Save interrupt status (among other things)
+  cli();  // Disable interrupts
+  arrival = xbeeSyncArrivalMillis;
+  uint8_t arrivals = xbeeSyncArrivals;
+  SREG = oldSREG;  // Restore interrupt status
+  xbeeSyncConsumed++;
+  if (arrivals != xbeeSyncConsumed) {
+    xbeeSyncConsumed = arrivals;
+    return false;
+  }
+  return true;
+}
+
+
+/* Writes a sub-second time as a 13-digit timestamp (10-digit unix
+   time followed by 3-digit milliseconds) to the given buffer, which
+   must hold at least 14 characters. */
+void formatTimeSyncStamp(char *buff, const time_t t, const uint16_t ms) {
+  sprintf(buff,"%010lu%03u",(unsigned long)t,ms);
+}
+
+
+/* Parses a 13-digit timestamp as written by formatTimeSyncStamp().
+   Returns false if invalid. */
+bool parseTimeSyncStamp(const char *buff, time_t &t, uint16_t &ms) {
+  t = 0;
+  ms = 0;
+  for (int k = 0; k < TIMESYNC_TIMESTAMP_LEN; k++) {
+    char c = buff[k];
+    if ((c < '0') || (c > '9')) return false;
+    if (k < 10) {
+      t = 10*t + (c - '0');
+    } else {
+      ms = 10*ms + (c - '0');
+    }
+  }
+  return true;
+}
+
+
+/* Sends a time sync request to the coordinator, stamped with the
+   drone's current time (t1).  The request is padded to the length
+   of the reply.  Intended to be called from drones only. */
+void requestTimeSync() {
+  if (getModeCoord()) return;
+  // Sub-second time requires a fresh lock to the RTC.
+  if (!refreshRTCPhase(TIMESYNC_PHASE_MAX_AGE)) {
+    Serial.println(F("Warning: Unable to lock to RTC for time sync."));
+    return;
+  }
+  char buff[TIMESYNC_PACKET_LEN + 1];
+  memset(buff,'0',TIMESYNC_PACKET_LEN);
+  buff[TIMESYNC_PACKET_LEN] = '\0';
+  buff[0] = 'Q';
+  getUTCPrecise(timeSync.t1,timeSync.t1ms);
+  formatTimeSyncStamp(&buff[1],timeSync.t1,timeSync.t1ms);
+  buff[1 + TIMESYNC_TIMESTAMP_LEN] = '0';
+  timeSync.pending = true;
+  timeSync.requestMillis = millis();
+  timeSync.requests++;
+  sendXBee(buff);
+}
+
+
+/* Responds to a drone's time sync request with the request's own
+   timestamp (t1), the request's arrival time (t2) and the reply's
+   send time (t3).  Intended to be called from coordinator only. */
+void processTimeSyncRequest(const String packet) {
+  unsigned long arrival;
+  bool unambiguous = getXBeeSyncArrival(arrival);
+  time_t t1;
+  uint16_t t1ms;
+  if ((packet.length() != TIMESYNC_PACKET_LEN) || (packet.charAt(0) != 'Q')
+      || !parseTimeSyncStamp(packet.c_str() + 1,t1,t1ms)) {
+    Serial.println(F("Warning: Received invalid time sync request (ignoring)."));
+    return;
+  }
+  // No reply if arrival time unknown: drone will retry.
+  if (!unambiguous) {
+    Serial.println(F("Warning: Time sync request arrival time ambiguous (ignoring)."));
+    return;
+  }
+  if (!refreshRTCPhase(TIMESYNC_PHASE_MAX_AGE)) {
+    Serial.println(F("Warning: Unable to lock to RTC for time sync."));
+    return;
+  }
+  time_t t2,t3;
+  uint16_t t2ms,t3ms;
+  getUTCPrecise(t2,t2ms);
+  shiftUTCPrecise(t2,t2ms,-(int32_t)(millis() - arrival));
+  char buff[TIMESYNC_PACKET_LEN + 1];
+  buff[0] = 'P';
+  formatTimeSyncStamp(&buff[1],t1,t1ms);
+  formatTimeSyncStamp(&buff[1 + TIMESYNC_TIMESTAMP_LEN],t2,t2ms);
+  getUTCPrecise(t3,t3ms);
+  formatTimeSyncStamp(&buff[1 + 2*TIMESYNC_TIMESTAMP_LEN],t3,t3ms);
+  sendXBee(buff);
+}
+
+
+/* Processes the coordinator's reply to a time sync request: computes
+   clock offset and network delay, updates the drift estimate, and
+   corrects the clock if necessary.  Replies are broadcast, so those
+   not matching this drone's outstanding request are ignored.
+   Intended to be called from drones only. */
+void processTimeSyncReply(const String packet) {
+  unsigned long arrival;
+  bool unambiguous = getXBeeSyncArrival(arrival);
+  time_t t1,t2,t3,t4;
+  uint16_t t1ms,t2ms,t3ms,t4ms;
+  if ((packet.length() != TIMESYNC_PACKET_LEN) || (packet.charAt(0) != 'P')
+      || !parseTimeSyncStamp(packet.c_str() + 1,t1,t1ms)
+      || !parseTimeSyncStamp(packet.c_str() + 1 + TIMESYNC_TIMESTAMP_LEN,t2,t2ms)
+      || !parseTimeSyncStamp(packet.c_str() + 1 + 2*TIMESYNC_TIMESTAMP_LEN,t3,t3ms)) {
+    Serial.println(F("Warning: Received invalid time sync reply (ignoring)."));
+    return;
+  }
+  // Reply to another drone's (or an expired) request
+  if (!timeSync.pending || (t1 != timeSync.t1) || (t1ms != timeSync.t1ms)) return;
+  timeSync.pending = false;
+  timeSync.replies++;
+  if (!unambiguous || !getUTCPrecise(t4,t4ms)) {
+    timeSync.rejected++;
+    return;
+  }
+  shiftUTCPrecise(t4,t4ms,-(int32_t)(millis() - arrival));
+
+  int32_t offset = (diffUTCPrecise(t2,t2ms,t1,t1ms) + diffUTCPrecise(t3,t3ms,t4,t4ms)) / 2;
+  int32_t roundTrip = diffUTCPrecise(t4,t4ms,t1,t1ms) - diffUTCPrecise(t3,t3ms,t2,t2ms);
+  if ((roundTrip < 0) || (roundTrip > TIMESYNC_MAX_DELAY)) {
+    Serial.print(F("Warning: Time sync delay out of range ("));
+    Serial.print(roundTrip);
+    Serial.println(F(" ms, ignoring)."));
+    timeSync.rejected++;
+    return;
+  }
+  
+  // Drift estimate: drone clock error accumulated since the last
+  // exchange, including any drift corrections made in between.
+  // Use an exponential moving average over exchanges.
+  unsigned long now = millis();
+  if (timeSync.synced) {
+    int32_t drift = -offset - timeSync.residual + timeSync.driftCorrection;
+    unsigned long elapsed = now - timeSync.syncMillis;
+    if (elapsed >= 1000*(unsigned long)TIMESYNC_INTERVAL_MIN) {
+      float sample = 1e6 * (float)drift / (float)elapsed;
+      if (timeSync.driftSamples == 0) {
+        timeSync.drift = sample;
+      } else {
+        timeSync.drift += 0.25 * (sample - timeSync.drift);
+      }
+      if (timeSync.driftSamples < 0xFF) timeSync.driftSamples++;
+    }
+  }
+
+  // Step clock to remove offset if significant
+  timeSync.residual = -offset;
+  if ((offset >= TIMESYNC_STEP_THRESHOLD) || (offset <= -TIMESYNC_STEP_THRESHOLD)) {
+    time_t t;
+    uint16_t ms;
+    getUTCPrecise(t,ms);
+    shiftUTCPrecise(t,ms,offset);
+    setUTCPrecise(t,ms);
+    timeSync.residual = 0;
+  }
+
+  // Adapt exchange interval: back off while aligned
+  if ((offset < TIMESYNC_ALIGNED_OFFSET) && (offset > -TIMESYNC_ALIGNED_OFFSET)) {
+    timeSync.interval = min(2*timeSync.interval,(unsigned long)TIMESYNC_INTERVAL_MAX);
+  } else {
+    timeSync.interval = TIMESYNC_INTERVAL_MIN;
+  }
+
+  timeSync.synced = true;
+  timeSync.syncMillis = now;
+  timeSync.offset = offset;
+  timeSync.roundTrip = roundTrip;
+  timeSync.driftCorrection = 0;
+
+#if defined(TIMESYNC_TRIM_AGING)
+  // Move a persistent drift into the RTC's aging offset; the
+  // oscillator has then changed, so restart the drift estimate.
+  if ((timeSync.driftSamples >= TIMESYNC_TRIM_MIN_SAMPLES)
+      && (fabs(timeSync.drift) >= TIMESYNC_TRIM_MIN_DRIFT)) {
+    int aging = getDS3234AgingOffset() + (int)lround(timeSync.drift / 0.1);
+    aging = constrain(aging,-127,127);
+    setDS3234AgingOffset((int8_t)aging);
+    Serial.print(F("RTC aging offset trimmed to "));
+    Serial.println(aging);
+    timeSync.drift = 0;
+    timeSync.driftSamples = 0;
+  }
+#endif
+
+  if (getDebugMode()) printTimeSyncStats();
+}
+
+
+/* Performs periodic drone time sync tasks: sends time sync requests
+   at the current exchange interval (retrying after unanswered
+   requests) and corrects the clock for estimated drift between
+   exchanges.  Should be called regularly from drones. */
+void maintainTimeSync() {
+  if (getModeCoord()) return;
+  unsigned long now = millis();
+  
+  if (timeSync.pending) {
+    if (now - timeSync.requestMillis < TIMESYNC_REPLY_TIMEOUT) return;
+    timeSync.pending = false;
+    timeSync.rejected++;
+    // Retry sooner if unanswered
+    timeSync.interval = TIMESYNC_INTERVAL_MIN;
+  }
+  
+  // Exchange is due at the current interval, or immediately if never
+  // synced; requests are never sent more often than the minimum
+  // interval.
+  bool due = !timeSync.synced || (now - timeSync.syncMillis >= 1000*timeSync.interval);
+  if (due && ((timeSync.requests == 0)
+              || (now - timeSync.requestMillis >= 1000*(unsigned long)TIMESYNC_INTERVAL_MIN))) {
+    requestTimeSync();
+    return;
+  }
+  
+  // Correct for drift once the expected accumulated error is large
+  // enough.
+  if (timeSync.driftSamples == 0) return;
+  int32_t expected = (int32_t)(1e-6 * timeSync.drift * (float)(now - timeSync.syncMillis));
+  int32_t correction = expected - timeSync.driftCorrection;
+  if ((correction >= TIMESYNC_DRIFT_STEP) || (correction <= -TIMESYNC_DRIFT_STEP)) {
+    if (!refreshRTCPhase(TIMESYNC_PHASE_MAX_AGE)) return;
+    time_t t;
+    uint16_t ms;
+    getUTCPrecise(t,ms);
+    shiftUTCPrecise(t,ms,-correction);
+    setUTCPrecise(t,ms);
+    timeSync.driftCorrection += correction;
+  }
+}
+
+
+/* Prints drone time sync status and statistics to serial. */
+void printTimeSyncStats() {
+  Serial.println(F("Time sync statistics:"));
+  Serial.print(F("  Last offset:  "));
+  Serial.print(timeSync.offset);
+  Serial.print(F(" ms (delay "));
+  Serial.print(timeSync.roundTrip);
+  Serial.println(F(" ms)"));
+  Serial.print(F("  Drift:        "));
+  Serial.print(timeSync.drift,2);
+  Serial.print(F(" ppm ("));
+  Serial.print(timeSync.driftSamples);
+  Serial.println(F(" samples)"));
+  Serial.print(F("  Interval:     "));
+  Serial.print(timeSync.interval);
+  Serial.println(F(" s"));
+  Serial.print(F("  Exchanges:    "));
+  Serial.print(timeSync.requests);
+  Serial.print(F(" requests, "));
+  Serial.print(timeSync.replies);
+  Serial.print(F(" replies, "));
+  Serial.print(timeSync.rejected);
+  Serial.println(F(" rejected/lost"));
+  printClockStats();
+}
+
+
+
+/* Network routine benchmarks (see runBenchmarks()).  Incoming XBee
+   data is injected directly into the circular buffer, as the serial
+   port cannot be fed locally.  The worst-case XBee ISR is estimated
+   from the idle ISR plus a full 64-byte hardware serial buffer, each
+   byte costing a serial read and a buffer store (timed on a stream of
+   time sync packets, which take the arrival-timestamp path). */
+// Benchmark testing >>>>>>>>>>>>>>>>>>>
+#ifdef BENCHMARK_TESTING
+#define BENCH_XBEE_SERIAL_BUFFER 64
+char benchXBeeStream[TIMESYNC_PACKET_LEN + 8];
+size_t benchXBeeStreamLen = 0;
+size_t benchXBeeStreamPos = 0;
+Reading benchReading = {1600000000, 72.35, READING_GLOBETEMP};
+char benchPostBuff[READING_POST_LEN];
+volatile int benchNetworkSink;
+
+void benchResetXBeeBuffer() {
+  xbeeBufferHead = 0;
+  xbeeBufferElements = 0;
+  xbeePacketPos = 0;
+  xbeePacketType = '\0';
+}
+void benchPrepXBeeByte() {
+  if (xbeeBufferElements >= XBEE_BUFFER_SIZE - 1) benchResetXBeeBuffer();
+}
+void benchStoreXBeeByte() {
+  storeXBeeByte(benchXBeeStream[benchXBeeStreamPos]);
+  benchXBeeStreamPos = (benchXBeeStreamPos + 1) % benchXBeeStreamLen;
+}
+void benchXBeeSerialRead() {
+  benchNetworkSink = xbee.available();
+  benchNetworkSink += xbee.read();
+}
+void benchPrepXBeePacket() {
+  benchResetXBeeBuffer();
+  // Framed as by sendXBee()
+  const char packet[] = "V,0013A20040A1B2C3,GlobeTemp,72.35,1600000000,2020-09-13 05:26:40";
+  char lbuf[3];
+  sprintf(lbuf,"%02X",(uint8_t)(strlen(packet) % 256));
+  storeXBeeByte(PACKET_START_TOKEN);
+  storeXBeeByte(lbuf[0]);
+  storeXBeeByte(lbuf[1]);
+  for (const char *c = packet; *c != '\0'; c++) storeXBeeByte(*c);
+  storeXBeeByte(PACKET_END_TOKEN);
+}
+void benchGetXBeeBufferPacket() {
+  String packet = getXBeeBufferPacket();
+  benchNetworkSink = packet.length();
+}
+void benchFormatReading() {
+  // Same steps as postReading(); new second each call (no date/time cache)
+  char ST[READING_NAME_LEN];
+  char R[READING_VALUE_LEN];
+  char TS[12];
+  char DT[CLOCK_DATETIME_LEN];
+  benchReading.utc++;
+  formatReadingName(ST,benchReading.type);
+  formatReadingValue(R,benchReading);
+  sprintf(TS,"%lu",(unsigned long)benchReading.utc);
+  formatDBDateTime(DT,benchReading.utc);
+  benchNetworkSink = formatReadingPost(benchPostBuff,sizeof(benchPostBuff),"0013A20040A1B2C3",ST,R,TS,DT);
+}
+
+void benchmarkNetwork() {
+  // Stream of framed time sync requests
+  char packet[TIMESYNC_PACKET_LEN + 1];
+  memset(packet,'0',TIMESYNC_PACKET_LEN);
+  packet[0] = 'Q';
+  packet[TIMESYNC_PACKET_LEN] = '\0';
+  benchXBeeStreamLen = sprintf(benchXBeeStream,"%c%02X%s%c",PACKET_START_TOKEN,
+                               TIMESYNC_PACKET_LEN,packet,PACKET_END_TOKEN);
+  benchXBeeStreamPos = 0;
+  
+  BenchmarkStats idle = runBenchmark(F("readXBeeISR (idle)"),readXBeeISR,64);
+  BenchmarkStats serial = runBenchmark(F("xbee available+read"),benchXBeeSerialRead,64);
+  BenchmarkStats store = runBenchmark(F("storeXBeeByte"),benchStoreXBeeByte,256,benchPrepXBeeByte);
+  printISRBudget(F("readXBeeISR (64 bytes, est.)"),
+                 idle.max + BENCH_XBEE_SERIAL_BUFFER * (serial.max + store.max),
+                 XBEE_READ_INTERVAL);
+  runBenchmark(F("getXBeeBufferPacket"),benchGetXBeeBufferPacket,32,benchPrepXBeePacket);
+  runBenchmark(F("postReading formatting"),benchFormatReading,64);
+  
+  // Clear benchmark data from buffer and statistics
+  benchResetXBeeBuffer();
+  xbeeBufferReceived = 0;
+  xbeeBufferHighWater = 0;
+  xbeeSyncArrivals = 0;
+  xbeeSyncConsumed = 0;
+}
+#endif
+//<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
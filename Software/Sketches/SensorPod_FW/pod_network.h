@@ -10,6 +10,7 @@
 #define POD_NETWORK_H
 
 #include "Arduino.h"
+#include <TimeLib.h>
 
 //--------------------------------------------------------------------------------------------- [XBee Management]
 
@@ -35,7 +36,10 @@ void configureXBee(const bool coord);
 void startXBee();
 void readXBeeISR();
 void readXBee();
+void storeXBeeByte(const char c);
+void sendXBee(const char *packet);
 void sendXBee(const String packet);
+unsigned long getXBeeAnswerDelay(const unsigned long spread);
 void broadcastXBee(const String packet);
 bool holdXBeeBuffer();
 void releaseXBeeBuffer();
@@ -43,11 +47,17 @@ void resetXBeeBuffer();
 void cleanXBeeBuffer(const bool cleanStart=true, const bool cleanEnd=true);
 String getXBeeBufferPacket();
 void processXBee();
+size_t parseXBeePackets();
+const char* copyXBeePacketField(const char *src, char *dest, const size_t size, const bool last);
+bool queueXBeeReading(const String &packet);
+size_t uploadXBeeReadings(const size_t maxCount);
+void printXBeePipelineStats();
+size_t getXBeeBufferHighWater();
+void getXBeeCounters(uint32_t &received, uint32_t &overrun, uint32_t &parsed);
 bool submitXBeeCommand(const String cmd);
 
 void xbeeRate(String incoming);
 void xbeeSettings(String incoming, String incoming2);
-void xbeeReading(String incoming);
 
 void broadcastCoordinatorAddress();
 void processDestinationPacket(const String packet);
@@ -80,16 +90,74 @@ bool ethernetConnected();
 void ethernetMaintain();
 //String formatTime();
 //String formatDate();
-void saveReading(String lstr, String rstr, String atstr, String gtstr, String sstr, String c2str, String p1str, String p2str, String cstr);
-void postReading(String DID, String ST, String R, String TS, String DT);
+
+// Sensor reading types.  Order matches the sensor columns of the SD
+// data log; diagnostic types after READING_SD_COUNT are uploaded only.
+enum ReadingType : uint8_t {
+  READING_LIGHT, READING_HUMIDITY, READING_AIRTEMP, READING_GLOBETEMP,
+  READING_SOUND, READING_CO2, READING_PM2_5, READING_PM10, READING_CO,
+  READING_SD_COUNT,
+  READING_MEM_FREE = READING_SD_COUNT, READING_MEM_LARGEST,
+  READING_LOOP_RATE, READING_READ_FAILURES, READING_PACKET_DROPS,
+  READING_POST_FAILURES,
+  READING_TYPE_COUNT
+};
+// Compact sensor reading record.  Readings are passed around in this
+// form and only converted to text when written to SD, XBee or HTTP.
+// The quality flags (see pod_quality.h) are set when the reading is
+// saved.
+struct Reading {
+  time_t utc;
+  float value;
+  ReadingType type;
+  uint8_t quality;
+};
+// Buffer sizes for formatted reading type names (longest: "MemLargest"
+// and its terminator) and values
+#define READING_NAME_LEN 12
+#define READING_VALUE_LEN 16
+// Buffer size for HTTP form data of an uploaded reading
+#define READING_POST_LEN 160
+
+char* formatReadingName(char *buff, const ReadingType type);
+// Reading type of the given upload name; false if not a known name.
+bool parseReadingName(const char *name, ReadingType &type);
+char* formatReadingValue(char *buff, const Reading &r);
+// Log readings to SD (one row) and upload/send each of them.
+void saveReading(Reading &r);
+void saveReadings(Reading *r, const uint8_t n);
+bool isReadingReportable(const Reading &r);
+void noteReadingReported(const Reading &r);
+bool postReading(const Reading &r);
+bool postReading(const char *DID, const char *ST, const char *R, const char *TS, const char *DT, const char *Q="");
+size_t formatReadingPost(char *buff, const size_t len, const char *DID, const char *ST, const char *R, const char *TS, const char *DT, const char *Q="");
 void updateRate(String DID, String ST, String R, String DT);
 void updateConfig(String DID, String Location, String Coordinator, String Project, String Rate, String Setup, String Teardown, String Datetime, String NetID);
 byte postPage(const char* domainBuffer, int thisPort, const char* page, const char* thisData);
+byte sendPostRequest(const char* domainBuffer, int thisPort, const char* page, const char* thisData);
 
 //void getTimeFromWeb();
 //void sendNTPpacket(const char* address);
 void updateClockFromNTP();
+bool startNTPPoll(const uint8_t burst);
+bool sendNTPRequest();
+void readNTPTimestamp(const byte *b, time_t &t, uint16_t &ms);
+void writeNTPTimestamp(byte *b, const time_t t, const uint16_t ms);
+void processNTPReply();
+void finishNTPPoll();
+void maintainNTP();
+void printNTPStats();
 void broadcastClock();
 void processClockPacket(const String packet);
 
+// Two-way XBee time synchronization
+bool getXBeeSyncArrival(unsigned long &arrival);
+void formatTimeSyncStamp(char *buff, const time_t t, const uint16_t ms);
+bool parseTimeSyncStamp(const char *buff, time_t &t, uint16_t &ms);
+void requestTimeSync();
+void processTimeSyncRequest(const String packet);
+void processTimeSyncReply(const String packet);
+void maintainTimeSync();
+void printTimeSyncStats();
+
 #endif
@@ -0,0 +1,738 @@
+/*==============================================================================
+  Firmware image distribution over XBee.
+
+  This file is part of the LMN PODD distribution:
+    https://github.com/lmnts/PODD
+
+  CONTRIBUTORS:
+    PODD contributors (2026)
+
+  COPYRIGHT/LICENSE:
+  Copyright (c) 2026 LMN Architects
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Affero General Public License as
+  published by the Free Software Foundation, either version 3 of the
+  License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Affero General Public License for more details.
+
+  You should have received a copy of the GNU Affero General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+==============================================================================*/
+
+#include "pod_ota.h"
+#include "pod_config.h"
+#include "pod_eeprom.h"
+#include "pod_network.h"
+#include "pod_util.h"
+
+#include <SD.h>
+#include <stdarg.h>
+
+
+// Global variables ============================================================
+
+// Longest packet: a full chunk.
+#define OTA_PACKET_LEN 96
+// Drone status while it is still receiving (coordinator's list only).
+#define OTA_RECEIVING 0xFF
+#define FIRMWARE_HANDOFF_SCHEMA 1
+
+static_assert(OTA_WINDOW_CHUNKS <= 32,"Window bitmaps are 32 bits");
+static_assert(sizeof(FirmwareHandoff) <= EEPROM_RECORD_MAX(EEPROM_FIRMWARE_SLOT_SIZE),
+              "Firmware handoff does not fit in its EEPROM slots");
+
+// Coordinator's transfer steps.
+enum OTAPhase : uint8_t {
+  OTA_IDLE,
+  OTA_ANNOUNCE,       // announcing the image
+  OTA_SEND,           // sending the chunks of a window still pending
+  OTA_WINDOW_WAIT,    // end of window sent: collecting missing chunks
+  OTA_QUERY,          // all windows sent: announce again, then query
+  OTA_QUERY_WAIT,     // query sent: collecting missing chunks
+  OTA_DONE
+};
+
+// Coordinator's transfer state.  Times are millis() values.
+struct OTASendState {
+  OTAPhase phase;
+  File image;
+  uint32_t size;
+  uint32_t crc;
+  uint16_t tag;
+  uint16_t chunks;
+  uint16_t window;          // current window
+  uint32_t pending;         // chunks of the window to send (bit k)
+  uint32_t missing;         // chunks reported missing while waiting
+  int16_t missingWindow;    // window reported by queries (-1 if none)
+  uint8_t repairs;          // repair rounds of the current window
+  uint8_t announced;
+  uint16_t queries;
+  uint8_t quiet;            // queries in a row without an answer
+  bool allSent;             // every window sent once
+  unsigned long lastSent;
+  unsigned long gap;        // from the last packet to the next [ms]
+  unsigned long waitStart;
+  unsigned long started;
+  unsigned long finished;
+  uint32_t chunksSent;
+  uint32_t chunksResent;
+  uint16_t nacks;
+} otaSend;
+
+// Role-specific state is allocated once the role is known
+// (initFirmwareUpdate()): drones never need the coordinator's list of
+// drones, nor the coordinator a drone's chunk bitmap.
+
+// Drones heard from during a transfer (coordinator).
+struct OTADrone {
+  char devid[17];     // empty if unused
+  uint8_t status;     // OTAStatus, or OTA_RECEIVING
+  uint16_t window;    // last window reported missing chunks
+  unsigned long seen;
+};
+OTADrone *otaDrones = NULL;
+
+// Drone's transfer state.
+struct OTAReceiveState {
+  uint16_t tag;             // 0 if none
+  uint32_t size;
+  uint32_t crc;
+  uint16_t chunks;
+  uint16_t received;
+  uint32_t filled;          // staging file bytes written so far
+  bool staged;
+  uint8_t have[OTA_CHUNKS_MAX / 8];
+  // Answer waiting for its (random) time
+  bool answer;
+  unsigned long answerDue;
+  char answerPacket[40];
+};
+OTAReceiveState *otaReceive = NULL;
+
+
+// Functions ===================================================================
+
+/* CRC-32 (IEEE 802.3, reflected polynomial 0xEDB88320), continuing
+   from the given CRC (start with 0xFFFFFFFF, invert at the end). */
+static uint32_t crc32Update(uint32_t crc, const void *data, const uint16_t len) {
+  for (uint16_t k = 0; k < len; k++) {
+    crc ^= ((const uint8_t*)data)[k];
+    for (uint8_t j = 0; j < 8; j++) {
+      crc = (crc & 1) ? (crc >> 1) ^ 0xEDB88320UL : (crc >> 1);
+    }
+  }
+  return crc;
+}
+
+
+/* CRC-32 of the first size bytes of the given file.  Returns false if
+   the file is shorter. */
+static bool fileCRC32(File &f, const uint32_t size, uint32_t &crc) {
+  uint8_t buff[OTA_CHUNK_SIZE];
+  crc = 0xFFFFFFFFUL;
+  if (!f.seek(0)) return false;
+  for (uint32_t pos = 0; pos < size; pos += OTA_CHUNK_SIZE) {
+    const uint16_t n = min((uint32_t)OTA_CHUNK_SIZE,size - pos);
+    if (f.read(buff,n) != n) return false;
+    crc = crc32Update(crc,buff,n);
+  }
+  crc = ~crc;
+  return true;
+}
+
+
+static bool loadFirmwareHandoff(FirmwareHandoff &h) {
+  uint8_t schema;
+  memset(&h,0,sizeof(h));
+  return loadEEPROMRecord(EEPROM_RECORD_FIRMWARE,&h,sizeof(h),schema) > 0;
+}
+
+
+static void saveFirmwareHandoff(const FirmwareHandoff &h) {
+  saveEEPROMRecord(EEPROM_RECORD_FIRMWARE,&h,sizeof(h),FIRMWARE_HANDOFF_SCHEMA);
+}
+
+
+/* Parses a hexadecimal packet field, returning a pointer to the next
+   field (NULL if invalid). */
+static const char* parseHexField(const char *p, uint32_t &v, const bool last) {
+  char field[9];
+  if ((p == NULL) || ((p = copyXBeePacketField(p,field,sizeof(field),last)) == NULL)) return NULL;
+  char *end;
+  v = strtoul(field,&end,16);
+  return ((field[0] != '\0') && (*end == '\0')) ? p : NULL;
+}
+
+
+/* Number of chunks in the given window. */
+static uint8_t windowChunks(const uint16_t chunks, const uint16_t window) {
+  const uint16_t first = window * OTA_WINDOW_CHUNKS;
+  return (chunks - first < OTA_WINDOW_CHUNKS) ? chunks - first : OTA_WINDOW_CHUNKS;
+}
+
+
+static uint32_t windowMask(const uint16_t chunks, const uint16_t window) {
+  const uint8_t n = windowChunks(chunks,window);
+  return (n >= 32) ? 0xFFFFFFFFUL : ((1UL << n) - 1);
+}
+
+
+static uint16_t imageTag(const uint32_t crc) {
+  const uint16_t tag = (uint16_t)(crc ^ (crc >> 16));
+  return (tag == 0) ? 1 : tag;
+}
+
+
+/* Allocates the state of this pod's role.  Done once, from setup(),
+   so the block sits at the bottom of the heap for good. */
+void initFirmwareUpdate() {
+  if (getModeCoord()) {
+    if (otaDrones == NULL) otaDrones = (OTADrone*)calloc(OTA_DRONES,sizeof(OTADrone));
+  } else {
+    if (otaReceive == NULL) otaReceive = (OTAReceiveState*)calloc(1,sizeof(OTAReceiveState));
+  }
+  if ((otaDrones == NULL) && (otaReceive == NULL)) {
+    Serial.println(F("WARNING: No memory for firmware updates: disabled."));
+  }
+}
+
+
+//------------------------------------------------------------------------------
+// Coordinator
+
+bool startFirmwareDistribution() {
+  if (otaDrones == NULL) return false;
+  if (otaSend.image) otaSend.image.close();
+  File f = SD.open(OTA_IMAGE_FILE,FILE_READ);
+  if (!f) return false;
+  const uint32_t size = f.size();
+  uint32_t crc;
+  if ((size == 0) || (size > OTA_IMAGE_MAX) || !fileCRC32(f,size,crc)) {
+    f.close();
+    return false;
+  }
+  otaSend.image = f;
+  otaSend.size = size;
+  otaSend.crc = crc;
+  otaSend.tag = imageTag(crc);
+  otaSend.chunks = (size + OTA_CHUNK_SIZE - 1) / OTA_CHUNK_SIZE;
+  otaSend.phase = OTA_ANNOUNCE;
+  otaSend.announced = 0;
+  otaSend.queries = 0;
+  otaSend.quiet = 0;
+  otaSend.allSent = false;
+  otaSend.gap = 0;
+  otaSend.started = millis();
+  otaSend.chunksSent = 0;
+  otaSend.chunksResent = 0;
+  otaSend.nacks = 0;
+  for (uint8_t k = 0; k < OTA_DRONES; k++) otaDrones[k].devid[0] = '\0';
+  return true;
+}
+
+
+/* Sends a packet, and holds off the next one to leave the link free
+   for other traffic. */
+static void sendOTAPacket(const char *packet) {
+  sendXBee(packet);
+  // 10 bits per byte at 9600 baud, with the framing
+  otaSend.lastSent = millis();
+  otaSend.gap = OTA_THROTTLE_FACTOR * ((strlen(packet) + 4) * 25UL / 24);
+}
+
+
+static void startWindow(const uint16_t window, const uint32_t pending) {
+  otaSend.window = window;
+  otaSend.pending = pending & windowMask(otaSend.chunks,window);
+  otaSend.repairs = 0;
+  otaSend.phase = OTA_SEND;
+}
+
+
+/* Sends the given chunk of the image. */
+static void sendChunk(const uint16_t index) {
+  uint8_t data[OTA_CHUNK_SIZE];
+  const uint32_t pos = (uint32_t)index * OTA_CHUNK_SIZE;
+  const uint8_t n = min((uint32_t)OTA_CHUNK_SIZE,otaSend.size - pos);
+  if (!otaSend.image.seek(pos) || (otaSend.image.read(data,n) != n)) {
+    Serial.println(F("WARNING: Failed to read firmware image: transfer stopped."));
+    otaSend.phase = OTA_DONE;
+    otaSend.finished = millis();
+    return;
+  }
+  static const char HEX_DIGITS[] PROGMEM = "0123456789ABCDEF";
+  char buff[OTA_PACKET_LEN];
+  size_t len = sprintf(buff,"F,D,%04X,%X,",otaSend.tag,index);
+  for (uint8_t k = 0; k < n; k++) {
+    buff[len++] = pgm_read_byte(&HEX_DIGITS[data[k] >> 4]);
+    buff[len++] = pgm_read_byte(&HEX_DIGITS[data[k] & 0x0F]);
+  }
+  buff[len++] = ',';
+  sprintf(buff + len,"%04X",crc16(0xFFFF,buff,len));
+  sendOTAPacket(buff);
+}
+
+
+static void maintainDistribution() {
+  if (otaSend.gap > 0) {
+    if (millis() - otaSend.lastSent < otaSend.gap) return;
+    otaSend.gap = 0;
+  }
+  char buff[OTA_PACKET_LEN];
+  switch (otaSend.phase) {
+    case OTA_IDLE:
+    case OTA_DONE:
+      break;
+    case OTA_ANNOUNCE:
+    case OTA_QUERY:
+      sprintf(buff,"F,I,%04X,%lX,%08lX",otaSend.tag,(unsigned long)otaSend.size,
+              (unsigned long)otaSend.crc);
+      sendOTAPacket(buff);
+      if (otaSend.phase == OTA_QUERY) {
+        // Announced again for drones that missed the start: now ask
+        otaSend.phase = OTA_QUERY_WAIT;
+        otaSend.missingWindow = -1;
+        otaSend.queries++;
+        otaSend.waitStart = 0;
+      } else if (++otaSend.announced >= OTA_ANNOUNCE_REPEATS) {
+        startWindow(0,0xFFFFFFFFUL);
+      }
+      break;
+    case OTA_SEND: {
+      if (otaSend.pending == 0) {
+        sprintf(buff,"F,E,%04X,%X",otaSend.tag,otaSend.window);
+        sendOTAPacket(buff);
+        otaSend.phase = OTA_WINDOW_WAIT;
+        otaSend.missing = 0;
+        otaSend.waitStart = millis();
+        break;
+      }
+      uint8_t k = 0;
+      while (!(otaSend.pending & (1UL << k))) k++;
+      otaSend.pending &= ~(1UL << k);
+      otaSend.chunksSent++;
+      if ((otaSend.repairs > 0) || otaSend.allSent) otaSend.chunksResent++;
+      sendChunk(otaSend.window * OTA_WINDOW_CHUNKS + k);
+      break;
+    }
+    case OTA_WINDOW_WAIT:
+      if (millis() - otaSend.waitStart < OTA_NACK_WAIT) break;
+      if ((otaSend.missing != 0) && (otaSend.repairs < OTA_REPAIR_ROUNDS)) {
+        otaSend.pending = otaSend.missing;
+        otaSend.repairs++;
+        otaSend.phase = OTA_SEND;
+      } else if (!otaSend.allSent && ((otaSend.window + 1) * OTA_WINDOW_CHUNKS < otaSend.chunks)) {
+        startWindow(otaSend.window + 1,0xFFFFFFFFUL);
+      } else {
+        otaSend.allSent = true;
+        otaSend.phase = OTA_QUERY;
+      }
+      break;
+    case OTA_QUERY_WAIT:
+      if (otaSend.waitStart == 0) {
+        sprintf(buff,"F,C,%04X",otaSend.tag);
+        sendOTAPacket(buff);
+        otaSend.waitStart = millis();
+        break;
+      }
+      if (millis() - otaSend.waitStart < OTA_NACK_WAIT) break;
+      if (otaSend.missingWindow >= 0) {
+        otaSend.quiet = 0;
+        startWindow(otaSend.missingWindow,otaSend.missing);
+      } else if (++otaSend.quiet >= OTA_QUERY_QUIET) {
+        otaSend.phase = OTA_DONE;
+        otaSend.finished = millis();
+        Serial.println(F("Firmware image sent: no drone missing any part."));
+        break;
+      }
+      if (otaSend.queries >= OTA_QUERY_MAX + (otaSend.chunks + OTA_WINDOW_CHUNKS - 1) / OTA_WINDOW_CHUNKS) {
+        otaSend.phase = OTA_DONE;
+        otaSend.finished = millis();
+        Serial.println(F("WARNING: Firmware transfer stopped: drones still missing parts."));
+      } else if (otaSend.phase == OTA_QUERY_WAIT) {
+        otaSend.phase = OTA_QUERY;
+      }
+      break;
+  }
+}
+
+
+/* Finds the given drone in the coordinator's list, adding it (in place
+   of the drone not heard from the longest) if not found. */
+static OTADrone& findOTADrone(const char *devid) {
+  uint8_t oldest = 0;
+  for (uint8_t k = 0; k < OTA_DRONES; k++) {
+    OTADrone &d = otaDrones[k];
+    if ((d.devid[0] != '\0') && (strcmp(d.devid,devid) == 0)) return d;
+    if (otaDrones[oldest].devid[0] == '\0') continue;
+    if ((d.devid[0] == '\0') || (millis() - d.seen > millis() - otaDrones[oldest].seen)) oldest = k;
+  }
+  OTADrone &d = otaDrones[oldest];
+  snprintf(d.devid,sizeof(d.devid),"%s",devid);
+  d.status = OTA_RECEIVING;
+  d.window = 0;
+  return d;
+}
+
+
+/* Handles a drone's answer (F,N or F,S). */
+static void processDroneAnswer(const char *p, const char type) {
+  char devid[17];
+  uint32_t tag, window, bits;
+  if (((p = copyXBeePacketField(p,devid,sizeof(devid),false)) == NULL) || (devid[0] == '\0')
+      || ((p = parseHexField(p,tag,false)) == NULL)) return;
+  if ((tag != otaSend.tag) || (otaSend.tag == 0)) return;
+  OTADrone &d = findOTADrone(devid);
+  d.seen = millis();
+  if (type == 'S') {
+    if (parseHexField(p,bits,true) == NULL) return;
+    d.status = bits;
+    return;
+  }
+  if (((p = parseHexField(p,window,false)) == NULL) || (parseHexField(p,bits,true) == NULL)) return;
+  if (window * OTA_WINDOW_CHUNKS >= otaSend.chunks) return;
+  otaSend.nacks++;
+  d.status = OTA_RECEIVING;
+  d.window = window;
+  bits &= windowMask(otaSend.chunks,window);
+  if ((otaSend.phase == OTA_WINDOW_WAIT) && (window == otaSend.window)) {
+    otaSend.missing |= bits;
+  } else if ((otaSend.phase == OTA_SEND) && (window == otaSend.window)) {
+    otaSend.pending |= bits;
+  } else if (otaSend.phase == OTA_QUERY_WAIT) {
+    // Windows are repaired one at a time, first one first
+    if ((otaSend.missingWindow < 0) || ((int16_t)window < otaSend.missingWindow)) {
+      otaSend.missingWindow = window;
+      otaSend.missing = bits;
+    } else if ((int16_t)window == otaSend.missingWindow) {
+      otaSend.missing |= bits;
+    }
+  }
+}
+
+
+//------------------------------------------------------------------------------
+// Drones
+
+/* Queues an answer to the coordinator, to be sent after a random
+   delay so that drones answering the same packet do not collide. */
+static void queueOTAAnswer(const char *fmt, ...) {
+  va_list args;
+  va_start(args,fmt);
+  vsnprintf(otaReceive->answerPacket,sizeof(otaReceive->answerPacket),fmt,args);
+  va_end(args);
+  otaReceive->answer = true;
+  otaReceive->answerDue = millis() + getXBeeAnswerDelay(OTA_NACK_SPREAD);
+}
+
+
+static bool haveChunk(const uint16_t index) {
+  return otaReceive->have[index / 8] & (1 << (index % 8));
+}
+
+
+/* Chunks missing from the given window (bit k: chunk k). */
+static uint32_t missingChunks(const uint16_t window) {
+  uint32_t bits = 0;
+  const uint8_t n = windowChunks(otaReceive->chunks,window);
+  for (uint8_t k = 0; k < n; k++) {
+    if (!haveChunk(window * OTA_WINDOW_CHUNKS + k)) bits |= (1UL << k);
+  }
+  return bits;
+}
+
+
+/* Starts receiving the announced image.  The staging file is created
+   empty and filled to its full size from the main loop
+   (fillStagingFile()), so chunks can then be written in any order.
+   An image already staged (e.g. before a restart) is kept. */
+static void startReceiving(const uint16_t tag, const uint32_t size, const uint32_t crc) {
+  otaReceive->tag = 0;
+  otaReceive->answer = false;
+  FirmwareHandoff h;
+  loadFirmwareHandoff(h);
+  if ((h.state != FIRMWARE_NONE) && (h.size == size) && (h.crc == crc)) {
+    otaReceive->tag = tag;
+    otaReceive->size = size;
+    otaReceive->crc = crc;
+    otaReceive->staged = true;
+    return;
+  }
+  if (h.state != FIRMWARE_NONE) {
+    h.state = FIRMWARE_NONE;
+    saveFirmwareHandoff(h);
+  }
+
+  Serial.print(F("Receiving firmware image ("));
+  Serial.print(size);
+  Serial.println(F(" bytes)...."));
+  SD.remove(OTA_STAGE_FILE);
+  File f = SD.open(OTA_STAGE_FILE,FILE_WRITE);
+  if (!f) {
+    Serial.println(F("WARNING: Could not create firmware staging file."));
+    return;
+  }
+  f.close();
+  otaReceive->tag = tag;
+  otaReceive->size = size;
+  otaReceive->crc = crc;
+  otaReceive->chunks = (size + OTA_CHUNK_SIZE - 1) / OTA_CHUNK_SIZE;
+  otaReceive->received = 0;
+  otaReceive->filled = 0;
+  otaReceive->staged = false;
+  memset(otaReceive->have,0,sizeof(otaReceive->have));
+}
+
+
+/* Indicates if the staging file is at its full size, ready for
+   chunks. */
+static bool isStagingFileReady() {
+  return otaReceive->filled >= otaReceive->size;
+}
+
+
+/* Fills the staging file with zeros, OTA_FILL_BYTES at a time, so the
+   SD writes do not hold up the main loop for long.  The transfer is
+   abandoned if the file cannot be written. */
+static void fillStagingFile() {
+  if ((otaReceive->tag == 0) || otaReceive->staged || isStagingFileReady()) return;
+  // FILE_WRITE appends: each pass adds to the end
+  File f = SD.open(OTA_STAGE_FILE,FILE_WRITE);
+  uint8_t zeros[OTA_CHUNK_SIZE];
+  memset(zeros,0,sizeof(zeros));
+  uint16_t written = 0;
+  while (f && (written < OTA_FILL_BYTES) && !isStagingFileReady()) {
+    const uint8_t n = min((uint32_t)sizeof(zeros),otaReceive->size - otaReceive->filled);
+    if (f.write(zeros,n) != n) break;
+    otaReceive->filled += n;
+    written += n;
+  }
+  if (f) f.close();
+  if ((written < OTA_FILL_BYTES) && !isStagingFileReady()) {
+    Serial.println(F("WARNING: Could not create firmware staging file."));
+    otaReceive->tag = 0;
+  }
+}
+
+
+/* Checks the staged image once every chunk is in. */
+static void checkStagedImage() {
+  File f = SD.open(OTA_STAGE_FILE,FILE_READ);
+  uint32_t crc = 0;
+  const bool read = f && fileCRC32(f,otaReceive->size,crc);
+  if (f) f.close();
+  if (!read || (crc != otaReceive->crc)) {
+    Serial.println(F("WARNING: Received firmware image is corrupt: starting over."));
+    otaReceive->received = 0;
+    memset(otaReceive->have,0,sizeof(otaReceive->have));
+    queueOTAAnswer("F,S,%s,%04X,%X",getDevID(),otaReceive->tag,OTA_BAD_IMAGE);
+    return;
+  }
+  otaReceive->staged = true;
+  FirmwareHandoff h;
+  memset(&h,0,sizeof(h));
+  h.state = FIRMWARE_STAGED;
+  h.size = otaReceive->size;
+  h.crc = otaReceive->crc;
+  strcpy(h.file,OTA_STAGE_FILE);
+  saveFirmwareHandoff(h);
+  Serial.println(F("Firmware image received and checked."));
+  queueOTAAnswer("F,S,%s,%04X,%X",getDevID(),otaReceive->tag,OTA_STAGED);
+}
+
+
+/* Stores a chunk (F,D) of the image being received. */
+static void receiveChunk(const char *packet) {
+  uint32_t tag, index;
+  const char *p = parseHexField(packet + 4,tag,false);
+  p = parseHexField(p,index,false);
+  if ((p == NULL) || (tag != otaReceive->tag) || otaReceive->staged || !isStagingFileReady()
+      || (index >= otaReceive->chunks) || haveChunk(index)) return;
+  const char *c = strrchr(p,',');
+  if ((c == NULL) || (strlen(c + 1) != 4)
+      || (strtoul(c + 1,NULL,16) != crc16(0xFFFF,packet,c + 1 - packet))) return;
+  const uint32_t pos = index * OTA_CHUNK_SIZE;
+  const uint8_t n = min((uint32_t)OTA_CHUNK_SIZE,otaReceive->size - pos);
+  if (c - p != 2*n) return;
+  uint8_t data[OTA_CHUNK_SIZE];
+  for (uint8_t k = 0; k < n; k++) {
+    char hex[3] = {p[2*k], p[2*k + 1], '\0'};
+    char *end;
+    data[k] = strtoul(hex,&end,16);
+    if (*end != '\0') return;
+  }
+  // Not FILE_WRITE: it appends, whatever the seek
+  File f = SD.open(OTA_STAGE_FILE,O_READ | O_WRITE);
+  if (!f) return;
+  const bool written = f.seek(pos) && (f.write(data,n) == n);
+  f.close();
+  if (!written) return;
+  otaReceive->have[index / 8] |= (1 << (index % 8));
+  if (++otaReceive->received == otaReceive->chunks) checkStagedImage();
+}
+
+
+static void processCoordinatorPacket(const char *p, const char type) {
+  uint32_t tag, v1, v2;
+  switch (type) {
+    case 'I':
+      if ((p = parseHexField(p,tag,false)) == NULL) return;
+      if (((p = parseHexField(p,v1,false)) == NULL) || (parseHexField(p,v2,true) == NULL)) return;
+      if ((tag == otaReceive->tag) || (v1 == 0) || (v1 > OTA_IMAGE_MAX)) return;
+      startReceiving(tag,v1,v2);
+      break;
+    case 'E':
+      if (((p = parseHexField(p,tag,false)) == NULL) || (parseHexField(p,v1,true) == NULL)) return;
+      // Missing chunks are only reported once the staging file is
+      // ready: chunks sent before then are picked up by the queries
+      if ((tag != otaReceive->tag) || otaReceive->staged || !isStagingFileReady()) return;
+      if (v1 * OTA_WINDOW_CHUNKS >= otaReceive->chunks) return;
+      v2 = missingChunks(v1);
+      if (v2 != 0) queueOTAAnswer("F,N,%s,%04X,%X,%lX",getDevID(),otaReceive->tag,(unsigned)v1,(unsigned long)v2);
+      break;
+    case 'C':
+      if ((parseHexField(p,tag,true) == NULL) || (tag != otaReceive->tag)) return;
+      if (!otaReceive->staged && !isStagingFileReady()) return;
+      if (otaReceive->staged) {
+        queueOTAAnswer("F,S,%s,%04X,%X",getDevID(),otaReceive->tag,OTA_STAGED);
+        return;
+      }
+      for (uint16_t w = 0; w * OTA_WINDOW_CHUNKS < otaReceive->chunks; w++) {
+        v2 = missingChunks(w);
+        if (v2 == 0) continue;
+        queueOTAAnswer("F,N,%s,%04X,%X,%lX",getDevID(),otaReceive->tag,w,(unsigned long)v2);
+        break;
+      }
+      break;
+    default:
+      break;
+  }
+}
+
+
+//------------------------------------------------------------------------------
+
+void maintainFirmwareUpdate() {
+  if (getModeCoord()) {
+    maintainDistribution();
+  } else if (otaReceive != NULL) {
+    fillStagingFile();
+    if (otaReceive->answer && ((long)(millis() - otaReceive->answerDue) >= 0)) {
+      otaReceive->answer = false;
+      sendXBee(otaReceive->answerPacket);
+    }
+  }
+}
+
+
+unsigned long getFirmwareUpdateIdleTime() {
+  const unsigned long t = millis();
+  if (!getModeCoord()) {
+    if (otaReceive == NULL) return 0xFFFFFFFF;
+    if ((otaReceive->tag != 0) && !otaReceive->staged && !isStagingFileReady()) return 0;
+    if (!otaReceive->answer) return 0xFFFFFFFF;
+    return ((long)(otaReceive->answerDue - t) > 0) ? otaReceive->answerDue - t : 0;
+  }
+  if ((otaSend.phase == OTA_IDLE) || (otaSend.phase == OTA_DONE)) {
+    return 0xFFFFFFFF;
+  }
+  if ((otaSend.gap > 0) && (t - otaSend.lastSent < otaSend.gap)) {
+    return otaSend.gap - (t - otaSend.lastSent);
+  }
+  const bool waiting = (otaSend.phase == OTA_WINDOW_WAIT)
+                       || ((otaSend.phase == OTA_QUERY_WAIT) && (otaSend.waitStart != 0));
+  if (waiting && (t - otaSend.waitStart < OTA_NACK_WAIT)) {
+    return OTA_NACK_WAIT - (t - otaSend.waitStart);
+  }
+  return 0;
+}
+
+
+void processFirmwarePacket(const String &packet) {
+  const char *p = packet.c_str();
+  if ((p[0] != 'F') || (p[1] == '\0') || (p[2] == '\0') || (p[3] != ',')) return;
+  if (getModeCoord()) {
+    if (otaDrones == NULL) return;
+    if ((p[2] == 'N') || (p[2] == 'S')) processDroneAnswer(p + 4,p[2]);
+  } else if (otaReceive == NULL) {
+    return;
+  } else if (p[2] == 'D') {
+    receiveChunk(p);
+  } else {
+    processCoordinatorPacket(p + 4,p[2]);
+  }
+}
+
+
+//------------------------------------------------------------------------------
+// Prints the state of the transfer to serial.
+//
+void printFirmwareUpdateStatus() {
+  char buff[64];
+  if (!getModeCoord()) {
+    Serial.print(F("Firmware update: "));
+    if ((otaReceive == NULL) || (otaReceive->tag == 0)) {
+      Serial.println(F("none"));
+    } else if (otaReceive->staged) {
+      sprintf(buff,"image %04X (%lu bytes) staged",otaReceive->tag,(unsigned long)otaReceive->size);
+      Serial.println(buff);
+    } else if (!isStagingFileReady()) {
+      sprintf(buff,"image %04X, preparing staging file (",otaReceive->tag);
+      Serial.print(buff);
+      Serial.print(otaReceive->filled);
+      Serial.print(F(" of "));
+      Serial.print(otaReceive->size);
+      Serial.println(F(" bytes)"));
+    } else {
+      sprintf(buff,"image %04X, %u of %u chunks received",otaReceive->tag,
+              otaReceive->received,otaReceive->chunks);
+      Serial.println(buff);
+    }
+    return;
+  }
+
+  if (otaSend.tag == 0) {
+    Serial.println(F("Firmware update: none"));
+    return;
+  }
+  sprintf(buff,"Firmware update: image %04X (%lu bytes, CRC-32 %08lX)",otaSend.tag,
+          (unsigned long)otaSend.size,(unsigned long)otaSend.crc);
+  Serial.println(buff);
+  const unsigned long elapsed = (((otaSend.phase == OTA_DONE) ? otaSend.finished : millis())
+                                 - otaSend.started) / 1000;
+  sprintf(buff,"  %s, window %u of %u, %lu s",(otaSend.phase == OTA_DONE) ? "finished" : "sending",
+          otaSend.window + 1,(otaSend.chunks + OTA_WINDOW_CHUNKS - 1) / OTA_WINDOW_CHUNKS,elapsed);
+  Serial.println(buff);
+  Serial.print(F("  Chunks sent: "));
+  Serial.print(otaSend.chunksSent);
+  Serial.print(F(" ("));
+  Serial.print(otaSend.chunksResent);
+  Serial.print(F(" again), missing reports: "));
+  Serial.print(otaSend.nacks);
+  Serial.print(F(", queries: "));
+  Serial.println(otaSend.queries);
+  for (uint8_t k = 0; k < OTA_DRONES; k++) {
+    const OTADrone &d = otaDrones[k];
+    if (d.devid[0] == '\0') continue;
+    Serial.print(F("  "));
+    Serial.print(d.devid);
+    for (size_t j = strlen(d.devid); j < 18; j++) Serial.print(' ');
+    if (d.status == OTA_STAGED) {
+      Serial.println(F("staged"));
+    } else if (d.status == OTA_BAD_IMAGE) {
+      Serial.println(F("image corrupt, starting over"));
+    } else {
+      Serial.print(F("receiving, missing chunks in window "));
+      Serial.println(d.window + 1);
+    }
+  }
+}
+
+
+//==============================================================================
@@ -0,0 +1,154 @@
+/*==============================================================================
+  Firmware image distribution over XBee.
+
+  This file is part of the LMN PODD distribution:
+    https://github.com/lmnts/PODD
+
+  CONTRIBUTORS:
+    PODD contributors (2026)
+
+  COPYRIGHT/LICENSE:
+  Copyright (c) 2026 LMN Architects
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Affero General Public License as
+  published by the Free Software Foundation, either version 3 of the
+  License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Affero General Public License for more details.
+
+  You should have received a copy of the GNU Affero General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+==============================================================================*/
+
+#pragma once
+
+// Standard libraries
+// Contributed libraries
+#include <Arduino.h>
+// Local headers
+
+
+// Constants/global variables ==================================================
+
+// The coordinator broadcasts a firmware image (a binary flash image,
+// OTA_IMAGE_FILE on its SD card) to the drones in fixed-size chunks.
+// Drones write each chunk to OTA_STAGE_FILE on their own SD card as it
+// arrives and check the whole image against its CRC-32 once they have
+// every chunk.  The file is first filled to the image's size, a little
+// per pass through the main loop: a drone ignores the transfer until
+// then, and catches up through the final queries.  All packets are text (the XBee framing reserves some
+// byte values), with TAG identifying the image (4 hexadecimal digits,
+// from its CRC-32) and numbers in hexadecimal:
+//   F,I,TAG,SIZE,CRC32           announce the image
+//   F,D,TAG,INDEX,DATA,CRC       chunk INDEX (DATA: up to OTA_CHUNK_SIZE
+//                                bytes as hex; CRC: CRC-16 of the
+//                                packet before it)
+//   F,E,TAG,WINDOW               end of a window of chunks
+//   F,C,TAG                      any drone missing chunks?
+// Chunks are sent in windows of OTA_WINDOW_CHUNKS.  After each window
+// the drones missing any of its chunks answer, at a random time within
+// OTA_NACK_SPREAD so their answers do not collide, with the chunks
+// missing (bit k: chunk k of the window), and the coordinator sends
+// those again (up to OTA_REPAIR_ROUNDS times).  Drones that have all
+// chunks stay silent.  Once every window has been sent, the
+// coordinator asks (F,C) until no drone answers; a drone still
+// missing chunks answers with the first window it is missing them in,
+// so drones that missed the start (or restarted) catch up:
+//   F,N,DEVID,TAG,WINDOW,MISSING
+// A drone answers the query once it holds the whole, checked image, or
+// when the check fails (it then starts over):
+//   F,S,DEVID,TAG,STATUS
+#define OTA_IMAGE_FILE "FIRMWARE.BIN"
+#define OTA_STAGE_FILE "FWSTAGE.BIN"
+
+// Chunk size [bytes]: a chunk packet (about 90 bytes) fits in a single
+// XBee radio packet.
+#define OTA_CHUNK_SIZE 32
+#define OTA_WINDOW_CHUNKS 32
+// Largest image: the Teensy++ 2.0 flash.
+#define OTA_IMAGE_MAX 131072UL
+#define OTA_CHUNKS_MAX (OTA_IMAGE_MAX / OTA_CHUNK_SIZE)
+// Staging file bytes filled per pass through the main loop: two SD
+// blocks, a few ms of writing.  A full-size image is ready after 128
+// passes.
+#define OTA_FILL_BYTES 1024
+
+// The coordinator leaves the link free for sensor readings between
+// its packets: after each, it waits this many times the packet's
+// transmission time (at 9600 baud) before the next.  At 4, the
+// transfer takes at most a quarter of the link.
+#define OTA_THROTTLE_FACTOR 4
+// Drones answer after a random delay of up to this long [ms].  The
+// coordinator waits for answers until OTA_NACK_WAIT after the end of
+// each window.
+#define OTA_NACK_SPREAD 3000
+#define OTA_NACK_WAIT 5000
+// Times the missing chunks of a window are sent again before moving
+// on (the final queries pick up anything left).
+#define OTA_REPAIR_ROUNDS 3
+// Announcements at the start, and queries without an answer before
+// the transfer is finished.  Each query repairs at most one window:
+// the transfer is abandoned after OTA_QUERY_MAX queries more than the
+// image has windows.
+#define OTA_ANNOUNCE_REPEATS 3
+#define OTA_QUERY_QUIET 2
+#define OTA_QUERY_MAX 64
+// Drones tracked by the coordinator for status output.
+#define OTA_DRONES 16
+
+// Drone answer once it has every chunk.
+enum OTAStatus : uint8_t {
+  OTA_STAGED,       // image staged and checked
+  OTA_BAD_IMAGE     // whole-image check failed: starting over
+};
+
+// Staged image, kept in an EEPROM record (see pod_eeprom.h) so it is
+// not received again after a restart.  The firmware cannot rewrite its
+// own flash and the stock bootloader only loads over USB, so images
+// are staged, not applied: there is no apply command until a
+// bootloader that can read the SD card (and this record) exists.
+enum FirmwareHandoffState : uint8_t {
+  FIRMWARE_NONE,
+  FIRMWARE_STAGED     // image staged and checked
+};
+struct FirmwareHandoff {
+  uint8_t state;
+  uint32_t size;
+  uint32_t crc;
+  char file[13];
+};
+
+
+// Functions ===================================================================
+
+// Allocates the transfer state of the pod's role (coordinator or
+// drone).  Called from setup(), once the role is set: until then (or
+// if memory runs out), firmware update packets are ignored.
+void initFirmwareUpdate();
+
+// Coordinator: starts sending OTA_IMAGE_FILE to all drones.  Returns
+// false if there is no image (or it is too large).  The transfer
+// itself runs from the main loop (maintainFirmwareUpdate()).
+bool startFirmwareDistribution();
+
+// Sends the next packet of a transfer, or a drone's pending answer,
+// when due.  Called from the main loop.
+void maintainFirmwareUpdate();
+// Time until maintainFirmwareUpdate() next has something to do [ms]
+// (0xFFFFFFFF if nothing is in progress).
+unsigned long getFirmwareUpdateIdleTime();
+// Handles a firmware update packet (F,...): from the coordinator on
+// drones, from drones on the coordinator.
+void processFirmwarePacket(const String &packet);
+
+// Prints the state of the transfer (and, on the coordinator, the
+// drones' answers) to serial.
+void printFirmwareUpdateStatus();
+
+
+//==============================================================================
@@ -0,0 +1,292 @@
+/*==============================================================================
+  Particulate matter sensor duty-cycle planning.
+
+  This file is part of the LMN PODD distribution:
+    https://github.com/lmnts/PODD
+
+  CONTRIBUTORS:
+    PODD contributors (2026)
+
+  COPYRIGHT/LICENSE:
+  Copyright (c) 2026 LMN Architects
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Affero General Public License as
+  published by the Free Software Foundation, either version 3 of the
+  License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Affero General Public License for more details.
+
+  You should have received a copy of the GNU Affero General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+==============================================================================*/
+
+#include "pod_pmplan.h"
+#include "pod_clock.h"
+#include "pod_config.h"
+#include "pod_health.h"
+#include "pod_network.h"
+#include "pod_sampling.h"
+#include "pod_sensors.h"
+#include "pod_stats.h"
+
+
+// Global variables ============================================================
+
+// The schedule is driven from the main loop using millis() rather than
+// TimeAlarms timers, which are in short supply and only have one second
+// resolution.  Each cycle ends with a report at pmReportMillis; the
+// averaging window precedes it and, for duty-cycled sensors, the
+// power-on, cleaning (when due) and settling periods precede that.
+enum PMPhase : uint8_t {
+  PM_PHASE_DISABLED,    // sensor not in use
+  PM_PHASE_OFF,         // powered off until the next window
+  PM_PHASE_CLEANING,    // fan cleaning cycle
+  PM_PHASE_SETTLING,    // measuring, readings not yet used
+  PM_PHASE_AVERAGING    // collecting readings for the next report
+};
+PMPlan pmPlan = {0, 0, 0, false, 0, 0, 0};
+PMPhase pmPhase = PM_PHASE_DISABLED;
+unsigned long pmReportMillis = 0;   // when the next reading is due
+unsigned long pmPhaseMillis = 0;    // start of the current phase
+unsigned long pmSampleMillis = 0;   // last 1 Hz sample
+uint32_t pmCleanElapsed = 0;        // time since last cleaning [s]
+float pmSum2_5 = 0;
+float pmSum10 = 0;
+uint16_t pmSamples = 0;
+
+
+// Functions ===================================================================
+
+/* Indicates if the given millis() time has been reached (valid for
+   times within ~24 days of now). */
+static inline bool pmReached(const unsigned long t) {
+  return (long)(millis() - t) >= 0;
+}
+
+
+PMPlan planPMSensor(uint16_t interval, uint16_t settle, uint16_t average) {
+  PMPlan plan = {interval, settle, average, false, 0, 0, 0};
+  if (interval == 0) return plan;
+  if (plan.average < 1) plan.average = 1;
+  if (plan.average > interval) plan.average = interval;
+
+  // Power cycle only if the sensor would stay off for a while, even
+  // when a cleaning cycle is added.
+  const uint32_t active = (uint32_t)PM_POWERON_TIME + plan.settle + plan.average;
+  plan.dutyCycled = ((uint32_t)interval >= active + PM_CLEAN_TIME + PM_OFF_MIN);
+
+  float runTime, idleTime;  // per reading [s]
+  if (plan.dutyCycled) {
+    plan.onTime = active;
+    runTime = plan.settle + plan.average;
+    idleTime = PM_POWERON_TIME;
+    // Cleaning cycles, spread over the readings between them
+    runTime += (float)PM_CLEAN_TIME * interval / PM_CLEAN_INTERVAL;
+  } else {
+    plan.onTime = interval;
+    runTime = interval;
+    idleTime = 0;
+  }
+  plan.energy = PM_SUPPLY_VOLTAGE * (PM_CURRENT_RUN * runTime + PM_CURRENT_IDLE * idleTime) / 1000;
+  plan.current = 1000 * plan.energy / (PM_SUPPLY_VOLTAGE * interval);
+  return plan;
+}
+
+
+void startPMPlanner(uint16_t interval) {
+  pmPlan = planPMSensor(interval,getPMSettleTime(),getPMAverageTime());
+  registerSamplingSchedule(SENSOR_PM,interval);
+  pmCleanElapsed = 0;
+  if (interval == 0) {
+    stopPMSensor();
+    powerOffPMSensor();
+    pmPhase = PM_PHASE_DISABLED;
+    return;
+  }
+  // First reading as soon as the sensor has settled.
+  powerOnPMSensor();
+  startPMSensor();
+  pmPhase = PM_PHASE_SETTLING;
+  pmPhaseMillis = millis();
+  pmReportMillis = pmPhaseMillis + 1000UL * (pmPlan.settle + pmPlan.average);
+}
+
+
+const PMPlan& getPMPlan() {
+  return pmPlan;
+}
+
+
+/* Time at which a powered-off sensor is next powered on. */
+static unsigned long pmPowerOnMillis() {
+  const bool clean = (pmCleanElapsed >= PM_CLEAN_INTERVAL);
+  return pmReportMillis - 1000UL * (pmPlan.onTime + (clean ? PM_CLEAN_TIME : 0));
+}
+
+
+/* Adds the sensor's latest readings to the running averages. */
+static void samplePMSensor() {
+  if (!retrievePMData()) return;
+  const float c2_5 = getPM2_5();
+  const float c10 = getPM10();
+  if (isnan(c2_5) || (c2_5 < 0) || isnan(c10) || (c10 < 0)) return;
+  pmSum2_5 += c2_5;
+  pmSum10 += c10;
+  pmSamples++;
+}
+
+
+/* Saves the averaged readings and schedules the next cycle. */
+static void finishPMCycle() {
+  if (pmSamples > 0) {
+    const float c2_5 = pmSum2_5 / pmSamples;
+    const float c10 = pmSum10 / pmSamples;
+    Serial.print(F("PM_2.5: "));
+    Serial.print(c2_5);
+    Serial.println(F(" ug/m^3"));
+    Serial.print(F("PM_10:  "));
+    Serial.print(c10);
+    Serial.print(F(" ug/m^3  (average of "));
+    Serial.print(pmSamples);
+    Serial.println(F(" readings)"));
+    time_t utc = getUTC();
+    Reading readings[2] = {{utc, c2_5, READING_PM2_5},
+                           {utc, c10, READING_PM10}};
+    saveReadings(readings, 2);
+  } else {
+    Serial.println(F("Failed to retrieve particle meter data."));
+    reportReadFailure(READING_PM2_5);
+  }
+
+  pmReportMillis += 1000UL * pmPlan.interval;
+  // If the loop fell a whole interval behind (e.g. a long blocking
+  // upload), restart the schedule rather than reporting back-to-back.
+  if (pmReached(pmReportMillis)) {
+    pmReportMillis = millis() + 1000UL * pmPlan.interval;
+  }
+  if (pmPlan.dutyCycled) {
+    pmCleanElapsed += pmPlan.interval;
+    powerOffPMSensor();
+    pmPhase = PM_PHASE_OFF;
+  } else {
+    pmPhase = PM_PHASE_SETTLING;
+  }
+  pmPhaseMillis = millis();
+}
+
+
+/* Skips the current cycle of a failed sensor (see pod_health.h): the
+   sensor stays off until the next cycle. */
+static void skipPMCycle() {
+  stopPMSensor();
+  powerOffPMSensor();
+  pmReportMillis += 1000UL * pmPlan.interval;
+  if (pmReached(pmReportMillis)) {
+    pmReportMillis = millis() + 1000UL * pmPlan.interval;
+  }
+  pmPhase = PM_PHASE_OFF;
+  pmPhaseMillis = millis();
+}
+
+
+void maintainPMPlanner() {
+  switch (pmPhase) {
+    case PM_PHASE_DISABLED:
+      return;
+    case PM_PHASE_OFF:
+      if (!pmReached(pmPowerOnMillis())) return;
+      if (!isSensorReadable(SENSOR_PM)) {
+        skipPMCycle();
+        return;
+      }
+      powerOnPMSensor();
+      startPMSensor();
+      pmPhase = ((pmCleanElapsed >= PM_CLEAN_INTERVAL) && cleanPMSensor())
+                ? PM_PHASE_CLEANING : PM_PHASE_SETTLING;
+      pmPhaseMillis = millis();
+      return;
+    case PM_PHASE_CLEANING:
+      if (millis() - pmPhaseMillis < 1000UL * PM_CLEAN_TIME) return;
+      pmCleanElapsed = 0;
+      pmPhase = PM_PHASE_SETTLING;
+      pmPhaseMillis = millis();
+      return;
+    case PM_PHASE_SETTLING:
+      if (!pmReached(pmReportMillis - 1000UL * pmPlan.average)) return;
+      if (!isSensorReadable(SENSOR_PM)) {
+        skipPMCycle();
+        return;
+      }
+      pmSum2_5 = 0;
+      pmSum10 = 0;
+      pmSamples = 0;
+      pmSampleMillis = millis() - 1000;
+      pmPhase = PM_PHASE_AVERAGING;
+      pmPhaseMillis = millis();
+      // Fall through to take the first sample
+    case PM_PHASE_AVERAGING:
+      if (millis() - pmSampleMillis >= 1000) {
+        pmSampleMillis = millis();
+        samplePMSensor();
+      }
+      if (pmReached(pmReportMillis)) finishPMCycle();
+      return;
+  }
+}
+
+
+unsigned long getPMPlannerIdleTime() {
+  unsigned long t;
+  switch (pmPhase) {
+    case PM_PHASE_OFF:
+      t = pmPowerOnMillis();
+      break;
+    case PM_PHASE_CLEANING:
+      t = pmPhaseMillis + 1000UL * PM_CLEAN_TIME;
+      break;
+    case PM_PHASE_SETTLING:
+      t = pmReportMillis - 1000UL * pmPlan.average;
+      break;
+    case PM_PHASE_AVERAGING:
+      t = pmSampleMillis + 1000;
+      if ((long)(pmReportMillis - t) < 0) t = pmReportMillis;
+      break;
+    default:
+      return 0xFFFFFFFF;
+  }
+  const long remaining = (long)(t - millis());
+  return (remaining > 0) ? remaining : 0;
+}
+
+
+//------------------------------------------------------------------------------
+// Prints the measurement schedule and energy estimates to serial.
+// 
+void printPMPlan() {
+  if (pmPlan.interval == 0) return;
+  char buff[40];
+  Serial.print(F("Particulate matter sensor: "));
+  Serial.println(pmPlan.dutyCycled ? F("duty-cycled") : F("continuous"));
+  sprintf(buff,"%u / %u / %u",pmPlan.interval,pmPlan.settle,pmPlan.average);
+  Serial.print(F("  Interval / settle / average [s]: "));
+  Serial.println(buff);
+  Serial.print(F("  Powered per reading [s]:         "));
+  Serial.println(pmPlan.onTime);
+  Serial.print(F("  Energy per reading [J]:          "));
+  Serial.println(pmPlan.energy,1);
+  Serial.print(F("  Average current [mA]:            "));
+  Serial.println(pmPlan.current,1);
+  if (pmPlan.dutyCycled) {
+    const uint32_t remaining = (pmCleanElapsed < PM_CLEAN_INTERVAL) ? (PM_CLEAN_INTERVAL - pmCleanElapsed) : 0;
+    Serial.print(F("  Next fan cleaning in [h]:        "));
+    Serial.println(remaining / 3600);
+  }
+}
+
+
+//==============================================================================
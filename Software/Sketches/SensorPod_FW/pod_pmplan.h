@@ -0,0 +1,95 @@
+/*==============================================================================
+  Particulate matter sensor duty-cycle planning.
+
+  This file is part of the LMN PODD distribution:
+    https://github.com/lmnts/PODD
+
+  CONTRIBUTORS:
+    PODD contributors (2026)
+
+  COPYRIGHT/LICENSE:
+  Copyright (c) 2026 LMN Architects
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Affero General Public License as
+  published by the Free Software Foundation, either version 3 of the
+  License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Affero General Public License for more details.
+
+  You should have received a copy of the GNU Affero General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+==============================================================================*/
+
+#pragma once
+
+// Standard libraries
+// Contributed libraries
+#include <Arduino.h>
+// Local headers
+
+
+// Constants/global variables ==================================================
+
+// Delay between powering on the sensor and starting measurements [s].
+#define PM_POWERON_TIME 1
+// Duration of a fan cleaning cycle, including spin-up/down [s].
+#define PM_CLEAN_TIME 12
+// Interval between fan cleanings [s].  The sensor cleans itself weekly
+// while running continuously, but that counter is reset whenever it is
+// powered off, so duty-cycled sensors are cleaned by the planner.
+#define PM_CLEAN_INTERVAL 604800UL
+// Shortest time powered off that is worth a power cycle [s]; with less
+// slack than this, the sensor is left running.
+#define PM_OFF_MIN 30
+// Sensor supply voltage [V] and current [mA] while measuring and while
+// powered but not measuring, for energy estimates.
+#define PM_SUPPLY_VOLTAGE 5.0
+#define PM_CURRENT_RUN 60
+#define PM_CURRENT_IDLE 8
+
+// Measurement schedule for a given reporting interval.  Each reported
+// value is the average of the sensor's 1 Hz readings over the final
+// 'average' seconds of the interval, once the sensor has been measuring
+// for at least 'settle' seconds.  Duty-cycled sensors are powered off
+// between measurement windows; otherwise the sensor runs continuously.
+struct PMPlan {
+  uint16_t interval;    // reporting interval [s]
+  uint16_t settle;      // measuring time before averaging begins [s]
+  uint16_t average;     // averaging window [s]
+  bool dutyCycled;
+  uint16_t onTime;      // powered time per reading [s]
+  float energy;         // estimated sensor energy per reading [J]
+  float current;        // estimated average sensor current [mA]
+};
+
+
+// Functions ===================================================================
+
+// Plans the measurement schedule for the given reporting interval,
+// settle time, and averaging window [s].
+PMPlan planPMSensor(uint16_t interval, uint16_t settle, uint16_t average);
+
+// Starts taking particulate matter readings using the configured
+// interval and settle/averaging times (the sensor should already have
+// been probed), or stops the sensor if disabled (interval of 0).
+void startPMPlanner(uint16_t interval);
+// Advances the measurement schedule: powers the sensor on and off,
+// cleans it when due, and collects, averages and saves readings.
+// Intended to be called on every pass through the main loop.
+void maintainPMPlanner();
+// Time until maintainPMPlanner() next has something to do [ms]
+// (0xFFFFFFFF if the sensor is not in use).
+unsigned long getPMPlannerIdleTime();
+// Current plan (interval of 0 if the sensor is not in use).
+const PMPlan& getPMPlan();
+
+// Prints the measurement schedule and energy estimates to serial.
+void printPMPlan();
+
+
+//==============================================================================
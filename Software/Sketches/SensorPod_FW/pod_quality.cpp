@@ -0,0 +1,240 @@
+/*==============================================================================
+  Streaming sensor data quality checks.
+
+  Each reading is checked as it is taken, in constant memory per
+  reading type and in fixed-point arithmetic:
+    * range:   outside the plausible values for the sensor
+    * spike:   far from the running (exponentially weighted) mean,
+               relative to the running variance
+    * stuck:   the same value too many times in a row
+    * invalid: not a number
+  Flags are stored with the reading (SD log, uploads and XBee packets)
+  and counted in the runtime statistics.  Range/stuck/invalid readings
+  count as sensor faults for the health tracking (see pod_health.h).
+
+  This file is part of the LMN PODD distribution:
+    https://github.com/lmnts/PODD
+
+  CONTRIBUTORS:
+    PODD contributors (2026)
+
+  COPYRIGHT/LICENSE:
+  Copyright (c) 2026 LMN Architects
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Affero General Public License as
+  published by the Free Software Foundation, either version 3 of the
+  License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Affero General Public License for more details.
+
+  You should have received a copy of the GNU Affero General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+==============================================================================*/
+
+#include "pod_quality.h"
+#include "pod_health.h"
+#include "pod_sampling.h"
+#include "pod_stats.h"
+#include "pod_util.h"
+
+
+// Global variables ============================================================
+
+// Checks for each reading type.  Values are converted to integers in
+// units of 1/scale of the reading's units (e.g. hundredths of a degree
+// for scale 100) and checked against [min,max].  Spikes are only
+// flagged if at least spikeMin (scaled) from the running mean (0: not
+// checked), and stuck values after stuckRun identical readings (0: not
+// checked).  Without stuckZero, runs of zeros are not stuck: light in
+// the dark, particulates in clean air.
+struct QualityLimits {
+  uint8_t scale;
+  int32_t min;
+  int32_t max;
+  uint16_t spikeMin;
+  uint8_t stuckRun;
+  bool stuckZero;
+};
+static const QualityLimits QUALITY_LIMITS[READING_SD_COUNT] PROGMEM = {
+  // scale    min     max  spikeMin  stuckRun  stuckZero
+  {     1,     0,  83866,       0,     120,  false},  // Light [lux]
+  {   100,     0,  10010,     500,      60,  true },  // Humidity [%]
+  {   100, -4000,  25700,     500,      60,  true },  // AirTemp [F]
+  {   100, -4000,  25700,     500,       0,  true },  // GlobeTemp [F]
+  {   100,     0,  51200,       0,      30,  true },  // Sound [arb]
+  {     1,   100,  10000,     200,      60,  true },  // CO2 [ppm]
+  {   100,     0, 100000,       0,      60,  false},  // PM_2.5 [ug/m^3]
+  {   100,     0, 100000,       0,      60,  false},  // PM_10 [ug/m^3]
+  {     1,     0,   1023,       0,       0,  true }   // CO [arb]
+};
+
+// Flags indicating a sensor fault rather than an unusual reading.
+#define QUALITY_FAULTS (QUALITY_RANGE | QUALITY_STUCK | QUALITY_INVALID)
+// Extra fractional bits of the running mean, so the small steps of the
+// exponential average are not lost to rounding.
+#define QUALITY_MEAN_FRAC 4
+
+// Running statistics of each reading type (scaled values).  Only
+// readings within range are included.
+struct QualityState {
+  int32_t mean;     // mean << QUALITY_MEAN_FRAC
+  uint32_t var;     // variance
+  int32_t last;     // previous value
+  uint8_t count;    // readings so far, up to QUALITY_WARMUP
+  uint8_t run;      // identical values in a row (up to 255)
+};
+QualityState qualityState[READING_SD_COUNT];
+
+static const char QUALITY_NAME_RANGE[] PROGMEM   = "range";
+static const char QUALITY_NAME_SPIKE[] PROGMEM   = "spike";
+static const char QUALITY_NAME_STUCK[] PROGMEM   = "stuck";
+static const char QUALITY_NAME_INVALID[] PROGMEM = "invalid";
+static const char * const QUALITY_NAMES[QUALITY_FLAG_COUNT] PROGMEM = {
+  QUALITY_NAME_RANGE, QUALITY_NAME_SPIKE, QUALITY_NAME_STUCK,
+  QUALITY_NAME_INVALID
+};
+
+
+// Functions ===================================================================
+
+/* Checks a single reading and updates the statistics of its type.
+   Returns its quality flags. */
+static uint8_t checkReading(const Reading &r) {
+  if (r.type >= READING_SD_COUNT) return 0;
+  if (isnan(r.value)) return QUALITY_INVALID;
+  QualityLimits lim;
+  memcpy_P(&lim,&QUALITY_LIMITS[r.type],sizeof(lim));
+  // Range checked before conversion, so the values used below are
+  // small enough not to overflow.
+  const float scaled = r.value * lim.scale;
+  if ((scaled < lim.min) || (scaled > lim.max)) return QUALITY_RANGE;
+  const int32_t x = lround(scaled);
+  QualityState &s = qualityState[r.type];
+  uint8_t flags = 0;
+
+  if ((s.count > 0) && (x == s.last)) {
+    if (s.run < 255) s.run++;
+  } else {
+    s.run = 1;
+  }
+  s.last = x;
+  if ((lim.stuckRun > 0) && (s.run >= lim.stuckRun) && (lim.stuckZero || (x != 0))) {
+    flags |= QUALITY_STUCK;
+  }
+
+  if (s.count == 0) {
+    s.mean = x * (1L << QUALITY_MEAN_FRAC);
+    s.var = 0;
+    s.count = 1;
+    return flags;
+  }
+  // Squared deviation from the running mean, limited to 16 bits so
+  // the square fits in 32.
+  const int32_t d = x - (s.mean >> QUALITY_MEAN_FRAC);
+  uint32_t ad = (d < 0) ? (uint32_t)(-d) : (uint32_t)d;
+  if (ad > 0xFFFF) ad = 0xFFFF;
+  const uint32_t d2 = ad * ad;
+  if ((s.count >= QUALITY_WARMUP) && (lim.spikeMin > 0) && (ad >= lim.spikeMin)
+      && ((d2 >> (2*QUALITY_SPIKE_SIGMA_SHIFT)) > s.var)) {
+    flags |= QUALITY_SPIKE;
+  }
+  // Spikes are included, so a lasting step change is soon accepted.
+  s.mean += (x * (1L << QUALITY_MEAN_FRAC) - s.mean) >> QUALITY_EWMA_SHIFT;
+  if (d2 >= s.var) {
+    s.var += (d2 - s.var) >> QUALITY_EWMA_SHIFT;
+  } else {
+    s.var -= (s.var - d2) >> QUALITY_EWMA_SHIFT;
+  }
+  if (s.count < QUALITY_WARMUP) s.count++;
+  return flags;
+}
+
+
+void resetQualityState(const SensorChannel ch) {
+  for (uint8_t k = 0; k < READING_SD_COUNT; k++) {
+    if (getReadingChannel((ReadingType)k) != ch) continue;
+    qualityState[k].count = 0;
+    qualityState[k].run = 0;
+  }
+}
+
+
+uint8_t checkReadings(Reading *r, const uint8_t n) {
+  if (n == 0) return 0;
+  uint8_t flags = 0;
+  for (uint8_t k = 0; k < n; k++) {
+    r[k].quality = checkReading(r[k]);
+    countReadingFlags(r[k].type,r[k].quality);
+    flags |= r[k].quality;
+  }
+  reportSensorResult(r[0].type,(flags & QUALITY_FAULTS) != 0);
+  return flags;
+}
+
+
+char* formatQualityFlags(char *buff, const uint8_t flags) {
+  if (flags == 0) {
+    strcpy_P(buff,PSTR("ok"));
+    return buff;
+  }
+  buff[0] = '\0';
+  for (uint8_t k = 0; k < QUALITY_FLAG_COUNT; k++) {
+    if (!(flags & (1 << k))) continue;
+    if (buff[0] != '\0') strcat(buff,",");
+    strcat_P(buff,(PGM_P)pgm_read_word(&QUALITY_NAMES[k]));
+  }
+  return buff;
+}
+
+
+//------------------------------------------------------------------------------
+// Prints the running statistics of each reading type to serial.
+//
+void printQualityStatus() {
+  char buff[16];
+  Serial.println(F("Data quality:               mean      s.d.   run"));
+  for (uint8_t k = 0; k < READING_SD_COUNT; k++) {
+    const QualityState &s = qualityState[k];
+    if (s.count == 0) continue;
+    const uint8_t scale = pgm_read_byte(&QUALITY_LIMITS[k].scale);
+    char name[READING_NAME_LEN];
+    formatReadingName(name,(ReadingType)k);
+    Serial.print(F("  "));
+    Serial.print(name);
+    for (size_t j = strlen(name); j < 14; j++) Serial.print(' ');
+    Serial.print(dtostrf((float)s.mean / (scale << QUALITY_MEAN_FRAC),12,2,buff));
+    Serial.print(dtostrf(sqrt((float)s.var) / scale,10,2,buff));
+    sprintf(buff," %5u",s.run);
+    Serial.println(buff);
+  }
+}
+
+
+/* Quality check benchmark (see runBenchmarks()): one reading,
+   alternating between two values within the air temperature's
+   range.  The statistics are cleared afterwards. */
+// Benchmark testing >>>>>>>>>>>>>>>>>>>
+#ifdef BENCHMARK_TESTING
+Reading benchQualityReading = {1600000000, 72.35, READING_AIRTEMP};
+
+void benchPrepQualityReading() {
+  benchQualityReading.value = (benchQualityReading.value < 72.5) ? 72.65 : 72.35;
+}
+void benchCheckReadings() {
+  checkReadings(&benchQualityReading,1);
+}
+
+void benchmarkQuality() {
+  runBenchmark(F("checkReadings"),benchCheckReadings,64,benchPrepQualityReading);
+  memset(qualityState,0,sizeof(qualityState));
+}
+#endif
+//<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+//==============================================================================
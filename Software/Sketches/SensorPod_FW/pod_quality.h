@@ -0,0 +1,81 @@
+/*==============================================================================
+  Streaming sensor data quality checks.
+
+  This file is part of the LMN PODD distribution:
+    https://github.com/lmnts/PODD
+
+  CONTRIBUTORS:
+    PODD contributors (2026)
+
+  COPYRIGHT/LICENSE:
+  Copyright (c) 2026 LMN Architects
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Affero General Public License as
+  published by the Free Software Foundation, either version 3 of the
+  License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Affero General Public License for more details.
+
+  You should have received a copy of the GNU Affero General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+==============================================================================*/
+
+#pragma once
+
+// Standard libraries
+// Contributed libraries
+#include <Arduino.h>
+// Local headers
+#include "pod_config.h"
+#include "pod_network.h"
+
+
+// Constants/global variables ==================================================
+
+// Quality flags of a reading (Reading::quality), written to the SD log
+// and sent with the reading.  Zero if no problem was found.
+enum QualityFlag : uint8_t {
+  QUALITY_RANGE   = 0x01,   // outside the sensor's plausible range
+  QUALITY_SPIKE   = 0x02,   // sudden jump from the running mean
+  QUALITY_STUCK   = 0x04,   // same value for too many readings in a row
+  QUALITY_INVALID = 0x08    // not a number
+};
+#define QUALITY_FLAG_COUNT 4
+
+// Readings after a (re)start before spikes are flagged, while the
+// running mean and variance settle.
+#define QUALITY_WARMUP 8
+// Running mean/variance weight of each new reading: 1/2^N.
+#define QUALITY_EWMA_SHIFT 3
+// Spike threshold: deviations beyond 2^N standard deviations (and the
+// sensor's minimum spike size).
+#define QUALITY_SPIKE_SIGMA_SHIFT 2
+
+
+// Functions ===================================================================
+
+// Checks the given readings (from one sensor, as passed to
+// saveReadings()) against their sensors' plausible ranges and running
+// statistics and sets their quality flags.  Flagged readings are
+// counted, and range/stuck/invalid readings reported as a sensor fault
+// (see pod_health.h).  Returns the flags of all the readings.
+uint8_t checkReadings(Reading *r, const uint8_t n);
+// Starts the running statistics of the given sensor's readings over,
+// e.g. after the sensor is re-initialized.
+void resetQualityState(const SensorChannel ch);
+
+// Writes the flags as text (e.g. "range,stuck"; "ok" if none) to the
+// buffer (at least QUALITY_FLAGS_LEN long) and returns it.
+#define QUALITY_FLAGS_LEN 26
+char* formatQualityFlags(char *buff, const uint8_t flags);
+
+// Prints the running statistics of each reading type to serial.
+void printQualityStatus();
+
+
+//==============================================================================
@@ -0,0 +1,514 @@
+/*==============================================================================
+  Remote configuration of drones over XBee.
+
+  This file is part of the LMN PODD distribution:
+    https://github.com/lmnts/PODD
+
+  CONTRIBUTORS:
+    PODD contributors (2026)
+
+  COPYRIGHT/LICENSE:
+  Copyright (c) 2026 LMN Architects
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Affero General Public License as
+  published by the Free Software Foundation, either version 3 of the
+  License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Affero General Public License for more details.
+
+  You should have received a copy of the GNU Affero General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+==============================================================================*/
+
+#include "pod_remote.h"
+#include "pod_clock.h"
+#include "pod_eeprom.h"
+#include "pod_logging.h"
+#include "pod_network.h"
+#include "pod_util.h"
+
+
+// Global variables ============================================================
+
+// Interval field tags, in SensorChannel order.
+static const char PUSH_RATE_TAGS[SENSOR_CHANNEL_COUNT + 1] PROGMEM = "LHGSCPO";
+
+// Coordinator's current push, kept in EEPROM so it survives a restart.
+// Version 0: nothing pushed yet.
+#define CONFIG_PUSH_SCHEMA 1
+struct ConfigPushRecord {
+  uint16_t version;
+  ConfigPush push;
+};
+
+static_assert(sizeof(ConfigPushRecord) <= EEPROM_RECORD_MAX(EEPROM_PUSH_SLOT_SIZE),
+              "Pushed configuration does not fit in its EEPROM slots");
+
+// Coordinator's sending state for the current push.
+struct ConfigPushState {
+  uint16_t sent;              // times sent
+  unsigned long lastSent;     // millis() of last send
+  uint16_t retry;             // time from last send to the next [s]
+};
+
+// Drones the coordinator has heard from, with their latest answer.
+// Times are millis() values.
+struct ConfigPushDrone {
+  char devid[17];           // empty if unused
+  uint16_t version;         // version answered
+  ConfigPushStatus status;
+  unsigned long seen;       // last packet from this drone
+  unsigned long answered;   // last answer
+};
+
+// The coordinator's push state is allocated on the coordinator only
+// (initConfigPush()): drones only keep the version they applied, in
+// their configuration.
+struct ConfigPushTables {
+  ConfigPushRecord record;
+  ConfigPushState state;
+  ConfigPushDrone drones[CONFIG_PUSH_DRONES];
+};
+ConfigPushTables *pushTables = NULL;
+
+// Drone's answer waiting for its (random) time, and the report of
+// newly applied settings that follows it.
+struct ConfigAckState {
+  bool pending;
+  unsigned long due;
+  char packet[32];
+  bool report;            // log and report the settings once answered
+  bool ratesChanged;      // ...and the rates too
+} pushAck;
+
+static const char PUSH_STATUS_APPLIED[] PROGMEM  = "applied";
+static const char PUSH_STATUS_CHECKSUM[] PROGMEM = "damaged";
+static const char PUSH_STATUS_INVALID[] PROGMEM  = "rejected";
+static const char PUSH_STATUS_PENDING[] PROGMEM  = "-";
+static const char * const PUSH_STATUS_NAMES[] PROGMEM = {
+  PUSH_STATUS_APPLIED, PUSH_STATUS_CHECKSUM, PUSH_STATUS_INVALID,
+  PUSH_STATUS_PENDING
+};
+
+
+// Functions ===================================================================
+
+/* Done once, from setup() (or from the menu before that), so the
+   block sits at the bottom of the heap for good. */
+void initConfigPush() {
+  if (!getModeCoord() || (pushTables != NULL)) return;
+  pushTables = (ConfigPushTables*)calloc(1,sizeof(ConfigPushTables));
+  if (pushTables == NULL) {
+    Serial.println(F("WARNING: No memory for settings pushes: disabled."));
+    return;
+  }
+  ConfigPushRecord &r = pushTables->record;
+  uint8_t schema;
+  if (loadEEPROMRecord(EEPROM_RECORD_PUSH,&r,sizeof(r),schema) == 0) r.version = 0;
+}
+
+
+/* Appends to the packet in buff (of size len); returns false if it
+   does not fit. */
+static bool appendPacket(char *buff, const size_t len, const char *fmt, ...) {
+  const size_t n = strlen(buff);
+  va_list args;
+  va_start(args,fmt);
+  const int k = vsnprintf(buff + n,len - n,fmt,args);
+  va_end(args);
+  return (k >= 0) && ((size_t)k < len - n);
+}
+
+
+/* Writes the packet for the current push to buff (at least
+   CONFIG_PUSH_PACKET_LEN long).  Returns its length. */
+static size_t formatConfigPushPacket(char *buff) {
+  const ConfigPush &p = pushTables->record.push;
+  const size_t len = CONFIG_PUSH_PACKET_LEN;
+  buff[0] = '\0';
+  appendPacket(buff,len,"K,%u,%s",pushTables->record.version,p.target);
+  for (uint8_t k = 0; k < SENSOR_CHANNEL_COUNT; k++) {
+    if (!(p.fields & (PUSH_RATE_FIRST << k))) continue;
+    appendPacket(buff,len,",%c%d",pgm_read_byte(&PUSH_RATE_TAGS[k]),p.rates[k]);
+  }
+  if (p.fields & PUSH_UPLOAD) appendPacket(buff,len,",U%d",p.uploadT);
+  if (p.fields & PUSH_PROJECT) appendPacket(buff,len,",J%s",p.project);
+  if (p.fields & PUSH_ROOM) appendPacket(buff,len,",M%s",p.room);
+  if (p.fields & PUSH_NETID) appendPacket(buff,len,",N%s",p.networkID);
+  if (p.fields & PUSH_TIMEZONE) appendPacket(buff,len,",Z%s/%s",p.timezone[0],p.timezone[1]);
+  appendPacket(buff,len,",");
+  const uint16_t crc = crc16(0xFFFF,buff,strlen(buff));
+  appendPacket(buff,len,"%04X",crc);
+  return strlen(buff);
+}
+
+
+/* Indicates if the given string can be sent as a field: no commas
+   (field separator) or control characters. */
+static bool isPushString(const char *s) {
+  for (; *s != '\0'; s++) {
+    if ((*s == ',') || ((uint8_t)*s < 0x20) || (*s == 0x7F)) return false;
+  }
+  return true;
+}
+
+
+bool startConfigPush(const ConfigPush &push) {
+  initConfigPush();
+  if (pushTables == NULL) return false;
+  const char *strings[] = {push.target, push.project, push.room,
+                           push.networkID, push.timezone[0], push.timezone[1]};
+  for (uint8_t k = 0; k < sizeof(strings)/sizeof(strings[0]); k++) {
+    if (!isPushString(strings[k])) return false;
+  }
+  if ((push.target[0] == '\0') || (strchr(push.timezone[0],'/') != NULL)
+      || (strchr(push.timezone[1],'/') != NULL)) return false;
+  for (uint8_t k = 0; k < SENSOR_CHANNEL_COUNT; k++) {
+    if ((push.fields & (PUSH_RATE_FIRST << k)) && (push.rates[k] < 0)) return false;
+  }
+  if ((push.fields & PUSH_UPLOAD) && (push.uploadT < 0)) return false;
+
+  // The first version is taken from the clock, so a coordinator that
+  // lost its EEPROM does not reuse a version the drones already have.
+  ConfigPushRecord &r = pushTables->record;
+  uint16_t version = (r.version != 0) ? r.version + 1 : (uint16_t)getUTC();
+  if (version == 0) version = 1;
+  r.version = version;
+  r.push = push;
+  saveEEPROMRecord(EEPROM_RECORD_PUSH,&r,sizeof(r),CONFIG_PUSH_SCHEMA);
+  pushTables->state.sent = 0;
+  pushTables->state.retry = CONFIG_PUSH_RETRY_MIN;
+  for (uint8_t k = 0; k < CONFIG_PUSH_DRONES; k++) pushTables->drones[k].status = PUSH_PENDING;
+  return true;
+}
+
+
+/* Indicates if the given drone is to receive the current push. */
+static bool isPushTarget(const char *devid) {
+  const char *target = pushTables->record.push.target;
+  return (strcmp(target,"*") == 0) || (strcmp(target,devid) == 0);
+}
+
+
+/* Indicates if any drone still needs the current push: one that has
+   been heard from recently without answering with the current version,
+   or any drone at all if none has been heard from. */
+static bool isConfigPushWaiting() {
+  bool targetSeen = false;
+  for (uint8_t k = 0; k < CONFIG_PUSH_DRONES; k++) {
+    const ConfigPushDrone &d = pushTables->drones[k];
+    if (d.devid[0] == '\0') continue;
+    if (millis() - d.seen > 1000UL * CONFIG_PUSH_DRONE_TIMEOUT) continue;
+    if (!isPushTarget(d.devid)) continue;
+    targetSeen = true;
+    if ((d.version != pushTables->record.version)
+        || ((d.status != PUSH_APPLIED) && (d.status != PUSH_INVALID))) return true;
+  }
+  return !targetSeen;
+}
+
+
+void maintainConfigPush() {
+  if (!getModeCoord()) {
+    if (pushAck.pending && ((long)(millis() - pushAck.due) >= 0)) {
+      pushAck.pending = false;
+      sendXBee(pushAck.packet);
+      // Log and report the new settings, as at startup (after
+      // answering, as the rates take a couple of seconds to send)
+      if (pushAck.report) {
+        savePodConfig();
+        if (pushAck.ratesChanged) savePodRates();
+        pushAck.report = false;
+        pushAck.ratesChanged = false;
+      }
+    }
+    return;
+  }
+  if (pushTables == NULL) return;
+  if (pushTables->record.version == 0) return;
+  if (!isConfigPushWaiting()) return;
+  ConfigPushState &s = pushTables->state;
+  if ((s.sent > 0) && (millis() - s.lastSent < 1000UL * s.retry)) return;
+  if (s.sent > 0) {
+    s.retry = min(2*(uint32_t)s.retry,(uint32_t)CONFIG_PUSH_RETRY_MAX);
+  }
+  char buff[CONFIG_PUSH_PACKET_LEN];
+  formatConfigPushPacket(buff);
+  Serial.print(F("Sending settings version "));
+  Serial.print(pushTables->record.version);
+  Serial.println(F(" to drones...."));
+  sendXBee(buff);
+  s.sent++;
+  s.lastSent = millis();
+}
+
+
+/* Finds the drone with the given device ID in the coordinator's list,
+   adding it (in place of the drone not heard from the longest) if
+   not found. */
+static ConfigPushDrone& findConfigPushDrone(const char *devid) {
+  ConfigPushDrone * const drones = pushTables->drones;
+  uint8_t oldest = 0;
+  for (uint8_t k = 0; k < CONFIG_PUSH_DRONES; k++) {
+    ConfigPushDrone &d = drones[k];
+    if ((d.devid[0] != '\0') && (strcmp(d.devid,devid) == 0)) return d;
+    if (drones[oldest].devid[0] == '\0') continue;
+    if ((d.devid[0] == '\0') || (millis() - d.seen > millis() - drones[oldest].seen)) oldest = k;
+  }
+  ConfigPushDrone &d = drones[oldest];
+  snprintf(d.devid,sizeof(d.devid),"%s",devid);
+  d.version = 0;
+  d.status = PUSH_PENDING;
+  d.seen = millis();
+  d.answered = 0;
+  // Send the current push soon to a newly heard drone
+  if (isPushTarget(devid)) pushTables->state.retry = CONFIG_PUSH_RETRY_MIN;
+  return d;
+}
+
+
+void noteConfigPushDrone(const char *devid) {
+  if ((pushTables == NULL) || (devid == NULL) || (devid[0] == '\0')) return;
+  findConfigPushDrone(devid).seen = millis();
+}
+
+
+void processConfigAckPacket(const String &packet) {
+  if (pushTables == NULL) return;
+  char devid[17], version[6], status[4];
+  const char *p = packet.c_str();
+  if ((p[0] != 'A') || (p[1] != ',')
+      || ((p = copyXBeePacketField(p + 2,devid,sizeof(devid),false)) == NULL)
+      || ((p = copyXBeePacketField(p,version,sizeof(version),false)) == NULL)
+      || (copyXBeePacketField(p,status,sizeof(status),true) == NULL)
+      || (devid[0] == '\0') || (atoi(status) >= PUSH_PENDING)) {
+    Serial.println(F("Warning: Received invalid settings answer (ignoring)."));
+    return;
+  }
+  ConfigPushDrone &d = findConfigPushDrone(devid);
+  d.version = (uint16_t)atol(version);
+  d.status = (ConfigPushStatus)atoi(status);
+  d.seen = millis();
+  d.answered = millis();
+  Serial.print(devid);
+  Serial.print(F(": settings version "));
+  Serial.print(d.version);
+  Serial.print(' ');
+  Serial.println((FType)pgm_read_word(&PUSH_STATUS_NAMES[d.status]));
+}
+
+
+/* Queues a drone's answer to the coordinator, to be sent after a
+   random delay so that drones answering a broadcast push do not
+   collide.  A newer answer replaces one still waiting. */
+static void sendConfigAck(const uint16_t version, const ConfigPushStatus status) {
+  snprintf(pushAck.packet,sizeof(pushAck.packet),"A,%s,%u,%u",getDevID(),version,status);
+  pushAck.pending = true;
+  pushAck.due = millis() + getXBeeAnswerDelay(CONFIG_ACK_SPREAD);
+}
+
+
+unsigned long getConfigPushIdleTime() {
+  if (getModeCoord() || !pushAck.pending) return 0xFFFFFFFF;
+  const unsigned long t = millis();
+  return ((long)(pushAck.due - t) > 0) ? pushAck.due - t : 0;
+}
+
+
+/* Parses an interval field value [s] (0 to disable). */
+static bool parsePushInterval(const char *s, int &v) {
+  char *end;
+  const long l = strtol(s,&end,10);
+  if ((end == s) || (*end != '\0') || (l < 0) || (l > 32767)) return false;
+  v = l;
+  return true;
+}
+
+
+/* Parses the fields of a configuration packet (after the target).
+   Returns false if any field is unknown or invalid. */
+static bool parseConfigPushFields(const char *p, ConfigPush &push) {
+  char field[20];
+  while (*p != '\0') {
+    if ((p = copyXBeePacketField(p,field,sizeof(field),false)) == NULL) return false;
+    const char *v = field + 1;
+    uint8_t k = 0;
+    while ((k < SENSOR_CHANNEL_COUNT) && (pgm_read_byte(&PUSH_RATE_TAGS[k]) != field[0])) k++;
+    if (k < SENSOR_CHANNEL_COUNT) {
+      if (!parsePushInterval(v,push.rates[k])) return false;
+      push.fields |= (PUSH_RATE_FIRST << k);
+      continue;
+    }
+    switch (field[0]) {
+      case 'U':
+        if (!parsePushInterval(v,push.uploadT)) return false;
+        push.fields |= PUSH_UPLOAD;
+        break;
+      case 'J':
+        if (strlen(v) >= sizeof(push.project)) return false;
+        strcpy(push.project,v);
+        push.fields |= PUSH_PROJECT;
+        break;
+      case 'M':
+        if (strlen(v) >= sizeof(push.room)) return false;
+        strcpy(push.room,v);
+        push.fields |= PUSH_ROOM;
+        break;
+      case 'N':
+        if (strlen(v) >= sizeof(push.networkID)) return false;
+        strcpy(push.networkID,v);
+        push.fields |= PUSH_NETID;
+        break;
+      case 'Z': {
+        const char *sep = strchr(v,'/');
+        if ((sep == NULL) || (sep - v >= (int)sizeof(push.timezone[0]))
+            || (strlen(sep + 1) >= sizeof(push.timezone[1]))) return false;
+        memcpy(push.timezone[0],v,sep - v);
+        push.timezone[0][sep - v] = '\0';
+        strcpy(push.timezone[1],sep + 1);
+        push.fields |= PUSH_TIMEZONE;
+        break;
+      }
+      default:
+        return false;
+    }
+  }
+  return true;
+}
+
+
+/* Applies the pushed settings.  The timezone (kept in its own EEPROM
+   record) is saved first, so the version is only saved once all the
+   settings are: a drone that loses power part way through applies the
+   push again when it is repeated.  Returns true if any interval
+   changed. */
+static bool applyConfigPush(const ConfigPush &push, const uint16_t version) {
+  if (push.fields & PUSH_TIMEZONE) setTimezone(push.timezone[0],push.timezone[1]);
+  PodConfigStruct &config = getPodConfig();
+  bool ratesChanged = false;
+  for (uint8_t k = 0; k < SENSOR_CHANNEL_COUNT; k++) {
+    if (!(push.fields & (PUSH_RATE_FIRST << k))) continue;
+    if (getRate((SensorChannel)k) == push.rates[k]) continue;
+    setRate((SensorChannel)k,push.rates[k]);
+    ratesChanged = true;
+  }
+  if ((push.fields & PUSH_UPLOAD) && (config.uploadT != push.uploadT)) {
+    config.uploadT = push.uploadT;
+    ratesChanged = true;
+  }
+  if (push.fields & PUSH_PROJECT) strcpy(config.project,push.project);
+  if (push.fields & PUSH_ROOM) strcpy(config.room,push.room);
+  if (push.fields & PUSH_NETID) strcpy(config.networkID,push.networkID);
+  config.pushVersion = version;
+  storePodConfig();
+  if (ratesChanged) updateSensorTimers();
+  return ratesChanged;
+}
+
+
+void processConfigPushPacket(const String &packet) {
+  char version[6], target[17];
+  const char *p = packet.c_str();
+  if ((p[0] != 'K') || (p[1] != ',')
+      || ((p = copyXBeePacketField(p + 2,version,sizeof(version),false)) == NULL)
+      || ((p = copyXBeePacketField(p,target,sizeof(target),false)) == NULL)) {
+    Serial.println(F("Warning: Received invalid settings packet (ignoring)."));
+    return;
+  }
+  if ((strcmp(target,"*") != 0) && (strcmp(target,getDevID()) != 0)) return;
+  const uint16_t v = (uint16_t)atol(version);
+
+  // Checksum: last field, covering everything before it
+  const char *c = strrchr(p - 1,',');
+  if ((c == NULL) || (strlen(c + 1) != 4)
+      || (strtoul(c + 1,NULL,16) != crc16(0xFFFF,packet.c_str(),c + 1 - packet.c_str()))) {
+    Serial.println(F("Warning: Received damaged settings packet (ignoring)."));
+    sendConfigAck(v,PUSH_CHECKSUM);
+    return;
+  }
+
+  // Already applied: only answer
+  if (v == getPodConfig().pushVersion) {
+    sendConfigAck(v,PUSH_APPLIED);
+    return;
+  }
+
+  // All fields are checked before any is applied
+  ConfigPush push;
+  memset(&push,0,sizeof(push));
+  String fields = packet.substring(p - packet.c_str(),c + 1 - packet.c_str());
+  if (!parseConfigPushFields(fields.c_str(),push)) {
+    Serial.print(F("Warning: Settings version "));
+    Serial.print(v);
+    Serial.println(F(" from coordinator not valid (ignoring)."));
+    sendConfigAck(v,PUSH_INVALID);
+    return;
+  }
+  const bool ratesChanged = applyConfigPush(push,v);
+  Serial.print(F("Settings version "));
+  Serial.print(v);
+  Serial.println(F(" from coordinator applied."));
+  sendConfigAck(v,PUSH_APPLIED);
+  // Reported once the answer is sent (maintainConfigPush())
+  pushAck.report = true;
+  if (ratesChanged) pushAck.ratesChanged = true;
+}
+
+
+//------------------------------------------------------------------------------
+// Prints the current push and the drones' versions to serial.
+//
+void printConfigPushStatus() {
+  initConfigPush();
+  if ((pushTables == NULL) || (pushTables->record.version == 0)) {
+    Serial.println(F("Settings push: none"));
+    return;
+  }
+  char buff[CONFIG_PUSH_PACKET_LEN];
+  const size_t n = formatConfigPushPacket(buff);
+  Serial.print(F("Settings push: version "));
+  Serial.print(pushTables->record.version);
+  Serial.print(F(", sent "));
+  Serial.print(pushTables->state.sent);
+  Serial.print(F(" times, "));
+  Serial.print(n);
+  Serial.print(F(" bytes ("));
+  // 10 bits per byte at 9600 baud, plus framing
+  Serial.print((n + 5) * 10 / 9.6,0);
+  Serial.println(F(" ms to send)"));
+  Serial.print(F("  "));
+  Serial.println(buff);
+  if (getModeCoord() && !isConfigPushWaiting()) {
+    Serial.println(F("  All drones answered."));
+  }
+  bool header = false;
+  for (uint8_t k = 0; k < CONFIG_PUSH_DRONES; k++) {
+    const ConfigPushDrone &d = pushTables->drones[k];
+    if (d.devid[0] == '\0') continue;
+    if (!header) {
+      Serial.println(F("  Drone               version  status     last seen [s]"));
+      header = true;
+    }
+    Serial.print(F("  "));
+    Serial.print(d.devid);
+    for (size_t j = strlen(d.devid); j < 18; j++) Serial.print(' ');
+    if (d.status == PUSH_PENDING) {
+      Serial.print(F("      -  "));
+    } else {
+      sprintf(buff," %6u  ",d.version);
+      Serial.print(buff);
+    }
+    PGM_P status = (PGM_P)pgm_read_word(&PUSH_STATUS_NAMES[d.status]);
+    Serial.print((FType)status);
+    for (size_t j = strlen_P(status); j < 10; j++) Serial.print(' ');
+    Serial.println((millis() - d.seen) / 1000);
+  }
+}
+
+
+//==============================================================================
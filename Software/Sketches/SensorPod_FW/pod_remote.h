@@ -0,0 +1,131 @@
+/*==============================================================================
+  Remote configuration of drones over XBee.
+
+  This file is part of the LMN PODD distribution:
+    https://github.com/lmnts/PODD
+
+  CONTRIBUTORS:
+    PODD contributors (2026)
+
+  COPYRIGHT/LICENSE:
+  Copyright (c) 2026 LMN Architects
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Affero General Public License as
+  published by the Free Software Foundation, either version 3 of the
+  License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Affero General Public License for more details.
+
+  You should have received a copy of the GNU Affero General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+==============================================================================*/
+
+#pragma once
+
+// Standard libraries
+// Contributed libraries
+#include <Arduino.h>
+// Local headers
+#include "pod_config.h"
+
+
+// Constants/global variables ==================================================
+
+// Settings pushed by the coordinator to all drones, or to one drone,
+// over XBee.  Only the selected settings are sent, as a single packet:
+//   K,VERSION,TARGET,FIELD,...,CRC
+// with TARGET a device ID or '*' for all drones, each FIELD a tag
+// character followed by the value, and CRC the CRC-16 (4 hexadecimal
+// digits) of everything before it.  Tags:
+//   L H G S C P O  sensor intervals [s] (SensorChannel order)
+//   U              upload interval [s]
+//   J  project name     M  room/location
+//   N  network ID       Z  timezone labels (e.g. "PST/PDT")
+// A drone checks the whole packet before changing anything, then
+// saves the settings together with the version (the timezone first,
+// in its own record) and answers, at a random time within
+// CONFIG_ACK_SPREAD so the answers to a broadcast do not collide:
+//   A,DEVID,VERSION,STATUS
+// A drone already on the version only answers, so the coordinator can
+// repeat the packet until every drone has it.
+enum ConfigPushField : uint16_t {
+  PUSH_RATE_FIRST = 0x0001,   // sensor intervals: PUSH_RATE_FIRST << channel
+  PUSH_UPLOAD     = 0x0080,
+  PUSH_PROJECT    = 0x0100,
+  PUSH_ROOM       = 0x0200,
+  PUSH_NETID      = 0x0400,
+  PUSH_TIMEZONE   = 0x0800
+};
+#define PUSH_RATES ((PUSH_RATE_FIRST << SENSOR_CHANNEL_COUNT) - 1)
+
+// Drone answer to a pushed configuration.
+enum ConfigPushStatus : uint8_t {
+  PUSH_APPLIED,     // settings applied (or already applied)
+  PUSH_CHECKSUM,    // packet damaged (CRC mismatch)
+  PUSH_INVALID,     // a setting is out of range: nothing applied
+  PUSH_PENDING      // no answer yet (coordinator only)
+};
+
+// Settings to push.  Only those selected in fields are sent.
+struct ConfigPush {
+  char target[17];    // device ID, or "*" for all drones
+  uint16_t fields;    // ConfigPushField bits
+  int rates[SENSOR_CHANNEL_COUNT];
+  int uploadT;
+  char project[17];
+  char room[17];
+  char networkID[5];
+  char timezone[2][6];
+};
+
+// Longest packet: all fields at their longest.
+#define CONFIG_PUSH_PACKET_LEN 160
+
+// Drones tracked by the coordinator (those it has heard from).
+#define CONFIG_PUSH_DRONES 16
+// Drones not heard from in this long [s] are no longer waited for.
+#define CONFIG_PUSH_DRONE_TIMEOUT 3600
+// Interval [s] between repeats of a push while drones have not
+// answered: doubles after each repeat, up to the maximum.
+#define CONFIG_PUSH_RETRY_MIN 15
+#define CONFIG_PUSH_RETRY_MAX 900
+// Drones answer after a random delay of up to this long [ms]: at 9600
+// baud, an answer takes under 40 ms, so a full mesh fits with room.
+#define CONFIG_ACK_SPREAD 3000
+
+
+// Functions ===================================================================
+
+// Allocates the coordinator's push state and loads the current push
+// (nothing on drones).  Called from setup(), once the role is set, and
+// by the coordinator functions below if the menu needs it earlier.
+void initConfigPush();
+
+// Starts pushing the given settings to drones (coordinator), as the
+// next version.  Returns false if a setting cannot be sent.
+bool startConfigPush(const ConfigPush &push);
+// Sends or repeats the current push as needed (coordinator), or a
+// drone's answer once due.  Called from the main loop.
+void maintainConfigPush();
+// Time until maintainConfigPush() next has something to do on a drone
+// [ms] (0xFFFFFFFF if no answer is waiting).
+unsigned long getConfigPushIdleTime();
+
+// Handles a configuration packet from the coordinator (drones).
+void processConfigPushPacket(const String &packet);
+// Handles a drone's answer (coordinator).
+void processConfigAckPacket(const String &packet);
+// Notes that a drone with the given device ID was heard from
+// (coordinator).
+void noteConfigPushDrone(const char *devid);
+
+// Prints the current push and the drones' versions to serial.
+void printConfigPushStatus();
+
+
+//==============================================================================
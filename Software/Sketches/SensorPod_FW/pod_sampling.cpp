@@ -0,0 +1,205 @@
+/*==============================================================================
+  Adaptive sensor sampling intervals.
+
+  This file is part of the LMN PODD distribution:
+    https://github.com/lmnts/PODD
+
+  CONTRIBUTORS:
+    PODD contributors (2026)
+
+  COPYRIGHT/LICENSE:
+  Copyright (c) 2026 LMN Architects
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Affero General Public License as
+  published by the Free Software Foundation, either version 3 of the
+  License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Affero General Public License for more details.
+
+  You should have received a copy of the GNU Affero General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+==============================================================================*/
+
+#include "pod_sampling.h"
+#include "pod_util.h"
+
+
+// Global variables ============================================================
+
+// Adaptive sampling: after each reading, the rate of change since the
+// previous reading is compared with the sensor's threshold.  Above the
+// threshold, the interval is halved (down to the minimum); below half
+// the threshold, it grows by half (up to the configured interval).
+// The gap between the two avoids flipping back and forth around the
+// threshold.  Multi-value sensors adapt on their first reading type.
+struct SamplingState {
+  AlarmID_t alarm;
+  uint16_t interval;    // current interval [s]
+  float last;           // previous reading
+  time_t lastUTC;
+  bool valid;           // previous reading available
+};
+SamplingState samplingState[SENSOR_CHANNEL_COUNT];
+bool samplingInitialized = false;
+
+// Sensor names for status output.
+static const char SENSOR_NAME_LIGHT[] PROGMEM     = "Light";
+static const char SENSOR_NAME_RH[] PROGMEM        = "Temp/humidity";
+static const char SENSOR_NAME_GLOBETEMP[] PROGMEM = "Radiant temp";
+static const char SENSOR_NAME_SOUND[] PROGMEM     = "Sound";
+static const char SENSOR_NAME_CO2[] PROGMEM       = "CO2";
+static const char SENSOR_NAME_PM[] PROGMEM        = "Particulates";
+static const char SENSOR_NAME_CO[] PROGMEM        = "CO";
+static const char * const SENSOR_NAMES[SENSOR_CHANNEL_COUNT] PROGMEM = {
+  SENSOR_NAME_LIGHT, SENSOR_NAME_RH, SENSOR_NAME_GLOBETEMP,
+  SENSOR_NAME_SOUND, SENSOR_NAME_CO2, SENSOR_NAME_PM, SENSOR_NAME_CO
+};
+
+
+// Functions ===================================================================
+
+/* Marks all sensors as unregistered (no alarm). */
+void initSamplingState() {
+  for (uint8_t k = 0; k < SENSOR_CHANNEL_COUNT; k++) {
+    samplingState[k].alarm = dtINVALID_ALARM_ID;
+    samplingState[k].interval = 0;
+    samplingState[k].valid = false;
+  }
+  samplingInitialized = true;
+}
+
+
+PGM_P getSensorName(const SensorChannel ch) {
+  if (ch >= SENSOR_CHANNEL_COUNT) return PSTR("");
+  return (PGM_P)pgm_read_word(&SENSOR_NAMES[ch]);
+}
+
+
+SensorChannel getReadingChannel(const ReadingType type) {
+  switch (type) {
+    case READING_LIGHT:     return SENSOR_LIGHT;
+    case READING_HUMIDITY:  return SENSOR_RH;
+    case READING_AIRTEMP:   return SENSOR_RH;
+    case READING_GLOBETEMP: return SENSOR_GLOBETEMP;
+    case READING_SOUND:     return SENSOR_SOUND;
+    case READING_CO2:       return SENSOR_CO2;
+    case READING_PM2_5:     return SENSOR_PM;
+    case READING_PM10:      return SENSOR_PM;
+    case READING_CO:        return SENSOR_CO;
+    default:                return SENSOR_CHANNEL_COUNT;
+  }
+}
+
+
+void registerSamplingAlarm(const SensorChannel ch, const AlarmID_t id) {
+  if (!samplingInitialized) initSamplingState();
+  if (ch >= SENSOR_CHANNEL_COUNT) return;
+  SamplingState &state = samplingState[ch];
+  state.alarm = id;
+  state.interval = (id == dtINVALID_ALARM_ID) ? 0 : getRate(ch);
+  state.valid = false;
+}
+
+
+void registerSamplingSchedule(const SensorChannel ch, const uint16_t interval) {
+  if (!samplingInitialized) initSamplingState();
+  if (ch >= SENSOR_CHANNEL_COUNT) return;
+  SamplingState &state = samplingState[ch];
+  state.alarm = dtINVALID_ALARM_ID;
+  state.interval = interval;
+  state.valid = false;
+}
+
+
+bool setSamplingRate(const SensorChannel ch, const uint16_t rate) {
+  if (!samplingInitialized || (ch >= SENSOR_CHANNEL_COUNT)) return false;
+  SamplingState &state = samplingState[ch];
+  if (state.alarm == dtINVALID_ALARM_ID) return false;
+  state.valid = false;
+  if (rate == state.interval) return true;
+  state.interval = rate;
+  if (rate > 0) {
+    Alarm.write(state.alarm,rate);
+  } else {
+    // A disabled alarm still counts in Alarm.getNextTrigger(), where
+    // its stale trigger would keep the drone from idling (pod_idle.h)
+    Alarm.free(state.alarm);
+    state.alarm = dtINVALID_ALARM_ID;
+  }
+  return true;
+}
+
+
+void adaptSampling(const Reading *r, const uint8_t n) {
+  if ((n == 0) || !samplingInitialized) return;
+  const SensorChannel ch = getReadingChannel(r[0].type);
+  // The PM sensor follows its duty-cycle plan (see pod_pmplan.h), so
+  // its interval is not adapted.
+  if ((ch >= SENSOR_CHANNEL_COUNT) || (ch == SENSOR_PM)) return;
+  SamplingState &state = samplingState[ch];
+  const int maxT = getRate(ch);
+  const int minT = getAdaptiveMin(ch);
+  if ((state.alarm == dtINVALID_ALARM_ID) || (minT <= 0) || (minT >= maxT)) return;
+  if (isnan(r[0].value)) return;
+
+  // Rate of change [units/minute] since the previous reading
+  const bool hadLast = state.valid && (r[0].utc > state.lastUTC);
+  const float rate = hadLast ? 60 * fabs(r[0].value - state.last) / (r[0].utc - state.lastUTC) : 0;
+  state.last = r[0].value;
+  state.lastUTC = r[0].utc;
+  state.valid = true;
+  if (!hadLast) return;
+
+  const float threshold = getAdaptiveThreshold(ch);
+  int interval = state.interval;
+  if (rate > threshold) {
+    interval = interval / 2;
+  } else if (rate < threshold / 2) {
+    interval = interval + (interval + 1) / 2;
+  }
+  if (interval < minT) interval = minT;
+  if (interval > maxT) interval = maxT;
+  if (interval == state.interval) return;
+  state.interval = interval;
+  // Restarts the timer: the next reading is one interval from now.
+  Alarm.write(state.alarm,interval);
+}
+
+
+uint16_t getSamplingInterval(const SensorChannel ch) {
+  if (!samplingInitialized || (ch >= SENSOR_CHANNEL_COUNT)) return 0;
+  return samplingState[ch].interval;
+}
+
+
+//------------------------------------------------------------------------------
+// Prints the current sampling intervals to serial.
+// 
+void printSamplingStatus() {
+  char buff[32];
+  Serial.println(F("Sampling intervals [s]:   current  (min - max)"));
+  for (uint8_t k = 0; k < SENSOR_CHANNEL_COUNT; k++) {
+    const SensorChannel ch = (SensorChannel)k;
+    const uint16_t interval = getSamplingInterval(ch);
+    if (interval == 0) continue;
+    const int minT = getAdaptiveMin(ch);
+    PGM_P name = getSensorName(ch);
+    Serial.print(F("  "));
+    Serial.print((FType)name);
+    for (size_t j = strlen_P(name); j < 20; j++) Serial.print(' ');
+    if ((minT > 0) && (minT < getRate(ch))) {
+      sprintf(buff," %8u  (%d - %d)",interval,minT,getRate(ch));
+    } else {
+      sprintf(buff," %8u  (fixed)",interval);
+    }
+    Serial.println(buff);
+  }
+}
+
+
+//==============================================================================
@@ -0,0 +1,76 @@
+/*==============================================================================
+  Adaptive sensor sampling intervals.
+
+  This file is part of the LMN PODD distribution:
+    https://github.com/lmnts/PODD
+
+  CONTRIBUTORS:
+    PODD contributors (2026)
+
+  COPYRIGHT/LICENSE:
+  Copyright (c) 2026 LMN Architects
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Affero General Public License as
+  published by the Free Software Foundation, either version 3 of the
+  License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Affero General Public License for more details.
+
+  You should have received a copy of the GNU Affero General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+==============================================================================*/
+
+#pragma once
+
+// Standard libraries
+// Contributed libraries
+#include <Arduino.h>
+#include <TimeAlarms.h>
+// Local headers
+#include "pod_config.h"
+#include "pod_network.h"
+
+
+// Constants/global variables ==================================================
+
+
+// Functions ===================================================================
+
+// Sensor channel whose interval determines when the given reading type
+// is taken.
+SensorChannel getReadingChannel(const ReadingType type);
+// Name of the given sensor for status output (in program memory).
+PGM_P getSensorName(const SensorChannel ch);
+
+// Registers the repeating alarm that takes readings for the given
+// sensor, starting at its configured interval.  Adaptive sampling is
+// applied to registered sensors with a minimum interval configured
+// (see PodConfigStruct).
+void registerSamplingAlarm(const SensorChannel ch, const AlarmID_t id);
+// Registers a sensor read on a fixed interval [s] by its own scheduler
+// rather than an alarm (no adaptive sampling).
+void registerSamplingSchedule(const SensorChannel ch, const uint16_t interval);
+
+// Changes the interval [s] of a sensor read by a registered alarm to
+// the given one (0 to disable it, freeing the alarm), restarting its
+// timer.  Returns false if the sensor has no alarm registered.
+bool setSamplingRate(const SensorChannel ch, const uint16_t rate);
+
+// Adjusts the sampling interval of the sensor that produced the given
+// readings (see below) and reschedules its alarm if needed.  Intended
+// to be called after each set of readings is logged.
+void adaptSampling(const Reading *r, const uint8_t n);
+
+// Current sampling interval [s] of the given sensor (0 if disabled).
+uint16_t getSamplingInterval(const SensorChannel ch);
+
+// Prints the current sampling intervals to serial.
+void printSamplingStatus();
+
+
+//==============================================================================
@@ -13,6 +13,7 @@
 #include "pod_util.h"
 #include "pod_serial.h"
 #include "pod_config.h"
+#include "pod_trace.h"
 
 #include <limits.h>
 
@@ -948,8 +949,8 @@ bool isSoundSampling() {
 }
 
 
-/* Takes a sound sample.  Intended to be run as a timer-based ISR. */
-void sampleSoundISR() {
+/* Takes a sound sample (body of sampleSoundISR). */
+static inline void sampleSound() {
   if (!soundSampling) return;
   // Take most recent measurement from continuously-sampling ADC.
   // Will return -1 if no new measurement available or if ADC not
@@ -964,6 +965,14 @@ void sampleSoundISR() {
 }
 
 
+/* Takes a sound sample.  Intended to be run as a timer-based ISR. */
+void sampleSoundISR() {
+  TRACE_BEGIN(TRACE_ISR_SOUND);
+  sampleSound();
+  TRACE_END(TRACE_ISR_SOUND);
+}
+
+
 /* Resets accumulated sound data for a new round of sound sampling.
    ISR-safe. */
 void resetSoundData() {
@@ -2225,3 +2234,47 @@ void testPMSensor(unsigned long cycles, unsigned long sampleInterval,
 }
 #endif
 //<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+/* Sensor routine benchmarks (see runBenchmarks()).  The sound ISR is
+   timed on its full path (a new ADC sample available, which occurs at
+   most once per conversion) without starting timer-driven sampling. */
+// Benchmark testing >>>>>>>>>>>>>>>>>>>
+#ifdef BENCHMARK_TESTING
+SoundData benchSoundData;
+int benchSoundValue = 0;
+uint8_t benchSPS30Data[6];
+volatile float benchSensorSink;
+void benchSoundDataAdd() {benchSoundData.add(benchSoundValue++ & 0x3FF);}
+void benchWaitADCSample() {while (!(ADCSRA & (1 << ADIF))) continue;}
+void benchGlobeTemperature() {benchSensorSink = getGlobeTemperature();}
+void benchExtractSPS30Float() {benchSensorSink = extractSPS30Float(benchSPS30Data);}
+
+void benchmarkSensors() {
+  benchSoundData.reset();
+  runBenchmark(F("SoundData::add"),benchSoundDataAdd,256);
+  
+  initADC();
+  stopSoundSampling();
+  soundData.reset();
+  startADCFreeRunning();
+  soundSampling = true;
+  BenchmarkStats isr = runBenchmark(F("sampleSoundISR"),sampleSoundISR,256,benchWaitADCSample);
+  soundSampling = false;
+  stopADCFreeRunning();
+  soundData.reset();
+  printISRBudget(F("sampleSoundISR"),isr.max,SOUND_SAMPLE_INTERVAL_US);
+  
+  runBenchmark(F("getGlobeTemperature"),benchGlobeTemperature,32);
+  
+  // 12.5 as a big-endian IEEE754 float, split into two checksummed words
+  benchSPS30Data[0] = 0x41;
+  benchSPS30Data[1] = 0x48;
+  benchSPS30Data[2] = calcSPS30Checksum(&benchSPS30Data[0]);
+  benchSPS30Data[3] = 0x00;
+  benchSPS30Data[4] = 0x00;
+  benchSPS30Data[5] = calcSPS30Checksum(&benchSPS30Data[3]);
+  runBenchmark(F("extractSPS30Float"),benchExtractSPS30Float,64);
+}
+#endif
+//<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
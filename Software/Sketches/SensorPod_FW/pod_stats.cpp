@@ -0,0 +1,246 @@
+/*==============================================================================
+  Runtime performance counters.
+
+  This file is part of the LMN PODD distribution:
+    https://github.com/lmnts/PODD
+
+  CONTRIBUTORS:
+    PODD contributors (2026)
+
+  COPYRIGHT/LICENSE:
+  Copyright (c) 2026 LMN Architects
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Affero General Public License as
+  published by the Free Software Foundation, either version 3 of the
+  License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Affero General Public License for more details.
+
+  You should have received a copy of the GNU Affero General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+==============================================================================*/
+
+#include "pod_stats.h"
+#include "pod_util.h"
+
+
+// Global variables ============================================================
+
+// Interval [ms] over which the loop rate is measured.
+#define LOOP_RATE_INTERVAL 10000
+
+PodStats podStats = {};
+
+// Start of the current loop rate interval and loop count at its start.
+unsigned long loopRateStart = 0;
+uint32_t loopRateLoops = 0;
+
+
+// Functions ===================================================================
+
+void countReading(const ReadingType type) {
+  if (type < READING_SD_COUNT) podStats.readings[type]++;
+}
+
+
+void countReadFailure(const ReadingType type) {
+  if (type < READING_SD_COUNT) podStats.readFailures[type]++;
+}
+
+
+/* Records the quality flags of a reading (nothing if none). */
+void countReadingFlags(const ReadingType type, const uint8_t flags) {
+  if ((flags == 0) || (type >= READING_SD_COUNT)) return;
+  podStats.readingsFlagged[type]++;
+  for (uint8_t k = 0; k < QUALITY_FLAG_COUNT; k++) {
+    if (flags & (1 << k)) podStats.qualityFlags[k]++;
+  }
+}
+
+
+void countReadingSuppressed() {
+  podStats.readingsSuppressed++;
+}
+
+
+/* Records an SD write of the given size; a write of zero bytes is
+   counted as an error (file not open or card not available). */
+void countSDWrite(const size_t bytes, const bool flushed) {
+  if (bytes == 0) {
+    podStats.sdErrors++;
+    return;
+  }
+  podStats.sdBytes += bytes;
+  if (flushed) podStats.sdFlushes++;
+}
+
+
+void countXBeeSent(const size_t bytes) {
+  podStats.xbeeBytesOut += bytes;
+  podStats.xbeePacketsOut++;
+}
+
+
+void countPacketDropped(const PacketDropReason reason) {
+  if (reason < PACKET_DROP_REASON_COUNT) podStats.packetsDropped[reason]++;
+}
+
+
+void countPost(const bool success, const unsigned long ms) {
+  if (success) {
+    podStats.postSuccesses++;
+  } else {
+    podStats.postFailures++;
+  }
+  podStats.postTimeTotal += ms;
+  if (ms > podStats.postTimeMax) podStats.postTimeMax = ms;
+}
+
+
+void countPostTimeout() {
+  podStats.postTimeouts++;
+}
+
+
+/* Records one main loop iteration of the given duration [us] and
+   updates the loop rate at the end of each interval. */
+void countLoop(const unsigned long us) {
+  podStats.loops++;
+  if (us > podStats.loopTimeMax) podStats.loopTimeMax = us;
+  const unsigned long now = millis();
+  if (loopRateStart == 0) {
+    loopRateStart = now;
+    loopRateLoops = podStats.loops;
+  } else if (now - loopRateStart >= LOOP_RATE_INTERVAL) {
+    podStats.loopRate = (1000.0 * (podStats.loops - loopRateLoops)) / (now - loopRateStart);
+    loopRateStart = now;
+    loopRateLoops = podStats.loops;
+  }
+}
+
+
+const PodStats& getPodStats() {
+  return podStats;
+}
+
+
+uint32_t getReadFailures() {
+  uint32_t n = 0;
+  for (uint8_t k = 0; k < READING_SD_COUNT; k++) n += podStats.readFailures[k];
+  return n;
+}
+
+
+uint32_t getReadingsFlagged() {
+  uint32_t n = 0;
+  for (uint8_t k = 0; k < READING_SD_COUNT; k++) n += podStats.readingsFlagged[k];
+  return n;
+}
+
+
+uint32_t getPacketsDropped() {
+  uint32_t n = 0;
+  for (uint8_t k = 0; k < PACKET_DROP_REASON_COUNT; k++) n += podStats.packetsDropped[k];
+  return n;
+}
+
+
+//------------------------------------------------------------------------------
+// Prints all counters to serial.
+// 
+void printPodStats() {
+  const PodStats &s = podStats;
+  uint32_t xbeeIn, xbeeOverrun, packetsParsed;
+  getXBeeCounters(xbeeIn,xbeeOverrun,packetsParsed);
+  char buff[48];
+
+  Serial.print(F("Runtime statistics (uptime "));
+  Serial.print(millis()/1000);
+  Serial.println(F(" s):"));
+
+  Serial.print(F("  Main loop:      "));
+  Serial.print(s.loops);
+  Serial.print(F(" iterations, "));
+  Serial.print(s.loopRate);
+  Serial.print(F("/s, max "));
+  Serial.print(s.loopTimeMax);
+  Serial.println(F(" us"));
+
+  Serial.println(F("  Sensor readings:     taken    failed   flagged"));
+  for (uint8_t k = 0; k < READING_SD_COUNT; k++) {
+    if ((s.readings[k] == 0) && (s.readFailures[k] == 0)) continue;
+    char name[READING_NAME_LEN];
+    formatReadingName(name,(ReadingType)k);
+    sprintf(buff,"    %-12s %8lu  %8u  %8u",name,(unsigned long)s.readings[k],
+            s.readFailures[k],s.readingsFlagged[k]);
+    Serial.println(buff);
+  }
+  Serial.print(F("    (flagged: "));
+  for (uint8_t k = 0; k < QUALITY_FLAG_COUNT; k++) {
+    if (k > 0) Serial.print(F(", "));
+    Serial.print(s.qualityFlags[k]);
+    Serial.print(' ');
+    Serial.print(formatQualityFlags(buff,1 << k));
+  }
+  Serial.println(')');
+  Serial.print(F("    (not sent, within deadband: "));
+  Serial.print(s.readingsSuppressed);
+  Serial.println(F(")"));
+
+  Serial.print(F("  SD card:        "));
+  Serial.print(s.sdBytes);
+  Serial.print(F(" bytes, "));
+  Serial.print(s.sdFlushes);
+  Serial.print(F(" flushes, "));
+  Serial.print(s.sdErrors);
+  Serial.println(F(" errors"));
+
+  Serial.print(F("  XBee:           in "));
+  Serial.print(xbeeIn);
+  Serial.print(F(" bytes (overrun "));
+  Serial.print(xbeeOverrun);
+  Serial.print(F("), out "));
+  Serial.print(s.xbeeBytesOut);
+  Serial.print(F(" bytes in "));
+  Serial.print(s.xbeePacketsOut);
+  Serial.println(F(" packets"));
+
+  Serial.print(F("  XBee packets:   "));
+  Serial.print(packetsParsed);
+  Serial.print(F(" parsed, "));
+  Serial.print(getPacketsDropped());
+  Serial.print(F(" dropped ("));
+  Serial.print(s.packetsDropped[PACKET_DROP_TRUNCATED]);
+  Serial.print(F(" truncated, "));
+  Serial.print(s.packetsDropped[PACKET_DROP_EMPTY]);
+  Serial.print(F(" empty, "));
+  Serial.print(s.packetsDropped[PACKET_DROP_NO_LENGTH]);
+  Serial.print(F(" no length, "));
+  Serial.print(s.packetsDropped[PACKET_DROP_LENGTH]);
+  Serial.print(F(" bad length, "));
+  Serial.print(s.packetsDropped[PACKET_DROP_MALFORMED]);
+  Serial.print(F(" malformed, "));
+  Serial.print(s.packetsDropped[PACKET_DROP_UNKNOWN]);
+  Serial.println(F(" unknown)"));
+
+  Serial.print(F("  HTTP POST:      "));
+  Serial.print(s.postSuccesses);
+  Serial.print(F(" sent ("));
+  Serial.print(s.postTimeouts);
+  Serial.print(F(" without response), "));
+  Serial.print(s.postFailures);
+  Serial.print(F(" failed, mean "));
+  const uint32_t posts = s.postSuccesses + s.postFailures;
+  Serial.print(posts > 0 ? s.postTimeTotal / posts : 0);
+  Serial.print(F(" ms, max "));
+  Serial.print(s.postTimeMax);
+  Serial.println(F(" ms"));
+}
+
+
+//==============================================================================
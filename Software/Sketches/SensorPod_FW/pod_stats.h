@@ -0,0 +1,116 @@
+/*==============================================================================
+  Runtime performance counters.
+
+  This file is part of the LMN PODD distribution:
+    https://github.com/lmnts/PODD
+
+  CONTRIBUTORS:
+    PODD contributors (2026)
+
+  COPYRIGHT/LICENSE:
+  Copyright (c) 2026 LMN Architects
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Affero General Public License as
+  published by the Free Software Foundation, either version 3 of the
+  License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Affero General Public License for more details.
+
+  You should have received a copy of the GNU Affero General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+==============================================================================*/
+
+#pragma once
+
+// Standard libraries
+// Contributed libraries
+#include <Arduino.h>
+// Local headers
+#include "pod_network.h"
+#include "pod_quality.h"
+
+
+// Constants/global variables ==================================================
+
+// Reasons an incoming XBee packet is dropped.
+enum PacketDropReason : uint8_t {
+  PACKET_DROP_TRUNCATED = 0,  // incomplete packet followed by a new start token
+  PACKET_DROP_EMPTY,          // nothing between start and end tokens
+  PACKET_DROP_NO_LENGTH,      // too short to hold the length prefix
+  PACKET_DROP_LENGTH,         // length prefix does not match
+  PACKET_DROP_MALFORMED,      // sensor reading that could not be decoded
+  PACKET_DROP_UNKNOWN,        // unrecognized packet type
+  PACKET_DROP_REASON_COUNT
+};
+
+// Counters accumulated since startup.  Only updated from the main
+// thread; the XBee receive counters are kept by the read ISR and are
+// available through getXBeeCounters().
+struct PodStats {
+  // Sensor readings taken and failed read attempts, by type.  Failures
+  // of multi-value sensors count against their first type.
+  uint32_t readings[READING_SD_COUNT];
+  uint16_t readFailures[READING_SD_COUNT];
+  // Readings with quality flags, by type and by flag (see
+  // pod_quality.h)
+  uint16_t readingsFlagged[READING_SD_COUNT];
+  uint16_t qualityFlags[QUALITY_FLAG_COUNT];
+  // Readings logged to SD but not sent (report-by-exception)
+  uint32_t readingsSuppressed;
+  // SD card data/diagnostics writes: bytes, flushes/closes, and
+  // writes that failed (nothing written)
+  uint32_t sdBytes;
+  uint32_t sdFlushes;
+  uint16_t sdErrors;
+  // XBee transmission
+  uint32_t xbeeBytesOut;
+  uint32_t xbeePacketsOut;
+  // Dropped incoming XBee packets, by reason
+  uint16_t packetsDropped[PACKET_DROP_REASON_COUNT];
+  // HTTP POST requests: accepted, failed (no connection), accepted
+  // without a server response before timeout, and duration [ms]
+  uint32_t postSuccesses;
+  uint32_t postFailures;
+  uint32_t postTimeouts;
+  uint32_t postTimeTotal;
+  uint32_t postTimeMax;
+  // Main loop iterations and longest iteration [us].  On drones, each
+  // iteration includes the Alarm.delay() wait.
+  uint32_t loops;
+  uint32_t loopTimeMax;
+  // Loop iterations per second over the last LOOP_RATE_INTERVAL
+  float loopRate;
+};
+
+
+// Functions ===================================================================
+
+// Counter updates.
+void countReading(const ReadingType type);
+void countReadFailure(const ReadingType type);
+void countReadingFlags(const ReadingType type, const uint8_t flags);
+void countReadingSuppressed();
+void countSDWrite(const size_t bytes, const bool flushed=true);
+void countXBeeSent(const size_t bytes);
+void countPacketDropped(const PacketDropReason reason);
+void countPost(const bool success, const unsigned long ms);
+void countPostTimeout();
+void countLoop(const unsigned long us);
+
+// Current counter values.
+const PodStats& getPodStats();
+// Totals across sensor types/drop reasons.
+uint32_t getReadFailures();
+uint32_t getReadingsFlagged();
+uint32_t getPacketsDropped();
+
+// Prints all counters to serial.
+void printPodStats();
+
+
+//==============================================================================
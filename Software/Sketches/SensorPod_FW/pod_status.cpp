@@ -0,0 +1,496 @@
+/*==============================================================================
+  Coordinator status: latest readings from each drone, served as JSON
+  over the local network.
+
+  This file is part of the LMN PODD distribution:
+    https://github.com/lmnts/PODD
+
+  CONTRIBUTORS:
+    PODD contributors (2026)
+
+  COPYRIGHT/LICENSE:
+  Copyright (c) 2026 LMN Architects
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Affero General Public License as
+  published by the Free Software Foundation, either version 3 of the
+  License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Affero General Public License for more details.
+
+  You should have received a copy of the GNU Affero General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+==============================================================================*/
+
+#include "pod_status.h"
+#include "pod_clock.h"
+#include "pod_config.h"
+#include "pod_network.h"
+#include "pod_stats.h"
+#include "pod_util.h"
+
+#include <Ethernet.h>
+#include <TimeLib.h>
+
+
+// Global variables ============================================================
+
+// The tables are only used on the coordinator, which allocates them
+// (initStatusTables()).
+
+// Latest reading of one sensor of a drone.
+struct StatusSensor {
+  float value;
+  uint16_t age;         // before the drone's latest reading [s]
+  uint8_t quality;
+};
+
+// Drones heard from, with their sensors (indexed by ReadingType).
+// Times are millis() values.
+struct StatusDrone {
+  char devid[17];       // empty if unused
+  unsigned long seen;   // last reading
+  uint16_t readings;
+  uint16_t flagged;     // readings with quality flags set
+  uint16_t delay;       // of the last reading [s]
+  time_t utc;           // timestamp of the latest reading
+  uint16_t present;     // sensors with a reading (bit: ReadingType)
+  StatusSensor sensors[READING_SD_COUNT];
+};
+static_assert(READING_SD_COUNT <= 16,"Sensor bitmap is 16 bits");
+StatusDrone *statusDrones = NULL;
+
+// Incremented on each change to the tables, for long polls.
+uint32_t statusVersion = 0;
+
+// The one client being served.
+enum StatusClientState : uint8_t {
+  STATUS_IDLE,
+  STATUS_REQUEST,   // reading the request
+  STATUS_WAITING,   // long poll: waiting for a change
+  STATUS_SENDING    // writing the response, one piece at a time
+};
+struct StatusServerState {
+  StatusClientState state;
+  EthernetClient client;
+  unsigned long started;  // request start, then wait or send start
+  char line[48];          // request line (cut short if longer)
+  uint8_t len;
+  bool lineDone;
+  uint8_t newlines;       // consecutive line ends (2: end of headers)
+  uint32_t since;
+  uint16_t wait;          // [s]
+  uint8_t next;           // next piece: 0 the head, k + 1 drone k, then the tail
+  bool first;             // no drone written yet
+} statusClient;
+
+/* One piece of the response, formatted on the stack so it goes to the
+   client in a single write rather than a character at a time. */
+struct StatusChunk : public Print {
+  char buff[STATUS_CHUNK_LEN];
+  uint16_t len = 0;
+  bool overflow = false;
+  size_t write(uint8_t ch) {
+    if (len >= sizeof(buff)) {
+      overflow = true;
+      return 0;
+    }
+    buff[len++] = ch;
+    return 1;
+  }
+  using Print::write;
+};
+
+EthernetServer statusServer(STATUS_SERVER_PORT);
+bool statusServerStarted = false;
+
+// Server counters.
+struct StatusServerStats {
+  uint32_t requests;      // answered with the tables
+  uint32_t longPolls;     // ...after waiting for a change
+  uint32_t rejected;      // bad requests and clients turned away
+  uint32_t timeouts;      // clients that did not send a request or
+                          // take the response in time
+} statusStats;
+
+
+// Functions ===================================================================
+
+/* Done once, from setup(), so the tables sit at the bottom of the heap
+   for good. */
+void initStatusTables() {
+  if (!getModeCoord() || (statusDrones != NULL)) return;
+  statusDrones = (StatusDrone*)calloc(STATUS_DRONES,sizeof(StatusDrone));
+  if (statusDrones == NULL) {
+    Serial.println(F("WARNING: No memory for the status tables: status server disabled."));
+  }
+}
+
+
+/* Finds the given drone, adding it (in place of the drone not heard
+   from the longest) if not found. */
+static uint8_t findStatusDrone(const char *devid) {
+  uint8_t oldest = 0;
+  for (uint8_t k = 0; k < STATUS_DRONES; k++) {
+    const StatusDrone &d = statusDrones[k];
+    if ((d.devid[0] != '\0') && (strcmp(d.devid,devid) == 0)) return k;
+    if (statusDrones[oldest].devid[0] == '\0') continue;
+    if ((d.devid[0] == '\0') || (millis() - d.seen > millis() - statusDrones[oldest].seen)) oldest = k;
+  }
+  StatusDrone &d = statusDrones[oldest];
+  memset(&d,0,sizeof(d));
+  snprintf(d.devid,sizeof(d.devid),"%s",devid);
+  return oldest;
+}
+
+
+/* Age of a reading taken dt seconds before the reference, capped at
+   STATUS_AGE_MAX. */
+static uint16_t statusAge(const uint32_t age, const uint32_t dt) {
+  return ((dt >= STATUS_AGE_MAX) || (age + dt >= STATUS_AGE_MAX)) ? STATUS_AGE_MAX : age + dt;
+}
+
+
+void updateDroneStatus(const char *devid, const char *sensor, const char *value,
+                       const char *timestamp, const char *quality) {
+  ReadingType type;
+  if ((statusDrones == NULL) || (devid[0] == '\0') || !parseReadingName(sensor,type)) return;
+  StatusDrone &d = statusDrones[findStatusDrone(devid)];
+  const time_t utc = strtoul(timestamp,NULL,10);
+  const uint8_t q = atoi(quality);
+  // Diagnostic readings count towards delivery, but are not kept
+  if (type < READING_SD_COUNT) {
+    // Ages count from the drone's latest reading: a newer one moves
+    // the others back
+    if (d.present == 0) {
+      d.utc = utc;
+    } else if (utc > d.utc) {
+      for (uint8_t j = 0; j < READING_SD_COUNT; j++) {
+        d.sensors[j].age = statusAge(d.sensors[j].age,utc - d.utc);
+      }
+      d.utc = utc;
+    }
+    StatusSensor &s = d.sensors[type];
+    s.value = atof(value);
+    s.age = statusAge(0,d.utc - utc);
+    s.quality = q;
+    d.present |= (1 << type);
+  }
+  d.seen = millis();
+  d.readings++;
+  if (q != 0) d.flagged++;
+  const time_t t = getUTC();
+  d.delay = (t > utc) ? min(t - utc,(time_t)0xFFFF) : 0;
+  statusVersion++;
+}
+
+
+//------------------------------------------------------------------------------
+// JSON output
+
+/* Writes a JSON string, escaping as needed. */
+static void printJSONString(Print &out, const char *s) {
+  out.print('"');
+  for (; *s != '\0'; s++) {
+    if ((*s == '"') || (*s == '\\')) {
+      out.print('\\');
+      out.print(*s);
+    } else if ((uint8_t)*s < 0x20) {
+      out.print(' ');
+    } else {
+      out.print(*s);
+    }
+  }
+  out.print('"');
+}
+
+
+static void printStatusHead(Print &out) {
+  uint32_t received, overrun, parsed;
+  getXBeeCounters(received,overrun,parsed);
+  out.print(F("{\"id\":"));
+  printJSONString(out,getDevID());
+  out.print(F(",\"time\":"));
+  out.print((unsigned long)getUTC());
+  out.print(F(",\"version\":"));
+  out.print(statusVersion);
+  out.print(F(",\"xbee\":{\"received\":"));
+  out.print(received);
+  out.print(F(",\"overrun\":"));
+  out.print(overrun);
+  out.print(F(",\"parsed\":"));
+  out.print(parsed);
+  out.print(F(",\"dropped\":"));
+  out.print(getPacketsDropped());
+  out.print(F("},\"drones\":["));
+}
+
+
+/* Writes the given drone, if in use.  Returns true if written. */
+static bool printStatusDrone(Print &out, const uint8_t k, const bool first) {
+  const StatusDrone &d = statusDrones[k];
+  if (d.devid[0] == '\0') return false;
+  char buff[READING_VALUE_LEN];
+  if (!first) out.print(',');
+  out.print(F("{\"id\":"));
+  printJSONString(out,d.devid);
+  out.print(F(",\"age\":"));
+  out.print((millis() - d.seen) / 1000);
+  out.print(F(",\"readings\":"));
+  out.print(d.readings);
+  out.print(F(",\"flagged\":"));
+  out.print(d.flagged);
+  out.print(F(",\"delay\":"));
+  out.print(d.delay);
+  out.print(F(",\"sensors\":{"));
+  bool firstSensor = true;
+  for (uint8_t j = 0; j < READING_SD_COUNT; j++) {
+    if (!(d.present & (1 << j))) continue;
+    const StatusSensor &s = d.sensors[j];
+    const ReadingType type = (ReadingType)j;
+    const time_t utc = d.utc - s.age;
+    if (!firstSensor) out.print(',');
+    firstSensor = false;
+    printJSONString(out,formatReadingName(buff,type));
+    out.print(F(":{\"v\":"));
+    const Reading r = {utc, s.value, type, s.quality};
+    formatReadingValue(buff,r);
+    // NaN and infinity are not valid JSON numbers
+    if (isnan(s.value) || isinf(s.value)) {
+      out.print(F("null"));
+    } else {
+      out.print(buff);
+    }
+    out.print(F(",\"t\":"));
+    out.print((unsigned long)utc);
+    out.print(F(",\"q\":"));
+    out.print(s.quality);
+    out.print('}');
+  }
+  out.print(F("}}"));
+  return true;
+}
+
+
+static void printStatusTail(Print &out) {
+  out.print(F("]}"));
+}
+
+
+void printStatusJSON(Print &out) {
+  printStatusHead(out);
+  bool first = true;
+  for (uint8_t k = 0; (statusDrones != NULL) && (k < STATUS_DRONES); k++) {
+    if (printStatusDrone(out,k,first)) first = false;
+  }
+  printStatusTail(out);
+}
+
+
+//------------------------------------------------------------------------------
+// Server
+
+/* Writes a response without a body and closes the connection. */
+static void rejectStatusClient(EthernetClient &client, FType status) {
+  client.print(F("HTTP/1.0 "));
+  client.print(status);
+  client.print(F("\r\nConnection: close\r\n\r\n"));
+  client.stop();
+  statusStats.rejected++;
+}
+
+
+/* Returns the value of the given query parameter (0 if absent). */
+static uint32_t queryParameter(const char *query, const char *name) {
+  const size_t n = strlen(name);
+  for (const char *p = query; p != NULL; p = strchr(p,'&')) {
+    if (*p == '&') p++;
+    if ((strncmp(p,name,n) == 0) && (p[n] == '=')) return strtoul(p + n + 1,NULL,10);
+  }
+  return 0;
+}
+
+
+/* Parses the request line: GET / or /status, with optional since and
+   wait parameters.  Returns false if not a status request. */
+static bool parseStatusRequest() {
+  StatusServerState &c = statusClient;
+  if (strncmp(c.line,"GET /",5) != 0) return false;
+  char *path = c.line + 4;
+  char *end = strchr(path,' ');
+  if (end != NULL) *end = '\0';
+  char *query = strchr(path,'?');
+  if (query != NULL) *query++ = '\0';
+  if ((strcmp(path,"/") != 0) && (strcmp(path,"/status") != 0)) return false;
+  c.since = (query != NULL) ? queryParameter(query,"since") : 0;
+  c.wait = (query != NULL) ? min(queryParameter(query,"wait"),(uint32_t)STATUS_WAIT_MAX) : 0;
+  return true;
+}
+
+
+/* Reads what the client has sent so far, up to the end of its
+   headers.  Returns true once the whole request is in. */
+static bool readStatusRequest() {
+  StatusServerState &c = statusClient;
+  while (c.client.available() > 0) {
+    const char ch = c.client.read();
+    if (ch == '\r') continue;
+    if (ch == '\n') {
+      c.lineDone = true;
+      if (++c.newlines >= 2) return true;
+      continue;
+    }
+    c.newlines = 0;
+    if (!c.lineDone && (c.len < sizeof(c.line) - 1)) {
+      c.line[c.len++] = ch;
+      c.line[c.len] = '\0';
+    }
+  }
+  return false;
+}
+
+
+void maintainStatusServer() {
+  if ((statusDrones == NULL) || !ethernetHasIPAddress()) return;
+  if (!statusServerStarted) {
+    statusServer.begin();
+    statusServerStarted = true;
+  }
+  StatusServerState &c = statusClient;
+
+  // One client at a time: others are turned away
+  EthernetClient incoming = statusServer.available();
+  if (incoming) {
+    if (c.state == STATUS_IDLE) {
+      c.client = incoming;
+      c.state = STATUS_REQUEST;
+      c.started = millis();
+      c.len = 0;
+      c.line[0] = '\0';
+      c.lineDone = false;
+      c.newlines = 0;
+    } else if (incoming.getSocketNumber() != c.client.getSocketNumber()) {
+      rejectStatusClient(incoming,F("503 Service Unavailable"));
+    }
+  }
+
+  switch (c.state) {
+    case STATUS_IDLE:
+      break;
+    case STATUS_REQUEST:
+      if (!readStatusRequest()) {
+        if (millis() - c.started >= STATUS_REQUEST_TIMEOUT) {
+          c.client.stop();
+          c.state = STATUS_IDLE;
+          statusStats.timeouts++;
+        }
+        break;
+      }
+      if (!parseStatusRequest()) {
+        rejectStatusClient(c.client,F("404 Not Found"));
+        c.state = STATUS_IDLE;
+        break;
+      }
+      c.started = millis();
+      c.state = ((c.wait > 0) && (c.since == statusVersion)) ? STATUS_WAITING : STATUS_SENDING;
+      if (c.state == STATUS_WAITING) statusStats.longPolls++;
+      c.next = 0;
+      c.first = true;
+      break;
+    case STATUS_WAITING:
+      if (!c.client.connected()) {
+        c.client.stop();
+        c.state = STATUS_IDLE;
+      } else if ((c.since != statusVersion) || (millis() - c.started >= 1000UL * c.wait)) {
+        c.started = millis();
+        c.state = STATUS_SENDING;
+      }
+      break;
+    case STATUS_SENDING: {
+      if (!c.client.connected()) {
+        c.client.stop();
+        c.state = STATUS_IDLE;
+        break;
+      }
+      if (millis() - c.started >= STATUS_SEND_TIMEOUT) {
+        c.client.stop();
+        c.state = STATUS_IDLE;
+        statusStats.timeouts++;
+        break;
+      }
+      // Next piece: the head, a drone in use or the tail
+      while ((c.next > 0) && (c.next <= STATUS_DRONES)
+             && (statusDrones[c.next - 1].devid[0] == '\0')) c.next++;
+      StatusChunk chunk;
+      if (c.next == 0) {
+        chunk.print(F("HTTP/1.0 200 OK\r\nContent-Type: application/json\r\n"
+                      "Access-Control-Allow-Origin: *\r\nConnection: close\r\n\r\n"));
+        printStatusHead(chunk);
+      } else if (c.next <= STATUS_DRONES) {
+        printStatusDrone(chunk,c.next - 1,c.first);
+        // Left out rather than sent as broken JSON
+        if (chunk.overflow) {
+          c.next++;
+          break;
+        }
+      } else {
+        printStatusTail(chunk);
+      }
+      // Written whole once the socket has room for it: the write never
+      // waits on the client
+      if (c.client.availableForWrite() < (int)chunk.len) break;
+      c.client.write((const uint8_t*)chunk.buff,chunk.len);
+      if (c.next > STATUS_DRONES) {
+        c.client.stop();
+        c.state = STATUS_IDLE;
+        statusStats.requests++;
+        break;
+      }
+      if (c.next > 0) c.first = false;
+      c.next++;
+      break;
+    }
+  }
+}
+
+
+//------------------------------------------------------------------------------
+// Prints the status server's counters to serial.
+//
+void printStatusServerStats() {
+  uint8_t drones = 0, sensors = 0;
+  for (uint8_t k = 0; (statusDrones != NULL) && (k < STATUS_DRONES); k++) {
+    const StatusDrone &d = statusDrones[k];
+    if (d.devid[0] == '\0') continue;
+    drones++;
+    for (uint8_t j = 0; j < READING_SD_COUNT; j++) {
+      if (d.present & (1 << j)) sensors++;
+    }
+  }
+  Serial.print(F("Status server: port "));
+  Serial.print(STATUS_SERVER_PORT);
+  Serial.println(statusServerStarted ? F("") : F(" (not started: no network)"));
+  Serial.print(F("  Drones: "));
+  Serial.print(drones);
+  Serial.print(F(" of "));
+  Serial.print(STATUS_DRONES);
+  Serial.print(F(", sensors: "));
+  Serial.print(sensors);
+  Serial.print(F(", version "));
+  Serial.println(statusVersion);
+  Serial.print(F("  Requests: "));
+  Serial.print(statusStats.requests);
+  Serial.print(F(" ("));
+  Serial.print(statusStats.longPolls);
+  Serial.print(F(" long polls), rejected: "));
+  Serial.print(statusStats.rejected);
+  Serial.print(F(", timed out: "));
+  Serial.println(statusStats.timeouts);
+}
+
+
+//==============================================================================
@@ -0,0 +1,112 @@
+/*==============================================================================
+  Coordinator status: latest readings from each drone, served as JSON
+  over the local network.
+
+  This file is part of the LMN PODD distribution:
+    https://github.com/lmnts/PODD
+
+  CONTRIBUTORS:
+    PODD contributors (2026)
+
+  COPYRIGHT/LICENSE:
+  Copyright (c) 2026 LMN Architects
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Affero General Public License as
+  published by the Free Software Foundation, either version 3 of the
+  License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Affero General Public License for more details.
+
+  You should have received a copy of the GNU Affero General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+==============================================================================*/
+
+#pragma once
+
+// Standard libraries
+// Contributed libraries
+#include <Arduino.h>
+// Local headers
+
+
+// Constants/global variables ==================================================
+
+// The coordinator keeps the latest reading of each sensor (the
+// READING_SD_COUNT types; diagnostic readings are left out) of each
+// drone it hears from, with delivery counters per drone, in a
+// fixed table: drones beyond STATUS_DRONES replace the one not heard
+// from the longest.
+// There is no measure of the radio link itself (the XBee runs in
+// transparent mode, without signal strength): link problems show up
+// as delay, silence and flagged readings.
+// 96 bytes per drone, 1.5 KB for a full mesh (16, as for
+// CONFIG_PUSH_DRONES).  Each reading keeps its value, its quality
+// flags and its age from the drone's latest reading, up to
+// STATUS_AGE_MAX [s] (about 18 h; older readings show as that old).
+#define STATUS_DRONES 16
+#define STATUS_AGE_MAX 0xFFFF
+
+// The tables are served on this port as JSON, one request at a time:
+//   GET /status                      the tables now
+//   GET /status?since=V&wait=S       once the tables change from
+//                                    version V, or after S seconds
+//                                    (long poll)
+// e.g.
+//   {"id":"coord","time":1704067200,"version":42,
+//    "xbee":{"received":51200,"overrun":0,"parsed":1210,"dropped":1},
+//    "drones":[{"id":"drone001","age":12,"readings":310,"flagged":2,
+//      "delay":1,"sensors":{"Light":{"v":312.50,"t":1704067188,"q":0},
+//      ...}},...]}
+// with the coordinator's XBee counters (bytes received and lost to
+// overruns, packets parsed and dropped); for each drone, the time
+// since it was last heard from [s], the readings received, those with
+// quality flags set and the delay of the last reading from its
+// timestamp [s]; for each sensor, the latest value, its timestamp,
+// and its quality flags (see pod_quality.h).
+// Drones only send readings that changed (report-by-exception, see
+// pod_config.h), so a quiet sensor is not necessarily a lost one.
+// The response is written one piece (the head, a drone, the tail) per
+// pass through the main loop.  Each piece is formatted on the stack and
+// written whole once the Ethernet chip has room for it, so a slow
+// client never holds up the upload path; one that has not taken the
+// response after STATUS_SEND_TIMEOUT is dropped.
+#define STATUS_SERVER_PORT 80
+// Longest long poll [s], and time allowed for a client to send its
+// request and to take the response [ms].
+#define STATUS_WAIT_MAX 60
+#define STATUS_REQUEST_TIMEOUT 2000
+#define STATUS_SEND_TIMEOUT 10000
+// Largest piece of the response [bytes]: a drone with every sensor
+// (650 bytes at most) or the head with the HTTP headers.  On the
+// stack while a piece is written.
+#define STATUS_CHUNK_LEN 656
+
+
+// Functions ===================================================================
+
+// Allocates the status tables on the coordinator (nothing on drones).
+// Called from setup(), once the role is set.
+void initStatusTables();
+
+// Records a reading received from a drone (the fields of a 'V'
+// packet).  Readings of unknown types are ignored; diagnostic readings
+// are counted but not kept.
+void updateDroneStatus(const char *devid, const char *sensor, const char *value,
+                       const char *timestamp, const char *quality);
+
+// Accepts, reads and answers status requests without blocking
+// (coordinator, once the tables exist).  Called from the main loop.
+void maintainStatusServer();
+
+// Writes the status tables as JSON.
+void printStatusJSON(Print &out);
+// Prints the server's counters to serial.
+void printStatusServerStats();
+
+
+//==============================================================================
@@ -0,0 +1,196 @@
+/*==============================================================================
+  Lightweight event trace for ISR and main-loop timing.
+
+  This file is part of the LMN PODD distribution:
+    https://github.com/lmnts/PODD
+
+  CONTRIBUTORS:
+    PODD contributors (2026)
+
+  COPYRIGHT/LICENSE:
+  Copyright (c) 2026 LMN Architects
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Affero General Public License as
+  published by the Free Software Foundation, either version 3 of the
+  License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Affero General Public License for more details.
+
+  You should have received a copy of the GNU Affero General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+==============================================================================*/
+
+#include "pod_trace.h"
+
+#ifdef PODD_TRACE
+
+#include "pod_util.h"
+
+#if (TRACE_BUFFER_SIZE & (TRACE_BUFFER_SIZE - 1)) != 0
+#error "TRACE_BUFFER_SIZE must be a power of two"
+#endif
+
+
+// Global variables ============================================================
+
+// A single trace event: truncated timestamp and ID (with TRACE_EXIT
+// flag for exit events).
+struct TraceEvent {
+  uint16_t tick;
+  uint8_t id;
+};
+
+// Ring buffer of trace events.  Index of next write and number of
+// events recorded since last cleared (may exceed buffer size).
+static TraceEvent traceBuffer[TRACE_BUFFER_SIZE];
+static volatile uint16_t traceHead = 0;
+static volatile uint32_t traceCount = 0;
+// IDs to record (bit n for ID n) and flag to pause recording.
+static volatile uint16_t traceMask = 0xFFFF;
+static volatile bool tracePaused = false;
+
+// Names for trace IDs, as reported in the dump.
+static const char TRACE_NAME_MARK[] PROGMEM         = "mark";
+static const char TRACE_NAME_ISR_XBEE[] PROGMEM     = "isr_xbee";
+static const char TRACE_NAME_ISR_SOUND[] PROGMEM    = "isr_sound";
+static const char TRACE_NAME_ISR_SWSERIAL[] PROGMEM = "isr_swserial";
+static const char TRACE_NAME_LOOP[] PROGMEM         = "loop";
+static const char TRACE_NAME_ETHERNET[] PROGMEM     = "ethernet";
+static const char TRACE_NAME_ALARMS[] PROGMEM       = "alarms";
+static const char TRACE_NAME_XBEE[] PROGMEM         = "xbee";
+static const char TRACE_NAME_NTP[] PROGMEM          = "ntp";
+static const char TRACE_NAME_TIMESYNC[] PROGMEM     = "timesync";
+static const char TRACE_NAME_MEMORY[] PROGMEM       = "memory";
+static const char TRACE_NAME_PM[] PROGMEM           = "pm";
+static const char * const TRACE_NAMES[TRACE_ID_COUNT] PROGMEM = {
+  TRACE_NAME_MARK, TRACE_NAME_ISR_XBEE, TRACE_NAME_ISR_SOUND,
+  TRACE_NAME_ISR_SWSERIAL, TRACE_NAME_LOOP, TRACE_NAME_ETHERNET,
+  TRACE_NAME_ALARMS, TRACE_NAME_XBEE, TRACE_NAME_NTP,
+  TRACE_NAME_TIMESYNC, TRACE_NAME_MEMORY, TRACE_NAME_PM
+};
+
+
+// Functions ===================================================================
+
+/* Records an enter/exit event in the ring buffer.  ISR-safe: the
+   buffer is updated with interrupts disabled, so nested ISRs cannot
+   interleave partial events. */
+void traceEvent(uint8_t id) {
+  if (tracePaused) return;
+  if (!(traceMask & _BV(id & ~TRACE_EXIT))) return;
+  uint8_t oldSREG = SREG;
+  cli();
+  // micros() is safe with interrupts disabled
+  TraceEvent &e = traceBuffer[traceHead];
+  e.tick = (uint16_t)(micros() >> TRACE_TICK_SHIFT);
+  e.id = id;
+  traceHead = (traceHead + 1) & (TRACE_BUFFER_SIZE - 1);
+  traceCount++;
+  SREG = oldSREG;
+}
+
+
+/* Hook called by the NeoSWSerial pin change ISR on entry and exit. */
+extern "C" void neoswserial_isr_hook(uint8_t exiting) {
+  traceEvent(exiting ? (TRACE_ISR_SWSERIAL | TRACE_EXIT) : TRACE_ISR_SWSERIAL);
+}
+
+
+/* Selects which IDs are recorded (bit n for ID n). */
+void setTraceMask(uint16_t mask) {
+  traceMask = mask;
+}
+
+
+/* Returns the mask of IDs being recorded. */
+uint16_t getTraceMask() {
+  return traceMask;
+}
+
+
+/* Discards all recorded events. */
+void clearTrace() {
+  uint8_t oldSREG = SREG;
+  cli();
+  traceHead = 0;
+  traceCount = 0;
+  SREG = oldSREG;
+}
+
+
+/* Prints the buffered events, oldest first, in the CSV format described
+   in the header.  Recording is paused while printing so the buffer is
+   not overwritten mid-dump, then resumed where it left off. */
+void dumpTrace() {
+  tracePaused = true;
+  uint8_t oldSREG = SREG;
+  cli();
+  uint32_t count = traceCount;
+  uint16_t head = traceHead;
+  uint16_t now = (uint16_t)(micros() >> TRACE_TICK_SHIFT);
+  SREG = oldSREG;
+
+  uint16_t n = (count < TRACE_BUFFER_SIZE) ? count : TRACE_BUFFER_SIZE;
+  Serial.println(F("# PODD trace"));
+  Serial.print(F("H,tick_us,"));
+  Serial.println(1 << TRACE_TICK_SHIFT);
+  Serial.print(F("H,events,"));
+  Serial.print(count);
+  Serial.print(',');
+  Serial.println(n);
+  Serial.print(F("H,mask,"));
+  Serial.println(traceMask,HEX);
+  Serial.print(F("H,now,"));
+  Serial.println(now);
+  for (uint8_t k = 0; k < TRACE_ID_COUNT; k++) {
+    Serial.print(F("N,"));
+    Serial.print(k);
+    Serial.print(',');
+    Serial.println((FType)pgm_read_word(&TRACE_NAMES[k]));
+  }
+  for (uint16_t k = 0; k < n; k++) {
+    const TraceEvent &e = traceBuffer[(head - n + k) & (TRACE_BUFFER_SIZE - 1)];
+    Serial.print(F("T,"));
+    Serial.print(e.tick);
+    Serial.print(',');
+    Serial.print(e.id & ~TRACE_EXIT);
+    Serial.println((e.id & TRACE_EXIT) ? F(",E") : F(",B"));
+  }
+  Serial.println(F("# end"));
+  tracePaused = false;
+}
+
+
+/* Handles a single-key trace command:
+     T  dump trace
+     C  clear trace
+     I  toggle recording of the periodic timer ISRs
+   Returns false if the key is not a trace command. */
+bool handleTraceCommand(const char c) {
+  switch (c) {
+    case 'T':
+    case 't':
+      dumpTrace();
+      return true;
+    case 'C':
+    case 'c':
+      clearTrace();
+      return true;
+    case 'I':
+    case 'i':
+      setTraceMask(traceMask ^ TRACE_MASK_TIMER_ISRS);
+      return true;
+    default:
+      return false;
+  }
+}
+
+#endif
+
+
+//==============================================================================
@@ -0,0 +1,121 @@
+/*==============================================================================
+  Lightweight event trace for ISR and main-loop timing.
+
+  This file is part of the LMN PODD distribution:
+    https://github.com/lmnts/PODD
+
+  CONTRIBUTORS:
+    PODD contributors (2026)
+
+  COPYRIGHT/LICENSE:
+  Copyright (c) 2026 LMN Architects
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Affero General Public License as
+  published by the Free Software Foundation, either version 3 of the
+  License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Affero General Public License for more details.
+
+  You should have received a copy of the GNU Affero General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+==============================================================================*/
+
+#pragma once
+
+// Standard libraries
+// Contributed libraries
+#include <Arduino.h>
+// Local headers
+
+// Define this to enable the event trace.  When not defined, the
+// TRACE_* macros below compile to nothing and no RAM is used.
+//#define PODD_TRACE
+
+
+// Constants/global variables ==================================================
+
+// Traced code sections.  IDs must stay below 16 (see setTraceMask()).
+enum TraceID : uint8_t {
+  TRACE_MARK = 0,       // free-form marker for ad hoc use
+  TRACE_ISR_XBEE,       // readXBeeISR (Timer1)
+  TRACE_ISR_SOUND,      // sampleSoundISR (Timer3)
+  TRACE_ISR_SWSERIAL,   // NeoSWSerial pin change interrupt
+  TRACE_LOOP,           // loop()
+  TRACE_ETHERNET,       // ethernetMaintain()
+  TRACE_ALARMS,         // Alarm.delay()/idling: sensor readings, logging, uploads
+  TRACE_XBEE,           // processXBee()
+  TRACE_NTP,            // maintainNTP()
+  TRACE_TIMESYNC,       // maintainTimeSync()
+  TRACE_MEMORY,         // maintainMemoryStats()
+  TRACE_PM,             // maintainPMPlanner()
+  TRACE_ID_COUNT
+};
+
+// Flag OR'd into the ID for exit events.
+#define TRACE_EXIT 0x80
+
+// Number of events kept in the ring buffer (power of two).  Each event
+// is 3 bytes; older events are overwritten.
+#ifndef TRACE_BUFFER_SIZE
+#define TRACE_BUFFER_SIZE 128
+#endif
+
+// Event timestamps are micros() >> TRACE_TICK_SHIFT, truncated to
+// 16 bits.  micros() only has 8 us resolution at 8 MHz, so nothing is
+// lost with a shift of 3; the timestamp wraps every ~524 ms, which the
+// periodic XBee ISR events keep unambiguous for the host.
+#define TRACE_TICK_SHIFT 3
+
+// Mask of the periodic timer ISRs, which otherwise dominate the buffer.
+#define TRACE_MASK_TIMER_ISRS (_BV(TRACE_ISR_XBEE) | _BV(TRACE_ISR_SOUND))
+
+
+// Functions ===================================================================
+
+#ifdef PODD_TRACE
+
+// Records an enter/exit event.  ISR-safe.
+void traceEvent(uint8_t id);
+
+#define TRACE_BEGIN(id) traceEvent(id)
+#define TRACE_END(id)   traceEvent((id) | TRACE_EXIT)
+
+// Selects which IDs are recorded (bit n for ID n; default all).
+void setTraceMask(uint16_t mask);
+uint16_t getTraceMask();
+
+// Discards all recorded events.
+void clearTrace();
+
+// Prints the buffered events, oldest first, in a line-based CSV format
+// for host-side parsing:
+//   # PODD trace
+//   H,tick_us,<us per tick>
+//   H,events,<recorded since clear>,<in dump>
+//   H,mask,<hex mask>
+//   N,<id>,<name>                one per ID
+//   T,<tick>,<id>,<B|E>          one per event
+//   # end
+// Recording is paused while dumping.  Events recorded - events in dump
+// is the number overwritten.
+void dumpTrace();
+
+// Handles a single-key trace command received over serial while
+// running (see handleRuntimeCommands()): 'T' dumps, 'C' clears, 'I'
+// toggles timer ISR recording.  Returns false for other keys.
+bool handleTraceCommand(const char c);
+
+#else
+
+#define TRACE_BEGIN(id) do {} while (0)
+#define TRACE_END(id)   do {} while (0)
+
+#endif
+
+
+//==============================================================================
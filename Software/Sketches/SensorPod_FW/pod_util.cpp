@@ -36,6 +36,41 @@
 
 // Constants/global variables ==================================================
 
+// Symbols provided by the linker/avr-libc describing the RAM layout:
+// static variables end at __heap_start (_end), the heap grows up to
+// __brkval and the stack grows down from __stack (RAMEND).  Freed
+// heap blocks below __brkval are kept in the __flp free list.
+extern int __heap_start;
+extern int *__brkval;
+extern uint8_t _end;
+extern uint8_t __stack;
+struct __freelist {
+  size_t sz;
+  struct __freelist *nx;
+};
+extern struct __freelist *__flp;
+
+// Byte pattern used to paint unused RAM at startup and the number of
+// consecutive intact bytes taken to mark the bottom of the stack
+// (avoids stopping at stack data that happens to match the pattern).
+#define MEMORY_PAINT 0xC5
+#define MEMORY_PAINT_RUN 16
+
+// Minimum interval [ms] between updateMemoryStats() samples: each
+// scans the unused RAM (a few ms).
+#define MEMORY_UPDATE_INTERVAL 10000
+
+// Worst values seen and time of the last sample.
+MemoryStats memoryStatsWorst = {0,0,0,0,0,0,0};
+bool memoryStatsValid = false;
+unsigned long memoryStatsLastUpdate = 0;
+
+#ifdef BENCHMARK_TESTING
+// Cycles counted for an empty benchmark call (timer access and call
+// through function pointer), subtracted from all results.
+uint16_t benchmarkOverhead = 0;
+#endif
+
 
 // Functions ===================================================================
 
@@ -49,8 +84,6 @@
 // the maximum free RAM available to the stack.
 // 
 size_t freeRAM() {
-  extern int __heap_start;
-  extern int *__brkval;
   // This contains end of heap location and itself is located at edge of stack
   const size_t heaploc = (size_t)(__brkval == 0 ? &__heap_start : __brkval);
   if ((size_t)(&heaploc) > heaploc) {
@@ -62,6 +95,153 @@ size_t freeRAM() {
 }
 
 
+//------------------------------------------------------------------------------
+// Paints RAM from the end of the static variables to the top of the
+// stack with MEMORY_PAINT.  Placed in the .init1 section so it runs
+// once at reset, before the stack is in use or any constructors have
+// run; written in assembly as registers (including the zero register)
+// are not yet set up at that point.
+void paintRAM() __attribute__((naked, used, section(".init1")));
+void paintRAM() {
+  __asm volatile (
+    "    ldi r30,lo8(_end)\n"
+    "    ldi r31,hi8(_end)\n"
+    "    ldi r24,%0\n"
+    "    ldi r25,hi8(__stack)\n"
+    "    rjmp 2f\n"
+    "1:  st Z+,r24\n"
+    "2:  cpi r30,lo8(__stack)\n"
+    "    cpc r31,r25\n"
+    "    brlo 1b\n"
+    "    breq 1b\n"
+    :: "M" (MEMORY_PAINT));
+}
+
+
+//------------------------------------------------------------------------------
+// Takes a snapshot of current memory usage.  The stack extent is found
+// by walking down from the stack pointer to the first run of intact
+// paint: freed heap blocks above the current heap top are no longer
+// painted, so the search cannot simply start from the heap.
+// 
+void getMemoryStats(MemoryStats &stats) {
+  uint8_t * const heapStart = (uint8_t*)&__heap_start;
+  uint8_t * const heapTop = (__brkval == 0) ? heapStart : (uint8_t*)__brkval;
+  
+  stats.freeRAM = freeRAM();
+  stats.heapSize = heapTop - heapStart;
+  
+  // Heap free list (not modified by any ISRs)
+  stats.heapFree = 0;
+  stats.heapFreeBlocks = 0;
+  stats.largestFree = 0;
+  for (struct __freelist *fp = __flp; fp != NULL; fp = fp->nx) {
+    stats.heapFree += fp->sz;
+    stats.heapFreeBlocks++;
+    if (fp->sz > stats.largestFree) stats.largestFree = fp->sz;
+  }
+  // malloc() can also extend the heap up to __malloc_margin below
+  // the stack pointer
+  if ((stats.freeRAM > __malloc_margin)
+      && (stats.freeRAM - __malloc_margin > stats.largestFree)) {
+    stats.largestFree = stats.freeRAM - __malloc_margin;
+  }
+  
+  // Stack: search down from the stack pointer for intact paint
+  uint8_t *p = (uint8_t*)SP;
+  size_t run = 0;
+  while ((p > heapTop) && (run < MEMORY_PAINT_RUN)) {
+    p--;
+    run = (*p == MEMORY_PAINT) ? run + 1 : 0;
+  }
+  uint8_t *stackBottom = p + run;
+  stats.stackPeak = &__stack - stackBottom + 1;
+  // Unused: intact paint below deepest stack extent
+  while ((p > heapTop) && (*(p-1) == MEMORY_PAINT)) p--;
+  stats.stackUnused = stackBottom - p;
+}
+
+
+//------------------------------------------------------------------------------
+// Samples the current memory usage and updates the worst values seen.
+// Rate-limited to one sample every MEMORY_UPDATE_INTERVAL unless forced.
+// 
+void updateMemoryStats(bool force) {
+  if (!force && memoryStatsValid
+      && (millis() - memoryStatsLastUpdate < MEMORY_UPDATE_INTERVAL)) {
+    return;
+  }
+  memoryStatsLastUpdate = millis();
+  MemoryStats stats;
+  getMemoryStats(stats);
+  MemoryStats &w = memoryStatsWorst;
+  if (!memoryStatsValid) {
+    w = stats;
+    memoryStatsValid = true;
+    return;
+  }
+  if (stats.freeRAM < w.freeRAM) w.freeRAM = stats.freeRAM;
+  if (stats.stackPeak > w.stackPeak) w.stackPeak = stats.stackPeak;
+  if (stats.stackUnused < w.stackUnused) w.stackUnused = stats.stackUnused;
+  if (stats.heapSize > w.heapSize) w.heapSize = stats.heapSize;
+  if (stats.heapFree < w.heapFree) w.heapFree = stats.heapFree;
+  if (stats.heapFreeBlocks > w.heapFreeBlocks) w.heapFreeBlocks = stats.heapFreeBlocks;
+  if (stats.largestFree < w.largestFree) w.largestFree = stats.largestFree;
+}
+
+
+//------------------------------------------------------------------------------
+// Worst values recorded by updateMemoryStats().
+// 
+const MemoryStats& getMemoryStatsWorst() {
+  if (!memoryStatsValid) updateMemoryStats(true);
+  return memoryStatsWorst;
+}
+
+
+//------------------------------------------------------------------------------
+// Prints a labelled line of current and worst memory values.
+// 
+void printMemoryStatsLine(FType label, const size_t cur, const size_t worst) {
+  char buff[24];
+  Serial.print(label);
+  sprintf(buff,"%7u   %7u",(unsigned int)cur,(unsigned int)worst);
+  Serial.println(buff);
+}
+
+
+//------------------------------------------------------------------------------
+// Prints current and worst memory usage to serial.
+// 
+void printMemoryStats() {
+  MemoryStats stats;
+  getMemoryStats(stats);
+  updateMemoryStats(true);
+  const MemoryStats &w = memoryStatsWorst;
+  const size_t total = &__stack - (uint8_t*)&__heap_start + 1;
+  
+  Serial.print(F("Memory usage [bytes] (static variables use "));
+  Serial.print((size_t)((uint8_t*)&__heap_start - (uint8_t*)RAMSTART));
+  Serial.print(F(", leaving "));
+  Serial.print(total);
+  Serial.println(F(" for heap & stack):"));
+  Serial.println(F("                          current     worst"));
+  printMemoryStatsLine(F("  Free (heap to stack):  "),stats.freeRAM,w.freeRAM);
+  printMemoryStatsLine(F("  Stack depth:           "),stats.stackPeak,w.stackPeak);
+  printMemoryStatsLine(F("  Never used:            "),stats.stackUnused,w.stackUnused);
+  printMemoryStatsLine(F("  Heap size:             "),stats.heapSize,w.heapSize);
+  printMemoryStatsLine(F("  Heap free list:        "),stats.heapFree,w.heapFree);
+  printMemoryStatsLine(F("  Heap free blocks:      "),stats.heapFreeBlocks,w.heapFreeBlocks);
+  printMemoryStatsLine(F("  Largest free block:    "),stats.largestFree,w.largestFree);
+  Serial.println(F("  (worst: minimum, except maximum stack depth, heap size and free blocks)"));
+  if (stats.heapFree > 0) {
+    Serial.print(F("  Heap fragmentation:    "));
+    Serial.print(100 - (100UL * stats.largestFree) / (stats.heapFree + stats.freeRAM));
+    Serial.println(F("%"));
+  }
+}
+
+
 //------------------------------------------------------------------------------
 // Writes to serial the status of the given pin, with optional
 // label to include in output.  Note this gives digital states:
@@ -135,6 +315,129 @@ void poddPinChecks() {
 }
 
 
+// Benchmark testing >>>>>>>>>>>>>>>>>>>
+#ifdef BENCHMARK_TESTING
+//------------------------------------------------------------------------------
+// Empty routine used to calibrate the benchmark overhead.
+// 
+void benchmarkEmpty() {}
+
+
+//------------------------------------------------------------------------------
+// Times a single call of the given routine in CPU cycles, with
+// interrupts disabled and Timer1 counting at the CPU clock.  Returns
+// false if the call exceeded the 16-bit timer range.
+// 
+bool timeBenchmarkCall(void (*fn)(), uint32_t &cycles) {
+  uint8_t oldSREG = SREG;  // Save interrupt status (among other things)
+  cli();  // Disable interrupts
+  TIFR1 = _BV(TOV1);
+  TCNT1 = 0;
+  fn();
+  uint16_t c = TCNT1;
+  bool overflow = TIFR1 & _BV(TOV1);
+  SREG = oldSREG;  // Restore interrupt status
+  cycles = (c > benchmarkOverhead) ? c - benchmarkOverhead : 0;
+  return !overflow;
+}
+
+
+//------------------------------------------------------------------------------
+// Times the given routine over the given number of calls and prints
+// a BENCH result line.  The optional preparation routine is run
+// (untimed) before each call.  Calls exceeding the timer range are
+// repeated with interrupts enabled and timed with micros(), which
+// has a resolution of 4 us.
+// 
+BenchmarkStats runBenchmark(FType name, void (*fn)(), const uint16_t calls, void (*prep)()) {
+  BenchmarkStats stats = {0,0,0xFFFFFFFF,0,false};
+  for (uint16_t k = 0; k < calls; k++) {
+    if (prep != NULL) prep();
+    uint32_t cycles;
+    if (!timeBenchmarkCall(fn,cycles)) {
+      if (prep != NULL) prep();
+      unsigned long t0 = micros();
+      fn();
+      cycles = (micros() - t0) * (F_CPU / 1000000UL);
+      stats.coarse = true;
+    }
+    stats.calls++;
+    stats.total += cycles;
+    if (cycles < stats.min) stats.min = cycles;
+    if (cycles > stats.max) stats.max = cycles;
+  }
+  if (stats.calls == 0) stats.min = 0;
+  
+  Serial.print(F("BENCH,"));
+  Serial.print(name);
+  Serial.print(',');
+  Serial.print(stats.calls);
+  Serial.print(',');
+  Serial.print(stats.min);
+  Serial.print(',');
+  Serial.print((stats.calls > 0) ? stats.total / stats.calls : 0);
+  Serial.print(',');
+  Serial.print(stats.max);
+  Serial.println(stats.coarse ? F(",micros") : F(",timer"));
+  return stats;
+}
+
+
+//------------------------------------------------------------------------------
+// Prints an ISR result line: worst-case cycles per interrupt and the
+// fraction of the interrupt period [us] that represents.
+// 
+void printISRBudget(FType name, const uint32_t worst, const unsigned long periodUs) {
+  const uint32_t period = periodUs * (F_CPU / 1000000UL);
+  Serial.print(F("ISR,"));
+  Serial.print(name);
+  Serial.print(',');
+  Serial.print(worst);
+  Serial.print(',');
+  Serial.print(period);
+  Serial.print(',');
+  Serial.println((period > 0) ? (100.0 * worst) / period : 0.0, 2);
+}
+
+
+//------------------------------------------------------------------------------
+// Runs all module benchmarks, printing results to serial.  Uses Timer1
+// as a free-running cycle counter (the XBee routines reconfigure it
+// when started).
+// 
+void runBenchmarks() {
+  // Timer1: normal mode, no prescaling, no interrupts
+  TCCR1A = 0;
+  TCCR1B = _BV(CS10);
+  TCCR1C = 0;
+  TIMSK1 = 0;
+  // Calibrate overhead: minimum of a few empty calls
+  uint16_t overhead = 0xFFFF;
+  for (uint8_t k = 0; k < 8; k++) {
+    uint32_t cycles;
+    timeBenchmarkCall(benchmarkEmpty,cycles);
+    if (cycles < overhead) overhead = cycles;
+  }
+  benchmarkOverhead = overhead;
+  
+  Serial.println(F("# PODD benchmarks"));
+  Serial.print(F("# F_CPU="));
+  Serial.println(F_CPU);
+  Serial.print(F("# overhead="));
+  Serial.println(benchmarkOverhead);
+  Serial.println(F("BENCH,name,calls,cycles_min,cycles_mean,cycles_max,timing"));
+  Serial.println(F("ISR,name,worst_cycles,period_cycles,load_pct"));
+  benchmarkClock();
+  benchmarkSensors();
+  benchmarkQuality();
+  benchmarkNetwork();
+  Serial.println(F("# end"));
+  Serial.println();
+}
+#endif
+//<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
 //------------------------------------------------------------------------------
 // Prints compilation info to serial output, with optional prefix
 // for each output line and name of compilation file (defaults to
@@ -41,6 +41,9 @@
 #define PODD_UTIL_DEBUG
 #endif
 
+// Define this to run the cycle-count benchmark suite at startup.
+//#define BENCHMARK_TESTING
+
 
 // Types =======================================================================
 
@@ -59,6 +62,27 @@
 //        work as intended (unclear why).
 typedef const __FlashStringHelper * FType;
 
+// Snapshot of RAM usage, as returned by getMemoryStats().  All sizes
+// are in bytes.
+struct MemoryStats {
+  size_t freeRAM;         // Gap between heap top and stack pointer
+  size_t stackPeak;       // Deepest stack extent since startup
+  size_t stackUnused;     // Gap between heap and deepest stack extent
+  size_t heapSize;        // Heap extent (allocated and freed)
+  size_t heapFree;        // Bytes in heap free list
+  size_t heapFreeBlocks;  // Number of blocks in heap free list
+  size_t largestFree;     // Largest block malloc() could return
+};
+
+#ifdef BENCHMARK_TESTING
+// Cycle counts for a benchmarked routine, as returned by runBenchmark().
+struct BenchmarkStats {
+  uint16_t calls;
+  uint32_t total,min,max;
+  bool coarse;  // Some calls too long for Timer1: timed with micros()
+};
+#endif
+
 
 // Constants/global variables ==================================================
 
@@ -68,6 +92,20 @@ typedef const __FlashStringHelper * FType;
 // Returns the amount of RAM available to the stack and/or heap.
 size_t freeRAM();
 
+// Memory telemetry.  The RAM above the static variables is painted
+// at startup, so the deepest stack extent can be found later from
+// where the paint is intact; the heap free list is walked to find
+// fragmentation.  updateMemoryStats() records the worst values seen
+// (minimum free, maximum stack) and is rate-limited internally, so it
+// may be called from the main loop.
+void getMemoryStats(MemoryStats &stats);
+void updateMemoryStats(bool force=false);
+// Worst values recorded by updateMemoryStats().  Fields hold minima,
+// except stackPeak, heapSize and heapFreeBlocks (more blocks: more
+// fragmented), which hold maxima.
+const MemoryStats& getMemoryStatsWorst();
+void printMemoryStats();
+
 // Writes to serial the status of the given pin, with optional
 // label to include in output.
 void pinCheck(const int pin, const String s="");
@@ -75,6 +113,25 @@ void pinCheck(const int pin, const String s="");
 // debugging.
 void poddPinChecks();
 
+// Benchmark suite (BENCHMARK_TESTING): times firmware hot paths in CPU
+// cycles and prints machine-readable lines to serial:
+//   BENCH,<name>,<calls>,<min>,<mean>,<max>,<timer|micros>
+//   ISR,<name>,<worst cycles>,<period cycles>,<load %>
+// Timer1 is used as the cycle counter, so runBenchmarks() must be
+// called before the XBee is started.  Each module provides its own
+// benchmark routine, which calls runBenchmark() for individual
+// routines (with an optional untimed preparation routine run before
+// each call).
+#ifdef BENCHMARK_TESTING
+void runBenchmarks();
+BenchmarkStats runBenchmark(FType name, void (*fn)(), const uint16_t calls, void (*prep)()=NULL);
+void printISRBudget(FType name, const uint32_t worst, const unsigned long periodUs);
+void benchmarkClock();
+void benchmarkNetwork();
+void benchmarkSensors();
+void benchmarkQuality();
+#endif
+
 // Prints compilation info to serial output, with optional prefix
 // for each output line and name of compilation file (defaults to
 // main compilation input file).
@@ -0,0 +1,138 @@
+/*==============================================================================
+  Firmware-side glue for the replay harness: configuration preloading,
+  the idle wake estimate and counters (see replay.h).
+
+  This file is part of the LMN PODD distribution:
+    https://github.com/lmnts/PODD
+
+  CONTRIBUTORS:
+    PODD contributors (2026)
+
+  COPYRIGHT/LICENSE:
+  Copyright (c) 2026 LMN Architects
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Affero General Public License as
+  published by the Free Software Foundation, either version 3 of the
+  License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Affero General Public License for more details.
+
+  You should have received a copy of the GNU Affero General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+==============================================================================*/
+
+#include "replay.h"
+#include "sim.h"
+
+#include <Arduino.h>
+#include <SD.h>
+#include <TimeAlarms.h>
+#include "pod_config.h"
+#include "pod_network.h"
+#include "pod_ota.h"
+#include "pod_pmplan.h"
+#include "pod_remote.h"
+#include "pod_stats.h"
+
+
+// Constants/global variables ==================================================
+
+// Longest idle step, so the main loop's own polling (NTP, statistics,
+// ethernet maintenance) keeps running.
+#define WAKE_MAX_STEP 1000000
+// Step while an alarm is due within the second: alarms fire on whole
+// seconds of the firmware clock, whose phase is not known here.
+#define WAKE_ALARM_STEP 50000
+
+// The sketch's entry points (SensorPod_FW.ino)
+void setup();
+void loop();
+
+
+// Functions ===================================================================
+
+/* Starts from the firmware defaults, so fields the harness does not
+   set keep their normal values. */
+void firmwarePreloadConfig(const ReplayPodConfig &c) {
+  loadPodConfig();
+  PodConfigStruct &config = getPodConfig();
+  snprintf(config.devid,sizeof(config.devid),"%s",c.devid);
+  config.coord = c.coordinator ? 'Y' : 'N';
+  int * const rates[REPLAY_CHANNEL_COUNT] = {
+    &config.lightT, &config.humidityT, &config.tempT, &config.soundT,
+    &config.co2T, &config.pmT, &config.coT
+  };
+  for (uint8_t k = 0; k < REPLAY_CHANNEL_COUNT; k++) *rates[k] = c.rates[k];
+  storePodConfig();
+}
+
+
+void firmwareSetCard(const char *dir) {
+  SD.setRoot(dir);
+}
+
+
+void firmwareSetup() {
+  setup();
+}
+
+
+void firmwareLoop() {
+  loop();
+}
+
+
+/* The next alarm is known in whole seconds of the firmware clock:
+   skip to a second before it, then step until it fires. */
+uint64_t firmwareWakeTime() {
+  const uint64_t t = simMicros();
+  uint64_t wake = t + WAKE_MAX_STEP;
+  const unsigned long pm = getPMPlannerIdleTime();
+  if (pm < (wake - t) / 1000) wake = t + 1000ull * pm;
+  const unsigned long ota = getFirmwareUpdateIdleTime();
+  if (ota < (wake - t) / 1000) wake = t + 1000ull * ota;
+  const unsigned long ack = getConfigPushIdleTime();
+  if (ack < (wake - t) / 1000) wake = t + 1000ull * ack;
+  const time_t next = Alarm.getNextTrigger();
+  if (next != 0) {
+    const time_t current = now();
+    if (next <= current) return t;
+    const uint64_t alarm = (next - current >= 2) ? t + 1000000ull * (next - current - 1)
+                                                 : t + WAKE_ALARM_STEP;
+    if (alarm < wake) wake = alarm;
+  }
+  return wake;
+}
+
+
+bool firmwareStartImageTransfer() {
+  return startFirmwareDistribution();
+}
+
+
+FirmwareCounters firmwareCounters() {
+  FirmwareCounters c = {};
+  const PodStats &s = getPodStats();
+  for (uint8_t k = 0; k < REPLAY_TYPE_COUNT; k++) {
+    c.readings[k] = s.readings[k];
+    c.readFailures[k] = s.readFailures[k];
+  }
+  c.suppressed = s.readingsSuppressed;
+  c.postSuccesses = s.postSuccesses;
+  c.postFailures = s.postFailures;
+  c.postTimeouts = s.postTimeouts;
+  c.postTimeMax = s.postTimeMax;
+  c.loops = s.loops;
+  c.loopTimeMax = s.loopTimeMax;
+  getXBeeCounters(c.xbeeReceived,c.xbeeOverrun,c.packetsParsed);
+  c.packetsDropped = getPacketsDropped();
+  return c;
+}
+
+
+//==============================================================================
@@ -0,0 +1,90 @@
+/*==============================================================================
+  Helpers shared by the host-side tools that drive the firmware
+  (see harness.h).
+
+  This file is part of the LMN PODD distribution:
+    https://github.com/lmnts/PODD
+
+  CONTRIBUTORS:
+    PODD contributors (2026)
+
+  COPYRIGHT/LICENSE:
+  Copyright (c) 2026 LMN Architects
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Affero General Public License as
+  published by the Free Software Foundation, either version 3 of the
+  License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Affero General Public License for more details.
+
+  You should have received a copy of the GNU Affero General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+==============================================================================*/
+
+#include "harness.h"
+
+#include "podd_csv.h"
+#include "sim.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+
+// Constants/global variables ==================================================
+
+const char * const READING_NAMES[REPLAY_TYPE_COUNT] = {
+  "Light", "Humidity", "AirTemp", "GlobeTemp", "Sound", "CO2", "PM_2.5", "PM_10", "CO"
+};
+
+// Reading type whose values are sent as integers (formatReadingValue())
+#define READING_TYPE_CO2 5
+
+
+// Functions ===================================================================
+
+/* Packets are framed as '\x02', the message length in two hex digits,
+   the message and '\x03'. */
+void queueXBeeMessage(const uint64_t at, const char *message) {
+  char packet[256];
+  const int m = snprintf(packet,sizeof(packet),"\x02%02X%s\x03",
+                         (unsigned)(strlen(message) % 256),message);
+  xbeeQueueIncoming(at,packet,std::min(m,(int)sizeof(packet) - 1));
+}
+
+
+/* Readings are "V,DEVID,TYPE,VALUE,TIMESTAMP,DATETIME".  Device IDs
+   are cut to the firmware's 16 characters. */
+void queueDronePacket(const uint64_t at, const char *devid, const uint8_t type,
+                      const float value, const int64_t utc) {
+  char v[32], dt[DATETIME_LEN];
+  snprintf(v,sizeof(v),(type == READING_TYPE_CO2) ? "%.0f" : "%.2f",value);
+  formatDateTime(dt,utc);
+  char message[128];
+  snprintf(message,sizeof(message),"V,%.16s,%s,%s,%lld,%s",
+           devid,READING_NAMES[type],v,(long long)utc,dt);
+  queueXBeeMessage(at,message);
+}
+
+
+DelayStats delayStats(std::vector<double> &d) {
+  DelayStats s;
+  s.count = d.size();
+  if (d.empty()) return s;
+  std::sort(d.begin(),d.end());
+  double sum = 0;
+  for (const double x : d) sum += x;
+  s.mean = sum / d.size();
+  s.p50 = d[(d.size() - 1) / 2];
+  s.p95 = d[(size_t)(0.95 * (d.size() - 1))];
+  s.max = d.back();
+  return s;
+}
+
+
+//==============================================================================
@@ -0,0 +1,67 @@
+/*==============================================================================
+  Helpers shared by the host-side tools that drive the firmware
+  (podd_replay, podd_load): drone packets and delay statistics.
+
+  This file is part of the LMN PODD distribution:
+    https://github.com/lmnts/PODD
+
+  CONTRIBUTORS:
+    PODD contributors (2026)
+
+  COPYRIGHT/LICENSE:
+  Copyright (c) 2026 LMN Architects
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Affero General Public License as
+  published by the Free Software Foundation, either version 3 of the
+  License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Affero General Public License for more details.
+
+  You should have received a copy of the GNU Affero General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+==============================================================================*/
+
+#pragma once
+
+// Standard libraries
+#include <cstdint>
+#include <vector>
+// Local headers
+#include "replay.h"
+
+
+// Constants/global variables ==================================================
+
+// Firmware reading names (pod_network.cpp), in ReadingType order.
+extern const char * const READING_NAMES[REPLAY_TYPE_COUNT];
+
+// Drones send each reading with a one second pause (postReading()).
+#define DRONE_PACKET_SPACING 1000000
+
+// Delay statistics [s].
+struct DelayStats {
+  uint64_t count = 0;
+  double mean = 0, p50 = 0, p95 = 0, max = 0;
+};
+
+
+// Functions ===================================================================
+
+// Queues an XBee packet (sendXBee() framing) with the given message,
+// to arrive at simulated time 'at' [us].
+void queueXBeeMessage(const uint64_t at, const char *message);
+// Queues the XBee packet a drone sends (sendXBee()) for a reading of
+// the given type and time, to arrive at simulated time 'at' [us].
+void queueDronePacket(const uint64_t at, const char *devid, const uint8_t type,
+                      const float value, const int64_t utc);
+
+// Statistics of the given delays (sorted in place).
+DelayStats delayStats(std::vector<double> &d);
+
+
+//==============================================================================
@@ -0,0 +1,235 @@
+/*==============================================================================
+  Host stand-in for the Teensy++ 2.0 Arduino core, for running the PODD
+  firmware in the replay harness (see ../README.md).  Only what the
+  firmware uses is provided.  Timing routines run on the simulated clock
+  (see sim.h); USB serial output goes to the console log.
+
+  This file is part of the LMN PODD distribution:
+    https://github.com/lmnts/PODD
+
+  COPYRIGHT/LICENSE:
+  Copyright (c) 2019 LMN Architects
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Affero General Public License as
+  published by the Free Software Foundation, either version 3 of the
+  License, or (at your option) any later version.
+
+==============================================================================*/
+
+#pragma once
+
+// Standard headers must come before the min/max/abs macros below.
+#include <ctype.h>
+#include <math.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "avr/interrupt.h"
+#include "avr/io.h"
+#include "avr/pgmspace.h"
+
+#define F_CPU 8000000UL
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+
+#define DEC 10
+#define HEX 16
+#define OCT 8
+#define BIN 2
+
+// Teensy++ 2.0 pin numbers
+enum {
+  PIN_D0 = 0, PIN_D1, PIN_D2, PIN_D3, PIN_D4, PIN_D5, PIN_D6, PIN_D7,
+  PIN_E0, PIN_E1,
+  PIN_C0, PIN_C1, PIN_C2, PIN_C3, PIN_C4, PIN_C5, PIN_C6, PIN_C7,
+  PIN_E6, PIN_E7,
+  PIN_B0, PIN_B1, PIN_B2, PIN_B3, PIN_B4, PIN_B5, PIN_B6, PIN_B7,
+  PIN_A0, PIN_A1, PIN_A2, PIN_A3, PIN_A4, PIN_A5, PIN_A6, PIN_A7,
+  PIN_E4, PIN_E5,
+  PIN_F0, PIN_F1, PIN_F2, PIN_F3, PIN_F4, PIN_F5, PIN_F6, PIN_F7
+};
+#define A0 38
+#define A1 39
+#define A2 40
+#define A3 41
+#define A4 42
+#define A5 43
+#define A6 44
+#define A7 45
+#define LED_BUILTIN 6
+#define NUM_DIGITAL_PINS 46
+#define CORE_NUM_TOTAL_PINS 46
+
+#define EXTERNAL 0
+#define DEFAULT 1
+#define INTERNAL 3
+
+#define min(a,b) ((a)<(b)?(a):(b))
+#define max(a,b) ((a)>(b)?(a):(b))
+#define abs(x) ((x)>0?(x):-(x))
+#define constrain(x,lo,hi) ((x)<(lo)?(lo):((x)>(hi)?(hi):(x)))
+#define bitRead(v,b) (((v) >> (b)) & 0x01)
+#define bitSet(v,b) ((v) |= (1UL << (b)))
+#define bitClear(v,b) ((v) &= ~(1UL << (b)))
+#define lowByte(w) ((uint8_t)((w) & 0xff))
+#define highByte(w) ((uint8_t)((w) >> 8))
+#define _BV(b) (1 << (b))
+
+#define interrupts() sei()
+#define noInterrupts() cli()
+
+// Timing: the simulated clock (see sim.h)
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void yield();
+
+// Pins: states are only recorded
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+int analogRead(uint8_t pin);
+void analogReference(uint8_t mode);
+void analogWrite(uint8_t pin, int value);
+
+long random(long howbig);
+long random(long howsmall, long howbig);
+void randomSeed(unsigned long seed);
+
+char* dtostrf(double val, signed char width, unsigned char prec, char *buff);
+
+// USB registers (written when the drones power down USB)
+extern volatile uint8_t USBCON;
+#define FRZCLK 5
+
+
+//------------------------------------------------------------------------------
+// Strings kept in flash on the AVR: plain strings here.
+
+class __FlashStringHelper;
+#define F(s) ((const __FlashStringHelper*)(s))
+
+#include "WString.h"
+
+
+//------------------------------------------------------------------------------
+// Print/Stream/serial classes
+
+class Print;
+
+class Printable {
+  public:
+    virtual ~Printable() {}
+    virtual size_t printTo(Print &p) const = 0;
+};
+
+class Print {
+  public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t *buff, size_t n);
+    size_t write(const char *s) {return (s == NULL) ? 0 : write((const uint8_t*)s,strlen(s));}
+    size_t write(const char *buff, size_t n) {return write((const uint8_t*)buff,n);}
+    virtual void flush() {}
+
+    size_t print(const __FlashStringHelper *s) {return write((const char*)s);}
+    size_t print(const String &s) {return write(s.c_str(),s.length());}
+    size_t print(const char *s) {return write(s);}
+    size_t print(char c) {return write((uint8_t)c);}
+    size_t print(unsigned char v, int base=DEC) {return printNumber(v,base);}
+    size_t print(int v, int base=DEC) {return printSigned(v,base);}
+    size_t print(unsigned int v, int base=DEC) {return printNumber(v,base);}
+    size_t print(long v, int base=DEC) {return printSigned(v,base);}
+    size_t print(unsigned long v, int base=DEC) {return printNumber(v,base);}
+    size_t print(long long v, int base=DEC) {return printSigned(v,base);}
+    size_t print(unsigned long long v, int base=DEC) {return printNumber(v,base);}
+    size_t print(double v, int digits=2) {return printFloat(v,digits);}
+    size_t print(const Printable &v) {return v.printTo(*this);}
+
+    size_t println() {return write("\r\n");}
+    template<typename T> size_t println(const T &v) {size_t n = print(v); return n + println();}
+    template<typename T> size_t println(const T &v, int f) {size_t n = print(v,f); return n + println();}
+    size_t println(const char *s) {size_t n = print(s); return n + println();}
+    size_t println(const __FlashStringHelper *s) {size_t n = print(s); return n + println();}
+
+    int printf(const char *format, ...);
+
+  private:
+    size_t printNumber(unsigned long long v, int base);
+    size_t printSigned(long long v, int base);
+    size_t printFloat(double v, int digits);
+};
+
+class Stream : public Print {
+  public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+    void setTimeout(unsigned long timeout) {_timeout = timeout;}
+    size_t readBytes(char *buff, size_t n);
+    size_t readBytesUntil(char terminator, char *buff, size_t n);
+    String readString();
+    String readStringUntil(char terminator);
+    long parseInt();
+    float parseFloat();
+    bool find(const char *target);
+  protected:
+    int timedRead();
+    int timedPeek();
+    unsigned long _timeout = 1000;
+};
+
+// USB serial: output to the console log, no input.
+class usb_serial_class : public Stream {
+  public:
+    void begin(long) {}
+    void end() {}
+    int available() {return 0;}
+    int read() {return -1;}
+    int peek() {return -1;}
+    void flush() {}
+    void clear() {}
+    size_t write(uint8_t c);
+    size_t write(const uint8_t *buff, size_t n);
+    using Print::write;
+    int availableForWrite() {return 64;}
+    operator bool() {return true;}
+};
+
+// Hardware serial port 1: the XBee radio (see sim.h).
+class HardwareSerial : public Stream {
+  public:
+    void begin(long baud);
+    void end() {}
+    int available();
+    int read();
+    int peek();
+    void flush();
+    void clear();
+    size_t write(uint8_t c) {return write(&c,1);}
+    size_t write(const uint8_t *buff, size_t n);
+    using Print::write;
+    int availableForWrite() {return 64;}
+    operator bool() {return true;}
+};
+
+extern usb_serial_class Serial;
+extern HardwareSerial Serial1;
+
+class Client : public Stream {};
+
+
+//==============================================================================
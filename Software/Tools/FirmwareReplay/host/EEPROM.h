@@ -0,0 +1,47 @@
+/*==============================================================================
+  Host stand-in for the Arduino EEPROM library: 4 KB of memory,
+  initially erased (0xFF).
+
+  This file is part of the LMN PODD distribution:
+    https://github.com/lmnts/PODD
+
+  COPYRIGHT/LICENSE:
+  Copyright (c) 2019 LMN Architects
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Affero General Public License as
+  published by the Free Software Foundation, either version 3 of the
+  License, or (at your option) any later version.
+
+==============================================================================*/
+
+#pragma once
+
+#include <Arduino.h>
+
+#define EEPROM_SIZE 4096
+
+class EEPROMClass {
+  public:
+    EEPROMClass() {memset(data,0xFF,sizeof(data));}
+    uint8_t read(int addr) const {return ((addr >= 0) && (addr < EEPROM_SIZE)) ? data[addr] : 0xFF;}
+    void write(int addr, uint8_t v) {if ((addr >= 0) && (addr < EEPROM_SIZE)) data[addr] = v;}
+    void update(int addr, uint8_t v) {write(addr,v);}
+    uint8_t operator[](int addr) const {return read(addr);}
+    uint16_t length() const {return EEPROM_SIZE;}
+    template<typename T> T& get(int addr, T &t) const {
+      for (size_t k = 0; k < sizeof(T); k++) ((uint8_t*)&t)[k] = read(addr + k);
+      return t;
+    }
+    template<typename T> const T& put(int addr, const T &t) {
+      for (size_t k = 0; k < sizeof(T); k++) write(addr + k,((const uint8_t*)&t)[k]);
+      return t;
+    }
+  private:
+    uint8_t data[EEPROM_SIZE];
+};
+
+extern EEPROMClass EEPROM;
+
+
+//==============================================================================
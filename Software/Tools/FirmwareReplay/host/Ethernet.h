@@ -0,0 +1,88 @@
+/*==============================================================================
+  Host stand-in for the Arduino Ethernet library (WIZnet W5100).  The
+  network behind it is the harness's NetworkModel (see sim.h): DHCP
+  succeeds while the network is up, and TCP clients hand their request
+  to the model once it has been sent, reading back its response when
+  the model says it arrives.  Servers never see a connection.
+
+  This file is part of the LMN PODD distribution:
+    https://github.com/lmnts/PODD
+
+  COPYRIGHT/LICENSE:
+  Copyright (c) 2019 LMN Architects
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Affero General Public License as
+  published by the Free Software Foundation, either version 3 of the
+  License, or (at your option) any later version.
+
+==============================================================================*/
+
+#pragma once
+
+#include <Arduino.h>
+#include "IPAddress.h"
+
+#define MAX_SOCK_NUM 4
+
+enum EthernetLinkStatus {Unknown, LinkON, LinkOFF};
+enum EthernetHardwareStatus {EthernetNoHardware, EthernetW5100};
+
+class EthernetClass {
+  public:
+    void init(uint8_t) {}
+    int begin(uint8_t *mac, unsigned long timeout=60000, unsigned long responseTimeout=4000);
+    void begin(uint8_t *mac, IPAddress ip, IPAddress dns, IPAddress gateway, IPAddress subnet);
+    int maintain() {return 0;}
+    IPAddress localIP() const {return ip;}
+    IPAddress subnetMask() const {return subnet;}
+    IPAddress gatewayIP() const {return gateway;}
+    IPAddress dnsServerIP() const {return dns;}
+    EthernetLinkStatus linkStatus();
+    EthernetHardwareStatus hardwareStatus() const {return EthernetW5100;}
+  private:
+    IPAddress ip, dns, gateway, subnet;
+};
+
+extern EthernetClass Ethernet;
+
+class EthernetClient : public Client {
+  public:
+    EthernetClient() {}
+    ~EthernetClient() {stop();}
+    int connect(const char *host, uint16_t port);
+    int connect(IPAddress ip, uint16_t port);
+    size_t write(uint8_t c) {return write(&c,1);}
+    size_t write(const uint8_t *buff, size_t n);
+    using Print::write;
+    int available();
+    // Room in the socket's transmit buffer (2 KB on the W5100); sends
+    // complete at once here
+    int availableForWrite() {return open ? 2048 : 0;}
+    int read();
+    int peek();
+    void flush();
+    void stop();
+    uint8_t connected();
+    operator bool() {return open;}
+    uint8_t getSocketNumber() const {return open ? 0 : MAX_SOCK_NUM;}
+  private:
+    bool open = false;
+    String request;
+    size_t sent = 0;
+    uint64_t responseTime = 0;
+    const char *response = NULL;
+    size_t responseLen = 0, responsePos = 0;
+    void send();
+};
+
+// No incoming connections: the harness has no clients on the LAN.
+class EthernetServer {
+  public:
+    EthernetServer(uint16_t) {}
+    void begin() {}
+    EthernetClient available() {return EthernetClient();}
+};
+
+
+//==============================================================================
@@ -0,0 +1,52 @@
+/*==============================================================================
+  Host stand-in for the Arduino EthernetUdp class.  The only UDP
+  traffic is NTP, so each request is answered by a simulated time
+  server from the harness's clock (one stratum-1 reply, after a short
+  delay, while the network is up).
+
+  This file is part of the LMN PODD distribution:
+    https://github.com/lmnts/PODD
+
+  COPYRIGHT/LICENSE:
+  Copyright (c) 2019 LMN Architects
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Affero General Public License as
+  published by the Free Software Foundation, either version 3 of the
+  License, or (at your option) any later version.
+
+==============================================================================*/
+
+#pragma once
+
+#include <Ethernet.h>
+
+class EthernetUDP : public Stream {
+  public:
+    uint8_t begin(uint16_t) {return 1;}
+    void stop() {pending = false; length = 0;}
+    int beginPacket(const char *host, uint16_t port);
+    int beginPacket(IPAddress ip, uint16_t port);
+    int endPacket();
+    size_t write(uint8_t c) {return write(&c,1);}
+    size_t write(const uint8_t *buff, size_t n);
+    using Print::write;
+    int parsePacket();
+    int available() {return length - pos;}
+    int read();
+    int read(uint8_t *buff, size_t n);
+    int read(char *buff, size_t n) {return read((uint8_t*)buff,n);}
+    int peek() {return (pos < length) ? packet[pos] : -1;}
+    void flush() {pos = length;}
+  private:
+    uint8_t out[48];
+    size_t outLen = 0;
+    // Reply in flight / being read
+    bool pending = false;
+    uint64_t replyTime = 0;
+    uint8_t packet[48];
+    size_t length = 0, pos = 0;
+};
+
+
+//==============================================================================
@@ -0,0 +1,41 @@
+/*==============================================================================
+  Host stand-in for the Arduino IPAddress class.
+
+  This file is part of the LMN PODD distribution:
+    https://github.com/lmnts/PODD
+
+  COPYRIGHT/LICENSE:
+  Copyright (c) 2019 LMN Architects
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Affero General Public License as
+  published by the Free Software Foundation, either version 3 of the
+  License, or (at your option) any later version.
+
+==============================================================================*/
+
+#pragma once
+
+#include <Arduino.h>
+
+class IPAddress : public Printable {
+  public:
+    IPAddress() : addr(0) {}
+    IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d)
+      : addr((uint32_t)a | ((uint32_t)b << 8) | ((uint32_t)c << 16) | ((uint32_t)d << 24)) {}
+    IPAddress(uint32_t v) : addr(v) {}
+    operator uint32_t() const {return addr;}
+    bool operator==(const IPAddress &ip) const {return addr == ip.addr;}
+    bool operator!=(const IPAddress &ip) const {return addr != ip.addr;}
+    uint8_t operator[](int k) const {return (addr >> (8*k)) & 0xFF;}
+    uint8_t& operator[](int k) {return ((uint8_t*)&addr)[k];}  // little-endian host
+    bool fromString(const char *s);
+    bool fromString(const String &s) {return fromString(s.c_str());}
+    size_t printTo(Print &p) const;
+  private:
+    // Network byte order: first octet in the low byte, as on the AVR
+    uint32_t addr;
+};
+
+
+//==============================================================================
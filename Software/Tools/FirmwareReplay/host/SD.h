@@ -0,0 +1,93 @@
+/*==============================================================================
+  Host stand-in for the Arduino SD library: files live under a
+  directory on the host (see SD.setRoot()).
+
+  This file is part of the LMN PODD distribution:
+    https://github.com/lmnts/PODD
+
+  COPYRIGHT/LICENSE:
+  Copyright (c) 2019 LMN Architects
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Affero General Public License as
+  published by the Free Software Foundation, either version 3 of the
+  License, or (at your option) any later version.
+
+==============================================================================*/
+
+#pragma once
+
+#include <Arduino.h>
+
+// Open flags, with the values of the SdFat library underneath SD.
+// Appending and creating have their own names here, as the host's
+// <fcntl.h> owns O_APPEND and O_CREAT.  As on the card, FILE_WRITE
+// appends: every write goes to the end of the file, whatever the seek.
+#define O_READ 0x01
+#define O_WRITE 0x02
+#define SD_O_APPEND 0x04
+#define SD_O_CREAT 0x10
+#define FILE_READ O_READ
+#define FILE_WRITE (O_READ | O_WRITE | SD_O_CREAT | SD_O_APPEND)
+
+#define FAT_DATE(y,m,d) (uint16_t)((((y) - 1980) << 9) | ((m) << 5) | (d))
+#define FAT_TIME(h,m,s) (uint16_t)(((h) << 11) | ((m) << 5) | ((s) >> 1))
+
+class SdFile {
+  public:
+    static void dateTimeCallback(void (*)(uint16_t*, uint16_t*)) {}
+};
+
+// Copies share the open host file, which is closed when the last copy
+// goes (or on close()).
+class File : public Stream {
+  public:
+    File() : handle(NULL) {}
+    File(const File &f);
+    File& operator=(const File &f);
+    ~File();
+    size_t write(uint8_t c) {return write(&c,1);}
+    size_t write(const uint8_t *buff, size_t n);
+    using Print::write;
+    int available();
+    int read();
+    int read(void *buff, uint16_t n);
+    int peek();
+    void flush();
+    bool seek(uint32_t pos);
+    uint32_t position();
+    uint32_t size();
+    void close();
+    operator bool() const {return (handle != NULL) && (handle->f != NULL);}
+  private:
+    struct Handle {
+      FILE *f;
+      int refs;
+      bool writing;   // last access was a write
+      bool append;    // writes go to the end
+    };
+    Handle *handle;
+    friend class SDClass;
+    void release();
+    FILE* reading();
+};
+
+class SDClass {
+  public:
+    // Host directory holding the card contents
+    void setRoot(const char *dir);
+    const char* root() const {return rootDir;}
+    bool begin(uint8_t) {return rootDir[0] != '\0';}
+    bool exists(const char *path);
+    bool mkdir(const char *path);
+    bool remove(const char *path);
+    File open(const char *path, uint8_t mode=FILE_READ);
+  private:
+    char rootDir[256] = "";
+    void hostPath(char *buff, size_t size, const char *path) const;
+};
+
+extern SDClass SD;
+
+
+//==============================================================================
@@ -0,0 +1,48 @@
+/*==============================================================================
+  Host stand-in for the Arduino SPI library.  The DS3234 clock is the
+  only device addressed through it, so transactions select the simulated
+  RTC (see sim.h).
+
+  This file is part of the LMN PODD distribution:
+    https://github.com/lmnts/PODD
+
+  COPYRIGHT/LICENSE:
+  Copyright (c) 2019 LMN Architects
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Affero General Public License as
+  published by the Free Software Foundation, either version 3 of the
+  License, or (at your option) any later version.
+
+==============================================================================*/
+
+#pragma once
+
+#include <Arduino.h>
+
+#define MSBFIRST 1
+#define LSBFIRST 0
+#define SPI_MODE0 0x00
+#define SPI_MODE1 0x04
+#define SPI_MODE2 0x08
+#define SPI_MODE3 0x0C
+
+class SPISettings {
+  public:
+    SPISettings() {}
+    SPISettings(uint32_t, uint8_t, uint8_t) {}
+};
+
+class SPIClass {
+  public:
+    void begin() {}
+    void end() {}
+    void beginTransaction(SPISettings);
+    void endTransaction();
+    uint8_t transfer(uint8_t v);
+};
+
+extern SPIClass SPI;
+
+
+//==============================================================================
@@ -0,0 +1,39 @@
+/*==============================================================================
+  Host stand-in for the TimerOne library: the attached routine runs
+  on the simulated clock (see sim.h).
+
+  This file is part of the LMN PODD distribution:
+    https://github.com/lmnts/PODD
+
+  COPYRIGHT/LICENSE:
+  Copyright (c) 2019 LMN Architects
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Affero General Public License as
+  published by the Free Software Foundation, either version 3 of the
+  License, or (at your option) any later version.
+
+==============================================================================*/
+
+#pragma once
+
+#include <Arduino.h>
+
+class TimerOne {
+  public:
+    void initialize(unsigned long microseconds=1000000) {period = microseconds;}
+    void setPeriod(unsigned long microseconds) {period = microseconds;}
+    void attachInterrupt(void (*isr)(), unsigned long microseconds=0);
+    void detachInterrupt();
+    void start() {}
+    void stop() {}
+    void restart() {}
+    void resume() {}
+  private:
+    unsigned long period = 1000000;
+};
+
+extern TimerOne Timer1;
+
+
+//==============================================================================
@@ -0,0 +1,37 @@
+/*==============================================================================
+  Host stand-in for the TimerThree library (used by the sensor
+  routines, which the harness replaces): no effect.
+
+  This file is part of the LMN PODD distribution:
+    https://github.com/lmnts/PODD
+
+  COPYRIGHT/LICENSE:
+  Copyright (c) 2019 LMN Architects
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Affero General Public License as
+  published by the Free Software Foundation, either version 3 of the
+  License, or (at your option) any later version.
+
+==============================================================================*/
+
+#pragma once
+
+#include <Arduino.h>
+
+class TimerThree {
+  public:
+    void initialize(unsigned long=1000000) {}
+    void setPeriod(unsigned long) {}
+    void attachInterrupt(void (*)(), unsigned long=0) {}
+    void detachInterrupt() {}
+    void start() {}
+    void stop() {}
+    void restart() {}
+    void resume() {}
+};
+
+extern TimerThree Timer3;
+
+
+//==============================================================================
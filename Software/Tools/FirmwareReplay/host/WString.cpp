@@ -0,0 +1,338 @@
+/*==============================================================================
+  Host stand-in for the Arduino String class (see Arduino.h).
+
+  This file is part of the LMN PODD distribution:
+    https://github.com/lmnts/PODD
+
+  COPYRIGHT/LICENSE:
+  Copyright (c) 2019 LMN Architects
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Affero General Public License as
+  published by the Free Software Foundation, either version 3 of the
+  License, or (at your option) any later version.
+
+==============================================================================*/
+
+#include "Arduino.h"
+
+#include <strings.h>
+
+
+// Functions ===================================================================
+
+/* Formats an integer in the given base (2-36) into buff (>= 66 bytes). */
+static const char* formatInteger(char *buff, unsigned long long v, bool negative, unsigned char base) {
+  if ((base < 2) || (base > 36)) base = 10;
+  char *p = buff + 65;
+  *p = '\0';
+  do {
+    const unsigned d = v % base;
+    *--p = (d < 10) ? '0' + d : 'a' + d - 10;
+    v /= base;
+  } while (v > 0);
+  if (negative) *--p = '-';
+  return p;
+}
+
+
+String::String(const char *s) : _buffer(NULL), _capacity(0), _len(0) {
+  if (s == NULL) s = "";
+  assign(s,strlen(s));
+}
+
+String::String(const String &s) : _buffer(NULL), _capacity(0), _len(0) {
+  assign(s._buffer,s._len);
+}
+
+String::String(String &&s) : _buffer(s._buffer), _capacity(s._capacity), _len(s._len) {
+  s._buffer = NULL;
+  s._capacity = 0;
+  s._len = 0;
+  s.assign("",0);
+}
+
+String::String(char c) : _buffer(NULL), _capacity(0), _len(0) {
+  assign(&c,1);
+}
+
+String::String(unsigned char v, unsigned char base) : String((unsigned long long)v,base) {}
+String::String(int v, unsigned char base) : String((long long)v,base) {}
+String::String(unsigned int v, unsigned char base) : String((unsigned long long)v,base) {}
+String::String(long v, unsigned char base) : String((long long)v,base) {}
+String::String(unsigned long v, unsigned char base) : String((unsigned long long)v,base) {}
+
+String::String(long long v, unsigned char base) : _buffer(NULL), _capacity(0), _len(0) {
+  char buff[66];
+  // Arduino formats negative values in other bases as unsigned
+  const bool negative = (v < 0) && (base == 10);
+  const unsigned long long u = negative ? 0 - (unsigned long long)v
+                             : (base == 10) ? (unsigned long long)v : (unsigned long)v;
+  const char *s = formatInteger(buff,u,negative,base);
+  assign(s,strlen(s));
+}
+
+String::String(unsigned long long v, unsigned char base) : _buffer(NULL), _capacity(0), _len(0) {
+  char buff[66];
+  const char *s = formatInteger(buff,v,false,base);
+  assign(s,strlen(s));
+}
+
+String::String(float v, unsigned char decimals) : String((double)v,decimals) {}
+
+String::String(double v, unsigned char decimals) : _buffer(NULL), _capacity(0), _len(0) {
+  char buff[64];
+  dtostrf(v,decimals + 2,decimals,buff);
+  assign(buff,strlen(buff));
+}
+
+String::~String() {
+  free(_buffer);
+}
+
+String& String::operator=(const String &s) {
+  if (this != &s) assign(s._buffer,s._len);
+  return *this;
+}
+
+String& String::operator=(String &&s) {
+  if (this != &s) {
+    free(_buffer);
+    _buffer = s._buffer;
+    _capacity = s._capacity;
+    _len = s._len;
+    s._buffer = NULL;
+    s._capacity = 0;
+    s._len = 0;
+    s.assign("",0);
+  }
+  return *this;
+}
+
+String& String::operator=(const char *s) {
+  if (s == NULL) s = "";
+  assign(s,strlen(s));
+  return *this;
+}
+
+bool String::reserve(unsigned int size) {
+  if ((_buffer != NULL) && (_capacity >= size)) return true;
+  char *b = (char*)realloc(_buffer,size + 1);
+  if (b == NULL) return false;
+  if (_buffer == NULL) b[0] = '\0';
+  _buffer = b;
+  _capacity = size;
+  return true;
+}
+
+void String::assign(const char *s, unsigned int n) {
+  if (!reserve(n)) return;
+  memmove(_buffer,s,n);
+  _buffer[n] = '\0';
+  _len = n;
+}
+
+bool String::concat(const char *s) {
+  return (s != NULL) && concat(s,strlen(s));
+}
+
+bool String::concat(const char *s, unsigned int n) {
+  if (n == 0) return true;
+  unsigned int size = _capacity;
+  while (size < _len + n) size = (size < 16) ? 16 : 2*size;
+  // s may point into this string
+  const bool inside = (_buffer != NULL) && (s >= _buffer) && (s < _buffer + _len);
+  const size_t offset = inside ? s - _buffer : 0;
+  if (!reserve(size)) return false;
+  memmove(_buffer + _len,inside ? _buffer + offset : s,n);
+  _len += n;
+  _buffer[_len] = '\0';
+  return true;
+}
+
+int String::compareTo(const String &s) const {
+  return strcmp(_buffer,s._buffer);
+}
+
+bool String::equals(const String &s) const {
+  return (_len == s._len) && (memcmp(_buffer,s._buffer,_len) == 0);
+}
+
+bool String::equals(const char *s) const {
+  return strcmp(_buffer,(s == NULL) ? "" : s) == 0;
+}
+
+bool String::equalsIgnoreCase(const String &s) const {
+  return (_len == s._len) && (strcasecmp(_buffer,s._buffer) == 0);
+}
+
+bool String::startsWith(const String &s) const {
+  return startsWith(s,0);
+}
+
+bool String::startsWith(const String &s, unsigned int offset) const {
+  return (offset + s._len <= _len) && (memcmp(_buffer + offset,s._buffer,s._len) == 0);
+}
+
+bool String::endsWith(const String &s) const {
+  return (s._len <= _len) && (memcmp(_buffer + _len - s._len,s._buffer,s._len) == 0);
+}
+
+char String::charAt(unsigned int index) const {
+  return (index < _len) ? _buffer[index] : '\0';
+}
+
+void String::setCharAt(unsigned int index, char c) {
+  if (index < _len) _buffer[index] = c;
+}
+
+char String::operator[](unsigned int index) const {
+  return charAt(index);
+}
+
+char& String::operator[](unsigned int index) {
+  static char dummy;
+  if (index >= _len) {
+    dummy = '\0';
+    return dummy;
+  }
+  return _buffer[index];
+}
+
+void String::getBytes(unsigned char *buff, unsigned int size, unsigned int index) const {
+  if ((size == 0) || (buff == NULL)) return;
+  if (index >= _len) {
+    buff[0] = '\0';
+    return;
+  }
+  unsigned int n = _len - index;
+  if (n > size - 1) n = size - 1;
+  memcpy(buff,_buffer + index,n);
+  buff[n] = '\0';
+}
+
+int String::indexOf(char c, unsigned int from) const {
+  if (from >= _len) return -1;
+  const char *p = strchr(_buffer + from,c);
+  return (p == NULL) ? -1 : p - _buffer;
+}
+
+int String::indexOf(const String &s, unsigned int from) const {
+  if (from > _len) return -1;
+  const char *p = strstr(_buffer + from,s._buffer);
+  return (p == NULL) ? -1 : p - _buffer;
+}
+
+int String::lastIndexOf(char c) const {
+  return (_len == 0) ? -1 : lastIndexOf(c,_len - 1);
+}
+
+int String::lastIndexOf(char c, unsigned int from) const {
+  if (from >= _len) return -1;
+  for (int k = from; k >= 0; k--) {
+    if (_buffer[k] == c) return k;
+  }
+  return -1;
+}
+
+int String::lastIndexOf(const String &s) const {
+  if (s._len > _len) return -1;
+  for (int k = _len - s._len; k >= 0; k--) {
+    if (memcmp(_buffer + k,s._buffer,s._len) == 0) return k;
+  }
+  return -1;
+}
+
+String String::substring(unsigned int from, unsigned int to) const {
+  if (from > to) {
+    const unsigned int t = from;
+    from = to;
+    to = t;
+  }
+  if (from >= _len) return String();
+  if (to > _len) to = _len;
+  String s;
+  s.assign(_buffer + from,to - from);
+  return s;
+}
+
+void String::replace(char find, char replacement) {
+  for (unsigned int k = 0; k < _len; k++) {
+    if (_buffer[k] == find) _buffer[k] = replacement;
+  }
+}
+
+void String::replace(const String &find, const String &replacement) {
+  if (find._len == 0) return;
+  String result;
+  unsigned int k = 0;
+  while (k < _len) {
+    const char *p = strstr(_buffer + k,find._buffer);
+    if (p == NULL) break;
+    result.concat(_buffer + k,p - _buffer - k);
+    result.concat(replacement);
+    k = p - _buffer + find._len;
+  }
+  result.concat(_buffer + k,_len - k);
+  *this = result;
+}
+
+void String::remove(unsigned int index) {
+  remove(index,(unsigned int)-1);
+}
+
+void String::remove(unsigned int index, unsigned int count) {
+  if (index >= _len) return;
+  if (count > _len - index) count = _len - index;
+  memmove(_buffer + index,_buffer + index + count,_len - index - count + 1);
+  _len -= count;
+}
+
+void String::toLowerCase() {
+  for (unsigned int k = 0; k < _len; k++) _buffer[k] = tolower(_buffer[k]);
+}
+
+void String::toUpperCase() {
+  for (unsigned int k = 0; k < _len; k++) _buffer[k] = toupper(_buffer[k]);
+}
+
+void String::trim() {
+  unsigned int a = 0, b = _len;
+  while ((a < b) && isspace((unsigned char)_buffer[a])) a++;
+  while ((b > a) && isspace((unsigned char)_buffer[b-1])) b--;
+  memmove(_buffer,_buffer + a,b - a);
+  _len = b - a;
+  _buffer[_len] = '\0';
+}
+
+long String::toInt() const {
+  return atol(_buffer);
+}
+
+float String::toFloat() const {
+  return (float)atof(_buffer);
+}
+
+double String::toDouble() const {
+  return atof(_buffer);
+}
+
+
+String operator+(const String &a, const String &b) {String s(a); s.concat(b); return s;}
+String operator+(const String &a, const char *b) {String s(a); s.concat(b); return s;}
+String operator+(const char *a, const String &b) {String s(a); s.concat(b); return s;}
+String operator+(const String &a, const __FlashStringHelper *b) {String s(a); s.concat(b); return s;}
+String operator+(const __FlashStringHelper *a, const String &b) {String s(a); s.concat(b); return s;}
+String operator+(const String &a, char b) {String s(a); s.concat(b); return s;}
+String operator+(const String &a, unsigned char b) {String s(a); s.concat(b); return s;}
+String operator+(const String &a, int b) {String s(a); s.concat(b); return s;}
+String operator+(const String &a, unsigned int b) {String s(a); s.concat(b); return s;}
+String operator+(const String &a, long b) {String s(a); s.concat(b); return s;}
+String operator+(const String &a, unsigned long b) {String s(a); s.concat(b); return s;}
+String operator+(const String &a, long long b) {String s(a); s.concat(b); return s;}
+String operator+(const String &a, unsigned long long b) {String s(a); s.concat(b); return s;}
+String operator+(const String &a, float b) {String s(a); s.concat(b); return s;}
+String operator+(const String &a, double b) {String s(a); s.concat(b); return s;}
+
+
+//==============================================================================
@@ -0,0 +1,134 @@
+/*==============================================================================
+  Host stand-in for the Arduino String class (see Arduino.h).
+
+  This file is part of the LMN PODD distribution:
+    https://github.com/lmnts/PODD
+
+  COPYRIGHT/LICENSE:
+  Copyright (c) 2019 LMN Architects
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Affero General Public License as
+  published by the Free Software Foundation, either version 3 of the
+  License, or (at your option) any later version.
+
+==============================================================================*/
+
+#pragma once
+
+#include <stddef.h>
+
+class __FlashStringHelper;
+
+class String {
+  public:
+    String(const char *s = "");
+    String(const String &s);
+    String(String &&s);
+    String(const __FlashStringHelper *s) : String((const char*)s) {}
+    explicit String(char c);
+    String(unsigned char v, unsigned char base=10);
+    String(int v, unsigned char base=10);
+    String(unsigned int v, unsigned char base=10);
+    String(long v, unsigned char base=10);
+    String(unsigned long v, unsigned char base=10);
+    String(long long v, unsigned char base=10);
+    String(unsigned long long v, unsigned char base=10);
+    String(float v, unsigned char decimals=2);
+    String(double v, unsigned char decimals=2);
+    ~String();
+
+    String& operator=(const String &s);
+    String& operator=(String &&s);
+    String& operator=(const char *s);
+    String& operator=(const __FlashStringHelper *s) {return *this = (const char*)s;}
+
+    unsigned int length() const {return _len;}
+    const char* c_str() const {return _buffer;}
+    bool reserve(unsigned int size);
+
+    bool concat(const String &s) {return concat(s._buffer,s._len);}
+    bool concat(const char *s);
+    bool concat(const char *s, unsigned int n);
+    bool concat(char c) {return concat(&c,1);}
+    bool concat(unsigned char v) {return concat(String(v));}
+    bool concat(int v) {return concat(String(v));}
+    bool concat(unsigned int v) {return concat(String(v));}
+    bool concat(long v) {return concat(String(v));}
+    bool concat(unsigned long v) {return concat(String(v));}
+    bool concat(long long v) {return concat(String(v));}
+    bool concat(unsigned long long v) {return concat(String(v));}
+    bool concat(float v) {return concat(String(v));}
+    bool concat(double v) {return concat(String(v));}
+    bool concat(const __FlashStringHelper *s) {return concat((const char*)s);}
+    template<typename T> String& operator+=(const T &v) {concat(v); return *this;}
+
+    int compareTo(const String &s) const;
+    bool equals(const String &s) const;
+    bool equals(const char *s) const;
+    bool equalsIgnoreCase(const String &s) const;
+    bool startsWith(const String &s) const;
+    bool startsWith(const String &s, unsigned int offset) const;
+    bool endsWith(const String &s) const;
+    bool operator==(const String &s) const {return equals(s);}
+    bool operator==(const char *s) const {return equals(s);}
+    bool operator!=(const String &s) const {return !equals(s);}
+    bool operator!=(const char *s) const {return !equals(s);}
+    bool operator<(const String &s) const {return compareTo(s) < 0;}
+    bool operator>(const String &s) const {return compareTo(s) > 0;}
+
+    char charAt(unsigned int index) const;
+    void setCharAt(unsigned int index, char c);
+    char operator[](unsigned int index) const;
+    char& operator[](unsigned int index);
+    void getBytes(unsigned char *buff, unsigned int size, unsigned int index=0) const;
+    void toCharArray(char *buff, unsigned int size, unsigned int index=0) const
+      {getBytes((unsigned char*)buff,size,index);}
+
+    int indexOf(char c) const {return indexOf(c,0);}
+    int indexOf(char c, unsigned int from) const;
+    int indexOf(const String &s) const {return indexOf(s,0);}
+    int indexOf(const String &s, unsigned int from) const;
+    int lastIndexOf(char c) const;
+    int lastIndexOf(char c, unsigned int from) const;
+    int lastIndexOf(const String &s) const;
+    String substring(unsigned int from) const {return substring(from,_len);}
+    String substring(unsigned int from, unsigned int to) const;
+
+    void replace(char find, char replacement);
+    void replace(const String &find, const String &replacement);
+    void remove(unsigned int index);
+    void remove(unsigned int index, unsigned int count);
+    void toLowerCase();
+    void toUpperCase();
+    void trim();
+
+    long toInt() const;
+    float toFloat() const;
+    double toDouble() const;
+
+  private:
+    char *_buffer;
+    unsigned int _capacity;
+    unsigned int _len;
+    void assign(const char *s, unsigned int n);
+};
+
+String operator+(const String &a, const String &b);
+String operator+(const String &a, const char *b);
+String operator+(const char *a, const String &b);
+String operator+(const String &a, const __FlashStringHelper *b);
+String operator+(const __FlashStringHelper *a, const String &b);
+String operator+(const String &a, char b);
+String operator+(const String &a, unsigned char b);
+String operator+(const String &a, int b);
+String operator+(const String &a, unsigned int b);
+String operator+(const String &a, long b);
+String operator+(const String &a, unsigned long b);
+String operator+(const String &a, long long b);
+String operator+(const String &a, unsigned long long b);
+String operator+(const String &a, float b);
+String operator+(const String &a, double b);
+
+
+//==============================================================================
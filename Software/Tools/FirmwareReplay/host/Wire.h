@@ -0,0 +1,31 @@
+/*==============================================================================
+  Host stand-in for the Wire (I2C) library.  The I2C sensors are read
+  by the harness's sensor routines, so the bus is never used.
+
+  This file is part of the LMN PODD distribution:
+    https://github.com/lmnts/PODD
+
+  COPYRIGHT/LICENSE:
+  Copyright (c) 2019 LMN Architects
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Affero General Public License as
+  published by the Free Software Foundation, either version 3 of the
+  License, or (at your option) any later version.
+
+==============================================================================*/
+
+#pragma once
+
+#include <Arduino.h>
+
+class TwoWire {
+  public:
+    void begin() {}
+    void setClock(uint32_t) {}
+};
+
+extern TwoWire Wire;
+
+
+//==============================================================================
@@ -0,0 +1,294 @@
+/*==============================================================================
+  Host stand-in for the Teensy++ 2.0 Arduino core (see Arduino.h).
+
+  This file is part of the LMN PODD distribution:
+    https://github.com/lmnts/PODD
+
+  COPYRIGHT/LICENSE:
+  Copyright (c) 2019 LMN Architects
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Affero General Public License as
+  published by the Free Software Foundation, either version 3 of the
+  License, or (at your option) any later version.
+
+==============================================================================*/
+
+#include "sim.h"
+
+#include "Arduino.h"
+#include "avr/sleep.h"
+
+
+// Constants/global variables ==================================================
+
+usb_serial_class Serial;
+HardwareSerial Serial1;
+
+volatile uint8_t USBCON = 0;
+
+static uint8_t pinStates[NUM_DIGITAL_PINS] = {};
+
+// Park-Miller generator, so runs are reproducible.
+static uint32_t randomState = 1;
+
+
+// Functions ===================================================================
+
+unsigned long millis() {
+  simCharge(SIM_CALL_COST);
+  return (unsigned long)(uint32_t)(simMicros() / 1000);
+}
+
+unsigned long micros() {
+  simCharge(SIM_CALL_COST);
+  return (unsigned long)(uint32_t)simMicros();
+}
+
+void delay(unsigned long ms) {
+  simAdvanceTo(simMicros() + 1000ull*ms);
+}
+
+void delayMicroseconds(unsigned int us) {
+  simAdvanceTo(simMicros() + us);
+}
+
+void yield() {
+  simCharge(SIM_CALL_COST);
+}
+
+void cli() {
+  SREG &= 0x7F;
+}
+
+void sei() {
+  SREG |= 0x80;
+}
+
+void sleep_cpu() {
+  simIdle(true);
+}
+
+
+void pinMode(uint8_t pin, uint8_t mode) {
+  if ((pin < NUM_DIGITAL_PINS) && (mode == INPUT_PULLUP)) pinStates[pin] = HIGH;
+}
+
+void digitalWrite(uint8_t pin, uint8_t value) {
+  if (pin < NUM_DIGITAL_PINS) pinStates[pin] = value ? HIGH : LOW;
+}
+
+int digitalRead(uint8_t pin) {
+  return (pin < NUM_DIGITAL_PINS) ? pinStates[pin] : LOW;
+}
+
+int analogRead(uint8_t) {
+  simCharge(110);
+  return 0;
+}
+
+void analogReference(uint8_t) {}
+
+void analogWrite(uint8_t pin, int value) {
+  digitalWrite(pin,(value > 127) ? HIGH : LOW);
+}
+
+
+long random(long howbig) {
+  if (howbig <= 0) return 0;
+  randomState = (uint32_t)((16807ull * randomState) % 2147483647ull);
+  return randomState % howbig;
+}
+
+long random(long howsmall, long howbig) {
+  if (howsmall >= howbig) return howsmall;
+  return howsmall + random(howbig - howsmall);
+}
+
+void randomSeed(unsigned long seed) {
+  if (seed == 0) return;
+  randomState = (uint32_t)(seed % 2147483646ul) + 1;
+}
+
+
+char* dtostrf(double val, signed char width, unsigned char prec, char *buff) {
+  sprintf(buff,"%*.*f",width,prec,val);
+  return buff;
+}
+
+
+//------------------------------------------------------------------------------
+// Print
+
+size_t Print::write(const uint8_t *buff, size_t n) {
+  size_t count = 0;
+  while (n-- > 0) count += write(*buff++);
+  return count;
+}
+
+size_t Print::printNumber(unsigned long long v, int base) {
+  return print(String(v,(unsigned char)base));
+}
+
+size_t Print::printSigned(long long v, int base) {
+  return print(String(v,(unsigned char)base));
+}
+
+size_t Print::printFloat(double v, int digits) {
+  char buff[64];
+  snprintf(buff,sizeof(buff),"%.*f",digits,v);
+  return write(buff);
+}
+
+int Print::printf(const char *format, ...) {
+  char buff[256];
+  va_list ap;
+  va_start(ap,format);
+  const int n = vsnprintf(buff,sizeof(buff),format,ap);
+  va_end(ap);
+  write(buff);
+  return n;
+}
+
+
+//------------------------------------------------------------------------------
+// Stream
+
+int Stream::timedRead() {
+  const unsigned long start = millis();
+  do {
+    const int c = read();
+    if (c >= 0) return c;
+  } while (millis() - start < _timeout);
+  return -1;
+}
+
+int Stream::timedPeek() {
+  const unsigned long start = millis();
+  do {
+    const int c = peek();
+    if (c >= 0) return c;
+  } while (millis() - start < _timeout);
+  return -1;
+}
+
+size_t Stream::readBytes(char *buff, size_t n) {
+  size_t count = 0;
+  while (count < n) {
+    const int c = timedRead();
+    if (c < 0) break;
+    buff[count++] = (char)c;
+  }
+  return count;
+}
+
+size_t Stream::readBytesUntil(char terminator, char *buff, size_t n) {
+  size_t count = 0;
+  while (count < n) {
+    const int c = timedRead();
+    if ((c < 0) || (c == terminator)) break;
+    buff[count++] = (char)c;
+  }
+  return count;
+}
+
+String Stream::readString() {
+  String s;
+  int c;
+  while ((c = timedRead()) >= 0) s += (char)c;
+  return s;
+}
+
+String Stream::readStringUntil(char terminator) {
+  String s;
+  int c;
+  while (((c = timedRead()) >= 0) && (c != terminator)) s += (char)c;
+  return s;
+}
+
+long Stream::parseInt() {
+  int c;
+  while (((c = timedPeek()) >= 0) && (c != '-') && !isdigit(c)) read();
+  if (c < 0) return 0;
+  bool negative = false;
+  long v = 0;
+  if (c == '-') {
+    negative = true;
+    read();
+  }
+  while (((c = timedPeek()) >= 0) && isdigit(c)) {
+    v = 10*v + (c - '0');
+    read();
+  }
+  return negative ? -v : v;
+}
+
+float Stream::parseFloat() {
+  int c;
+  while (((c = timedPeek()) >= 0) && (c != '-') && (c != '.') && !isdigit(c)) read();
+  String s;
+  while (((c = timedPeek()) >= 0) && ((c == '-') || (c == '.') || isdigit(c))) {
+    s += (char)c;
+    read();
+  }
+  return s.toFloat();
+}
+
+bool Stream::find(const char *target) {
+  const size_t n = strlen(target);
+  if (n == 0) return true;
+  size_t matched = 0;
+  int c;
+  while ((c = timedRead()) >= 0) {
+    if (c == target[matched]) {
+      if (++matched == n) return true;
+    } else {
+      matched = (c == target[0]) ? 1 : 0;
+    }
+  }
+  return false;
+}
+
+
+//------------------------------------------------------------------------------
+// Serial ports
+
+size_t usb_serial_class::write(uint8_t c) {
+  simConsoleWrite(&c,1);
+  return 1;
+}
+
+size_t usb_serial_class::write(const uint8_t *buff, size_t n) {
+  simConsoleWrite(buff,n);
+  return n;
+}
+
+void HardwareSerial::begin(long) {}
+
+int HardwareSerial::available() {
+  return xbeeAvailable();
+}
+
+int HardwareSerial::read() {
+  return xbeeRead();
+}
+
+int HardwareSerial::peek() {
+  return xbeePeek();
+}
+
+void HardwareSerial::flush() {
+  xbeeFlush();
+}
+
+void HardwareSerial::clear() {
+  xbeeClear();
+}
+
+size_t HardwareSerial::write(const uint8_t *buff, size_t n) {
+  xbeeWrite(buff,n);
+  return n;
+}
+
+
+//==============================================================================
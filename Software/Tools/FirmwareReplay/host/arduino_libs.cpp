@@ -0,0 +1,439 @@
+/*==============================================================================
+  Host stand-ins for the Arduino libraries used by the PODD firmware:
+  EEPROM, SPI, TimerOne/TimerThree, Wire, SD and Ethernet.
+
+  This file is part of the LMN PODD distribution:
+    https://github.com/lmnts/PODD
+
+  COPYRIGHT/LICENSE:
+  Copyright (c) 2019 LMN Architects
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Affero General Public License as
+  published by the Free Software Foundation, either version 3 of the
+  License, or (at your option) any later version.
+
+==============================================================================*/
+
+#include <errno.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "sim.h"
+
+#include "Arduino.h"
+#include "EEPROM.h"
+#include "Ethernet.h"
+#include "EthernetUdp.h"
+#include "SD.h"
+#include "SPI.h"
+#include "TimerOne.h"
+#include "TimerThree.h"
+#include "Wire.h"
+
+
+// Constants/global variables ==================================================
+
+EEPROMClass EEPROM;
+SPIClass SPI;
+TimerOne Timer1;
+TimerThree Timer3;
+TwoWire Wire;
+SDClass SD;
+EthernetClass Ethernet;
+
+// Network timings [ms]: DHCP exchange, TCP connect (and the W5100's
+// give-up time when nothing answers), sending the request and closing
+// the socket, and the NTP server's reply.
+#define DHCP_TIME 300
+#define CONNECT_TIME 3
+#define CONNECT_FAIL_TIME 1000
+#define SEND_TIME 1
+#define CLOSE_TIME 1
+#define NTP_REPLY_TIME 20
+
+// NTP timestamps count seconds from 1900
+#define NTP_UNIX_OFFSET 2208988800UL
+
+
+// Functions ===================================================================
+
+static bool networkUp() {
+  NetworkModel *net = simNetwork();
+  return (net != NULL) && net->up(simMicros());
+}
+
+
+//------------------------------------------------------------------------------
+// SPI, timers
+
+void SPIClass::beginTransaction(SPISettings) {
+  rtcSelect();
+}
+
+void SPIClass::endTransaction() {
+  rtcDeselect();
+}
+
+uint8_t SPIClass::transfer(uint8_t v) {
+  return rtcTransfer(v);
+}
+
+void TimerOne::attachInterrupt(void (*isr)(), unsigned long microseconds) {
+  if (microseconds > 0) period = microseconds;
+  simSetTimerInterrupt(isr,period);
+}
+
+void TimerOne::detachInterrupt() {
+  simSetTimerInterrupt(NULL,0);
+}
+
+
+//------------------------------------------------------------------------------
+// SD card
+
+File::File(const File &f) : Stream(), handle(f.handle) {
+  if (handle != NULL) handle->refs++;
+}
+
+File& File::operator=(const File &f) {
+  if (this != &f) {
+    if (f.handle != NULL) f.handle->refs++;
+    release();
+    handle = f.handle;
+  }
+  return *this;
+}
+
+File::~File() {
+  release();
+}
+
+void File::release() {
+  if ((handle != NULL) && (--handle->refs == 0)) {
+    if (handle->f != NULL) fclose(handle->f);
+    delete handle;
+  }
+  handle = NULL;
+}
+
+/* The host file, ready for reading (C streams must be flushed between
+   a write and a read). */
+FILE* File::reading() {
+  if ((handle == NULL) || (handle->f == NULL)) return NULL;
+  if (handle->writing) fflush(handle->f);
+  handle->writing = false;
+  return handle->f;
+}
+
+size_t File::write(const uint8_t *buff, size_t n) {
+  if ((handle == NULL) || (handle->f == NULL)) return 0;
+  if (handle->append) {
+    fseek(handle->f,0,SEEK_END);
+  } else if (!handle->writing) {
+    fseek(handle->f,0,SEEK_CUR);
+  }
+  handle->writing = true;
+  return fwrite(buff,1,n,handle->f);
+}
+
+int File::available() {
+  return (int)(size() - position());
+}
+
+int File::read() {
+  FILE *f = reading();
+  return (f == NULL) ? -1 : fgetc(f);
+}
+
+int File::read(void *buff, uint16_t n) {
+  FILE *f = reading();
+  return (f == NULL) ? -1 : (int)fread(buff,1,n,f);
+}
+
+int File::peek() {
+  FILE *f = reading();
+  if (f == NULL) return -1;
+  const int c = fgetc(f);
+  if (c != EOF) ungetc(c,f);
+  return c;
+}
+
+/* Positions past the end are refused, as on the card. */
+bool File::seek(uint32_t pos) {
+  if ((handle == NULL) || (handle->f == NULL) || (pos > size())) return false;
+  handle->writing = false;
+  return fseek(handle->f,pos,SEEK_SET) == 0;
+}
+
+uint32_t File::position() {
+  if ((handle == NULL) || (handle->f == NULL)) return 0;
+  return (uint32_t)ftell(handle->f);
+}
+
+uint32_t File::size() {
+  if ((handle == NULL) || (handle->f == NULL)) return 0;
+  fflush(handle->f);
+  struct stat st;
+  return (fstat(fileno(handle->f),&st) == 0) ? (uint32_t)st.st_size : 0;
+}
+
+void File::flush() {
+  if ((handle != NULL) && (handle->f != NULL)) fflush(handle->f);
+}
+
+void File::close() {
+  if (handle == NULL) return;
+  // Closes the host file for all copies, as on the card
+  if (handle->f != NULL) fclose(handle->f);
+  handle->f = NULL;
+  release();
+}
+
+
+void SDClass::setRoot(const char *dir) {
+  snprintf(rootDir,sizeof(rootDir),"%s",dir);
+  mkdir("/");
+}
+
+void SDClass::hostPath(char *buff, size_t size, const char *path) const {
+  snprintf(buff,size,"%s/%s",rootDir,(path[0] == '/') ? path + 1 : path);
+}
+
+bool SDClass::exists(const char *path) {
+  char p[512];
+  hostPath(p,sizeof(p),path);
+  struct stat st;
+  return stat(p,&st) == 0;
+}
+
+/* Creates the directory and any missing parents. */
+bool SDClass::mkdir(const char *path) {
+  char p[512];
+  hostPath(p,sizeof(p),path);
+  for (char *s = p + 1; ; s++) {
+    if ((*s != '/') && (*s != '\0')) continue;
+    const char c = *s;
+    *s = '\0';
+    if ((::mkdir(p,0777) != 0) && (errno != EEXIST)) return false;
+    *s = c;
+    if (c == '\0') break;
+  }
+  return true;
+}
+
+bool SDClass::remove(const char *path) {
+  char p[512];
+  hostPath(p,sizeof(p),path);
+  return ::remove(p) == 0;
+}
+
+/* Files opened for writing can also be read (the card has no
+   write-only files).  FILE_WRITE creates the file if needed and starts
+   at its end; other files start at the beginning. */
+File SDClass::open(const char *path, uint8_t mode) {
+  File file;
+  if (rootDir[0] == '\0') return file;
+  char p[512];
+  hostPath(p,sizeof(p),path);
+  const bool write = (mode & O_WRITE) != 0;
+  FILE *f = fopen(p,write ? "r+" : "r");
+  if ((f == NULL) && write && (mode & SD_O_CREAT)) f = fopen(p,"w+");
+  if (f == NULL) return file;
+  const bool append = write && (mode & SD_O_APPEND);
+  if (append) fseek(f,0,SEEK_END);
+  file.handle = new File::Handle{f,1,false,append};
+  return file;
+}
+
+
+//------------------------------------------------------------------------------
+// Ethernet
+
+bool IPAddress::fromString(const char *s) {
+  unsigned a,b,c,d;
+  char extra;
+  if (sscanf(s,"%u.%u.%u.%u%c",&a,&b,&c,&d,&extra) != 4) return false;
+  if ((a > 255) || (b > 255) || (c > 255) || (d > 255)) return false;
+  *this = IPAddress(a,b,c,d);
+  return true;
+}
+
+size_t IPAddress::printTo(Print &p) const {
+  size_t n = 0;
+  for (int k = 0; k < 4; k++) {
+    if (k > 0) n += p.print('.');
+    n += p.print((*this)[k],DEC);
+  }
+  return n;
+}
+
+
+/* DHCP: an address after a short exchange while the network is up,
+   otherwise nothing after the full timeout. */
+int EthernetClass::begin(uint8_t*, unsigned long timeout, unsigned long) {
+  if (!networkUp()) {
+    delay(timeout);
+    ip = IPAddress(0ul);
+    return 0;
+  }
+  delay(DHCP_TIME);
+  ip = IPAddress(192,168,1,100);
+  gateway = IPAddress(192,168,1,1);
+  dns = gateway;
+  subnet = IPAddress(255,255,255,0);
+  return 1;
+}
+
+void EthernetClass::begin(uint8_t*, IPAddress ip, IPAddress dns, IPAddress gateway, IPAddress subnet) {
+  this->ip = ip;
+  this->dns = dns;
+  this->gateway = gateway;
+  this->subnet = subnet;
+}
+
+EthernetLinkStatus EthernetClass::linkStatus() {
+  return networkUp() ? LinkON : LinkOFF;
+}
+
+
+int EthernetClient::connect(const char*, uint16_t) {
+  return connect(IPAddress(0ul),80);
+}
+
+int EthernetClient::connect(IPAddress, uint16_t) {
+  stop();
+  if (!networkUp()) {
+    delay(CONNECT_FAIL_TIME);
+    return 0;
+  }
+  delay(CONNECT_TIME);
+  open = true;
+  return 1;
+}
+
+size_t EthernetClient::write(const uint8_t *buff, size_t n) {
+  if (!open) return 0;
+  request.concat((const char*)buff,n);
+  return n;
+}
+
+/* Hands the request to the network once the firmware starts waiting
+   for the response (or flushes). */
+void EthernetClient::send() {
+  if (!open || (sent > 0) || (request.length() == 0)) return;
+  delay(SEND_TIME);
+  sent = request.length();
+  NetworkModel *net = simNetwork();
+  responseTime = SIM_NEVER;
+  if (net != NULL) {
+    responseTime = net->request(simMicros(),request.c_str(),request.length(),
+                                response,responseLen);
+  }
+  if (responseTime != SIM_NEVER) simWakeAt(responseTime);
+}
+
+void EthernetClient::flush() {
+  send();
+}
+
+int EthernetClient::available() {
+  send();
+  if ((sent == 0) || (responseTime == SIM_NEVER)) return 0;
+  if (simMicros() < responseTime) return 0;
+  return (int)(responseLen - responsePos);
+}
+
+int EthernetClient::read() {
+  if (available() <= 0) return -1;
+  return (uint8_t)response[responsePos++];
+}
+
+int EthernetClient::peek() {
+  if (available() <= 0) return -1;
+  return (uint8_t)response[responsePos];
+}
+
+uint8_t EthernetClient::connected() {
+  return open && ((responseTime == SIM_NEVER) || (simMicros() < responseTime)
+                  || (responsePos < responseLen));
+}
+
+void EthernetClient::stop() {
+  if (!open) return;
+  delay(CLOSE_TIME);
+  open = false;
+  request = "";
+  sent = 0;
+  response = NULL;
+  responseLen = 0;
+  responsePos = 0;
+}
+
+
+int EthernetUDP::beginPacket(const char*, uint16_t) {
+  // Name lookup fails without the network
+  if (!networkUp()) return 0;
+  outLen = 0;
+  return 1;
+}
+
+int EthernetUDP::beginPacket(IPAddress, uint16_t) {
+  outLen = 0;
+  return 1;
+}
+
+size_t EthernetUDP::write(const uint8_t *buff, size_t n) {
+  if (outLen + n > sizeof(out)) n = sizeof(out) - outLen;
+  memcpy(out + outLen,buff,n);
+  outLen += n;
+  return n;
+}
+
+/* Sends the request: while the network is up, a stratum-1 server
+   stamps it with the true time and echoes the transmit timestamp. */
+int EthernetUDP::endPacket() {
+  if ((outLen != sizeof(out)) || !networkUp()) return 1;
+  replyTime = simMicros() + 1000*NTP_REPLY_TIME;
+  const int64_t ms = simUTCMillis() + NTP_REPLY_TIME/2;
+  const uint32_t s = (uint32_t)(ms / 1000 + NTP_UNIX_OFFSET);
+  const uint32_t f = (uint32_t)(((uint64_t)(ms % 1000) << 32) / 1000);
+  memset(packet,0,sizeof(packet));
+  packet[0] = 0x24;  // version 4, server
+  packet[1] = 1;     // stratum
+  packet[2] = out[2];
+  packet[3] = 0xEC;
+  memcpy(&packet[12],"GPS\0",4);
+  memcpy(&packet[24],&out[40],8);
+  for (int k = 0; k < 4; k++) {
+    packet[32+k] = packet[40+k] = (s >> (24 - 8*k)) & 0xFF;
+    packet[36+k] = packet[44+k] = (f >> (24 - 8*k)) & 0xFF;
+  }
+  memcpy(&packet[16],&packet[32],8);
+  pending = true;
+  length = pos = 0;
+  simWakeAt(replyTime);
+  return 1;
+}
+
+int EthernetUDP::parsePacket() {
+  if (!pending || (simMicros() < replyTime)) return 0;
+  pending = false;
+  length = sizeof(packet);
+  pos = 0;
+  return (int)length;
+}
+
+int EthernetUDP::read() {
+  return (pos < length) ? packet[pos++] : -1;
+}
+
+int EthernetUDP::read(uint8_t *buff, size_t n) {
+  if (n > length - pos) n = length - pos;
+  memcpy(buff,packet + pos,n);
+  pos += n;
+  return (int)n;
+}
+
+
+//==============================================================================
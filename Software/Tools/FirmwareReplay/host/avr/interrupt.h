@@ -0,0 +1,8 @@
+// Host stand-in for <avr/interrupt.h>: SREG bit 7 is the global
+// interrupt flag, honoured by the simulated timer interrupt (sim.h).
+#pragma once
+#include <stdint.h>
+extern volatile uint8_t SREG;
+void cli();
+void sei();
+#define ISR(vector) extern "C" void vector(void)
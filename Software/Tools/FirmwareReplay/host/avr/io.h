@@ -0,0 +1,4 @@
+// Host stand-in for <avr/io.h>: no registers are used outside the
+// sensor and memory routines, which the harness replaces.
+#pragma once
+#include <stdint.h>
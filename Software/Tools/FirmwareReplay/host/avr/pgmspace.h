@@ -0,0 +1,22 @@
+// Host stand-in for <avr/pgmspace.h>: flash is ordinary memory.
+// pgm_read_word() is also used on pointer tables, so it reads the
+// pointed-to type rather than 16 bits.
+#pragma once
+#include <string.h>
+#define PROGMEM
+#define PSTR(s) (s)
+#define PGM_P const char *
+typedef char prog_char;
+#define pgm_read_byte(addr) (*(const uint8_t*)(addr))
+#define pgm_read_word(addr) (*(addr))
+#define pgm_read_dword(addr) (*(addr))
+#define pgm_read_float(addr) (*(const float*)(addr))
+#define strlen_P strlen
+#define strcpy_P strcpy
+#define strncpy_P strncpy
+#define strcmp_P strcmp
+#define strncmp_P strncmp
+#define strcat_P strcat
+#define memcpy_P memcpy
+#define sprintf_P sprintf
+#define snprintf_P snprintf
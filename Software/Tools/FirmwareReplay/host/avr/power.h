@@ -0,0 +1,10 @@
+// Host stand-in for <avr/power.h>: no effect.
+#pragma once
+inline void power_adc_disable() {}
+inline void power_adc_enable() {}
+inline void power_spi_disable() {}
+inline void power_spi_enable() {}
+inline void power_usb_disable() {}
+inline void power_usb_enable() {}
+inline void power_twi_disable() {}
+inline void power_twi_enable() {}
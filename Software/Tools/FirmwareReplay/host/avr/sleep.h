@@ -0,0 +1,13 @@
+// Host stand-in for <avr/sleep.h>: sleeping fast-forwards the
+// simulated clock to the next event (see simIdle() in sim.h).
+#pragma once
+#include <stdint.h>
+#define SLEEP_MODE_IDLE 0
+#define SLEEP_MODE_PWR_DOWN 2
+#define SLEEP_MODE_PWR_SAVE 3
+inline void set_sleep_mode(uint8_t) {}
+inline void sleep_enable() {}
+inline void sleep_disable() {}
+void sleep_cpu();
+inline void sleep_mode() {sleep_cpu();}
+inline void sleep_bod_disable() {}
@@ -0,0 +1,9 @@
+// Host stand-in for <avr/wdt.h>: the watchdog never fires.
+#pragma once
+#include <stdint.h>
+#define WDTO_15MS 0
+#define WDTO_1S 6
+#define WDTO_8S 9
+inline void wdt_enable(uint8_t) {}
+inline void wdt_disable() {}
+inline void wdt_reset() {}
@@ -0,0 +1,6 @@
+// Host stand-in for <util/atomic.h>: the simulated interrupt only runs
+// from timing calls, so blocks are atomic as they stand.
+#pragma once
+#define ATOMIC_BLOCK(type) for (int _atomic = 1; _atomic; _atomic = 0)
+#define ATOMIC_RESTORESTATE 0
+#define ATOMIC_FORCEON 0
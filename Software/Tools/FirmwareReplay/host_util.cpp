@@ -0,0 +1,92 @@
+/*==============================================================================
+  Utility routines for the firmware replay harness: the pod_util.h
+  interface without the AVR memory layout.  RAM usage on the host says
+  nothing about the pod's, so the memory statistics are all zero.
+
+  This file is part of the LMN PODD distribution:
+    https://github.com/lmnts/PODD
+
+  CONTRIBUTORS:
+    PODD contributors (2026)
+
+  COPYRIGHT/LICENSE:
+  Copyright (c) 2026 LMN Architects
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Affero General Public License as
+  published by the Free Software Foundation, either version 3 of the
+  License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Affero General Public License for more details.
+
+  You should have received a copy of the GNU Affero General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+==============================================================================*/
+
+#include <Arduino.h>
+#include "pod_util.h"
+
+
+// Constants/global variables ==================================================
+
+static MemoryStats memoryWorst = {};
+
+
+// Functions ===================================================================
+
+size_t freeRAM() {
+  return 0;
+}
+
+void getMemoryStats(MemoryStats &stats) {
+  stats = MemoryStats{};
+}
+
+void updateMemoryStats(bool) {}
+
+const MemoryStats& getMemoryStatsWorst() {
+  return memoryWorst;
+}
+
+void printMemoryStats() {
+  Serial.println(F("  Memory:           not tracked (replay)"));
+}
+
+void pinCheck(const int pin, const String s) {
+  Serial.print("Pin ");
+  if (pin < 10) Serial.print(" ");
+  Serial.print(pin);
+  Serial.print(": ");
+  if (pin >= NUM_DIGITAL_PINS) {
+    Serial.print("INVALID");
+  } else {
+    Serial.print(digitalRead(pin) ? "HIGH" : "LOW ");
+  }
+  if (!s.equals("")) Serial.print("  [" + s + "]");
+  Serial.println();
+}
+
+void poddPinChecks() {
+  for (int pin = 0; pin < NUM_DIGITAL_PINS; pin++) pinCheck(pin);
+}
+
+
+void printCompilationInfo(const String prefix, const String file) {
+  if (!file.equals("")) {
+    Serial.print(prefix);
+    Serial.print(F("Compilation file:    "));
+    int loc = max(file.lastIndexOf('\\'),file.lastIndexOf('/')) + 1;
+    Serial.println(file.substring(loc));
+  }
+  Serial.print(prefix);
+  Serial.println(F("Compilation date:    "  __DATE__ " " __TIME__));
+  Serial.print(prefix);
+  Serial.println(F("Build:               host (firmware replay)"));
+}
+
+
+//==============================================================================
@@ -0,0 +1,401 @@
+/*==============================================================================
+  podd_load: drives the PODD coordinator firmware, built for the host,
+  with readings from N simulated drones at stepped rates, and reports
+  the highest rate it sustains and where readings are lost beyond it.
+
+  This file is part of the LMN PODD distribution:
+    https://github.com/lmnts/PODD
+
+  CONTRIBUTORS:
+    PODD contributors (2026)
+
+  COPYRIGHT/LICENSE:
+  Copyright (c) 2026 LMN Architects
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Affero General Public License as
+  published by the Free Software Foundation, either version 3 of the
+  License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Affero General Public License for more details.
+
+  You should have received a copy of the GNU Affero General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+==============================================================================*/
+
+// Usage: podd_load [options]
+// See README.md for details.
+
+#include "harness.h"
+#include "replay.h"
+#include "sim.h"
+#include "socket_network.h"
+#include "stand_in_server.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+
+// Constants/global variables ==================================================
+
+// Clock at the start of the run (2024-01-01 00:00:00 UTC): recent
+// enough for the firmware to accept NTP replies.
+#define LOAD_START_UTC 1704067200
+// Firmware start-up before the first step [s] (setup takes about a
+// minute).
+#define LOAD_LEAD 120
+
+struct Options {
+  unsigned drones = 4;
+  double rateStart = 1;       // offered readings/s: first step,
+  double rateStep = 1;        // ...increment,
+  double rateMax = 0;         // ...and last (0: number of drones)
+  double stepTime = 300;      // [s]
+  double drain = 60;          // [s]
+  double maxLoss = 1;         // sustained: loss [%]...
+  double maxDelay = 30;       // ...and 95th percentile delay [s]
+  double latency = 50;        // stand-in server response time [ms]
+  double lossProbability = 0;
+  uint32_t seed = 1;
+  std::string server;         // HOST:PORT of a real server (empty: stand-in)
+  std::string card = "load_sd";
+  std::string console;
+  bool quiet = false;
+};
+
+// Counters along the data path, snapshot at the end of each step.
+struct PathCounters {
+  uint64_t uartLost;          // bytes lost in the serial receive buffer
+  uint64_t ringLost;          // bytes lost to ring buffer overruns
+  uint64_t parseDropped;      // packets dropped by the parser
+  uint64_t postFailed;        // uploads that failed or timed out
+  uint64_t serverFailed;      // requests lost, refused or answered with an error
+};
+
+// Counters from the network in use.
+static StandInServer *standIn = nullptr;
+static SocketNetwork *socketNet = nullptr;
+
+
+// Functions ===================================================================
+
+static void usage() {
+  fprintf(stderr,
+    "Usage: podd_load [options]\n"
+    "Runs the coordinator firmware on this computer in simulated time, relaying\n"
+    "readings from simulated drones to an upload server, with the offered rate\n"
+    "raised step by step.  Reports the readings stored and lost at each rate, the\n"
+    "highest sustained rate and where readings are lost.\n"
+    "\n"
+    "Options:\n"
+    "  -n DRONES          number of drones (default: 4)\n"
+    "  -r START[:STEP[:MAX]]  offered readings per second over all drones\n"
+    "                     (default: 1:1:DRONES); a drone sends at most one\n"
+    "                     reading per second\n"
+    "  -T SECONDS         duration of each rate step (default: 300)\n"
+    "  -D SECONDS         time to run on after the last step (default: 60)\n"
+    "  -m PERCENT         most readings lost at a sustained rate (default: 1)\n"
+    "  -w SECONDS         longest 95th percentile delay at a sustained rate\n"
+    "                     (default: 30)\n"
+    "  -S HOST:PORT       upload to this server (e.g. podd_mock_server) instead\n"
+    "                     of the built-in stand-in\n"
+    "  -L MS              stand-in server response time (default: 50)\n"
+    "  -p PROB            probability that the stand-in loses a request (default: 0)\n"
+    "  -f START-END:MODE  stand-in failure, in seconds (or with s, m, h or d) from\n"
+    "                     the first step; MODE is down, timeout, error or slow=MS\n"
+    "                     (repeatable)\n"
+    "  -s SEED            random seed for -p (default: 1)\n"
+    "  -o DIR             directory standing in for the SD card (default: load_sd)\n"
+    "  -c FILE            write the firmware's console output to FILE\n"
+    "  -q                 only report errors\n");
+}
+
+
+/* Parses a numeric argument; exits on error. */
+static double numberArg(const char *opt, const std::string &arg) {
+  char *end;
+  const double v = strtod(arg.c_str(),&end);
+  if (arg.empty() || (*end != '\0')) {
+    fprintf(stderr,"podd_load: option %s needs a number, not '%s'\n",opt,arg.c_str());
+    exit(2);
+  }
+  return v;
+}
+
+
+static double elapsedSeconds(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+
+// The coordinator's own sensors are off: there is no trace.
+bool replaySensorValue(const uint8_t, float&) {
+  return false;
+}
+
+bool replaySensorPresent(const uint8_t) {
+  return false;
+}
+
+
+static PathCounters pathCounters() {
+  const FirmwareCounters fw = firmwareCounters();
+  PathCounters c;
+  c.uartLost = xbeeCounters().rxDropped;
+  c.ringLost = fw.xbeeOverrun;
+  c.parseDropped = fw.packetsDropped;
+  c.postFailed = fw.postFailures + fw.postTimeouts;
+  c.serverFailed = 0;
+  if (standIn != nullptr) {
+    c.serverFailed = standIn->counters().lost + standIn->counters().errors;
+  } else if (socketNet != nullptr) {
+    const SocketCounters &s = socketNet->counters();
+    c.serverFailed = s.refused + s.resets + s.timeouts;
+  }
+  return c;
+}
+
+
+static PathCounters difference(const PathCounters &a, const PathCounters &b) {
+  return PathCounters{a.uartLost - b.uartLost, a.ringLost - b.ringLost,
+                      a.parseDropped - b.parseDropped, a.postFailed - b.postFailed,
+                      a.serverFailed - b.serverFailed};
+}
+
+
+/* Describes the first stage along the data path that lost data. */
+static const char* lossStage(const PathCounters &c) {
+  if (c.uartLost > 0) return "bytes lost in the serial receive buffer (interrupts held off too long)";
+  if (c.ringLost > 0) return "bytes lost to XBee ring buffer overruns (packets not parsed fast enough)";
+  if (c.parseDropped > 0) return "packets dropped by the parser (malformed or corrupted)";
+  if (c.postFailed > 0) return "uploads failed or timed out";
+  if (c.serverFailed > 0) return "requests lost or refused by the server";
+  return "nothing lost, but readings delayed (XBee link or uploads too slow)";
+}
+
+
+int main(int argc, char **argv) {
+  Options opt;
+  std::vector<std::string> failureArgs;
+  for (int k = 1; k < argc; k++) {
+    const std::string a = argv[k];
+    const bool hasValue = (a.size() == 2) && (a[0] == '-') && (std::string("nrTDmwSLpfsoc").find(a[1]) != std::string::npos);
+    if (hasValue && (k + 1 >= argc)) {
+      fprintf(stderr,"podd_load: option %s needs a value\n",a.c_str());
+      return 2;
+    }
+    const std::string v = hasValue ? argv[++k] : "";
+    if ((a == "-h") || (a == "--help")) {
+      usage();
+      return 0;
+    } else if (a == "-n") {
+      opt.drones = (unsigned)numberArg("-n",v);
+    } else if (a == "-r") {
+      const size_t c1 = v.find(':');
+      const size_t c2 = (c1 == std::string::npos) ? c1 : v.find(':',c1 + 1);
+      opt.rateStart = numberArg("-r",v.substr(0,c1));
+      if (c1 != std::string::npos) opt.rateStep = numberArg("-r",v.substr(c1 + 1,c2 - c1 - 1));
+      opt.rateMax = (c2 != std::string::npos) ? numberArg("-r",v.substr(c2 + 1))
+                                              : ((c1 == std::string::npos) ? opt.rateStart : 0);
+    } else if (a == "-T") {
+      opt.stepTime = numberArg("-T",v);
+    } else if (a == "-D") {
+      opt.drain = numberArg("-D",v);
+    } else if (a == "-m") {
+      opt.maxLoss = numberArg("-m",v);
+    } else if (a == "-w") {
+      opt.maxDelay = numberArg("-w",v);
+    } else if (a == "-S") {
+      opt.server = v;
+    } else if (a == "-L") {
+      opt.latency = numberArg("-L",v);
+    } else if (a == "-p") {
+      opt.lossProbability = numberArg("-p",v);
+    } else if (a == "-f") {
+      failureArgs.push_back(v);
+    } else if (a == "-s") {
+      opt.seed = (uint32_t)numberArg("-s",v);
+    } else if (a == "-o") {
+      opt.card = v;
+    } else if (a == "-c") {
+      opt.console = v;
+    } else if (a == "-q") {
+      opt.quiet = true;
+    } else {
+      fprintf(stderr,"podd_load: unknown option %s\n",a.c_str());
+      usage();
+      return 2;
+    }
+  }
+  if (opt.rateMax == 0) opt.rateMax = opt.drones;
+  if ((opt.drones == 0) || (opt.drones > 999) || (opt.rateStart <= 0) || (opt.rateStep <= 0)
+      || (opt.rateMax < opt.rateStart) || (opt.stepTime < 10) || (opt.drain < 0)
+      || (opt.latency < 0) || (opt.lossProbability < 0) || (opt.lossProbability > 1)) {
+    usage();
+    return 2;
+  }
+  if (opt.rateMax > opt.drones) {
+    fprintf(stderr,"podd_load: %g readings/s needs at least %g drones (-n)\n",
+            opt.rateMax,std::ceil(opt.rateMax));
+    return 2;
+  }
+  std::vector<double> rates;
+  for (double r = opt.rateStart; r <= opt.rateMax + 1e-9; r += opt.rateStep) rates.push_back(r);
+
+  // Simulated world
+  simSetStartTime(LOAD_START_UTC);
+  rtcSet(LOAD_START_UTC);
+  const uint64_t origin = 1000000ull * LOAD_LEAD;
+  StandInServer server((uint64_t)(1000 * opt.latency),opt.lossProbability,opt.seed);
+  SocketNetwork sockets;
+  if (opt.server.empty()) {
+    for (const std::string &s : failureArgs) {
+      FailureWindow w;
+      if (!parseFailureWindow(s,origin,w)) {
+        fprintf(stderr,"podd_load: -f needs START-END:MODE, not '%s'\n",s.c_str());
+        return 2;
+      }
+      server.addFailure(w);
+    }
+    standIn = &server;
+    simSetNetwork(&server);
+  } else {
+    std::string error;
+    if (!failureArgs.empty() || (opt.lossProbability > 0)) {
+      fprintf(stderr,"podd_load: -f and -p apply to the stand-in server, not -S\n");
+      return 2;
+    }
+    if (!sockets.open(opt.server,error)) {
+      fprintf(stderr,"podd_load: %s\n",error.c_str());
+      return 1;
+    }
+    socketNet = &sockets;
+    simSetNetwork(&sockets);
+  }
+  FILE *console = nullptr;
+  if (!opt.console.empty() && ((console = fopen(opt.console.c_str(),"w")) == nullptr)) {
+    fprintf(stderr,"podd_load: cannot write %s\n",opt.console.c_str());
+    return 1;
+  }
+  simSetConsole(console);
+  std::error_code ec;
+  std::filesystem::create_directories(opt.card,ec);
+  if (ec) {
+    fprintf(stderr,"podd_load: cannot create %s\n",opt.card.c_str());
+    return 1;
+  }
+  firmwareSetCard(opt.card.c_str());
+  xbeeSetSerialNumber("13A200","40A1B2C3");
+  ReplayPodConfig config = {"coordinator",true,{}};
+  firmwarePreloadConfig(config);
+
+  // The readings of all steps are queued up front, in time order, so
+  // a backlog on the XBee link carries over into the next step.
+  // Reading k carries k as its value, to match it up at the server.
+  std::vector<uint64_t> emitted;   // time [us] of reading k
+  std::vector<uint32_t> stepOf;    // step of reading k
+  std::vector<uint64_t> offered(rates.size(),0);
+  char devid[16];
+  for (size_t s = 0; s < rates.size(); s++) {
+    const uint64_t start = origin + (uint64_t)(1e6 * opt.stepTime * s);
+    const uint64_t end = start + (uint64_t)(1e6 * opt.stepTime);
+    for (uint64_t j = 0; ; j++) {
+      const uint64_t at = start + (uint64_t)(1e6 * j / rates[s]);
+      if (at >= end) break;
+      const uint64_t k = emitted.size();
+      snprintf(devid,sizeof(devid),"drone%03u",(unsigned)(k % opt.drones) + 1);
+      queueDronePacket(at,devid,(uint8_t)((k / opt.drones) % REPLAY_TYPE_COUNT),(float)k,
+                       LOAD_START_UTC + (int64_t)(at / 1000000));
+      emitted.push_back(at);
+      stepOf.push_back((uint32_t)s);
+      offered[s]++;
+    }
+  }
+
+  // Run, taking the data path counters at the end of each step
+  const auto wallStart = std::chrono::steady_clock::now();
+  simSetWakeHook(firmwareWakeTime);
+  firmwareSetup();
+  std::vector<PathCounters> path(rates.size());
+  PathCounters last = pathCounters();
+  for (size_t s = 0; s < rates.size(); s++) {
+    const uint64_t end = origin + (uint64_t)(1e6 * opt.stepTime * (s + 1))
+                         + ((s + 1 == rates.size()) ? (uint64_t)(1e6 * opt.drain) : 0);
+    while (simMicros() < end) {
+      firmwareLoop();
+      simIdle(false);
+    }
+    const PathCounters now = pathCounters();
+    path[s] = difference(now,last);
+    last = now;
+  }
+  const double wall = elapsedSeconds(wallStart);
+  if (console != nullptr) fclose(console);
+
+  // Stored readings by step, with their delay from the drone
+  std::vector<std::vector<double>> delays(rates.size());
+  std::vector<bool> seen(emitted.size(),false);
+  const std::vector<ReceivedReading> &stored = (standIn != nullptr) ? standIn->readings()
+                                                                    : socketNet->readings();
+  for (const ReceivedReading &r : stored) {
+    const uint64_t k = strtoull(r.value.c_str(),nullptr,10);
+    if ((r.deviceID.compare(0,5,"drone") != 0) || (k >= emitted.size()) || seen[k]) continue;
+    seen[k] = true;
+    delays[stepOf[k]].push_back((r.arrival - emitted[k]) / 1e6);
+  }
+
+  printf("%u drones, %zu steps of %.0f s; %s\n",opt.drones,rates.size(),opt.stepTime,
+         opt.server.empty() ? "stand-in server" : opt.server.c_str());
+  printf("\n  %7s %8s %8s %7s %7s %7s   %8s %8s %6s %6s %6s\n","rate/s","offered","stored",
+         "loss","p50","p95 [s]","uart [B]","ring [B]","parse","post","server");
+  double sustained = 0;
+  size_t firstFailure = rates.size();
+  for (size_t s = 0; s < rates.size(); s++) {
+    const DelayStats d = delayStats(delays[s]);
+    const double loss = (offered[s] > 0) ? 100.0 * (offered[s] - std::min(offered[s],d.count)) / offered[s] : 0;
+    const PathCounters &c = path[s];
+    printf("  %7.2f %8llu %8llu %6.2f%% %7.1f %7.1f   %8llu %8llu %6llu %6llu %6llu\n",
+           rates[s],(unsigned long long)offered[s],(unsigned long long)d.count,loss,d.p50,d.p95,
+           (unsigned long long)c.uartLost,(unsigned long long)c.ringLost,
+           (unsigned long long)c.parseDropped,(unsigned long long)c.postFailed,
+           (unsigned long long)c.serverFailed);
+    if ((loss <= opt.maxLoss) && (d.count > 0) && (d.p95 <= opt.maxDelay)) {
+      if (firstFailure == rates.size()) sustained = rates[s];
+    } else if (firstFailure == rates.size()) {
+      firstFailure = s;
+    }
+  }
+  printf("\n");
+  if (sustained > 0) {
+    printf("Highest sustained rate: %.2f readings/s (loss <= %g%%, p95 delay <= %g s)\n",
+           sustained,opt.maxLoss,opt.maxDelay);
+  } else {
+    printf("No sustained rate (loss <= %g%%, p95 delay <= %g s)\n",opt.maxLoss,opt.maxDelay);
+  }
+  if (firstFailure < rates.size()) {
+    printf("At %.2f readings/s: %s\n",rates[firstFailure],
+           lossStage(path[firstFailure]));
+  }
+  const FirmwareCounters fw = firmwareCounters();
+  printf("Firmware: %u packets parsed, %u dropped; %u posts ok, %u failed, %u timed out "
+         "(longest %u ms); longest loop %u us\n",fw.packetsParsed,fw.packetsDropped,
+         fw.postSuccesses,fw.postFailures,fw.postTimeouts,fw.postTimeMax,fw.loopTimeMax);
+  if (!opt.quiet) {
+    fprintf(stderr,"%.1f simulated hours in %.2f s (%.0fx real time)\n",
+            simMicros() / 3.6e9,wall,(wall > 0) ? simMicros() / 1e6 / wall : 0.0);
+  }
+  return 0;
+}
+
+
+//==============================================================================
@@ -0,0 +1,379 @@
+/*==============================================================================
+  podd_mock_server: a local stand-in for the PODD upload server
+  (LMNSensePod.php), for load-testing coordinators, real or built for
+  the host, with injected latency, errors and connection resets.
+
+  This file is part of the LMN PODD distribution:
+    https://github.com/lmnts/PODD
+
+  CONTRIBUTORS:
+    PODD contributors (2026)
+
+  COPYRIGHT/LICENSE:
+  Copyright (c) 2026 LMN Architects
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Affero General Public License as
+  published by the Free Software Foundation, either version 3 of the
+  License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Affero General Public License for more details.
+
+  You should have received a copy of the GNU Affero General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+==============================================================================*/
+
+// Usage: podd_mock_server [options]
+// See README.md for details.
+
+#include "stand_in_server.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+// Constants/global variables ==================================================
+
+// Largest request accepted [bytes]; pod posts are a few hundred.
+#define REQUEST_MAX 8192
+// Longest wait for a request, and longest a connection is held
+// without an answer (timeout failures) [s].
+#define REQUEST_TIMEOUT 10
+#define HOLD_TIME 60
+
+struct Options {
+  std::string address = "127.0.0.1";
+  int port = 8080;
+  std::string output;         // CSV of stored readings (empty: none)
+  double latency = 0;         // response time [ms]
+  double lossProbability = 0; // no response
+  double resetProbability = 0;
+  uint32_t seed = 1;
+  double interval = 10;       // statistics interval [s] (0: none)
+  bool quiet = false;
+};
+
+// Connection outcomes beyond those the server counts.
+struct ConnectionCounters {
+  std::atomic<uint64_t> connections{0};
+  std::atomic<uint64_t> resets{0};      // reset by request (-R) or down
+  std::atomic<uint64_t> held{0};        // no answer (lost requests)
+  std::atomic<uint64_t> incomplete{0};  // client closed or timed out first
+};
+
+static const std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+static std::mutex serverMutex;        // server, output and reset RNG
+static ConnectionCounters connCounters;
+static volatile sig_atomic_t stopping = 0;
+
+
+// Functions ===================================================================
+
+static void usage() {
+  fprintf(stderr,
+    "Usage: podd_mock_server [options]\n"
+    "Accepts pod uploads (form posts of DeviceID, SensorType, Reading, TimeStamp\n"
+    "and ReadTime to any page, e.g. /LMNSensePod.php) on a local port, with\n"
+    "injected latency, errors and connection resets.\n"
+    "\n"
+    "Options:\n"
+    "  -a ADDRESS         address to listen on (default: 127.0.0.1; 0.0.0.0 for\n"
+    "                     pods on the network)\n"
+    "  -P PORT            port (default: 8080)\n"
+    "  -L MS              response time (default: 0)\n"
+    "  -p PROB            probability that a request gets no answer (default: 0)\n"
+    "  -R PROB            probability that a connection is reset (default: 0)\n"
+    "  -f START-END:MODE  failure, in seconds (or with s, m, h or d) from start-up;\n"
+    "                     MODE is down (connections reset), timeout, error or\n"
+    "                     slow=MS (repeatable)\n"
+    "  -s SEED            random seed (default: 1)\n"
+    "  -o FILE            append stored readings to this CSV file\n"
+    "  -i SECONDS         statistics interval (default: 10; 0 for none)\n"
+    "  -q                 only report errors\n");
+}
+
+
+/* Parses a numeric argument; exits on error. */
+static double numberArg(const char *opt, const std::string &arg) {
+  char *end;
+  const double v = strtod(arg.c_str(),&end);
+  if (arg.empty() || (*end != '\0')) {
+    fprintf(stderr,"podd_mock_server: option %s needs a number, not '%s'\n",opt,arg.c_str());
+    exit(2);
+  }
+  return v;
+}
+
+
+/* Microseconds since start-up: the server's clock. */
+static uint64_t elapsedMicros() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+           std::chrono::steady_clock::now() - startTime).count();
+}
+
+
+/* Closes the connection with a reset rather than a normal close. */
+static void resetConnection(const int fd) {
+  linger l = {1,0};
+  setsockopt(fd,SOL_SOCKET,SO_LINGER,&l,sizeof(l));
+  close(fd);
+  connCounters.resets++;
+}
+
+
+/* Reads the request headers and as much body as Content-Length gives.
+   Returns false if the client closes, stalls or sends too much. */
+static bool readRequest(const int fd, std::string &req) {
+  char buff[2048];
+  size_t bodyStart = std::string::npos, length = 0;
+  while (true) {
+    if (bodyStart == std::string::npos) {
+      const size_t p = req.find("\r\n\r\n");
+      if (p != std::string::npos) {
+        bodyStart = p + 4;
+        for (size_t q = 0; q < p; q = req.find("\r\n",q) + 2) {
+          if (strncasecmp(req.c_str() + q,"Content-Length:",15) == 0) {
+            length = strtoul(req.c_str() + q + 15,nullptr,10);
+          }
+        }
+      }
+    }
+    if ((bodyStart != std::string::npos) && (req.size() >= bodyStart + length)) return true;
+    if (req.size() > REQUEST_MAX) return false;
+    const ssize_t n = recv(fd,buff,sizeof(buff),0);
+    if (n <= 0) return false;
+    req.append(buff,n);
+  }
+}
+
+
+/* Waits until the client closes the connection or the hold time ends. */
+static void holdConnection(const int fd) {
+  char buff[256];
+  const uint64_t end = elapsedMicros() + 1000000ull * HOLD_TIME;
+  while ((elapsedMicros() < end) && !stopping) {
+    const ssize_t n = recv(fd,buff,sizeof(buff),0);
+    if (n == 0) break;
+    if ((n < 0) && (errno != EAGAIN) && (errno != EWOULDBLOCK)) break;
+  }
+}
+
+
+static void writeReadings(FILE *out, std::vector<ReceivedReading> &readings) {
+  if (out == nullptr) return;
+  const int64_t now = std::chrono::duration_cast<std::chrono::milliseconds>(
+                        std::chrono::system_clock::now().time_since_epoch()).count();
+  for (const ReceivedReading &r : readings) {
+    fprintf(out,"%lld.%03lld, %s, %s, %s, %lld, %s\n",(long long)(now / 1000),(long long)(now % 1000),
+            r.deviceID.c_str(),r.sensorType.c_str(),r.value.c_str(),(long long)r.timestamp,
+            r.readTime.c_str());
+  }
+  fflush(out);
+}
+
+
+static void handleConnection(const int fd, StandInServer &server, std::mt19937 &random,
+                             const double resetProbability, FILE *out) {
+  connCounters.connections++;
+  timeval tv = {REQUEST_TIMEOUT,0};
+  setsockopt(fd,SOL_SOCKET,SO_RCVTIMEO,&tv,sizeof(tv));
+  setsockopt(fd,SOL_SOCKET,SO_SNDTIMEO,&tv,sizeof(tv));
+
+  // A down server or a random reset ends the connection at once.
+  bool reset;
+  {
+    std::lock_guard<std::mutex> lock(serverMutex);
+    std::uniform_real_distribution<double> uniform(0.0,1.0);
+    reset = !server.up(elapsedMicros())
+            || ((resetProbability > 0) && (uniform(random) < resetProbability));
+  }
+  if (reset) {
+    resetConnection(fd);
+    return;
+  }
+
+  std::string req;
+  if (!readRequest(fd,req)) {
+    connCounters.incomplete++;
+    close(fd);
+    return;
+  }
+  const char *response = nullptr;
+  size_t responseLen = 0;
+  uint64_t at;
+  {
+    std::lock_guard<std::mutex> lock(serverMutex);
+    at = server.request(elapsedMicros(),req.data(),req.size(),response,responseLen);
+    std::vector<ReceivedReading> readings;
+    server.takeReadings(readings);
+    writeReadings(out,readings);
+  }
+  if (at == SIM_NEVER) {
+    connCounters.held++;
+    holdConnection(fd);
+    close(fd);
+    return;
+  }
+  const uint64_t now = elapsedMicros();
+  if (at > now) std::this_thread::sleep_for(std::chrono::microseconds(at - now));
+  for (size_t k = 0; k < responseLen; ) {
+    const ssize_t n = send(fd,response + k,responseLen - k,MSG_NOSIGNAL);
+    if (n <= 0) break;
+    k += n;
+  }
+  shutdown(fd,SHUT_WR);
+  close(fd);
+}
+
+
+static void printStats(const StandInServer &server, const double seconds) {
+  std::lock_guard<std::mutex> lock(serverMutex);
+  const ServerCounters &c = server.counters();
+  fprintf(stderr,"%8.0f s: %llu connections, %llu requests, %llu readings stored "
+          "(%.1f/s), %llu other, %llu errors, %llu unanswered, %llu resets\n",
+          seconds,(unsigned long long)connCounters.connections,(unsigned long long)c.requests,
+          (unsigned long long)c.stored,(seconds > 0) ? c.stored / seconds : 0.0,
+          (unsigned long long)c.other,(unsigned long long)c.errors,
+          (unsigned long long)connCounters.held,(unsigned long long)connCounters.resets);
+}
+
+
+static void onSignal(int) {
+  stopping = 1;
+}
+
+
+int main(int argc, char **argv) {
+  Options opt;
+  std::vector<std::string> failureArgs;
+  for (int k = 1; k < argc; k++) {
+    const std::string a = argv[k];
+    const bool hasValue = (a.size() == 2) && (a[0] == '-') && (std::string("aPLpRfsoi").find(a[1]) != std::string::npos);
+    if (hasValue && (k + 1 >= argc)) {
+      fprintf(stderr,"podd_mock_server: option %s needs a value\n",a.c_str());
+      return 2;
+    }
+    const std::string v = hasValue ? argv[++k] : "";
+    if ((a == "-h") || (a == "--help")) {
+      usage();
+      return 0;
+    } else if (a == "-a") {
+      opt.address = v;
+    } else if (a == "-P") {
+      opt.port = (int)numberArg("-P",v);
+    } else if (a == "-L") {
+      opt.latency = numberArg("-L",v);
+    } else if (a == "-p") {
+      opt.lossProbability = numberArg("-p",v);
+    } else if (a == "-R") {
+      opt.resetProbability = numberArg("-R",v);
+    } else if (a == "-f") {
+      failureArgs.push_back(v);
+    } else if (a == "-s") {
+      opt.seed = (uint32_t)numberArg("-s",v);
+    } else if (a == "-o") {
+      opt.output = v;
+    } else if (a == "-i") {
+      opt.interval = numberArg("-i",v);
+    } else if (a == "-q") {
+      opt.quiet = true;
+    } else {
+      fprintf(stderr,"podd_mock_server: unknown option %s\n",a.c_str());
+      usage();
+      return 2;
+    }
+  }
+  if ((opt.port <= 0) || (opt.port > 65535) || (opt.latency < 0) || (opt.interval < 0)
+      || (opt.lossProbability < 0) || (opt.lossProbability > 1)
+      || (opt.resetProbability < 0) || (opt.resetProbability > 1)) {
+    usage();
+    return 2;
+  }
+
+  StandInServer server((uint64_t)(1000 * opt.latency),opt.lossProbability,opt.seed);
+  for (const std::string &s : failureArgs) {
+    FailureWindow w;
+    if (!parseFailureWindow(s,0,w)) {
+      fprintf(stderr,"podd_mock_server: -f needs START-END:MODE, not '%s'\n",s.c_str());
+      return 2;
+    }
+    server.addFailure(w);
+  }
+  std::mt19937 random(opt.seed + 1);
+  FILE *out = nullptr;
+  if (!opt.output.empty()) {
+    if ((out = fopen(opt.output.c_str(),"a")) == nullptr) {
+      fprintf(stderr,"podd_mock_server: cannot write %s\n",opt.output.c_str());
+      return 1;
+    }
+    if (ftell(out) == 0) fprintf(out,"Arrival, DeviceID, SensorType, Reading, TimeStamp, ReadTime\n");
+  }
+
+  const int listener = socket(AF_INET,SOCK_STREAM,0);
+  const int yes = 1;
+  setsockopt(listener,SOL_SOCKET,SO_REUSEADDR,&yes,sizeof(yes));
+  sockaddr_in addr = {};
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons((uint16_t)opt.port);
+  if ((listener < 0) || (inet_pton(AF_INET,opt.address.c_str(),&addr.sin_addr) != 1)
+      || (bind(listener,(sockaddr*)&addr,sizeof(addr)) != 0) || (listen(listener,64) != 0)) {
+    fprintf(stderr,"podd_mock_server: cannot listen on %s:%d: %s\n",opt.address.c_str(),
+            opt.port,strerror(errno));
+    return 1;
+  }
+  struct sigaction sa = {};
+  sa.sa_handler = onSignal;
+  sigaction(SIGINT,&sa,nullptr);
+  sigaction(SIGTERM,&sa,nullptr);
+  if (!opt.quiet) fprintf(stderr,"podd_mock_server: listening on %s:%d\n",opt.address.c_str(),opt.port);
+
+  // One thread per connection, so slow answers do not hold up others.
+  // accept() wakes up periodically for the statistics and signals.
+  timeval tv = {1,0};
+  setsockopt(listener,SOL_SOCKET,SO_RCVTIMEO,&tv,sizeof(tv));
+  std::atomic<int> active{0};
+  double nextStats = opt.interval;
+  while (!stopping) {
+    const int fd = accept(listener,nullptr,nullptr);
+    if (fd >= 0) {
+      active++;
+      std::thread([fd,&server,&random,&opt,out,&active]() {
+        handleConnection(fd,server,random,opt.resetProbability,out);
+        active--;
+      }).detach();
+    }
+    const double seconds = elapsedMicros() / 1e6;
+    if (!opt.quiet && (opt.interval > 0) && (seconds >= nextStats)) {
+      printStats(server,seconds);
+      nextStats += opt.interval;
+    }
+  }
+  close(listener);
+  while (active > 0) std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  printStats(server,elapsedMicros() / 1e6);
+  if (out != nullptr) fclose(out);
+  return 0;
+}
+
+
+//==============================================================================
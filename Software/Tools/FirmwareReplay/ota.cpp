@@ -0,0 +1,544 @@
+/*==============================================================================
+  podd_ota: drives the PODD coordinator firmware, built for the host,
+  through a firmware image transfer to N simulated drones over a lossy
+  XBee link, and reports how long the drones take to stage the image
+  and how the transfer delays the drones' readings.
+
+  This file is part of the LMN PODD distribution:
+    https://github.com/lmnts/PODD
+
+  CONTRIBUTORS:
+    PODD contributors (2026)
+
+  COPYRIGHT/LICENSE:
+  Copyright (c) 2026 LMN Architects
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Affero General Public License as
+  published by the Free Software Foundation, either version 3 of the
+  License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Affero General Public License for more details.
+
+  You should have received a copy of the GNU Affero General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+==============================================================================*/
+
+// Usage: podd_ota [options]
+// See README.md for details.
+
+#include "harness.h"
+#include "replay.h"
+#include "sim.h"
+#include "stand_in_server.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <queue>
+#include <random>
+#include <string>
+#include <vector>
+
+
+// Constants/global variables ==================================================
+
+// Clock at the start of the run (2024-01-01 00:00:00 UTC).
+#define OTA_START_UTC 1704067200
+// Transfer settings, as in the firmware (pod_ota.h).
+#define OTA_IMAGE_FILE "FIRMWARE.BIN"
+#define OTA_WINDOW_CHUNKS 32
+#define OTA_NACK_SPREAD 3000000
+// The run ends once every drone has the image and the coordinator has
+// been quiet this long [us].
+#define OTA_QUIET_END 30000000
+
+struct Options {
+  unsigned drones = 4;
+  uint32_t imageSize = 65536;
+  double lossProbability = 0.01;
+  double readingInterval = 60;  // per drone [s] (0: none)
+  double timeLimit = 14400;     // [s]
+  double latency = 50;          // stand-in server response time [ms]
+  uint32_t seed = 1;
+  std::string card = "ota_sd";
+  std::string console;
+  bool quiet = false;
+};
+
+// A simulated drone: the image as it is reassembled, as pod_ota.cpp
+// does on the SD card.
+struct Drone {
+  std::string devid;
+  uint16_t tag = 0;
+  uint32_t size = 0, crc = 0;
+  std::vector<uint8_t> image;
+  std::vector<bool> have;
+  uint32_t received = 0;
+  bool staged = false;
+  uint64_t stagedAt = 0;
+  uint32_t duplicates = 0;      // chunks received again
+  uint32_t corrupt = 0;         // whole-image checks failed
+  uint32_t answers = 0;         // missing-chunk reports and statuses sent
+};
+
+// Something a drone sends: a reading (value k) or an answer.
+struct DroneEvent {
+  uint64_t at;
+  uint64_t seq;                 // keeps events at the same time in order
+  unsigned drone;
+  bool reading;
+  uint64_t k;
+  std::string message;
+  bool operator>(const DroneEvent &e) const {
+    return (at != e.at) ? (at > e.at) : (seq > e.seq);
+  }
+};
+
+// Coordinator packets seen on the link.
+struct SendCounters {
+  uint64_t announces, chunks, windowEnds, queries, other;
+  uint64_t bytes;               // framed bytes of transfer packets
+  uint64_t lastTransfer;        // time of the last transfer packet
+};
+
+static Options opt;
+static std::vector<Drone> drones;
+static std::priority_queue<DroneEvent,std::vector<DroneEvent>,std::greater<DroneEvent>> events;
+static uint64_t eventSeq = 0;
+static std::mt19937 rng;
+static SendCounters sent = {};
+
+
+// Functions ===================================================================
+
+static void usage() {
+  fprintf(stderr,
+    "Usage: podd_ota [options]\n"
+    "Runs the coordinator firmware on this computer in simulated time, sending a\n"
+    "random firmware image to simulated drones over a lossy XBee link while the\n"
+    "drones keep sending readings.  Reports when each drone holds the checked\n"
+    "image, the transfer traffic and the readings' delays.\n"
+    "\n"
+    "Options:\n"
+    "  -n DRONES          number of drones (default: 4)\n"
+    "  -S BYTES           image size (default: 65536)\n"
+    "  -p PROB            probability that a drone misses a packet, or that its\n"
+    "                     answer is lost (default: 0.01)\n"
+    "  -r SECONDS         interval between each drone's readings (default: 60;\n"
+    "                     0: none)\n"
+    "  -T SECONDS         longest run after start-up (default: 14400)\n"
+    "  -L MS              stand-in server response time (default: 50)\n"
+    "  -s SEED            random seed (default: 1)\n"
+    "  -o DIR             directory standing in for the SD card (default: ota_sd)\n"
+    "  -c FILE            write the firmware's console output to FILE\n"
+    "  -q                 only report errors\n");
+}
+
+
+/* Parses a numeric argument; exits on error. */
+static double numberArg(const char *opt, const std::string &arg) {
+  char *end;
+  const double v = strtod(arg.c_str(),&end);
+  if (arg.empty() || (*end != '\0')) {
+    fprintf(stderr,"podd_ota: option %s needs a number, not '%s'\n",opt,arg.c_str());
+    exit(2);
+  }
+  return v;
+}
+
+
+static double elapsedSeconds(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+
+// The coordinator's own sensors are off: there is no trace.
+bool replaySensorValue(const uint8_t, float&) {
+  return false;
+}
+
+bool replaySensorPresent(const uint8_t) {
+  return false;
+}
+
+
+/* As in the firmware: CRC-16/CCITT and CRC-32 (IEEE 802.3). */
+static uint16_t crc16(uint16_t crc, const char *data, const size_t len) {
+  for (size_t k = 0; k < len; k++) {
+    crc ^= (uint16_t)(uint8_t)data[k] << 8;
+    for (int j = 0; j < 8; j++) crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : (crc << 1);
+  }
+  return crc;
+}
+
+static uint32_t crc32(const std::vector<uint8_t> &data, const size_t len) {
+  uint32_t crc = 0xFFFFFFFF;
+  for (size_t k = 0; k < len; k++) {
+    crc ^= data[k];
+    for (int j = 0; j < 8; j++) crc = (crc & 1) ? (crc >> 1) ^ 0xEDB88320 : (crc >> 1);
+  }
+  return ~crc;
+}
+
+
+static void queueEvent(const uint64_t at, const unsigned drone, const bool reading,
+                       const uint64_t k, const std::string &message) {
+  events.push(DroneEvent{at,eventSeq++,drone,reading,k,message});
+}
+
+
+/* A drone answers after a random delay, unless the answer is lost. */
+static void answer(const uint64_t t, const unsigned d, const std::string &message) {
+  drones[d].answers++;
+  if (std::uniform_real_distribution<double>(0,1)(rng) < opt.lossProbability) return;
+  const uint64_t delay = std::uniform_int_distribution<uint64_t>(0,OTA_NACK_SPREAD - 1)(rng);
+  queueEvent(t + delay,d,false,0,message);
+}
+
+
+/* Missing chunks of a window (bit k: chunk k), as reported by drones. */
+static uint32_t missingChunks(const Drone &dr, const uint32_t window) {
+  uint32_t bits = 0;
+  for (uint32_t k = 0; k < OTA_WINDOW_CHUNKS; k++) {
+    const size_t index = window * OTA_WINDOW_CHUNKS + k;
+    if ((index < dr.have.size()) && !dr.have[index]) bits |= (1u << k);
+  }
+  return bits;
+}
+
+
+static std::string format(const char *fmt, ...) __attribute__((format(printf,1,2)));
+static std::string format(const char *fmt, ...) {
+  char buff[128];
+  va_list args;
+  va_start(args,fmt);
+  vsnprintf(buff,sizeof(buff),fmt,args);
+  va_end(args);
+  return buff;
+}
+
+
+/* Splits a packet at commas. */
+static std::vector<std::string> fields(const char *packet, const size_t n) {
+  std::vector<std::string> f(1);
+  for (size_t k = 0; k < n; k++) {
+    if (packet[k] == ',') {
+      f.emplace_back();
+    } else {
+      f.back() += packet[k];
+    }
+  }
+  return f;
+}
+
+
+/* A drone handles a coordinator packet, as pod_ota.cpp does. */
+static void droneReceive(const uint64_t t, const unsigned d, const char *packet, const size_t n,
+                         const std::vector<std::string> &f) {
+  Drone &dr = drones[d];
+  const uint16_t tag = (uint16_t)strtoul(f[2].c_str(),nullptr,16);
+  const char type = f[1][0];
+  if (type == 'I') {
+    if ((f.size() != 5) || (tag == dr.tag)) return;
+    dr.tag = tag;
+    dr.size = strtoul(f[3].c_str(),nullptr,16);
+    dr.crc = strtoul(f[4].c_str(),nullptr,16);
+    const uint32_t chunks = (dr.size + 31) / 32;
+    dr.image.assign(dr.size,0);
+    dr.have.assign(chunks,false);
+    dr.received = 0;
+    dr.staged = false;
+    return;
+  }
+  if ((tag != dr.tag) || (dr.tag == 0)) return;
+  if ((type == 'D') && (f.size() == 6) && !dr.staged) {
+    const size_t crcAt = n - f[5].size();
+    if (strtoul(f[5].c_str(),nullptr,16) != crc16(0xFFFF,packet,crcAt)) return;
+    const uint32_t index = strtoul(f[3].c_str(),nullptr,16);
+    const size_t pos = (size_t)index * 32;
+    const size_t len = f[4].size() / 2;
+    if ((index >= dr.have.size()) || (pos + len > dr.size)) return;
+    if (dr.have[index]) {
+      dr.duplicates++;
+      return;
+    }
+    for (size_t k = 0; k < len; k++) {
+      dr.image[pos + k] = (uint8_t)strtoul(f[4].substr(2*k,2).c_str(),nullptr,16);
+    }
+    dr.have[index] = true;
+    if (++dr.received < dr.have.size()) return;
+    if (crc32(dr.image,dr.size) == dr.crc) {
+      dr.staged = true;
+      dr.stagedAt = t;
+      answer(t,d,format("F,S,%s,%04X,0",dr.devid.c_str(),dr.tag));
+    } else {
+      dr.corrupt++;
+      dr.have.assign(dr.have.size(),false);
+      dr.received = 0;
+      answer(t,d,format("F,S,%s,%04X,1",dr.devid.c_str(),dr.tag));
+    }
+  } else if ((type == 'E') && (f.size() == 4) && !dr.staged) {
+    const uint32_t window = strtoul(f[3].c_str(),nullptr,16);
+    const uint32_t bits = missingChunks(dr,window);
+    if (bits != 0) answer(t,d,format("F,N,%s,%04X,%X,%X",dr.devid.c_str(),dr.tag,window,bits));
+  } else if ((type == 'C') && (f.size() == 3)) {
+    if (dr.staged) {
+      answer(t,d,format("F,S,%s,%04X,0",dr.devid.c_str(),dr.tag));
+      return;
+    }
+    for (uint32_t w = 0; w * OTA_WINDOW_CHUNKS < dr.have.size(); w++) {
+      const uint32_t bits = missingChunks(dr,w);
+      if (bits == 0) continue;
+      answer(t,d,format("F,N,%s,%04X,%X,%X",dr.devid.c_str(),dr.tag,w,bits));
+      break;
+    }
+  }
+}
+
+
+/* Send hook: each drone receives a transfer packet unless it is lost. */
+static void onSend(uint64_t t, const char *packet, size_t n) {
+  if ((n < 4) || (packet[0] != 'F') || (packet[1] != ',')) return;
+  const std::vector<std::string> f = fields(packet,n);
+  if ((f.size() < 3) || (f[1].size() != 1)) return;
+  switch (f[1][0]) {
+    case 'I': sent.announces++; break;
+    case 'D': sent.chunks++; break;
+    case 'E': sent.windowEnds++; break;
+    case 'C': sent.queries++; break;
+    default: sent.other++; break;
+  }
+  sent.bytes += n + 4;
+  sent.lastTransfer = t;
+  std::uniform_real_distribution<double> u(0,1);
+  for (unsigned d = 0; d < drones.size(); d++) {
+    if (u(rng) < opt.lossProbability) continue;
+    droneReceive(t,d,packet,n,f);
+  }
+}
+
+
+/* Hands the drones' packets that are due to the XBee link. */
+static void deliverEvents() {
+  const uint64_t t = simMicros();
+  while (!events.empty() && (events.top().at <= t)) {
+    const DroneEvent e = events.top();
+    events.pop();
+    if (e.reading) {
+      queueDronePacket(e.at,drones[e.drone].devid.c_str(),(uint8_t)(e.k % REPLAY_TYPE_COUNT),
+                       (float)e.k,OTA_START_UTC + (int64_t)(e.at / 1000000));
+    } else {
+      queueXBeeMessage(e.at,e.message.c_str());
+    }
+  }
+}
+
+
+static uint64_t wakeTime() {
+  const uint64_t t = firmwareWakeTime();
+  return events.empty() ? t : std::min(t,events.top().at);
+}
+
+
+static bool allStaged() {
+  for (const Drone &dr : drones) {
+    if (!dr.staged) return false;
+  }
+  return true;
+}
+
+
+int main(int argc, char **argv) {
+  for (int k = 1; k < argc; k++) {
+    const std::string a = argv[k];
+    const bool hasValue = (a.size() == 2) && (a[0] == '-') && (std::string("nSprTLsoc").find(a[1]) != std::string::npos);
+    if (hasValue && (k + 1 >= argc)) {
+      fprintf(stderr,"podd_ota: option %s needs a value\n",a.c_str());
+      return 2;
+    }
+    const std::string v = hasValue ? argv[++k] : "";
+    if ((a == "-h") || (a == "--help")) {
+      usage();
+      return 0;
+    } else if (a == "-n") {
+      opt.drones = (unsigned)numberArg("-n",v);
+    } else if (a == "-S") {
+      opt.imageSize = (uint32_t)numberArg("-S",v);
+    } else if (a == "-p") {
+      opt.lossProbability = numberArg("-p",v);
+    } else if (a == "-r") {
+      opt.readingInterval = numberArg("-r",v);
+    } else if (a == "-T") {
+      opt.timeLimit = numberArg("-T",v);
+    } else if (a == "-L") {
+      opt.latency = numberArg("-L",v);
+    } else if (a == "-s") {
+      opt.seed = (uint32_t)numberArg("-s",v);
+    } else if (a == "-o") {
+      opt.card = v;
+    } else if (a == "-c") {
+      opt.console = v;
+    } else if (a == "-q") {
+      opt.quiet = true;
+    } else {
+      fprintf(stderr,"podd_ota: unknown option %s\n",a.c_str());
+      usage();
+      return 2;
+    }
+  }
+  if ((opt.drones == 0) || (opt.drones > 999) || (opt.imageSize == 0) || (opt.imageSize > 131072)
+      || (opt.lossProbability < 0) || (opt.lossProbability >= 1) || (opt.readingInterval < 0)
+      || ((opt.readingInterval > 0) && (opt.readingInterval < 1)) || (opt.timeLimit <= 0)
+      || (opt.latency < 0)) {
+    usage();
+    return 2;
+  }
+  rng.seed(opt.seed);
+
+  // Simulated world, with a random image on the coordinator's card
+  simSetStartTime(OTA_START_UTC);
+  rtcSet(OTA_START_UTC);
+  StandInServer server((uint64_t)(1000 * opt.latency),0,opt.seed);
+  simSetNetwork(&server);
+  FILE *console = nullptr;
+  if (!opt.console.empty() && ((console = fopen(opt.console.c_str(),"w")) == nullptr)) {
+    fprintf(stderr,"podd_ota: cannot write %s\n",opt.console.c_str());
+    return 1;
+  }
+  simSetConsole(console);
+  std::error_code ec;
+  std::filesystem::create_directories(opt.card,ec);
+  if (ec) {
+    fprintf(stderr,"podd_ota: cannot create %s\n",opt.card.c_str());
+    return 1;
+  }
+  std::vector<uint8_t> image(opt.imageSize);
+  for (uint8_t &b : image) b = (uint8_t)rng();
+  const std::string imagePath = opt.card + "/" OTA_IMAGE_FILE;
+  FILE *f = fopen(imagePath.c_str(),"wb");
+  if ((f == nullptr) || (fwrite(image.data(),1,image.size(),f) != image.size())) {
+    fprintf(stderr,"podd_ota: cannot write %s\n",imagePath.c_str());
+    if (f != nullptr) fclose(f);
+    return 1;
+  }
+  fclose(f);
+  const uint32_t imageCRC = crc32(image,image.size());
+  firmwareSetCard(opt.card.c_str());
+  xbeeSetSerialNumber("13A200","40A1B2C3");
+  ReplayPodConfig config = {"coordinator",true,{}};
+  firmwarePreloadConfig(config);
+  drones.resize(opt.drones);
+  char devid[16];
+  for (unsigned d = 0; d < opt.drones; d++) {
+    snprintf(devid,sizeof(devid),"drone%03u",d + 1);
+    drones[d].devid = devid;
+  }
+
+  // Start up, then start the transfer
+  const auto wallStart = std::chrono::steady_clock::now();
+  simSetWakeHook(wakeTime);
+  xbeeSetSendHook(onSend);
+  firmwareSetup();
+  const uint64_t start = simMicros();
+  if (!firmwareStartImageTransfer()) {
+    fprintf(stderr,"podd_ota: the firmware did not accept the image\n");
+    return 1;
+  }
+  const uint64_t end = start + (uint64_t)(1e6 * opt.timeLimit);
+
+  // The drones' readings, spread over each interval.  Reading k carries
+  // k as its value, to match it up at the server.
+  std::vector<uint64_t> emitted;
+  if (opt.readingInterval > 0) {
+    const uint64_t interval = (uint64_t)(1e6 * opt.readingInterval);
+    for (uint64_t at = start; at < end; at += interval) {
+      for (unsigned d = 0; d < opt.drones; d++) {
+        const uint64_t when = at + interval * d / opt.drones;
+        queueEvent(when,d,true,emitted.size(),"");
+        emitted.push_back(when);
+      }
+    }
+  }
+
+  // Run until every drone has the image and the coordinator is done
+  uint64_t finished = 0;
+  while (simMicros() < end) {
+    deliverEvents();
+    firmwareLoop();
+    simIdle(false);
+    if ((finished == 0) && allStaged()) finished = simMicros();
+    if ((finished != 0) && (simMicros() - std::max(sent.lastTransfer,finished) > OTA_QUIET_END)) break;
+  }
+  const uint64_t stop = simMicros();
+  const double wall = elapsedSeconds(wallStart);
+  if (console != nullptr) fclose(console);
+
+  // Readings sent at least a minute before the end, with their delay
+  // from the drone
+  std::vector<double> delays;
+  uint64_t offered = 0;
+  for (const uint64_t at : emitted) {
+    if (at + 60000000 <= stop) offered++;
+  }
+  std::vector<bool> seen(emitted.size(),false);
+  for (const ReceivedReading &r : server.readings()) {
+    const uint64_t k = strtoull(r.value.c_str(),nullptr,10);
+    if ((r.deviceID.compare(0,5,"drone") != 0) || (k >= emitted.size()) || seen[k]
+        || (emitted[k] + 60000000 > stop)) continue;
+    seen[k] = true;
+    delays.push_back((r.arrival - emitted[k]) / 1e6);
+  }
+
+  const uint32_t chunks = (opt.imageSize + 31) / 32;
+  printf("%u drones, %u-byte image (%u chunks, CRC-32 %08X), %.1f%% packet loss\n",
+         opt.drones,opt.imageSize,chunks,imageCRC,100 * opt.lossProbability);
+  printf("\n  %-10s %10s %10s %8s %8s %8s\n","drone","staged [s]","received","again",
+         "corrupt","answers");
+  unsigned staged = 0;
+  for (const Drone &dr : drones) {
+    char when[16] = "-";
+    if (dr.staged) snprintf(when,sizeof(when),"%.1f",(dr.stagedAt - start) / 1e6);
+    const bool match = dr.staged && (dr.crc == imageCRC) && (dr.image == image);
+    if (match) staged++;
+    printf("  %-10s %10s %10u %8u %8u %8u%s\n",dr.devid.c_str(),when,dr.received,dr.duplicates,
+           dr.corrupt,dr.answers,(dr.staged && !match) ? "  IMAGE MISMATCH" : "");
+  }
+  printf("\n");
+  if (staged == opt.drones) {
+    printf("All drones staged the image after %.1f s\n",(finished - start) / 1e6);
+  } else {
+    printf("%u of %u drones staged the image within %.0f s\n",staged,opt.drones,opt.timeLimit);
+  }
+  printf("Coordinator: %llu chunk packets (%.2f per chunk), %llu announcements, %llu window ends,\n"
+         "  %llu queries; %llu bytes, last %.1f s after the start\n",
+         (unsigned long long)sent.chunks,(double)sent.chunks / chunks,
+         (unsigned long long)sent.announces,(unsigned long long)sent.windowEnds,
+         (unsigned long long)sent.queries,(unsigned long long)sent.bytes,
+         (sent.lastTransfer > start) ? (sent.lastTransfer - start) / 1e6 : 0.0);
+  if (!emitted.empty()) {
+    const DelayStats d = delayStats(delays);
+    printf("Readings: %llu of %llu stored; delay p50 %.1f s, p95 %.1f s, max %.1f s\n",
+           (unsigned long long)d.count,(unsigned long long)offered,d.p50,d.p95,d.max);
+  }
+  const FirmwareCounters fw = firmwareCounters();
+  printf("Firmware: %u packets parsed, %u dropped; %llu bytes lost in the serial buffer, %u in the ring\n",
+         fw.packetsParsed,fw.packetsDropped,(unsigned long long)xbeeCounters().rxDropped,
+         fw.xbeeOverrun);
+  if (!opt.quiet) {
+    fprintf(stderr,"%.1f simulated hours in %.2f s (%.0fx real time)\n",
+            simMicros() / 3.6e9,wall,(wall > 0) ? simMicros() / 1e6 / wall : 0.0);
+  }
+  return (staged == opt.drones) ? 0 : 1;
+}
+
+
+//==============================================================================
@@ -0,0 +1,425 @@
+/*==============================================================================
+  podd_replay: runs the PODD firmware on the host against a recorded
+  sensor trace, in simulated time, uploading to a stand-in server with
+  scheduled failures, and reports throughput, queueing delay and data
+  loss.
+
+  This file is part of the LMN PODD distribution:
+    https://github.com/lmnts/PODD
+
+  CONTRIBUTORS:
+    PODD contributors (2026)
+
+  COPYRIGHT/LICENSE:
+  Copyright (c) 2026 LMN Architects
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Affero General Public License as
+  published by the Free Software Foundation, either version 3 of the
+  License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Affero General Public License for more details.
+
+  You should have received a copy of the GNU Affero General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+==============================================================================*/
+
+// Usage: podd_replay [options] TRACE...
+// See README.md for details.
+
+#include "harness.h"
+#include "podd_csv.h"
+#include "podd_series.h"
+#include "podd_sources.h"
+#include "replay.h"
+#include "sim.h"
+#include "stand_in_server.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <set>
+#include <string>
+#include <vector>
+
+
+// Constants/global variables ==================================================
+
+// Trace column that sets the default rate of each sampling channel.
+static const SensorColumn CHANNEL_COLUMNS[REPLAY_CHANNEL_COUNT] = {
+  COL_LIGHT, COL_RH, COL_GLOBETEMP, COL_SOUND, COL_CO2, COL_PM2_5, COL_CO
+};
+
+struct Options {
+  std::string card = "replay_sd";
+  std::string console;        // console output file (empty: discarded)
+  std::string devid = "replay";
+  int64_t utcOffset = 0;      // legacy local time - UTC [s]
+  int64_t tolerance = 600;    // oldest trace reading used [s]
+  double lead = 120;          // firmware start before the trace [s]
+  double drain = 600;         // run on after the trace [s]
+  double latency = 50;        // server response time [ms]
+  double lossProbability = 0;
+  uint32_t seed = 1;
+  int rate = 0;               // sampling interval [s] (0: from the trace)
+  bool quiet = false;
+};
+
+// A drone whose readings are injected over the XBee link.
+struct Drone {
+  std::string name;
+  PodSource source;
+  uint64_t readings = 0;
+};
+
+// The trace, looked up at the current simulated time.
+static PodData trace;
+static std::vector<AsOfCursor> traceCursors;
+
+
+// Functions ===================================================================
+
+static void usage() {
+  fprintf(stderr,
+    "Usage: podd_replay [options] TRACE...\n"
+    "Runs the pod firmware on this computer in simulated time, with its sensors\n"
+    "reading a recorded data log, and reports what reached a stand-in upload\n"
+    "server.  TRACE is a log file or a directory searched for *.CSV files.\n"
+    "\n"
+    "Options:\n"
+    "  -d DEVID           device ID of the replayed pod (default: replay)\n"
+    "  -r SECONDS         sampling interval of every sensor (default: the median\n"
+    "                     interval of each sensor in the trace)\n"
+    "  -f START-END:MODE  server failure, in seconds (or with s, m, h or d) from\n"
+    "                     the start of the trace; MODE is down, timeout, error or\n"
+    "                     slow=MS (repeatable)\n"
+    "  -L MS              server response time (default: 50)\n"
+    "  -p PROB            probability that a request is lost (default: 0)\n"
+    "  -s SEED            random seed for -p (default: 1)\n"
+    "  -x NAME=PATH       a drone sending the readings of this log over XBee\n"
+    "                     (repeatable)\n"
+    "  -o DIR             directory standing in for the SD card (default: replay_sd)\n"
+    "  -c FILE            write the firmware's console output to FILE\n"
+    "  -l SECONDS         firmware start-up time before the trace (default: 120)\n"
+    "  -D SECONDS         time to run on after the trace (default: 600)\n"
+    "  -t SECONDS         oldest trace reading a sensor returns (default: 600)\n"
+    "  -z HOURS           UTC offset of the local times in older (Date, Time) logs\n"
+    "  -q                 only report errors\n");
+}
+
+
+/* Parses a numeric argument; exits on error. */
+static double numberArg(const char *opt, const std::string &arg) {
+  char *end;
+  const double v = strtod(arg.c_str(),&end);
+  if (arg.empty() || (*end != '\0')) {
+    fprintf(stderr,"podd_replay: option %s needs a number, not '%s'\n",opt,arg.c_str());
+    exit(2);
+  }
+  return v;
+}
+
+
+static double elapsedSeconds(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+
+bool replaySensorValue(const uint8_t type, float &v) {
+  if (type >= traceCursors.size()) return false;
+  return traceCursors[type].lookup(simUTC(),v);
+}
+
+
+bool replaySensorPresent(const uint8_t type) {
+  return (type < COL_COUNT) && !trace.series[type].t.empty();
+}
+
+
+/* Median interval between readings [s], 0 if fewer than two. */
+static int medianInterval(const Series &s) {
+  if (s.t.size() < 2) return 0;
+  std::vector<int64_t> dt(s.t.size() - 1);
+  for (size_t k = 1; k < s.t.size(); k++) dt[k-1] = s.t[k] - s.t[k-1];
+  std::nth_element(dt.begin(),dt.begin() + dt.size()/2,dt.end());
+  return (int)std::max<int64_t>(1,dt[dt.size()/2]);
+}
+
+
+/* First and last reading times over all columns; false if none. */
+static bool traceRange(const PodData &data, int64_t &first, int64_t &last) {
+  first = INT64_MAX;
+  last = INT64_MIN;
+  for (const Series &s : data.series) {
+    if (s.t.empty()) continue;
+    first = std::min(first,s.t.front());
+    last = std::max(last,s.t.back());
+  }
+  return first <= last;
+}
+
+
+/* Queues a drone's readings within [first,last] as the XBee packets
+   the drone firmware sends (sendXBee()), a second apart within each
+   data row.  Returns the number of readings. */
+static uint64_t queueDronePackets(const std::string &name, const PodData &data,
+                                  const int64_t first, const int64_t last) {
+  std::set<int64_t> times;
+  for (const Series &s : data.series) times.insert(s.t.begin(),s.t.end());
+  size_t next[COL_COUNT] = {};
+  uint64_t count = 0;
+  for (const int64_t t : times) {
+    for (uint8_t c = 0; c < COL_COUNT; c++) {
+      while ((next[c] < data.series[c].t.size()) && (data.series[c].t[next[c]] < t)) next[c]++;
+    }
+    if ((t < first) || (t > last)) continue;
+    uint64_t at = simTimeOfUTC(t);
+    for (uint8_t c = 0; c < COL_COUNT; c++) {
+      const Series &s = data.series[c];
+      if ((next[c] >= s.t.size()) || (s.t[next[c]] != t)) continue;
+      queueDronePacket(at,name.c_str(),c,s.v[next[c]++],t);
+      at += DRONE_PACKET_SPACING;
+      count++;
+    }
+  }
+  return count;
+}
+
+
+static void printDelayRow(const char *name, const uint64_t sent, const DelayStats &d) {
+  const uint64_t lost = (sent > d.count) ? sent - d.count : 0;
+  printf("  %-12s %9llu %9llu %9llu %6.2f%%",name,(unsigned long long)sent,
+         (unsigned long long)d.count,(unsigned long long)lost,
+         (sent > 0) ? 100.0 * lost / sent : 0.0);
+  if (d.count > 0) {
+    printf(" %9.1f %9.1f %9.1f %9.1f\n",d.mean,d.p50,d.p95,d.max);
+  } else {
+    printf("\n");
+  }
+}
+
+
+int main(int argc, char **argv) {
+  Options opt;
+  std::vector<PodSource> traces;
+  std::vector<std::string> failureArgs;
+  std::vector<Drone> drones;
+  for (int k = 1; k < argc; k++) {
+    const std::string a = argv[k];
+    const bool hasValue = (a.size() == 2) && (a[0] == '-') && (std::string("drfLpsxoclDtz").find(a[1]) != std::string::npos);
+    if (hasValue && (k + 1 >= argc)) {
+      fprintf(stderr,"podd_replay: option %s needs a value\n",a.c_str());
+      return 2;
+    }
+    const std::string v = hasValue ? argv[++k] : "";
+    if ((a == "-h") || (a == "--help")) {
+      usage();
+      return 0;
+    } else if (a == "-d") {
+      opt.devid = v;
+    } else if (a == "-r") {
+      opt.rate = (int)numberArg("-r",v);
+    } else if (a == "-f") {
+      failureArgs.push_back(v);
+    } else if (a == "-L") {
+      opt.latency = numberArg("-L",v);
+    } else if (a == "-p") {
+      opt.lossProbability = numberArg("-p",v);
+    } else if (a == "-s") {
+      opt.seed = (uint32_t)numberArg("-s",v);
+    } else if (a == "-x") {
+      const size_t eq = v.find('=');
+      if ((eq == std::string::npos) || (eq == 0)) {
+        fprintf(stderr,"podd_replay: -x needs NAME=PATH, not '%s'\n",v.c_str());
+        return 2;
+      }
+      std::vector<PodSource> sources;
+      std::string error;
+      if (!addPodSource(v,sources,error)) {
+        fprintf(stderr,"podd_replay: %s\n",error.c_str());
+        return 1;
+      }
+      drones.push_back(Drone{v.substr(0,eq),sources.front()});
+    } else if (a == "-o") {
+      opt.card = v;
+    } else if (a == "-c") {
+      opt.console = v;
+    } else if (a == "-l") {
+      opt.lead = numberArg("-l",v);
+    } else if (a == "-D") {
+      opt.drain = numberArg("-D",v);
+    } else if (a == "-t") {
+      opt.tolerance = (int64_t)numberArg("-t",v);
+    } else if (a == "-z") {
+      opt.utcOffset = (int64_t)(3600 * numberArg("-z",v));
+    } else if (a == "-q") {
+      opt.quiet = true;
+    } else if ((a.size() > 1) && (a[0] == '-')) {
+      fprintf(stderr,"podd_replay: unknown option %s\n",a.c_str());
+      usage();
+      return 2;
+    } else {
+      std::string error;
+      if (!addPodSource("trace=" + a,traces,error)) {
+        fprintf(stderr,"podd_replay: %s\n",error.c_str());
+        return 1;
+      }
+    }
+  }
+  if (traces.empty() || opt.devid.empty() || (opt.rate < 0) || (opt.lead < 60)
+      || (opt.drain < 0) || (opt.tolerance < 0) || (opt.latency < 0)
+      || (opt.lossProbability < 0) || (opt.lossProbability > 1)) {
+    usage();
+    return 2;
+  }
+
+  // The trace
+  trace.stats = ParseStats{};
+  std::string error;
+  if (!loadPodData(traces.front().files,opt.utcOffset,(1U << COL_COUNT) - 1,trace,error)) {
+    fprintf(stderr,"podd_replay: %s\n",error.c_str());
+    return 1;
+  }
+  int64_t traceStart, traceEnd;
+  if (!traceRange(trace,traceStart,traceEnd)) {
+    fprintf(stderr,"podd_replay: no sensor readings in the trace\n");
+    return 1;
+  }
+  for (uint8_t c = 0; c < COL_COUNT; c++) {
+    traceCursors.emplace_back(trace.series[c],opt.tolerance,false);
+  }
+
+  // Simulated world: the clocks start a lead time before the trace,
+  // so setup (about a minute) is over when it begins.
+  const int64_t startUTC = traceStart - (int64_t)opt.lead;
+  simSetStartTime(startUTC);
+  rtcSet(startUTC);
+  const uint64_t origin = simTimeOfUTC(traceStart);
+  StandInServer server((uint64_t)(1000 * opt.latency),opt.lossProbability,opt.seed);
+  for (const std::string &s : failureArgs) {
+    FailureWindow w;
+    if (!parseFailureWindow(s,origin,w)) {
+      fprintf(stderr,"podd_replay: -f needs START-END:MODE, not '%s'\n",s.c_str());
+      return 2;
+    }
+    server.addFailure(w);
+  }
+  simSetNetwork(&server);
+  FILE *console = nullptr;
+  if (!opt.console.empty() && ((console = fopen(opt.console.c_str(),"w")) == nullptr)) {
+    fprintf(stderr,"podd_replay: cannot write %s\n",opt.console.c_str());
+    return 1;
+  }
+  simSetConsole(console);
+  std::error_code ec;
+  std::filesystem::create_directories(opt.card,ec);
+  if (ec) {
+    fprintf(stderr,"podd_replay: cannot create %s\n",opt.card.c_str());
+    return 1;
+  }
+  firmwareSetCard(opt.card.c_str());
+  xbeeSetSerialNumber("13A200","40A1B2C3");
+
+  ReplayPodConfig config = {opt.devid.c_str(),true,{}};
+  for (uint8_t k = 0; k < REPLAY_CHANNEL_COUNT; k++) {
+    config.rates[k] = (opt.rate > 0) ? opt.rate : medianInterval(trace.series[CHANNEL_COLUMNS[k]]);
+  }
+  firmwarePreloadConfig(config);
+
+  uint64_t droneReadings = 0;
+  for (Drone &d : drones) {
+    PodData data;
+    data.stats = ParseStats{};
+    if (!loadPodData(d.source.files,opt.utcOffset,(1U << COL_COUNT) - 1,data,error)) {
+      fprintf(stderr,"podd_replay: %s\n",error.c_str());
+      return 1;
+    }
+    d.readings = queueDronePackets(d.name,data,traceStart,traceEnd);
+    droneReadings += d.readings;
+  }
+
+  // Run
+  const auto wallStart = std::chrono::steady_clock::now();
+  const uint64_t end = simTimeOfUTC(traceEnd) + (uint64_t)(1e6 * opt.drain);
+  simSetWakeHook(firmwareWakeTime);
+  firmwareSetup();
+  while (simMicros() < end) {
+    firmwareLoop();
+    simIdle(false);
+  }
+  const double wall = elapsedSeconds(wallStart);
+  if (console != nullptr) fclose(console);
+
+  // Report: readings counted by the firmware against those stored by
+  // the server, with the delay from reading to storage.
+  const FirmwareCounters fw = firmwareCounters();
+  const ServerCounters &sc = server.counters();
+  const XBeeCounters &xc = xbeeCounters();
+  std::vector<double> delays[REPLAY_TYPE_COUNT], all;
+  for (const ReceivedReading &r : server.readings()) {
+    if (r.deviceID != opt.devid) continue;
+    for (uint8_t k = 0; k < REPLAY_TYPE_COUNT; k++) {
+      if (r.sensorType != READING_NAMES[k]) continue;
+      const double d = (double)startUTC + r.arrival / 1e6 - r.timestamp;
+      delays[k].push_back(d);
+      all.push_back(d);
+    }
+  }
+
+  const double simHours = (simMicros() - origin) / 3.6e9;
+  uint64_t logged = 0;
+  printf("Replayed %s: %.1f h of trace + %.0f s, %llu trace readings\n",
+         traces.front().files.size() == 1 ? traces.front().files.front().c_str() : "trace",
+         (traceEnd - traceStart) / 3600.0,opt.drain,(unsigned long long)trace.stats.samples);
+  printf("Failures: %zu window(s), %.1f h in total; request loss probability %g\n",
+         failureArgs.size(),server.failureTime(SIM_NEVER) / 3.6e9,opt.lossProbability);
+  printf("\n  %-12s %9s %9s %9s %7s %9s %9s %9s %9s\n","Reading","logged","received",
+         "lost","loss","delay","p50","p95","max [s]");
+  for (uint8_t k = 0; k < REPLAY_TYPE_COUNT; k++) {
+    if ((fw.readings[k] == 0) && delays[k].empty()) continue;
+    printDelayRow(READING_NAMES[k],fw.readings[k],delayStats(delays[k]));
+    logged += fw.readings[k];
+  }
+  printDelayRow("total",logged,delayStats(all));
+  for (size_t j = 0; j < drones.size(); j++) {
+    std::vector<double> d;
+    for (const ReceivedReading &r : server.readings()) {
+      if (r.deviceID.compare(0,16,drones[j].name,0,16) == 0) {
+        d.push_back((double)startUTC + r.arrival / 1e6 - r.timestamp);
+      }
+    }
+    printDelayRow(("drone " + drones[j].name).c_str(),drones[j].readings,delayStats(d));
+  }
+  printf("\nFirmware: %u posts ok, %u failed to connect, %u timed out (longest %u ms); "
+         "%u readings not sent (report-by-exception)\n",fw.postSuccesses,fw.postFailures,
+         fw.postTimeouts,fw.postTimeMax,fw.suppressed);
+  printf("Server:   %llu requests, %llu readings stored, %llu other posts, %llu lost, "
+         "%llu errors, %llu slow, %llu malformed\n",
+         (unsigned long long)sc.requests,(unsigned long long)sc.stored,
+         (unsigned long long)sc.other,(unsigned long long)sc.lost,
+         (unsigned long long)sc.errors,(unsigned long long)sc.slow,
+         (unsigned long long)sc.malformed);
+  if (!drones.empty()) {
+    printf("XBee:     %llu readings queued, %llu bytes arrived, %llu lost to overruns "
+           "(firmware: %u); %u packets parsed, %u dropped\n",
+           (unsigned long long)droneReadings,(unsigned long long)xc.rxBytes,
+           (unsigned long long)xc.rxDropped,fw.xbeeOverrun,fw.packetsParsed,fw.packetsDropped);
+  }
+  printf("Throughput: %.0f readings stored per simulated hour; %u loops (longest %u us)\n",
+         (simHours > 0) ? sc.stored / simHours : 0.0,fw.loops,fw.loopTimeMax);
+  if (!opt.quiet) {
+    fprintf(stderr,"%.1f simulated hours in %.2f s (%.0fx real time)\n",
+            (simMicros() / 3.6e9),wall,(wall > 0) ? simMicros() / 1e6 / wall : 0.0);
+  }
+  return 0;
+}
+
+
+//==============================================================================
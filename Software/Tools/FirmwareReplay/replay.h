@@ -0,0 +1,99 @@
+/*==============================================================================
+  Interface between the replay harness and the firmware built for the
+  host.
+
+  This file is part of the LMN PODD distribution:
+    https://github.com/lmnts/PODD
+
+  CONTRIBUTORS:
+    PODD contributors (2026)
+
+  COPYRIGHT/LICENSE:
+  Copyright (c) 2026 LMN Architects
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Affero General Public License as
+  published by the Free Software Foundation, either version 3 of the
+  License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Affero General Public License for more details.
+
+  You should have received a copy of the GNU Affero General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+==============================================================================*/
+
+#pragma once
+
+// Included on both sides: the firmware side sees the Arduino stand-ins
+// (whose min/max macros break the C++ library headers), the harness
+// side the PoddData tools.  Only plain types are used here.
+#include <stddef.h>
+#include <stdint.h>
+
+
+// Constants/global variables ==================================================
+
+// Sensor reading types, in the firmware's ReadingType order, which is
+// also the data log column order (SensorColumn): light, RH, air
+// temperature, globe temperature, sound, CO2, PM2.5, PM10, CO.
+#define REPLAY_TYPE_COUNT 9
+
+// Sampling channels, in the firmware's SensorChannel order: light,
+// RH/air temperature, globe temperature, sound, CO2, PM, CO.
+#define REPLAY_CHANNEL_COUNT 7
+
+// Configuration stored in the simulated EEPROM before the firmware
+// starts, as if the pod had been set up through its menu.
+struct ReplayPodConfig {
+  const char *devid;
+  bool coordinator;
+  int rates[REPLAY_CHANNEL_COUNT];  // sampling intervals [s] (0: off)
+};
+
+// Firmware counters for the report.
+struct FirmwareCounters {
+  uint32_t readings[REPLAY_TYPE_COUNT];
+  uint32_t readFailures[REPLAY_TYPE_COUNT];
+  uint32_t suppressed;        // not sent (report-by-exception)
+  uint32_t postSuccesses;
+  uint32_t postFailures;      // no connection
+  uint32_t postTimeouts;      // no response before the timeout
+  uint32_t postTimeMax;       // [ms]
+  uint32_t loops;
+  uint32_t loopTimeMax;       // [us]
+  uint32_t xbeeReceived;      // bytes taken in by the read ISR
+  uint32_t xbeeOverrun;       // ...lost to ring buffer overruns
+  uint32_t packetsParsed;
+  uint32_t packetsDropped;
+};
+
+
+// Functions ===================================================================
+
+// Harness side (replay.cpp): the trace value of a reading type at the
+// current simulated time.  Returns false if there is none.
+bool replaySensorValue(const uint8_t type, float &v);
+// Whether the trace has any readings of the type (sensor probes, which
+// run before the trace starts).
+bool replaySensorPresent(const uint8_t type);
+
+// Firmware side (firmware_hooks.cpp).
+void firmwarePreloadConfig(const ReplayPodConfig &c);
+// Host directory standing in for the SD card.
+void firmwareSetCard(const char *dir);
+void firmwareSetup();
+void firmwareLoop();
+// Simulated time the firmware next has something to do (the idle
+// wake hook, see simIdle()).
+uint64_t firmwareWakeTime();
+FirmwareCounters firmwareCounters();
+// Starts sending the card's firmware image to the drones (coordinator,
+// after setup).  Returns false if there is no valid image.
+bool firmwareStartImageTransfer();
+
+
+//==============================================================================
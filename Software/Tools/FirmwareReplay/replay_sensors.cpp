@@ -0,0 +1,376 @@
+/*==============================================================================
+  Sensor routines for the firmware replay harness: the pod_sensors.h
+  interface, with readings taken from a recorded trace instead of the
+  sensor hardware.  Each routine takes roughly as long as the real one,
+  in simulated time.
+
+  This file is part of the LMN PODD distribution:
+    https://github.com/lmnts/PODD
+
+  CONTRIBUTORS:
+    PODD contributors (2026)
+
+  COPYRIGHT/LICENSE:
+  Copyright (c) 2026 LMN Architects
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Affero General Public License as
+  published by the Free Software Foundation, either version 3 of the
+  License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Affero General Public License for more details.
+
+  You should have received a copy of the GNU Affero General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+==============================================================================*/
+
+#include "replay.h"
+
+#include <Arduino.h>
+#include "pod_network.h"
+#include "pod_sensors.h"
+#include "pod_serial.h"
+#include "pod_util.h"
+
+
+// Constants/global variables ==================================================
+
+// Time taken by the real routines [ms]: I2C reads (light, PM), the
+// humidity sensor's conversion, an ADC read and a CozIR exchange
+// over software serial at 9600 baud.
+#define LIGHT_READ_TIME 1
+#define TEMPERATURE_READ_TIME 37
+#define ANALOG_READ_TIME 1
+#define CO2_READ_TIME 15
+#define PM_READ_TIME 3
+// Particulate matter sensor power up/down, start-up and cleaning
+#define PM_POWER_TIME 100
+#define PM_START_TIME 8000
+#define PM_CLEAN_TIME 12000
+
+static bool sensorsInitialized = false;
+static bool adcFreeRunning = false;
+static bool soundSampling = false;
+static bool pmPowered = false;
+static bool pmRunning = false;
+static float temperature = NAN, humidity = NAN;
+static float pm2_5 = NAN, pm10 = NAN;
+
+
+// Functions ===================================================================
+
+/* Trace value of a reading type, NaN if there is none. */
+static float traceValue(const ReadingType type) {
+  float v;
+  return replaySensorValue(type,v) ? v : NAN;
+}
+
+
+//------------------------------------------------------------------------------
+// Multi-sensor routines
+
+void sensorSetup() {
+  initSensors();
+}
+
+void initSensors() {
+  if (sensorsInitialized) return;
+  initADC();
+  initLightSensor();
+  initSoundSensor();
+  initTemperatureSensor();
+  initGlobeTemperatureSensor();
+  initCO2Sensor();
+  initCOSensor();
+  initPMSensor();
+  sensorsInitialized = true;
+  delay(100);
+}
+
+/* A sensor is available if the trace has any readings for it. */
+void printSensorCheck() {
+  FType AVAILABLE   = F("    available         ");
+  FType UNAVAILABLE = F("   unavailable        ");
+  Serial.println(F("Sensor availability (replayed):"));
+  Serial.print(F("    Light:                   "));
+  Serial.println(probeLightSensor() ? AVAILABLE : UNAVAILABLE);
+  Serial.print(F("    Sound:                   "));
+  Serial.println(probeSoundSensor() ? AVAILABLE : UNAVAILABLE);
+  Serial.print(F("    Temperature/humidity:    "));
+  Serial.println(probeTemperatureSensor() ? AVAILABLE : UNAVAILABLE);
+  Serial.print(F("    Radiant temperature:     "));
+  Serial.println(probeGlobeTemperatureSensor() ? AVAILABLE : UNAVAILABLE);
+  Serial.print(F("    CO2:                     "));
+  Serial.println(probeCO2Sensor() ? AVAILABLE : UNAVAILABLE);
+  Serial.print(F("    CO:                      "));
+  Serial.println(probeCOSensor() ? AVAILABLE : UNAVAILABLE);
+  Serial.print(F("    Particulate matter:      "));
+  Serial.println(probePMSensor() ? AVAILABLE : UNAVAILABLE);
+}
+
+/* Prints the sensor values once per interval, as the real routine. */
+void testSensors(unsigned long cycles, unsigned long sampleInterval) {
+  Serial.println();
+  Serial.println(F("Sensor testing (replayed)"));
+  for (unsigned long k = 1; k <= cycles; k++) {
+    if (getSerialChar(sampleInterval) != (char)(-1)) break;
+    retrieveTemperatureData();
+    retrievePMData();
+    const float v[] = {getLight(), getSound(), getRelHumidity(), getTemperature(),
+                       getGlobeTemperature(), (float)getCO2(), getCO(),
+                       getPM2_5(), getPM10()};
+    for (uint8_t j = 0; j < sizeof(v)/sizeof(v[0]); j++) {
+      Serial.print(' ');
+      Serial.print(v[j]);
+    }
+    Serial.println();
+  }
+  Serial.println(F("Sensor testing is complete."));
+}
+
+
+//------------------------------------------------------------------------------
+// ADC
+
+void initADC() {}
+
+void startADCFreeRunning() {
+  adcFreeRunning = true;
+}
+
+void stopADCFreeRunning() {
+  adcFreeRunning = false;
+}
+
+bool isADCFreeRunning() {
+  return adcFreeRunning;
+}
+
+int readAnalog(uint8_t) {
+  delay(ANALOG_READ_TIME);
+  return 0;
+}
+
+int readAnalogFast() {
+  return 0;
+}
+
+
+//------------------------------------------------------------------------------
+// Light
+
+void initLightSensor() {}
+
+bool probeLightSensor() {
+  return replaySensorPresent(READING_LIGHT);
+}
+
+float getLight() {
+  delay(LIGHT_READ_TIME);
+  return traceValue(READING_LIGHT);
+}
+
+
+//------------------------------------------------------------------------------
+// Sound: the real sensor is sampled in the background between reads,
+// so reads are immediate.
+
+void initSoundSensor() {}
+
+bool probeSoundSensor() {
+  return replaySensorPresent(READING_SOUND);
+}
+
+float getSound() {
+  if (!soundSampling) return NAN;
+  return traceValue(READING_SOUND);
+}
+
+void startSoundSampling() {
+  soundSampling = true;
+}
+
+void stopSoundSampling() {
+  soundSampling = false;
+}
+
+bool isSoundSampling() {
+  return soundSampling;
+}
+
+void sampleSoundISR() {}
+
+void resetSoundData() {}
+
+
+//------------------------------------------------------------------------------
+// Temperature/humidity
+
+void initTemperatureSensor() {}
+
+bool probeTemperatureSensor() {
+  return replaySensorPresent(READING_AIRTEMP) || replaySensorPresent(READING_HUMIDITY);
+}
+
+bool retrieveTemperatureData() {
+  delay(TEMPERATURE_READ_TIME);
+  temperature = traceValue(READING_AIRTEMP);
+  humidity = traceValue(READING_HUMIDITY);
+  return !isnan(temperature) || !isnan(humidity);
+}
+
+float getTemperature() {
+  return temperature;
+}
+
+float getRelHumidity() {
+  return humidity;
+}
+
+
+//------------------------------------------------------------------------------
+// Globe temperature
+
+void initGlobeTemperatureSensor() {}
+
+bool probeGlobeTemperatureSensor() {
+  return replaySensorPresent(READING_GLOBETEMP);
+}
+
+float getGlobeTemperature() {
+  delay(ANALOG_READ_TIME);
+  return traceValue(READING_GLOBETEMP);
+}
+
+
+//------------------------------------------------------------------------------
+// CO2: calibration commands are accepted and ignored.
+
+void initCO2Sensor() {}
+
+bool probeCO2Sensor() {
+  return replaySensorPresent(READING_CO2);
+}
+
+int getCO2() {
+  delay(CO2_READ_TIME);
+  const float v = traceValue(READING_CO2);
+  return isnan(v) ? -1 : (int)lround(v);
+}
+
+void setCO2(int) {}
+
+void setCO2(int, int) {}
+
+void enableCO2Serial() {}
+
+void disableCO2Serial() {}
+
+String cozirCommandString(char c, int v, int v2) {
+  String s(c);
+  if (v >= 0) s += ' ' + String(v);
+  if (v2 >= 0) s += ' ' + String(v2);
+  return s + "\r\n";
+}
+
+bool cozirSendCommand(char, int, int) {
+  delay(CO2_READ_TIME);
+  return probeCO2Sensor();
+}
+
+int cozirGetValue(char c, int) {
+  return (c == 'Z') ? getCO2() : -1;
+}
+
+
+//------------------------------------------------------------------------------
+// CO
+
+void initCOSensor() {}
+
+bool probeCOSensor() {
+  return replaySensorPresent(READING_CO);
+}
+
+float getCO() {
+  delay(ANALOG_READ_TIME);
+  return traceValue(READING_CO);
+}
+
+
+//------------------------------------------------------------------------------
+// Particulate matter: readings only while powered and running.
+
+void initPMSensor() {
+  pmPowered = false;
+  pmRunning = false;
+}
+
+void powerOnPMSensor() {
+  if (pmPowered) return;
+  delay(PM_POWER_TIME);
+  pmPowered = true;
+}
+
+void powerOffPMSensor() {
+  if (!pmPowered) return;
+  pmRunning = false;
+  delay(PM_POWER_TIME);
+  pmPowered = false;
+}
+
+bool isPMSensorPowered() {
+  return pmPowered;
+}
+
+void startPMSensor(bool wait) {
+  if (!pmPowered) return;
+  pmRunning = true;
+  if (wait) delay(PM_START_TIME);
+}
+
+void stopPMSensor() {
+  pmRunning = false;
+}
+
+bool isPMSensorRunning() {
+  return pmRunning;
+}
+
+bool probePMSensor() {
+  return replaySensorPresent(READING_PM2_5) || replaySensorPresent(READING_PM10);
+}
+
+bool cleanPMSensor(bool wait) {
+  if (!pmRunning) return false;
+  if (wait) delay(PM_CLEAN_TIME);
+  return true;
+}
+
+void resetPMData() {
+  pm2_5 = NAN;
+  pm10 = NAN;
+}
+
+bool retrievePMData() {
+  if (!pmRunning) return false;
+  delay(PM_READ_TIME);
+  pm2_5 = traceValue(READING_PM2_5);
+  pm10 = traceValue(READING_PM10);
+  return !isnan(pm2_5) || !isnan(pm10);
+}
+
+float getPM2_5() {
+  return pm2_5;
+}
+
+float getPM10() {
+  return pm10;
+}
+
+
+//==============================================================================
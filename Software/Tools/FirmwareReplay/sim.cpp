@@ -0,0 +1,449 @@
+/*==============================================================================
+  Simulated time and devices for the firmware replay harness.
+
+  This file is part of the LMN PODD distribution:
+    https://github.com/lmnts/PODD
+
+  CONTRIBUTORS:
+    PODD contributors (2026)
+
+  COPYRIGHT/LICENSE:
+  Copyright (c) 2026 LMN Architects
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Affero General Public License as
+  published by the Free Software Foundation, either version 3 of the
+  License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Affero General Public License for more details.
+
+  You should have received a copy of the GNU Affero General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+==============================================================================*/
+
+#include "sim.h"
+
+#include <algorithm>
+#include <cstring>
+#include <ctime>
+#include <deque>
+#include <map>
+#include <string>
+
+
+// Constants/global variables ==================================================
+
+// Global interrupt flag (bit 7), as on the AVR.
+volatile uint8_t SREG = 0x80;
+
+// Command mode: the radio answers "+++" after its guard time and
+// leaves command mode after ATCN or this long without a command.
+#define XBEE_GUARD_TIME 1000000
+#define XBEE_COMMAND_TIMEOUT 10000000
+// Time for the radio to answer a command
+#define XBEE_COMMAND_TIME 2000
+
+// Bytes arriving from the radio: each chunk starts once the previous
+// one has been sent over the serial link.
+struct RxChunk {
+  uint64_t start;
+  std::string bytes;
+};
+
+struct SimState {
+  uint64_t now = 0;
+  uint64_t wakeAt = SIM_NEVER;
+  uint64_t (*wakeHook)() = nullptr;
+  int64_t startUTC = 0;
+  // Timer1
+  void (*isr)() = nullptr;
+  uint32_t period = 0;
+  uint64_t nextTick = 0;
+  bool inISR = false;
+  FILE *console = nullptr;
+  NetworkModel *network = nullptr;
+};
+
+struct XBeeState {
+  // Receive buffer and the bytes still to arrive
+  uint8_t fifo[SIM_XBEE_RX_BUFFER];
+  size_t head = 0, count = 0;
+  std::deque<RxChunk> incoming;
+  size_t incomingPos = 0;
+  uint64_t incomingEnd = 0;
+  // Transmit side
+  uint64_t txDone = 0;
+  bool commandMode = false;
+  uint64_t lastCommand = 0;
+  std::string command;
+  bool inPacket = false;
+  std::string packet;
+  void (*sendHook)(uint64_t,const char*,size_t) = nullptr;
+  std::map<std::string,std::string> registers;
+  XBeeCounters counters = {};
+};
+
+struct RTCState {
+  int64_t base = 0;         // time set...
+  uint64_t baseSim = 0;     // ...at this simulated time
+  uint8_t regs[0x20] = {};
+  int addr = -1;
+  bool write = false;
+  bool timeWritten = false;
+};
+
+static SimState sim;
+static XBeeState xbee;
+static RTCState rtc;
+
+
+// Functions ===================================================================
+
+uint64_t simMicros() {
+  return sim.now;
+}
+
+
+/* Time the next byte from the radio finishes arriving. */
+static uint64_t nextArrival() {
+  if (xbee.incoming.empty()) return SIM_NEVER;
+  return xbee.incoming.front().start + (xbee.incomingPos + 1) * SIM_XBEE_BYTE_TIME;
+}
+
+
+/* Moves bytes that have arrived by time t into the receive buffer,
+   dropping those that find it full. */
+static void deliverArrivals(const uint64_t t) {
+  while (nextArrival() <= t) {
+    RxChunk &c = xbee.incoming.front();
+    xbee.counters.rxBytes++;
+    if (xbee.count < SIM_XBEE_RX_BUFFER) {
+      xbee.fifo[(xbee.head + xbee.count) % SIM_XBEE_RX_BUFFER] = c.bytes[xbee.incomingPos];
+      xbee.count++;
+    } else {
+      xbee.counters.rxDropped++;
+    }
+    if (++xbee.incomingPos >= c.bytes.size()) {
+      xbee.incoming.pop_front();
+      xbee.incomingPos = 0;
+    }
+  }
+}
+
+
+/* Time of the next timer interrupt with work to do: the next tick if
+   the receive buffer holds data, else the first tick after the next
+   byte arrives. */
+static uint64_t nextInterrupt() {
+  if (sim.isr == nullptr) return SIM_NEVER;
+  if (xbee.count > 0) return sim.nextTick;
+  const uint64_t a = nextArrival();
+  if (a == SIM_NEVER) return SIM_NEVER;
+  if (a <= sim.nextTick) return sim.nextTick;
+  return sim.nextTick + (a - sim.nextTick + sim.period - 1) / sim.period * sim.period;
+}
+
+
+/* Runs the timer interrupts due up to time t and sets the clock to t
+   (if later). */
+static void runUntil(const uint64_t t) {
+  while (!sim.inISR) {
+    const uint64_t tick = nextInterrupt();
+    if (tick > t) break;
+    if (tick > sim.now) sim.now = tick;
+    sim.nextTick = tick + sim.period;
+    deliverArrivals(sim.now);
+    // With interrupts disabled the tick is lost (the next one catches up).
+    if (SREG & 0x80) {
+      sim.inISR = true;
+      sim.isr();
+      sim.inISR = false;
+    }
+  }
+  if (t > sim.now) sim.now = t;
+  if (sim.now >= sim.wakeAt) sim.wakeAt = SIM_NEVER;
+}
+
+
+void simCharge(const uint32_t us) {
+  runUntil(sim.now + us);
+}
+
+
+void simAdvanceTo(const uint64_t t) {
+  runUntil(t);
+}
+
+
+void simIdle(const bool sleeping) {
+  uint64_t t = std::min(nextInterrupt(),sim.wakeAt);
+  if (sim.wakeHook != nullptr) t = std::min(t,sim.wakeHook());
+  if (sleeping) t = std::max(t,sim.now + 1000);
+  if (t != SIM_NEVER) runUntil(t);
+}
+
+
+void simSetWakeHook(uint64_t (*hook)()) {
+  sim.wakeHook = hook;
+}
+
+
+void simWakeAt(const uint64_t t) {
+  if (t < sim.wakeAt) sim.wakeAt = t;
+}
+
+
+void simSetStartTime(const int64_t utc) {
+  sim.startUTC = utc;
+}
+
+
+int64_t simUTC() {
+  return sim.startUTC + (int64_t)(sim.now / 1000000);
+}
+
+
+int64_t simUTCMillis() {
+  return 1000 * sim.startUTC + (int64_t)(sim.now / 1000);
+}
+
+
+uint64_t simTimeOfUTC(const int64_t utc) {
+  return (utc <= sim.startUTC) ? 0 : (uint64_t)(utc - sim.startUTC) * 1000000;
+}
+
+
+void simSetTimerInterrupt(void (*isr)(), const uint32_t periodUs) {
+  sim.isr = (periodUs > 0) ? isr : nullptr;
+  sim.period = periodUs;
+  sim.nextTick = sim.now + periodUs;
+}
+
+
+void simSetConsole(FILE *f) {
+  sim.console = f;
+}
+
+
+void simConsoleWrite(const uint8_t *buff, const size_t n) {
+  if (sim.console != nullptr) fwrite(buff,1,n,sim.console);
+}
+
+
+//------------------------------------------------------------------------------
+// XBee radio
+
+void xbeeSetSerialNumber(const char *high, const char *low) {
+  xbee.registers["SH"] = high;
+  xbee.registers["SL"] = low;
+}
+
+
+int xbeeAvailable() {
+  deliverArrivals(sim.now);
+  return xbee.count;
+}
+
+
+int xbeeRead() {
+  deliverArrivals(sim.now);
+  if (xbee.count == 0) return -1;
+  const uint8_t c = xbee.fifo[xbee.head];
+  xbee.head = (xbee.head + 1) % SIM_XBEE_RX_BUFFER;
+  xbee.count--;
+  return c;
+}
+
+
+int xbeePeek() {
+  deliverArrivals(sim.now);
+  return (xbee.count == 0) ? -1 : xbee.fifo[xbee.head];
+}
+
+
+void xbeeClear() {
+  deliverArrivals(sim.now);
+  xbee.head = 0;
+  xbee.count = 0;
+}
+
+
+void xbeeQueueIncoming(const uint64_t t, const char *data, const size_t n) {
+  if (n == 0) return;
+  const uint64_t start = std::max(t,xbee.incomingEnd);
+  xbee.incoming.push_back(RxChunk{start,std::string(data,n)});
+  xbee.incomingEnd = start + n * SIM_XBEE_BYTE_TIME;
+}
+
+
+/* Answers an AT command (without the "AT" prefix or '\r'): a bare
+   register name reads it, anything after the name sets it. */
+static void xbeeCommand(const std::string &cmd) {
+  xbee.counters.commands++;
+  std::string reply = "OK";
+  const std::string reg = cmd.substr(0,2);
+  if ((reg == "CN") || (reg == "WR") || (reg == "AC")) {
+    if (reg == "CN") xbee.commandMode = false;
+  } else if (cmd.size() > 2) {
+    xbee.registers[reg] = cmd.substr(2);
+  } else {
+    auto it = xbee.registers.find(reg);
+    reply = (it != xbee.registers.end()) ? it->second : "0";
+  }
+  reply += '\r';
+  xbeeQueueIncoming(sim.now + XBEE_COMMAND_TIME,reply.data(),reply.size());
+}
+
+
+void xbeeWrite(const uint8_t *buff, const size_t n) {
+  xbee.counters.txBytes += n;
+  xbee.txDone = std::max(xbee.txDone,sim.now) + n * SIM_XBEE_BYTE_TIME;
+  if (xbee.commandMode && (sim.now - xbee.lastCommand > XBEE_COMMAND_TIMEOUT)) {
+    xbee.commandMode = false;
+  }
+  for (size_t k = 0; k < n; k++) {
+    const char c = buff[k];
+    if (xbee.commandMode) {
+      if (c != '\r') {
+        xbee.command += c;
+        continue;
+      }
+      xbee.lastCommand = sim.now;
+      if ((xbee.command.size() >= 4) && (xbee.command.compare(0,2,"AT") == 0)) {
+        xbeeCommand(xbee.command.substr(2));
+      }
+      xbee.command.clear();
+    } else if (c == '\x02') {
+      xbee.inPacket = true;
+      xbee.packet.clear();
+    } else if ((c == '\x03') && xbee.inPacket) {
+      xbee.inPacket = false;
+      xbee.counters.txPackets++;
+      // Payload without the length, once its last byte is out
+      if (xbee.sendHook && (xbee.packet.size() >= 2)) {
+        xbee.sendHook(xbee.txDone - (n - 1 - k) * SIM_XBEE_BYTE_TIME,
+                      xbee.packet.data() + 2,xbee.packet.size() - 2);
+      }
+    } else if (xbee.inPacket) {
+      xbee.packet += c;
+    }
+  }
+  // Command mode sequence: "+++" on its own after a guard time
+  if (!xbee.commandMode && (n == 3) && (memcmp(buff,"+++",3) == 0)) {
+    xbee.commandMode = true;
+    xbee.lastCommand = sim.now + XBEE_GUARD_TIME;
+    xbee.command.clear();
+    xbeeQueueIncoming(sim.now + XBEE_GUARD_TIME,"OK\r",3);
+  }
+}
+
+
+void xbeeSetSendHook(void (*hook)(uint64_t t, const char *packet, size_t n)) {
+  xbee.sendHook = hook;
+}
+
+
+void xbeeFlush() {
+  if (xbee.txDone > sim.now) runUntil(xbee.txDone);
+}
+
+
+const XBeeCounters& xbeeCounters() {
+  return xbee.counters;
+}
+
+
+//------------------------------------------------------------------------------
+// DS3234 RTC
+
+static uint8_t toBCD(const int v) {
+  return (uint8_t)(((v / 10) << 4) | (v % 10));
+}
+
+static int fromBCD(const uint8_t v) {
+  return 10*(v >> 4) + (v & 0x0F);
+}
+
+
+void rtcSet(const int64_t utc) {
+  rtc.base = utc;
+  rtc.baseSim = sim.now;
+  // 25 C
+  rtc.regs[0x11] = 25;
+  rtc.regs[0x12] = 0;
+}
+
+
+void rtcSelect() {
+  rtc.addr = -1;
+  rtc.timeWritten = false;
+}
+
+
+/* One SPI byte: the first selects the register (bit 7: write), later
+   ones read or write consecutive registers.  Reading the time registers
+   latches the current time, as the DS3234 does. */
+uint8_t rtcTransfer(const uint8_t v) {
+  if (rtc.addr < 0) {
+    rtc.write = (v & 0x80) != 0;
+    rtc.addr = v & 0x7F;
+    if (!rtc.write && (rtc.addr <= 0x06)) {
+      // Seconds count from when the time was last set
+      const time_t t = (time_t)(rtc.base + (int64_t)((sim.now - rtc.baseSim) / 1000000));
+      struct tm tm;
+      gmtime_r(&t,&tm);
+      rtc.regs[0] = toBCD(tm.tm_sec);
+      rtc.regs[1] = toBCD(tm.tm_min);
+      rtc.regs[2] = toBCD(tm.tm_hour);
+      rtc.regs[3] = toBCD(tm.tm_wday + 1);
+      rtc.regs[4] = toBCD(tm.tm_mday);
+      rtc.regs[5] = toBCD(tm.tm_mon + 1);
+      rtc.regs[6] = toBCD(tm.tm_year % 100);
+    }
+    return 0;
+  }
+  const int reg = rtc.addr;
+  rtc.addr = (rtc.addr + 1) % 0x20;
+  if (rtc.write) {
+    rtc.regs[reg] = v;
+    if (reg <= 0x06) rtc.timeWritten = true;
+    return 0;
+  }
+  return rtc.regs[reg];
+}
+
+
+/* Setting the time restarts the seconds countdown. */
+void rtcDeselect() {
+  if (!rtc.timeWritten) return;
+  struct tm tm = {};
+  tm.tm_sec = fromBCD(rtc.regs[0]);
+  tm.tm_min = fromBCD(rtc.regs[1]);
+  tm.tm_hour = fromBCD(rtc.regs[2]);
+  tm.tm_mday = fromBCD(rtc.regs[4]);
+  tm.tm_mon = fromBCD(rtc.regs[5]) - 1;
+  tm.tm_year = 100 + fromBCD(rtc.regs[6]);
+  rtc.base = timegm(&tm);
+  rtc.baseSim = sim.now;
+  rtc.timeWritten = false;
+}
+
+
+//------------------------------------------------------------------------------
+// Network
+
+void simSetNetwork(NetworkModel *network) {
+  sim.network = network;
+}
+
+
+NetworkModel* simNetwork() {
+  return sim.network;
+}
+
+
+//==============================================================================
@@ -0,0 +1,137 @@
+/*==============================================================================
+  Simulated time and devices for the firmware replay harness.
+
+  This file is part of the LMN PODD distribution:
+    https://github.com/lmnts/PODD
+
+  CONTRIBUTORS:
+    PODD contributors (2026)
+
+  COPYRIGHT/LICENSE:
+  Copyright (c) 2026 LMN Architects
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Affero General Public License as
+  published by the Free Software Foundation, either version 3 of the
+  License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Affero General Public License for more details.
+
+  You should have received a copy of the GNU Affero General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+==============================================================================*/
+
+#pragma once
+
+// Included by both the host-side harness and the Arduino stand-ins,
+// so only plain types are used here.
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+
+// Constants/global variables ==================================================
+
+// Simulated time is counted in microseconds from the start of the run.
+// The firmware only sees it through millis()/micros()/delay(), the RTC
+// and the timer interrupt.  Each millis()/micros() call costs
+// SIM_CALL_COST, so polling loops make progress.
+#define SIM_NEVER UINT64_MAX
+#define SIM_CALL_COST 4
+
+// XBee serial link: 9600 baud, 10 bits per byte, into the Teensy's
+// 64-byte hardware receive buffer.
+#define SIM_XBEE_BYTE_TIME 1042
+#define SIM_XBEE_RX_BUFFER 64
+
+// XBee traffic counters.
+struct XBeeCounters {
+  uint64_t rxBytes;         // bytes arriving from the radio
+  uint64_t rxDropped;       // ...lost to receive buffer overruns
+  uint64_t txBytes;         // bytes sent by the firmware
+  uint64_t txPackets;       // ...framed packets among them
+  uint64_t commands;        // AT commands answered
+};
+
+// The network seen through the ethernet stand-in: link/DHCP/DNS state
+// and the HTTP server (see stand_in_server.h).
+class NetworkModel {
+  public:
+    virtual ~NetworkModel() {}
+    // Whether the network can be reached at simulated time t.
+    virtual bool up(const uint64_t t) = 0;
+    // Handles an HTTP request fully received at time t.  Returns the
+    // time its response is available (SIM_NEVER: never) and points
+    // response at the response text.
+    virtual uint64_t request(const uint64_t t, const char *data, const size_t n,
+                             const char *&response, size_t &responseLen) = 0;
+};
+
+
+// Functions ===================================================================
+
+// Clock.  simCharge() adds processing time, running any interrupts
+// that fall due; simAdvanceTo() is delay().
+uint64_t simMicros();
+void simCharge(const uint32_t us);
+void simAdvanceTo(const uint64_t t);
+
+// Idles until the next event: an interrupt with work to do, the
+// one-shot wake time (simWakeAt()) or the time given by the wake hook
+// (the firmware's next scheduled task), whichever comes first.
+// Sleeping (sleep_cpu()) always advances by at least a millisecond,
+// as the millis() timer would wake the processor.
+void simIdle(const bool sleeping);
+void simSetWakeHook(uint64_t (*hook)());
+void simWakeAt(const uint64_t t);
+
+// Wall clock: UTC [s] and [ms] at the current simulated time, given the
+// UTC at the start of the run.
+void simSetStartTime(const int64_t utc);
+int64_t simUTC();
+int64_t simUTCMillis();
+uint64_t simTimeOfUTC(const int64_t utc);
+
+// Timer1 interrupt (the firmware's XBee reader).  Ticks with nothing
+// waiting in the receive buffer are skipped: the routine would find
+// no data.
+void simSetTimerInterrupt(void (*isr)(), const uint32_t periodUs);
+
+// Console output (USB serial); NULL discards it.
+void simSetConsole(FILE *f);
+void simConsoleWrite(const uint8_t *buff, const size_t n);
+
+// XBee radio on Serial1.  The firmware side reads the receive buffer
+// and writes commands or packets; the harness queues incoming bytes,
+// which arrive back to back at the link rate.  The radio answers AT
+// commands in command mode ("+++"), with the given serial number.
+void xbeeSetSerialNumber(const char *high, const char *low);
+int xbeeAvailable();
+int xbeeRead();
+int xbeePeek();
+void xbeeClear();
+void xbeeWrite(const uint8_t *buff, const size_t n);
+void xbeeFlush();
+void xbeeQueueIncoming(const uint64_t t, const char *data, const size_t n);
+// Called with the payload of each framed packet the firmware sends,
+// at the time its last byte is out.
+void xbeeSetSendHook(void (*hook)(uint64_t t, const char *packet, size_t n));
+const XBeeCounters& xbeeCounters();
+
+// DS3234 real-time clock on the SPI bus: chip select, transfers and
+// the time at the start of the run.
+void rtcSelect();
+uint8_t rtcTransfer(const uint8_t v);
+void rtcDeselect();
+void rtcSet(const int64_t utc);
+
+// The network behind the ethernet stand-in.
+void simSetNetwork(NetworkModel *network);
+NetworkModel* simNetwork();
+
+
+//==============================================================================
@@ -0,0 +1,131 @@
+/*==============================================================================
+  Network for the firmware harness that sends the firmware's HTTP
+  requests to a real server over TCP (see socket_network.h).
+
+  This file is part of the LMN PODD distribution:
+    https://github.com/lmnts/PODD
+
+  CONTRIBUTORS:
+    PODD contributors (2026)
+
+  COPYRIGHT/LICENSE:
+  Copyright (c) 2026 LMN Architects
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Affero General Public License as
+  published by the Free Software Foundation, either version 3 of the
+  License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Affero General Public License for more details.
+
+  You should have received a copy of the GNU Affero General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+==============================================================================*/
+
+#include "socket_network.h"
+
+#include <chrono>
+#include <cerrno>
+#include <cstring>
+#include <netdb.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+
+// Constants/global variables ==================================================
+
+// Longest wait for a response [s]; well beyond the firmware's own
+// timeout, which the charged time then exceeds.
+#define SOCKET_TIMEOUT 10
+
+
+// Functions ===================================================================
+
+bool SocketNetwork::open(const std::string &server, std::string &error) {
+  const size_t colon = server.rfind(':');
+  if ((colon == std::string::npos) || (colon == 0) || (colon + 1 == server.size())) {
+    error = "server needs HOST:PORT, not '" + server + "'";
+    return false;
+  }
+  _host = server.substr(0,colon);
+  _port = server.substr(colon + 1);
+  addrinfo hints = {}, *res = nullptr;
+  hints.ai_socktype = SOCK_STREAM;
+  const int rc = getaddrinfo(_host.c_str(),_port.c_str(),&hints,&res);
+  if (rc != 0) {
+    error = server + ": " + gai_strerror(rc);
+    return false;
+  }
+  freeaddrinfo(res);
+  return true;
+}
+
+
+/* Connects, sends the whole request and reads the response until the
+   server closes the connection. */
+uint64_t SocketNetwork::request(const uint64_t t, const char *data, const size_t n,
+                                const char *&response, size_t &responseLen) {
+  const auto start = std::chrono::steady_clock::now();
+  _counters.requests++;
+  _response.clear();
+  addrinfo hints = {}, *res = nullptr;
+  hints.ai_socktype = SOCK_STREAM;
+  int fd = -1;
+  if (getaddrinfo(_host.c_str(),_port.c_str(),&hints,&res) == 0) {
+    for (addrinfo *a = res; (a != nullptr) && (fd < 0); a = a->ai_next) {
+      fd = socket(a->ai_family,a->ai_socktype,a->ai_protocol);
+      if ((fd >= 0) && (connect(fd,a->ai_addr,a->ai_addrlen) != 0)) {
+        close(fd);
+        fd = -1;
+      }
+    }
+    freeaddrinfo(res);
+  }
+  if (fd < 0) {
+    _counters.refused++;
+    return SIM_NEVER;
+  }
+  timeval tv = {SOCKET_TIMEOUT,0};
+  setsockopt(fd,SOL_SOCKET,SO_RCVTIMEO,&tv,sizeof(tv));
+  setsockopt(fd,SOL_SOCKET,SO_SNDTIMEO,&tv,sizeof(tv));
+  bool ok = true;
+  for (size_t k = 0; ok && (k < n); ) {
+    const ssize_t m = send(fd,data + k,n - k,MSG_NOSIGNAL);
+    ok = (m > 0);
+    if (ok) k += m;
+  }
+  char buff[4096];
+  ssize_t m = 0;
+  while (ok && ((m = recv(fd,buff,sizeof(buff),0)) > 0)) _response.append(buff,m);
+  const bool timedOut = (m < 0) && ((errno == EAGAIN) || (errno == EWOULDBLOCK));
+  close(fd);
+  if (_response.empty()) {
+    if (timedOut) {
+      _counters.timeouts++;
+    } else {
+      _counters.resets++;
+    }
+    return SIM_NEVER;
+  }
+  _counters.responses++;
+  response = _response.data();
+  responseLen = _response.size();
+  const auto us = std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::steady_clock::now() - start).count();
+  const char *body = strstr(data,"\r\n\r\n");
+  ReceivedReading r;
+  if ((_response.compare(0,10,"HTTP/1.1 2") == 0) && (body != nullptr)
+      && parseReadingPost(body + 4,data + n,r)) {
+    r.arrival = t + (uint64_t)us;
+    _readings.push_back(r);
+  }
+  return t + (uint64_t)us;
+}
+
+
+//==============================================================================
@@ -0,0 +1,75 @@
+/*==============================================================================
+  Network for the firmware harness that sends the firmware's HTTP
+  requests to a real server (e.g. podd_mock_server) over TCP.
+
+  This file is part of the LMN PODD distribution:
+    https://github.com/lmnts/PODD
+
+  CONTRIBUTORS:
+    PODD contributors (2026)
+
+  COPYRIGHT/LICENSE:
+  Copyright (c) 2026 LMN Architects
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Affero General Public License as
+  published by the Free Software Foundation, either version 3 of the
+  License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Affero General Public License for more details.
+
+  You should have received a copy of the GNU Affero General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+==============================================================================*/
+
+#pragma once
+
+// Standard libraries
+#include <cstdint>
+#include <string>
+#include <vector>
+// Local headers
+#include "sim.h"
+#include "stand_in_server.h"
+
+
+// Constants/global variables ==================================================
+
+struct SocketCounters {
+  uint64_t requests;
+  uint64_t responses;
+  uint64_t refused;         // connection failed
+  uint64_t resets;          // connection closed without a response
+  uint64_t timeouts;        // no response in time
+};
+
+
+// Functions ===================================================================
+
+// Each request is sent on a new connection and the response read until
+// the server closes it.  The wall-clock time this takes is charged to
+// the simulated clock, so a run is paced by the server.  Readings the
+// server acknowledges (2xx) are kept, as the stand-in server does.
+class SocketNetwork : public NetworkModel {
+  public:
+    // Server as HOST:PORT; returns false (see error) if it cannot be
+    // resolved.
+    bool open(const std::string &server, std::string &error);
+    bool up(const uint64_t) override {return true;}
+    uint64_t request(const uint64_t t, const char *data, const size_t n,
+                     const char *&response, size_t &responseLen) override;
+    const SocketCounters& counters() const {return _counters;}
+    const std::vector<ReceivedReading>& readings() const {return _readings;}
+  private:
+    std::string _host, _port;
+    std::string _response;
+    std::vector<ReceivedReading> _readings;
+    SocketCounters _counters = {};
+};
+
+
+//==============================================================================
@@ -0,0 +1,239 @@
+/*==============================================================================
+  Stand-in for the PODD upload server and the network in front of it,
+  for the firmware replay harness.
+
+  This file is part of the LMN PODD distribution:
+    https://github.com/lmnts/PODD
+
+  CONTRIBUTORS:
+    PODD contributors (2026)
+
+  COPYRIGHT/LICENSE:
+  Copyright (c) 2026 LMN Architects
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Affero General Public License as
+  published by the Free Software Foundation, either version 3 of the
+  License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Affero General Public License for more details.
+
+  You should have received a copy of the GNU Affero General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+==============================================================================*/
+
+#include "stand_in_server.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+
+// Constants/global variables ==================================================
+
+static const char RESPONSE_OK[] =
+  "HTTP/1.1 200 OK\r\n"
+  "Content-Type: text/html\r\n"
+  "Content-Length: 0\r\n"
+  "Connection: close\r\n"
+  "\r\n";
+
+static const char RESPONSE_ERROR[] =
+  "HTTP/1.1 500 Internal Server Error\r\n"
+  "Content-Type: text/html\r\n"
+  "Content-Length: 0\r\n"
+  "Connection: close\r\n"
+  "\r\n";
+
+static const char RESPONSE_BAD_REQUEST[] =
+  "HTTP/1.1 400 Bad Request\r\n"
+  "Content-Length: 0\r\n"
+  "Connection: close\r\n"
+  "\r\n";
+
+
+// Functions ===================================================================
+
+/* Parses a time with optional s/m/h/d unit suffix into seconds. */
+static bool parseDuration(const std::string &s, double &seconds) {
+  char *end;
+  seconds = strtod(s.c_str(),&end);
+  if (s.empty() || (end == s.c_str())) return false;
+  const std::string unit = end;
+  if (unit.empty() || (unit == "s")) return true;
+  if (unit == "m") seconds *= 60;
+  else if (unit == "h") seconds *= 3600;
+  else if (unit == "d") seconds *= 86400;
+  else return false;
+  return true;
+}
+
+
+bool parseFailureWindow(const std::string &s, const uint64_t origin, FailureWindow &w) {
+  const size_t colon = s.find(':');
+  const size_t dash = s.find('-');
+  if ((colon == std::string::npos) || (dash == std::string::npos) || (dash > colon)) return false;
+  double start, end;
+  if (!parseDuration(s.substr(0,dash),start) || !parseDuration(s.substr(dash + 1,colon - dash - 1),end)) {
+    return false;
+  }
+  if ((start < 0) || (end <= start)) return false;
+  w.start = origin + (uint64_t)(1e6 * start);
+  w.end = origin + (uint64_t)(1e6 * end);
+  w.delay = 0;
+  const std::string mode = s.substr(colon + 1);
+  if (mode == "down") {
+    w.mode = FAIL_DOWN;
+  } else if (mode == "timeout") {
+    w.mode = FAIL_TIMEOUT;
+  } else if (mode == "error") {
+    w.mode = FAIL_ERROR;
+  } else if (mode.compare(0,5,"slow=") == 0) {
+    char *e;
+    const double ms = strtod(mode.c_str() + 5,&e);
+    if ((*e != '\0') || (ms < 0)) return false;
+    w.mode = FAIL_SLOW;
+    w.delay = (uint64_t)(1000 * ms);
+  } else {
+    return false;
+  }
+  return true;
+}
+
+
+const char* failureModeName(const FailureMode mode) {
+  switch (mode) {
+    case FAIL_DOWN:    return "down";
+    case FAIL_TIMEOUT: return "timeout";
+    case FAIL_ERROR:   return "error";
+    case FAIL_SLOW:    return "slow";
+  }
+  return "?";
+}
+
+
+/* Decodes an application/x-www-form-urlencoded value. */
+static std::string urlDecode(const char *b, const char *e) {
+  std::string s;
+  s.reserve(e - b);
+  for (const char *p = b; p < e; p++) {
+    if ((*p == '%') && (e - p >= 3)) {
+      const char hex[3] = {p[1],p[2],'\0'};
+      s += (char)strtol(hex,nullptr,16);
+      p += 2;
+    } else {
+      s += (*p == '+') ? ' ' : *p;
+    }
+  }
+  return s;
+}
+
+
+/* Finds a field in form data; returns false if absent. */
+static bool formField(const char *b, const char *e, const char *name, std::string &value) {
+  const size_t n = strlen(name);
+  const char *p = b;
+  while (p < e) {
+    const char *q = std::find(p,e,'&');
+    const char *eq = std::find(p,q,'=');
+    if ((eq < q) && ((size_t)(eq - p) == n) && (memcmp(p,name,n) == 0)) {
+      value = urlDecode(eq + 1,q);
+      return true;
+    }
+    p = q + 1;
+  }
+  return false;
+}
+
+
+bool parseReadingPost(const char *b, const char *e, ReceivedReading &r) {
+  std::string ts;
+  if (!formField(b,e,"DeviceID",r.deviceID) || !formField(b,e,"SensorType",r.sensorType)
+      || !formField(b,e,"Reading",r.value) || !formField(b,e,"TimeStamp",ts)) {
+    return false;
+  }
+  r.timestamp = strtoll(ts.c_str(),nullptr,10);
+  if (!formField(b,e,"ReadTime",r.readTime)) r.readTime.clear();
+  return true;
+}
+
+
+const FailureWindow* StandInServer::failureAt(const uint64_t t) const {
+  for (const FailureWindow &w : _failures) {
+    if ((t >= w.start) && (t < w.end)) return &w;
+  }
+  return nullptr;
+}
+
+
+bool StandInServer::up(const uint64_t t) {
+  const FailureWindow *w = failureAt(t);
+  return (w == nullptr) || (w->mode != FAIL_DOWN);
+}
+
+
+uint64_t StandInServer::failureTime(const uint64_t t) const {
+  uint64_t total = 0;
+  for (const FailureWindow &w : _failures) {
+    if (w.start < t) total += std::min(w.end,t) - w.start;
+  }
+  return total;
+}
+
+
+/* Handles one POST request; the form data follows the blank line that
+   ends the headers. */
+uint64_t StandInServer::request(const uint64_t t, const char *data, const size_t n,
+                                const char *&response, size_t &responseLen) {
+  _counters.requests++;
+  const FailureWindow *w = failureAt(t);
+  std::uniform_real_distribution<double> uniform(0.0,1.0);
+  const bool randomLoss = (_lossProbability > 0) && (uniform(_random) < _lossProbability);
+  if (randomLoss || ((w != nullptr) && ((w->mode == FAIL_DOWN) || (w->mode == FAIL_TIMEOUT)))) {
+    _counters.lost++;
+    return SIM_NEVER;
+  }
+  if ((w != nullptr) && (w->mode == FAIL_ERROR)) {
+    _counters.errors++;
+    response = RESPONSE_ERROR;
+    responseLen = sizeof(RESPONSE_ERROR) - 1;
+    return t + _latency;
+  }
+
+  const char *e = data + n;
+  const char *body = nullptr;
+  for (const char *p = data; p + 4 <= e; p++) {
+    if (memcmp(p,"\r\n\r\n",4) == 0) {
+      body = p + 4;
+      break;
+    }
+  }
+  if ((n < 5) || (memcmp(data,"POST ",5) != 0) || (body == nullptr)) {
+    _counters.malformed++;
+    response = RESPONSE_BAD_REQUEST;
+    responseLen = sizeof(RESPONSE_BAD_REQUEST) - 1;
+    return t + _latency;
+  }
+  ReceivedReading r;
+  if (parseReadingPost(body,e,r)) {
+    r.arrival = t;
+    _readings.push_back(r);
+    _counters.stored++;
+  } else {
+    _counters.other++;
+  }
+  response = RESPONSE_OK;
+  responseLen = sizeof(RESPONSE_OK) - 1;
+  if ((w != nullptr) && (w->mode == FAIL_SLOW)) {
+    _counters.slow++;
+    return t + w->delay;
+  }
+  return t + _latency;
+}
+
+
+//==============================================================================
@@ -0,0 +1,127 @@
+/*==============================================================================
+  Stand-in for the PODD upload server and the network in front of it,
+  for the firmware replay harness.
+
+  This file is part of the LMN PODD distribution:
+    https://github.com/lmnts/PODD
+
+  CONTRIBUTORS:
+    PODD contributors (2026)
+
+  COPYRIGHT/LICENSE:
+  Copyright (c) 2026 LMN Architects
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Affero General Public License as
+  published by the Free Software Foundation, either version 3 of the
+  License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Affero General Public License for more details.
+
+  You should have received a copy of the GNU Affero General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+==============================================================================*/
+
+#pragma once
+
+// Standard libraries
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+// Local headers
+#include "sim.h"
+
+
+// Constants/global variables ==================================================
+
+// What goes wrong during a failure window:
+//   FAIL_DOWN     no network: DHCP, name lookups and connections fail
+//   FAIL_TIMEOUT  requests are lost on the way (no response, not stored)
+//   FAIL_ERROR    the server answers 500 without storing the reading
+//   FAIL_SLOW     the server stores the reading but answers late
+enum FailureMode : uint8_t {
+  FAIL_DOWN,
+  FAIL_TIMEOUT,
+  FAIL_ERROR,
+  FAIL_SLOW
+};
+
+// A failure over [start,end) [us of simulated time]; delay [us] is the
+// response time of FAIL_SLOW.
+struct FailureWindow {
+  uint64_t start;
+  uint64_t end;
+  FailureMode mode;
+  uint64_t delay;
+};
+
+// A reading stored by the server, with the time it arrived [us].
+struct ReceivedReading {
+  std::string deviceID;
+  std::string sensorType;
+  std::string value;
+  int64_t timestamp;
+  std::string readTime;
+  uint64_t arrival;
+};
+
+struct ServerCounters {
+  uint64_t requests;        // requests that reached the network
+  uint64_t stored;          // readings stored
+  uint64_t other;           // other posts (settings, rate changes)
+  uint64_t lost;            // requests lost (FAIL_TIMEOUT, random)
+  uint64_t errors;          // 500 responses
+  uint64_t slow;            // late responses
+  uint64_t malformed;       // not a recognizable form post
+};
+
+
+// Functions ===================================================================
+
+// Parses a failure window, START-END:MODE with MODE one of down,
+// timeout, error or slow=MS.  Times are seconds (or with an s, m, h or
+// d suffix) from 'origin' [us].  Returns false if malformed.
+bool parseFailureWindow(const std::string &s, const uint64_t origin, FailureWindow &w);
+const char* failureModeName(const FailureMode mode);
+
+// Parses the form data of a reading upload (DeviceID, SensorType,
+// Reading, TimeStamp and optionally ReadTime) in [b,e).  Returns false
+// for other posts (settings, rate changes).
+bool parseReadingPost(const char *b, const char *e, ReceivedReading &r);
+
+// The server answers each form post after 'latency' [us], storing
+// readings; failure windows and a random per-request loss probability
+// (seeded, so runs repeat) are applied on top.  Times are simulated
+// time in the replay harness and wall-clock time in the mock server.
+class StandInServer : public NetworkModel {
+  public:
+    StandInServer(const uint64_t latency, const double lossProbability, const uint32_t seed)
+      : _latency(latency), _lossProbability(lossProbability), _random(seed) {}
+    void addFailure(const FailureWindow &w) {_failures.push_back(w);}
+    bool up(const uint64_t t) override;
+    uint64_t request(const uint64_t t, const char *data, const size_t n,
+                     const char *&response, size_t &responseLen) override;
+    const std::vector<ReceivedReading>& readings() const {return _readings;}
+    // Moves the readings stored so far into 'out' (long-running servers).
+    void takeReadings(std::vector<ReceivedReading> &out) {out.swap(_readings); _readings.clear();}
+    const ServerCounters& counters() const {return _counters;}
+    // Simulated time during which the server was down or failing [us],
+    // up to time t.
+    uint64_t failureTime(const uint64_t t) const;
+  private:
+    const FailureWindow* failureAt(const uint64_t t) const;
+    const uint64_t _latency;
+    const double _lossProbability;
+    std::mt19937 _random;
+    std::vector<FailureWindow> _failures;
+    std::vector<ReceivedReading> _readings;
+    ServerCounters _counters = {};
+};
+
+
+//==============================================================================
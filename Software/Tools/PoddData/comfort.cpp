@@ -0,0 +1,231 @@
+/*==============================================================================
+  Thermal comfort indices (ISO 7726, ISO 7730) for arrays of readings.
+
+  This file is part of the LMN PODD distribution:
+    https://github.com/lmnts/PODD
+
+  CONTRIBUTORS:
+    PODD contributors (2026)
+
+  COPYRIGHT/LICENSE:
+  Copyright (c) 2026 LMN Architects
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Affero General Public License as
+  published by the Free Software Foundation, either version 3 of the
+  License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Affero General Public License for more details.
+
+  You should have received a copy of the GNU Affero General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+==============================================================================*/
+
+#include "comfort.h"
+
+#include <algorithm>
+#include <cmath>
+
+
+// Constants/global variables ==================================================
+
+static const double STEFAN_BOLTZMANN = 5.67e-8;   // [W/m^2/K^4]
+static const double MET = 58.15;                  // [W/m^2]
+
+// Clothing temperature solve (ISO 7730 Annex D)
+static const double TCL_EPSILON = 0.00015;
+static const int TCL_MAX_ITERATIONS = 150;
+
+// Per-batch terms that depend only on the fixed conditions.
+struct ComfortTerms {
+  double icl, fcl, m, mw;
+  double hcf;                 // forced convection coefficient
+  double hcg;                 // globe forced convection term
+  double p1, p2, p3;
+  double tclOffset;           // initial tcl - ta
+  double hl2, ts;
+  double operativeWeight;     // weight of air temperature
+};
+
+
+// Functions ===================================================================
+
+/* |x|^0.25, written so that both code paths round identically. */
+static inline double root4(const double x) {
+  return std::sqrt(std::sqrt(std::fabs(x)));
+}
+
+
+static inline double pow4(const double x) {
+  const double x2 = x * x;
+  return x2 * x2;
+}
+
+
+/* Saturated water vapour pressure [kPa] at t [C]. */
+static inline double saturationPressure(const double t) {
+  return std::exp(16.6536 - 4030.183 / (t + 235));
+}
+
+
+static ComfortTerms comfortTerms(const ComfortConditions &c) {
+  ComfortTerms k;
+  k.icl = 0.155 * c.clo;
+  k.fcl = (k.icl <= 0.078) ? 1 + 1.29 * k.icl : 1.05 + 0.645 * k.icl;
+  k.m = c.met * MET;
+  k.mw = k.m - c.work * MET;
+  k.hcf = 12.1 * std::sqrt(c.airSpeed);
+  k.hcg = 6.3 * std::pow(c.airSpeed,0.6) / std::pow(c.globeDiameter,0.4);
+  k.p1 = k.icl * k.fcl;
+  k.p2 = k.p1 * 3.96;
+  k.p3 = k.p1 * 100;
+  k.tclOffset = 1 / (3.5 * k.icl + 0.1);
+  k.hl2 = (k.mw > MET) ? 0.42 * (k.mw - MET) : 0;
+  k.ts = 0.303 * std::exp(-0.036 * k.m) + 0.028;
+  k.operativeWeight = (c.airSpeed < 0.2) ? 0.5 : (c.airSpeed < 0.6) ? 0.6 : 0.7;
+  return k;
+}
+
+
+/* Mean radiant temperature from the precomputed terms. */
+static inline double radiantTemperature(const double ta, const double tg,
+                                        const ComfortTerms &k, const ComfortConditions &c) {
+  const double hcn = 1.4 * root4((tg - ta) / c.globeDiameter);
+  const double hc = std::max(k.hcg,hcn);
+  const double tga = tg + 273;
+  return root4(pow4(tga) + hc / (c.globeEmissivity * STEFAN_BOLTZMANN) * (tg - ta)) - 273;
+}
+
+
+double meanRadiantTemperature(const double ta, const double tg, const ComfortConditions &c) {
+  return radiantTemperature(ta,tg,comfortTerms(c),c);
+}
+
+
+double operativeTemperature(const double ta, const double tr, const double airSpeed) {
+  const double a = (airSpeed < 0.2) ? 0.5 : (airSpeed < 0.6) ? 0.6 : 0.7;
+  return a * ta + (1 - a) * tr;
+}
+
+
+/* PMV from the converged clothing temperature term xn (tcl/100 [K]). */
+static inline double pmvFromSolution(const double ta, const double tra, const double pa,
+                                     const double xn, const double hc, const ComfortTerms &k) {
+  const double tcl = 100 * xn - 273;
+  const double hl1 = 3.05e-3 * (5733 - 6.99 * k.mw - pa);
+  const double hl3 = 1.7e-5 * k.m * (5867 - pa);
+  const double hl4 = 0.0014 * k.m * (34 - ta);
+  const double hl5 = 3.96 * k.fcl * (pow4(xn) - pow4(tra / 100));
+  const double hl6 = k.fcl * hc * (tcl - ta);
+  return k.ts * (k.mw - hl1 - k.hl2 - hl3 - hl4 - hl5 - hl6);
+}
+
+
+double predictedMeanVote(const double ta, const double tr, const double rh,
+                         const ComfortConditions &c) {
+  const ComfortTerms k = comfortTerms(c);
+  const double pa = rh * 10 * saturationPressure(ta);
+  const double taa = ta + 273;
+  const double tra = tr + 273;
+  const double tcla = taa + (35.5 - ta) * k.tclOffset;
+  const double p4 = k.p1 * taa;
+  const double p5 = 308.7 - 0.028 * k.mw + k.p2 * pow4(tra / 100);
+  double xn = tcla / 100;
+  double xf = tcla / 50;
+  double hc;
+  for (int n = 1; ; n++) {
+    xf = (xf + xn) / 2;
+    const double hcn = 2.38 * root4(100 * xf - taa);
+    hc = std::max(k.hcf,hcn);
+    xn = (p5 + p4 * hc - k.p2 * pow4(xf)) / (100 + k.p3 * hc);
+    if (std::fabs(xn - xf) <= TCL_EPSILON) break;
+    if (n >= TCL_MAX_ITERATIONS) return NAN;
+  }
+  return pmvFromSolution(ta,tra,pa,xn,hc,k);
+}
+
+
+double predictedPercentDissatisfied(const double pmv) {
+  const double pmv2 = pmv * pmv;
+  return 100 - 95 * std::exp(-0.03353 * pmv2 * pmv2 - 0.2179 * pmv2);
+}
+
+
+/* Block of up to COMFORT_BLOCK samples.  The clothing temperature
+   solve steps all samples together until every one has converged, so
+   the step is a branch-free loop over arrays.  Samples that converge
+   early just take a few more steps towards the fixed point. */
+static void computeBlock(const ComfortTerms &k, const ComfortConditions &c,
+                         const ComfortArrays &a, const size_t n) {
+  const int B = COMFORT_BLOCK;
+  double ta[B], tr[B], pa[B], taa[B], tra[B], p4[B], p5[B];
+  double xn[B], xf[B], hc[B], diff[B];
+  // Pad a partial block with copies of its last sample
+  for (int i = 0; i < B; i++) {
+    const size_t j = std::min((size_t)i,n - 1);
+    ta[i] = a.ta[j];
+    tr[i] = radiantTemperature(a.ta[j],a.tg[j],k,c);
+    pa[i] = a.rh[j] * 10 * saturationPressure(a.ta[j]);
+  }
+  for (int i = 0; i < B; i++) {
+    taa[i] = ta[i] + 273;
+    tra[i] = tr[i] + 273;
+    const double tcla = taa[i] + (35.5 - ta[i]) * k.tclOffset;
+    p4[i] = k.p1 * taa[i];
+    p5[i] = 308.7 - 0.028 * k.mw + k.p2 * pow4(tra[i] / 100);
+    xn[i] = tcla / 100;
+    xf[i] = tcla / 50;
+  }
+  const double hcf = k.hcf, p2 = k.p2, p3 = k.p3;
+  for (int iter = 0; iter < TCL_MAX_ITERATIONS; iter++) {
+    for (int i = 0; i < B; i++) {
+      const double f = (xf[i] + xn[i]) / 2;
+      const double h = std::max(hcf,2.38 * root4(100 * f - taa[i]));
+      const double x = (p5[i] + p4[i] * h - p2 * pow4(f)) / (100 + p3 * h);
+      xf[i] = f;
+      hc[i] = h;
+      xn[i] = x;
+      diff[i] = std::fabs(x - f);
+    }
+    bool converged = true;
+    for (int i = 0; i < B; i++) converged &= (diff[i] <= TCL_EPSILON);
+    if (converged) break;
+  }
+  for (size_t i = 0; i < n; i++) {
+    const double pmv = (diff[i] <= TCL_EPSILON) ? pmvFromSolution(ta[i],tra[i],pa[i],xn[i],hc[i],k) : NAN;
+    if (a.tr) a.tr[i] = tr[i];
+    if (a.to) a.to[i] = k.operativeWeight * ta[i] + (1 - k.operativeWeight) * tr[i];
+    if (a.pmv) a.pmv[i] = pmv;
+    if (a.ppd) a.ppd[i] = predictedPercentDissatisfied(pmv);
+  }
+}
+
+
+void computeComfort(const ComfortConditions &c, const ComfortArrays &a, const size_t n) {
+  const ComfortTerms k = comfortTerms(c);
+  for (size_t i = 0; i < n; i += COMFORT_BLOCK) {
+    const ComfortArrays b = {a.ta + i, a.tg + i, a.rh + i,
+                             a.tr ? a.tr + i : nullptr, a.to ? a.to + i : nullptr,
+                             a.pmv ? a.pmv + i : nullptr, a.ppd ? a.ppd + i : nullptr};
+    computeBlock(k,c,b,std::min((size_t)COMFORT_BLOCK,n - i));
+  }
+}
+
+
+void computeComfortReference(const ComfortConditions &c, const ComfortArrays &a, const size_t n) {
+  for (size_t i = 0; i < n; i++) {
+    const double tr = meanRadiantTemperature(a.ta[i],a.tg[i],c);
+    const double pmv = predictedMeanVote(a.ta[i],tr,a.rh[i],c);
+    if (a.tr) a.tr[i] = tr;
+    if (a.to) a.to[i] = operativeTemperature(a.ta[i],tr,c.airSpeed);
+    if (a.pmv) a.pmv[i] = pmv;
+    if (a.ppd) a.ppd[i] = predictedPercentDissatisfied(pmv);
+  }
+}
+
+
+//==============================================================================
@@ -0,0 +1,90 @@
+/*==============================================================================
+  Thermal comfort indices (ISO 7726, ISO 7730) for arrays of readings.
+
+  This file is part of the LMN PODD distribution:
+    https://github.com/lmnts/PODD
+
+  CONTRIBUTORS:
+    PODD contributors (2026)
+
+  COPYRIGHT/LICENSE:
+  Copyright (c) 2026 LMN Architects
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Affero General Public License as
+  published by the Free Software Foundation, either version 3 of the
+  License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Affero General Public License for more details.
+
+  You should have received a copy of the GNU Affero General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+==============================================================================*/
+
+#pragma once
+
+// Standard libraries
+#include <cstddef>
+
+
+// Constants/global variables ==================================================
+
+// Samples processed together by the batch routines.  The iterative
+// clothing temperature solve runs in lock-step across a block, so
+// each step is a plain loop over the block that the compiler can
+// vectorize.
+#ifndef COMFORT_BLOCK
+#define COMFORT_BLOCK 16
+#endif
+
+// Conditions not measured by the pods, taken as fixed.
+struct ComfortConditions {
+  double airSpeed = 0.1;          // relative air speed [m/s]
+  double met = 1.1;               // metabolic rate [met] (1.1: typing)
+  double clo = 0.5;               // clothing insulation [clo] (0.5: summer)
+  double work = 0;                // external work [met], normally 0
+  double globeDiameter = 0.04;    // [m]
+  double globeEmissivity = 0.95;
+};
+
+// Arrays for a batch of n samples (structure of arrays).  Inputs are
+// air and globe temperature [C] and relative humidity [%]; outputs
+// are mean radiant and operative temperature [C], PMV and PPD [%].
+// Output arrays may be null if not wanted.
+struct ComfortArrays {
+  const double *ta, *tg, *rh;
+  double *tr, *to, *pmv, *ppd;
+};
+
+
+// Functions ===================================================================
+
+// Mean radiant temperature [C] from globe temperature (ISO 7726),
+// using the larger of the natural and forced convection coefficients.
+double meanRadiantTemperature(const double ta, const double tg, const ComfortConditions &c);
+// Operative temperature [C]: air and mean radiant temperature
+// weighted by air speed (ISO 7726).
+double operativeTemperature(const double ta, const double tr, const double airSpeed);
+// PMV for one sample, a direct transcription of the ISO 7730 Annex D
+// program; NaN if the clothing temperature does not converge.  Used
+// as the reference for the batch routine.
+double predictedMeanVote(const double ta, const double tr, const double rh,
+                         const ComfortConditions &c);
+// PPD [%] for a PMV.
+double predictedPercentDissatisfied(const double pmv);
+
+// Computes all indices for samples [0,n) of the arrays.  Agrees with
+// the single-sample routines above to within the tolerance of the
+// clothing temperature solve (a few thousandths of PMV; the batch
+// solve may take more steps, so it is the closer of the two).
+void computeComfort(const ComfortConditions &c, const ComfortArrays &a, const size_t n);
+// Same, one sample at a time with the reference routines (for
+// checking and benchmarking).
+void computeComfortReference(const ComfortConditions &c, const ComfortArrays &a, const size_t n);
+
+
+//==============================================================================
@@ -0,0 +1,120 @@
+/*==============================================================================
+  Buffered CSV output for the host tools.
+
+  This file is part of the LMN PODD distribution:
+    https://github.com/lmnts/PODD
+
+  CONTRIBUTORS:
+    PODD contributors (2026)
+
+  COPYRIGHT/LICENSE:
+  Copyright (c) 2026 LMN Architects
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Affero General Public License as
+  published by the Free Software Foundation, either version 3 of the
+  License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Affero General Public License for more details.
+
+  You should have received a copy of the GNU Affero General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+==============================================================================*/
+
+#pragma once
+
+// Standard libraries
+#include <charconv>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+
+// Constants/global variables ==================================================
+
+// Writes CSV text through a large buffer, formatting numbers without
+// locale lookups or temporary strings.
+class CsvWriter {
+  public:
+    CsvWriter() {}
+    ~CsvWriter() {close();}
+    CsvWriter(const CsvWriter&) = delete;
+    CsvWriter& operator=(const CsvWriter&) = delete;
+
+    // Opens the given file for writing ("-" for standard output).
+    bool open(const std::string &path) {
+      close();
+      _file = (path == "-") ? stdout : fopen(path.c_str(),"wb");
+      _ok = (_file != nullptr);
+      return _ok;
+    }
+    // Flushes and closes; returns false if any write failed.
+    bool close() {
+      if (_file == nullptr) return _ok;
+      flush();
+      if ((_file != stdout) && (fclose(_file) != 0)) _ok = false;
+      _file = nullptr;
+      return _ok;
+    }
+
+    void put(const char c) {
+      if (_used >= BUFFER_SIZE) flush();
+      _buffer[_used++] = c;
+    }
+    void put(const char *s, size_t n) {
+      if (_used + n > BUFFER_SIZE) flush();
+      if (n > BUFFER_SIZE) {
+        if (fwrite(s,1,n,_file) != n) _ok = false;
+        return;
+      }
+      memcpy(_buffer + _used,s,n);
+      _used += n;
+    }
+    void put(const char *s) {put(s,strlen(s));}
+    void put(const std::string &s) {put(s.data(),s.size());}
+    void putInt(const int64_t v) {
+      reserve(24);
+      _used = std::to_chars(_buffer + _used,_buffer + BUFFER_SIZE,v).ptr - _buffer;
+    }
+    // Shortest representation that reads back as the same value.
+    void putFloat(const float v) {
+      reserve(24);
+      _used = std::to_chars(_buffer + _used,_buffer + BUFFER_SIZE,v).ptr - _buffer;
+    }
+    void putDouble(const double v) {
+      reserve(32);
+      _used = std::to_chars(_buffer + _used,_buffer + BUFFER_SIZE,v).ptr - _buffer;
+    }
+    // Fixed number of decimal places.
+    void putFixed(const double v, const int decimals) {
+      reserve(48);
+      auto r = std::to_chars(_buffer + _used,_buffer + BUFFER_SIZE,v,std::chars_format::fixed,decimals);
+      _used = r.ptr - _buffer;
+    }
+    void endLine() {put('\n');}
+
+    void flush() {
+      if ((_used > 0) && (_file != nullptr)) {
+        if (fwrite(_buffer,1,_used,_file) != _used) _ok = false;
+      }
+      _used = 0;
+    }
+
+  private:
+    static const size_t BUFFER_SIZE = 1 << 16;
+    void reserve(const size_t n) {
+      if (_used + n > BUFFER_SIZE) flush();
+    }
+    FILE *_file = nullptr;
+    bool _ok = false;
+    size_t _used = 0;
+    char _buffer[BUFFER_SIZE];
+};
+
+
+//==============================================================================
@@ -0,0 +1,113 @@
+/*==============================================================================
+  Read-only memory-mapped files.
+
+  This file is part of the LMN PODD distribution:
+    https://github.com/lmnts/PODD
+
+  CONTRIBUTORS:
+    PODD contributors (2026)
+
+  COPYRIGHT/LICENSE:
+  Copyright (c) 2026 LMN Architects
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Affero General Public License as
+  published by the Free Software Foundation, either version 3 of the
+  License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Affero General Public License for more details.
+
+  You should have received a copy of the GNU Affero General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+==============================================================================*/
+
+#include "mapped_file.h"
+
+#include <cerrno>
+#include <cstring>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define MAPPED_FILE_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#include <fstream>
+#endif
+
+
+// Functions ===================================================================
+
+MappedFile::~MappedFile() {
+  close();
+}
+
+
+bool MappedFile::open(const std::string &path) {
+  close();
+  #ifdef MAPPED_FILE_MMAP
+  const int fd = ::open(path.c_str(),O_RDONLY);
+  if (fd < 0) {
+    _error = path + ": " + strerror(errno);
+    return false;
+  }
+  struct stat st;
+  if (fstat(fd,&st) != 0) {
+    _error = path + ": " + strerror(errno);
+    ::close(fd);
+    return false;
+  }
+  _size = (size_t)st.st_size;
+  if (_size > 0) {
+    void *p = mmap(nullptr,_size,PROT_READ,MAP_PRIVATE,fd,0);
+    if (p == MAP_FAILED) {
+      _error = path + ": " + strerror(errno);
+      _size = 0;
+      ::close(fd);
+      return false;
+    }
+    // Logs are scanned front to back once: favour read-ahead.
+    madvise(p,_size,MADV_SEQUENTIAL);
+    _data = (const char*)p;
+    _mapped = true;
+  }
+  // The mapping stays valid after the descriptor is closed.
+  ::close(fd);
+  return true;
+  #else
+  std::ifstream in(path,std::ios::binary | std::ios::ate);
+  if (!in) {
+    _error = path + ": cannot open";
+    return false;
+  }
+  _buffer.resize((size_t)in.tellg());
+  in.seekg(0);
+  if (!in.read(_buffer.data(),_buffer.size())) {
+    _error = path + ": read failed";
+    _buffer.clear();
+    return false;
+  }
+  _data = _buffer.data();
+  _size = _buffer.size();
+  return true;
+  #endif
+}
+
+
+void MappedFile::close() {
+  #ifdef MAPPED_FILE_MMAP
+  if (_mapped) munmap((void*)_data,_size);
+  #endif
+  _mapped = false;
+  _buffer.clear();
+  _data = nullptr;
+  _size = 0;
+}
+
+
+//==============================================================================
@@ -0,0 +1,66 @@
+/*==============================================================================
+  Read-only memory-mapped files.
+
+  This file is part of the LMN PODD distribution:
+    https://github.com/lmnts/PODD
+
+  CONTRIBUTORS:
+    PODD contributors (2026)
+
+  COPYRIGHT/LICENSE:
+  Copyright (c) 2026 LMN Architects
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Affero General Public License as
+  published by the Free Software Foundation, either version 3 of the
+  License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Affero General Public License for more details.
+
+  You should have received a copy of the GNU Affero General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+==============================================================================*/
+
+#pragma once
+
+// Standard libraries
+#include <cstddef>
+#include <string>
+#include <vector>
+
+
+// Constants/global variables ==================================================
+
+// Read-only view of a whole file.  On POSIX systems the file is
+// memory-mapped (pages are read on demand and shared through the page
+// cache); elsewhere it is read into memory.
+class MappedFile {
+  public:
+    MappedFile() {}
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // Maps the given file, replacing any previous mapping.  Returns
+    // false (see error()) on failure.
+    bool open(const std::string &path);
+    void close();
+
+    const char* data() const {return _data;}
+    size_t size() const {return _size;}
+    const std::string& error() const {return _error;}
+
+  private:
+    const char *_data = nullptr;
+    size_t _size = 0;
+    bool _mapped = false;
+    std::vector<char> _buffer;  // fallback when not mapped
+    std::string _error;
+};
+
+
+//==============================================================================
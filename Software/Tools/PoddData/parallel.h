@@ -0,0 +1,68 @@
+/*==============================================================================
+  Simple parallel loops for the host tools.
+
+  This file is part of the LMN PODD distribution:
+    https://github.com/lmnts/PODD
+
+  CONTRIBUTORS:
+    PODD contributors (2026)
+
+  COPYRIGHT/LICENSE:
+  Copyright (c) 2026 LMN Architects
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Affero General Public License as
+  published by the Free Software Foundation, either version 3 of the
+  License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Affero General Public License for more details.
+
+  You should have received a copy of the GNU Affero General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+==============================================================================*/
+
+#pragma once
+
+// Standard libraries
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+
+// Functions ===================================================================
+
+// Number of worker threads to use by default (one per core).
+inline unsigned defaultThreadCount() {
+  const unsigned n = std::thread::hardware_concurrency();
+  return (n > 0) ? n : 1;
+}
+
+// Calls fn(i) for each i in [0,count) using up to 'threads' threads.
+// Indices are handed out one at a time, so items of very different
+// sizes still balance across threads; callers wanting the largest
+// items started first should order them that way.  fn must be safe
+// to call concurrently for different indices.
+template <class F>
+void parallelFor(size_t count, unsigned threads, F fn) {
+  if (threads > count) threads = (unsigned)count;
+  if (threads <= 1) {
+    for (size_t i = 0; i < count; i++) fn(i);
+    return;
+  }
+  std::atomic<size_t> next(0);
+  auto worker = [&]() {
+    for (size_t i = next++; i < count; i = next++) fn(i);
+  };
+  std::vector<std::thread> pool;
+  for (unsigned k = 1; k < threads; k++) pool.emplace_back(worker);
+  worker();
+  for (std::thread &t : pool) t.join();
+}
+
+
+//==============================================================================
@@ -0,0 +1,381 @@
+/*==============================================================================
+  podd_align: time-aligns sensor data across pods.
+
+  This file is part of the LMN PODD distribution:
+    https://github.com/lmnts/PODD
+
+  CONTRIBUTORS:
+    PODD contributors (2026)
+
+  COPYRIGHT/LICENSE:
+  Copyright (c) 2026 LMN Architects
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Affero General Public License as
+  published by the Free Software Foundation, either version 3 of the
+  License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Affero General Public License for more details.
+
+  You should have received a copy of the GNU Affero General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+==============================================================================*/
+
+// Usage: podd_align [options] SOURCE...
+// See addPodSource() for the sources and README.md for details.
+
+#include "csv_writer.h"
+#include "parallel.h"
+#include "podd_csv.h"
+#include "podd_series.h"
+#include "podd_sources.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+
+// Constants/global variables ==================================================
+
+struct Options {
+  std::string output = "-";
+  uint16_t columnMask = (1U << COL_COUNT) - 1;
+  int64_t step = 300;         // grid step [s]
+  Aggregation agg[COL_COUNT];
+  int64_t fillLimit = 0;      // grid fill limit [s]
+  std::string refPod;         // as-of join reference series (empty: grid)
+  SensorColumn refColumn = COL_COUNT;
+  int64_t tolerance = 300;    // as-of tolerance [s]
+  bool nearest = false;
+  int64_t utcOffset = 0;      // legacy local time - UTC [s]
+  unsigned threads = defaultThreadCount();
+  bool quiet = false;
+};
+
+// An output column: one sensor column of one pod.
+struct OutputSeries {
+  size_t pod;
+  SensorColumn column;
+};
+
+
+// Functions ===================================================================
+
+static void usage() {
+  fprintf(stderr,
+    "Usage: podd_align [options] SOURCE...\n"
+    "Resamples the sensor data of several pods onto a common time grid, or joins\n"
+    "them as-of the reading times of one series, writing a single CSV table.\n"
+    "SOURCE is a log file, a directory searched for *.CSV files, or NAME=PATH.\n"
+    "\n"
+    "Options:\n"
+    "  -o FILE            output file (default: standard output)\n"
+    "  -k COLUMNS         comma-separated columns to include (default: all):\n"
+    "                     light, rh, airtemp, globetemp, sound, co2, pm2.5, pm10, co\n"
+    "  -s SECONDS         grid step (default: 300)\n"
+    "  -g AGG             how readings within a step are combined: mean, last,\n"
+    "                     min, max or count (default: mean)\n"
+    "  -g COLUMN=AGG      same, for a single column\n"
+    "  -f SECONDS         fill steps without readings with the last reading, if\n"
+    "                     no older than this (default: 0, no filling)\n"
+    "  -r POD:COLUMN      instead of a grid, write a row at each reading of this\n"
+    "                     series with the latest reading of every other series\n"
+    "  -t SECONDS         as-of tolerance: oldest reading used with -r (default: 300)\n"
+    "  -n                 with -r, use the nearest reading, before or after\n"
+    "  -c POD=SEC[,PPM]   clock correction: the pod's clock was SEC seconds ahead\n"
+    "                     at its first reading and gained PPM since\n"
+    "  -z HOURS           UTC offset of the local times in older (Date, Time) logs\n"
+    "  -j THREADS         worker threads (default: number of cores)\n"
+    "  -q                 only report errors\n");
+}
+
+
+/* Parses a numeric argument; exits on error. */
+static double numberArg(const char *opt, const std::string &arg) {
+  char *end;
+  const double v = strtod(arg.c_str(),&end);
+  if (arg.empty() || (*end != '\0')) {
+    fprintf(stderr,"podd_align: option %s needs a number, not '%s'\n",opt,arg.c_str());
+    exit(2);
+  }
+  return v;
+}
+
+
+/* Parses a comma-separated list of columns into a bit mask. */
+static bool parseColumnList(const std::string &s, uint16_t &mask) {
+  mask = 0;
+  size_t p = 0;
+  while (p <= s.size()) {
+    size_t q = s.find(',',p);
+    if (q == std::string::npos) q = s.size();
+    const SensorColumn c = parseColumn(s.substr(p,q - p));
+    if (c >= COL_COUNT) return false;
+    mask |= 1U << c;
+    p = q + 1;
+  }
+  return mask != 0;
+}
+
+
+static double elapsedSeconds(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+
+static void writeHeader(CsvWriter &out, const std::vector<OutputSeries> &series,
+                        const std::vector<PodSource> &pods) {
+  out.put("Timestamp, Date/Time (UTC)");
+  for (const OutputSeries &s : series) {
+    out.put(", ");
+    out.put(pods[s.pod].name);
+    out.put(' ');
+    out.put(COLUMN_NAMES[s.column]);
+  }
+  out.endLine();
+}
+
+
+/* Writes one table row; NaN values are left empty.  Returns false
+   (writing nothing) if all values are NaN. */
+static bool writeRow(CsvWriter &out, const int64_t t, const float *v, const size_t n) {
+  size_t k = 0;
+  while ((k < n) && std::isnan(v[k])) k++;
+  if (k == n) return false;
+  char buff[DATETIME_LEN];
+  out.putInt(t);
+  out.put(", ");
+  out.put(formatDateTime(buff,t));
+  for (k = 0; k < n; k++) {
+    out.put(", ");
+    if (!std::isnan(v[k])) out.putFloat(v[k]);
+  }
+  out.endLine();
+  return true;
+}
+
+
+int main(int argc, char **argv) {
+  Options opt;
+  for (uint8_t c = 0; c < COL_COUNT; c++) opt.agg[c] = AGG_MEAN;
+  std::vector<PodSource> pods;
+  std::vector<std::pair<std::string,ClockCorrection>> corrections;
+  bool ok = true;
+  for (int k = 1; k < argc; k++) {
+    const std::string a = argv[k];
+    const bool hasValue = (a.size() == 2) && (a[0] == '-') && (std::string("okgsfrtczj").find(a[1]) != std::string::npos);
+    if (hasValue && (k + 1 >= argc)) {
+      fprintf(stderr,"podd_align: option %s needs a value\n",a.c_str());
+      return 2;
+    }
+    const std::string v = hasValue ? argv[++k] : "";
+    if ((a == "-h") || (a == "--help")) {
+      usage();
+      return 0;
+    } else if (a == "-o") {
+      opt.output = v;
+    } else if (a == "-k") {
+      if (!parseColumnList(v,opt.columnMask)) {
+        fprintf(stderr,"podd_align: unknown column in '%s'\n",v.c_str());
+        return 2;
+      }
+    } else if (a == "-s") {
+      opt.step = (int64_t)numberArg("-s",v);
+    } else if (a == "-g") {
+      const size_t eq = v.find('=');
+      Aggregation agg;
+      if (!parseAggregation((eq == std::string::npos) ? v : v.substr(eq + 1),agg)) {
+        fprintf(stderr,"podd_align: unknown aggregation in '%s'\n",v.c_str());
+        return 2;
+      }
+      if (eq == std::string::npos) {
+        for (uint8_t c = 0; c < COL_COUNT; c++) opt.agg[c] = agg;
+      } else {
+        const SensorColumn c = parseColumn(v.substr(0,eq));
+        if (c >= COL_COUNT) {
+          fprintf(stderr,"podd_align: unknown column in '%s'\n",v.c_str());
+          return 2;
+        }
+        opt.agg[c] = agg;
+      }
+    } else if (a == "-f") {
+      opt.fillLimit = (int64_t)numberArg("-f",v);
+    } else if (a == "-r") {
+      const size_t colon = v.rfind(':');
+      opt.refColumn = (colon == std::string::npos) ? COL_COUNT : parseColumn(v.substr(colon + 1));
+      if (opt.refColumn >= COL_COUNT) {
+        fprintf(stderr,"podd_align: -r needs POD:COLUMN, not '%s'\n",v.c_str());
+        return 2;
+      }
+      opt.refPod = v.substr(0,colon);
+    } else if (a == "-t") {
+      opt.tolerance = (int64_t)numberArg("-t",v);
+    } else if (a == "-n") {
+      opt.nearest = true;
+    } else if (a == "-c") {
+      const size_t eq = v.find('=');
+      const size_t comma = v.find(',',eq);
+      if (eq == std::string::npos) {
+        fprintf(stderr,"podd_align: -c needs POD=SECONDS[,PPM], not '%s'\n",v.c_str());
+        return 2;
+      }
+      ClockCorrection c;
+      c.offset = numberArg("-c",v.substr(eq + 1,comma - eq - 1));
+      c.ppm = (comma == std::string::npos) ? 0 : numberArg("-c",v.substr(comma + 1));
+      corrections.emplace_back(v.substr(0,eq),c);
+    } else if (a == "-z") {
+      opt.utcOffset = (int64_t)(3600 * numberArg("-z",v));
+    } else if (a == "-j") {
+      opt.threads = (unsigned)std::max(1.0,numberArg("-j",v));
+    } else if (a == "-q") {
+      opt.quiet = true;
+    } else if ((a.size() > 1) && (a[0] == '-')) {
+      fprintf(stderr,"podd_align: unknown option %s\n",a.c_str());
+      usage();
+      return 2;
+    } else {
+      std::string error;
+      if (!addPodSource(a,pods,error)) {
+        fprintf(stderr,"podd_align: %s\n",error.c_str());
+        ok = false;
+      }
+    }
+  }
+  if (pods.empty() || (opt.step <= 0) || (opt.tolerance < 0) || (opt.fillLimit < 0)) {
+    usage();
+    return 2;
+  }
+
+  // Per-pod clock corrections and the as-of reference
+  std::vector<ClockCorrection> clock(pods.size(),ClockCorrection{0,0});
+  size_t refPod = pods.size();
+  for (size_t p = 0; p < pods.size(); p++) {
+    for (const auto &c : corrections) {
+      if (c.first == pods[p].name) clock[p] = c.second;
+    }
+    if (pods[p].name == opt.refPod) refPod = p;
+  }
+  for (const auto &c : corrections) {
+    bool found = false;
+    for (const PodSource &pod : pods) found = found || (pod.name == c.first);
+    if (!found) fprintf(stderr,"podd_align: warning: no pod named '%s' (-c)\n",c.first.c_str());
+  }
+  const bool asOf = !opt.refPod.empty();
+  if (asOf && (refPod >= pods.size())) {
+    fprintf(stderr,"podd_align: no pod named '%s' (-r)\n",opt.refPod.c_str());
+    return 2;
+  }
+
+  const auto start = std::chrono::steady_clock::now();
+  std::vector<ParseStats> stats(pods.size(),ParseStats{});
+  std::vector<std::string> errors(pods.size());
+  CsvWriter out;
+  if (!out.open(opt.output)) {
+    fprintf(stderr,"podd_align: cannot write %s\n",opt.output.c_str());
+    return 1;
+  }
+  std::vector<OutputSeries> series;
+  uint64_t rows = 0;
+
+  if (!asOf) {
+    // Grid: each pod is loaded, resampled and released in turn (pods
+    // in parallel), so only the grids of all pods are held at once.
+    std::vector<GridSeries> grids(pods.size() * COL_COUNT);
+    parallelFor(pods.size(),opt.threads,[&](size_t p) {
+      PodData data;
+      data.stats = ParseStats{};
+      if (!loadPodData(pods[p].files,opt.utcOffset,opt.columnMask,data,errors[p])) return;
+      correctClock(data,clock[p]);
+      for (uint8_t c = 0; c < COL_COUNT; c++) {
+        grids[p*COL_COUNT + c] = resampleSeries(data.series[c],opt.step,opt.agg[c],opt.fillLimit);
+      }
+      stats[p] = data.stats;
+    });
+    int64_t first = INT64_MAX, last = INT64_MIN;
+    for (size_t p = 0; p < pods.size(); p++) {
+      for (uint8_t c = 0; c < COL_COUNT; c++) {
+        const GridSeries &g = grids[p*COL_COUNT + c];
+        if (g.v.empty()) continue;
+        series.push_back(OutputSeries{p,(SensorColumn)c});
+        first = std::min(first,g.start);
+        last = std::max(last,g.start + (int64_t)(g.v.size() - 1) * opt.step);
+      }
+    }
+    writeHeader(out,series,pods);
+    std::vector<float> row(series.size());
+    for (int64_t t = first; t <= last; t += opt.step) {
+      for (size_t k = 0; k < series.size(); k++) {
+        const GridSeries &g = grids[series[k].pod*COL_COUNT + series[k].column];
+        const int64_t i = (t - g.start) / opt.step;
+        row[k] = ((t >= g.start) && (i < (int64_t)g.v.size())) ? g.v[i] : NAN;
+      }
+      if (writeRow(out,t,row.data(),row.size())) rows++;
+    }
+  } else {
+    // As-of join: all selected series are loaded, then each output
+    // column is looked up along the reference times in parallel.
+    std::vector<PodData> data(pods.size());
+    const uint16_t refMask = 1U << opt.refColumn;
+    parallelFor(pods.size(),opt.threads,[&](size_t p) {
+      data[p].stats = ParseStats{};
+      const uint16_t mask = opt.columnMask | ((p == refPod) ? refMask : 0);
+      if (!loadPodData(pods[p].files,opt.utcOffset,mask,data[p],errors[p])) return;
+      correctClock(data[p],clock[p]);
+      stats[p] = data[p].stats;
+    });
+    for (size_t p = 0; p < pods.size(); p++) {
+      for (uint8_t c = 0; c < COL_COUNT; c++) {
+        if (!(opt.columnMask & (1U << c)) || data[p].series[c].t.empty()) continue;
+        series.push_back(OutputSeries{p,(SensorColumn)c});
+      }
+    }
+    const Series &ref = data[refPod].series[opt.refColumn];
+    std::vector<std::vector<float>> columns(series.size());
+    parallelFor(series.size(),opt.threads,[&](size_t k) {
+      AsOfCursor cursor(data[series[k].pod].series[series[k].column],opt.tolerance,opt.nearest);
+      std::vector<float> &col = columns[k];
+      col.resize(ref.t.size());
+      for (size_t i = 0; i < ref.t.size(); i++) {
+        if (!cursor.lookup(ref.t[i],col[i])) col[i] = NAN;
+      }
+    });
+    writeHeader(out,series,pods);
+    std::vector<float> row(series.size());
+    for (size_t i = 0; i < ref.t.size(); i++) {
+      for (size_t k = 0; k < series.size(); k++) row[k] = columns[k][i];
+      if (writeRow(out,ref.t[i],row.data(),row.size())) rows++;
+    }
+  }
+  if (!out.close()) {
+    fprintf(stderr,"podd_align: error writing %s\n",opt.output.c_str());
+    ok = false;
+  }
+
+  for (size_t p = 0; p < pods.size(); p++) {
+    if (!errors[p].empty()) {
+      fprintf(stderr,"podd_align: %s\n",errors[p].c_str());
+      ok = false;
+    }
+  }
+  if (!opt.quiet) {
+    uint64_t bytes = 0;
+    for (size_t p = 0; p < pods.size(); p++) {
+      fprintf(stderr,"%-20s %10llu readings, %llu bad lines\n",pods[p].name.c_str(),
+              (unsigned long long)stats[p].samples,(unsigned long long)stats[p].badLines);
+      bytes += stats[p].bytes;
+    }
+    fprintf(stderr,"%zu series, %llu rows written; %.1f MB in %.2f s, %u threads\n",
+            series.size(),(unsigned long long)rows,bytes / 1e6,elapsedSeconds(start),opt.threads);
+  }
+  return ok ? 0 : 1;
+}
+
+
+//==============================================================================
@@ -0,0 +1,440 @@
+/*==============================================================================
+  podd_comfort: thermal comfort indices from PODD readings.
+
+  This file is part of the LMN PODD distribution:
+    https://github.com/lmnts/PODD
+
+  CONTRIBUTORS:
+    PODD contributors (2026)
+
+  COPYRIGHT/LICENSE:
+  Copyright (c) 2026 LMN Architects
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Affero General Public License as
+  published by the Free Software Foundation, either version 3 of the
+  License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Affero General Public License for more details.
+
+  You should have received a copy of the GNU Affero General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+==============================================================================*/
+
+// Usage: podd_comfort [options] SOURCE...
+//        podd_comfort --check
+//        podd_comfort --bench [SAMPLES]
+// See README.md for details.
+
+#include "comfort.h"
+#include "csv_writer.h"
+#include "parallel.h"
+#include "podd_csv.h"
+#include "podd_series.h"
+#include "podd_sources.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+
+// Constants/global variables ==================================================
+
+// Samples per parallel job.
+#define JOB_SAMPLES 65536
+
+struct Options {
+  std::string output = "-";
+  int64_t step = 300;         // grid step [s]
+  int64_t fillLimit = 600;    // grid fill limit [s]
+  int64_t utcOffset = 0;      // legacy local time - UTC [s]
+  bool fahrenheit = false;    // output temperatures in F
+  ComfortConditions conditions;
+  unsigned threads = defaultThreadCount();
+  bool quiet = false;
+};
+
+// Samples of all pods, as arrays.
+struct ComfortData {
+  std::vector<int64_t> t;
+  std::vector<double> ta, tg, rh, tr, to, pmv, ppd;
+  void resize(const size_t n) {
+    t.resize(n);
+    for (auto *v : {&ta,&tg,&rh,&tr,&to,&pmv,&ppd}) v->resize(n);
+  }
+  ComfortArrays arrays(const size_t offset) {
+    return ComfortArrays{&ta[offset],&tg[offset],&rh[offset],
+                         &tr[offset],&to[offset],&pmv[offset],&ppd[offset]};
+  }
+};
+
+// ISO 7730:2005 Table D.1: ta, tr, air speed, RH, met, clo -> PMV, PPD.
+// The table's 23.5/23.5/0.1/40/1.2/1.0 row (PMV 0.50) is left out: it
+// is inconsistent with its neighbours and with the standard's own
+// program, which gives 0.36.
+struct ReferenceCase {
+  double ta, tr, v, rh, met, clo, pmv, ppd;
+};
+static const ReferenceCase REFERENCE_CASES[] = {
+  {22.0, 22.0, 0.10, 60, 1.2, 0.5, -0.75, 17},
+  {27.0, 27.0, 0.10, 60, 1.2, 0.5,  0.77, 17},
+  {27.0, 27.0, 0.30, 60, 1.2, 0.5,  0.44,  9},
+  {23.5, 25.5, 0.10, 60, 1.2, 0.5, -0.01,  5},
+  {23.5, 25.5, 0.30, 60, 1.2, 0.5, -0.55, 11},
+  {19.0, 19.0, 0.10, 40, 1.2, 1.0, -0.60, 13},
+  {23.5, 23.5, 0.30, 40, 1.2, 1.0,  0.12,  5},
+  {23.0, 21.0, 0.10, 40, 1.2, 1.0,  0.05,  5},
+  {23.0, 21.0, 0.30, 40, 1.2, 1.0, -0.16,  6},
+  {22.0, 22.0, 0.10, 60, 1.6, 0.5,  0.05,  5},
+  {27.0, 27.0, 0.10, 60, 1.6, 0.5,  1.17, 34},
+  {27.0, 27.0, 0.30, 60, 1.6, 0.5,  0.95, 24},
+};
+
+
+// Functions ===================================================================
+
+static void usage() {
+  fprintf(stderr,
+    "Usage: podd_comfort [options] SOURCE...\n"
+    "       podd_comfort --check\n"
+    "       podd_comfort --bench [SAMPLES]\n"
+    "Computes mean radiant and operative temperature and ISO 7730 PMV/PPD from\n"
+    "the air temperature, globe temperature and humidity readings of pods.\n"
+    "SOURCE is a log file, a directory searched for *.CSV files, or NAME=PATH.\n"
+    "--check compares the results with the ISO 7730 reference table and the\n"
+    "batch code with the single-sample code; --bench measures throughput.\n"
+    "\n"
+    "Options:\n"
+    "  -o FILE       output file (default: standard output)\n"
+    "  -s SECONDS    time step readings are averaged over (default: 300)\n"
+    "  -f SECONDS    longest a reading is carried into later steps (default: 600)\n"
+    "  -v M/S        air speed (default: 0.1)\n"
+    "  -m MET        metabolic rate (default: 1.1)\n"
+    "  -l CLO        clothing insulation (default: 0.5)\n"
+    "  -d METERS     globe diameter (default: 0.04)\n"
+    "  -F            write temperatures in Fahrenheit (default: Celsius)\n"
+    "  -z HOURS      UTC offset of the local times in older (Date, Time) logs\n"
+    "  -j THREADS    worker threads (default: number of cores)\n"
+    "  -q            only report errors\n");
+}
+
+
+/* Parses a numeric argument; exits on error. */
+static double numberArg(const char *opt, const char *arg) {
+  char *end;
+  const double v = arg ? strtod(arg,&end) : 0;
+  if ((arg == nullptr) || (end == arg) || (*end != '\0')) {
+    fprintf(stderr,"podd_comfort: option %s needs a number\n",opt);
+    exit(2);
+  }
+  return v;
+}
+
+
+static double elapsedSeconds(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+
+static inline double toCelsius(const double f) {return (f - 32) / 1.8;}
+static inline double toFahrenheit(const double c) {return 1.8 * c + 32;}
+
+
+/* Random but plausible indoor readings. */
+static void randomSamples(ComfortData &data, const size_t n) {
+  std::mt19937_64 rng(7730);
+  std::uniform_real_distribution<double> air(12,32), globe(-3,6), humidity(10,90);
+  data.resize(n);
+  for (size_t i = 0; i < n; i++) {
+    data.ta[i] = air(rng);
+    data.tg[i] = data.ta[i] + globe(rng);
+    data.rh[i] = humidity(rng);
+  }
+}
+
+
+/* Computes all samples, JOB_SAMPLES at a time in parallel. */
+static void computeAll(const ComfortConditions &c, ComfortData &data, const unsigned threads,
+                       const bool reference) {
+  const size_t n = data.t.size();
+  parallelFor((n + JOB_SAMPLES - 1) / JOB_SAMPLES,threads,[&](size_t job) {
+    const size_t begin = job * JOB_SAMPLES;
+    const size_t count = std::min((size_t)JOB_SAMPLES,n - begin);
+    if (reference) {
+      computeComfortReference(c,data.arrays(begin),count);
+    } else {
+      computeComfort(c,data.arrays(begin),count);
+    }
+  });
+}
+
+
+/* Checks the ISO 7730 reference values and that the batch and
+   single-sample routines agree.  Returns true if all is well. */
+static bool selfCheck() {
+  bool ok = true;
+  printf("ISO 7730 Table D.1        PMV   (ref)     PPD  (ref)\n");
+  for (const ReferenceCase &r : REFERENCE_CASES) {
+    ComfortConditions c;
+    c.airSpeed = r.v;
+    c.met = r.met;
+    c.clo = r.clo;
+    const double pmv = predictedMeanVote(r.ta,r.tr,r.rh,c);
+    const double ppd = predictedPercentDissatisfied(pmv);
+    // The table is rounded to 0.01 PMV and 1% PPD, and differs from
+    // the program by up to a further 0.01
+    const bool good = (std::fabs(pmv - r.pmv) <= 0.011) && (std::fabs(ppd - r.ppd) <= 1);
+    printf("  %4.1f %4.1f %4.2f %2.0f%%  %6.3f (%5.2f)  %6.2f (%3.0f)  %s\n",r.ta,r.tr,r.v,r.rh,
+           pmv,r.pmv,ppd,r.ppd,good ? "ok" : "FAIL");
+    ok = ok && good;
+  }
+
+  // Batch vs. single-sample, including partial blocks
+  const size_t n = 100003;
+  ComfortData batch, single;
+  randomSamples(batch,n);
+  randomSamples(single,n);
+  ComfortConditions c;
+  for (const double v : {0.05,0.1,0.3,0.8,1.5}) {
+    c.airSpeed = v;
+    computeAll(c,batch,1,false);
+    computeAll(c,single,1,true);
+    double maxPMV = 0, maxTemp = 0;
+    size_t mismatched = 0;
+    for (size_t i = 0; i < n; i++) {
+      if (std::isnan(batch.pmv[i]) != std::isnan(single.pmv[i])) mismatched++;
+      if (!std::isnan(single.pmv[i])) maxPMV = std::max(maxPMV,std::fabs(batch.pmv[i] - single.pmv[i]));
+      maxTemp = std::max(maxTemp,std::fabs(batch.tr[i] - single.tr[i]));
+      maxTemp = std::max(maxTemp,std::fabs(batch.to[i] - single.to[i]));
+    }
+    const bool good = (mismatched == 0) && (maxPMV <= 0.005) && (maxTemp <= 1e-9);
+    printf("Batch vs. single, %zu samples, %.2f m/s: max PMV difference %.1e, "
+           "temperature %.1e, %zu unconverged mismatches  %s\n",
+           n,v,maxPMV,maxTemp,mismatched,good ? "ok" : "FAIL");
+    ok = ok && good;
+  }
+  printf("%s\n",ok ? "All checks passed." : "CHECKS FAILED.");
+  return ok;
+}
+
+
+/* Reports throughput of the single-sample and batch routines. */
+static void benchmark(const size_t n, const unsigned threads) {
+  ComfortData data;
+  randomSamples(data,n);
+  const ComfortConditions c;
+  struct {const char *name; unsigned threads; bool reference;} runs[] = {
+    {"single-sample",1,true},
+    {"batch",1,false},
+    {"batch",threads,false},
+  };
+  double base = 0;
+  for (const auto &r : runs) {
+    if ((&r == &runs[2]) && (threads == 1)) break;
+    const auto start = std::chrono::steady_clock::now();
+    computeAll(c,data,r.threads,r.reference);
+    const double rate = n / elapsedSeconds(start);
+    if (base == 0) base = rate;
+    printf("%-14s %2u thread%s %8.2f M samples/s  (x%.1f)\n",r.name,r.threads,
+           (r.threads == 1) ? " " : "s",rate / 1e6,rate / base);
+  }
+}
+
+
+/* Grids one pod's readings and appends samples with all three inputs
+   (converted to C) to the given arrays. */
+static bool loadPodSamples(const PodSource &source, const Options &opt, ComfortData &data,
+                           ParseStats &stats, std::string &error) {
+  PodData pod;
+  pod.stats = ParseStats{};
+  const uint16_t mask = (1U << COL_AIRTEMP) | (1U << COL_GLOBETEMP) | (1U << COL_RH);
+  if (!loadPodData(source.files,opt.utcOffset,mask,pod,error)) return false;
+  stats = pod.stats;
+  const GridSeries ta = resampleSeries(pod.series[COL_AIRTEMP],opt.step,AGG_MEAN,opt.fillLimit);
+  const GridSeries tg = resampleSeries(pod.series[COL_GLOBETEMP],opt.step,AGG_MEAN,opt.fillLimit);
+  const GridSeries rh = resampleSeries(pod.series[COL_RH],opt.step,AGG_MEAN,opt.fillLimit);
+  for (size_t i = 0; i < ta.v.size(); i++) {
+    const int64_t t = ta.start + (int64_t)i * opt.step;
+    const int64_t ig = (t - tg.start) / opt.step, ih = (t - rh.start) / opt.step;
+    if ((t < tg.start) || (ig >= (int64_t)tg.v.size()) || (t < rh.start) || (ih >= (int64_t)rh.v.size())) continue;
+    if (std::isnan(ta.v[i]) || std::isnan(tg.v[ig]) || std::isnan(rh.v[ih])) continue;
+    data.t.push_back(t);
+    data.ta.push_back(toCelsius(ta.v[i]));
+    data.tg.push_back(toCelsius(tg.v[ig]));
+    data.rh.push_back(rh.v[ih]);
+  }
+  return true;
+}
+
+
+static void writeTemperature(CsvWriter &out, const double c, const bool fahrenheit) {
+  out.put(", ");
+  if (!std::isnan(c)) out.putFixed(fahrenheit ? toFahrenheit(c) : c,2);
+}
+
+
+int main(int argc, char **argv) {
+  Options opt;
+  std::vector<PodSource> pods;
+  bool check = false;
+  size_t bench = 0;           // benchmark samples
+  bool ok = true;
+  for (int k = 1; k < argc; k++) {
+    const std::string a = argv[k];
+    const char *v = (k + 1 < argc) ? argv[k+1] : nullptr;
+    if ((a == "-h") || (a == "--help")) {
+      usage();
+      return 0;
+    } else if (a == "--check") {
+      check = true;
+    } else if (a == "--bench") {
+      bench = (v && (v[0] != '-')) ? (size_t)numberArg("--bench",argv[++k]) : 4000000;
+      bench = std::max(bench,(size_t)1);
+    } else if ((a == "-o") && v) {
+      opt.output = argv[++k];
+    } else if (a == "-s") {
+      opt.step = (int64_t)numberArg("-s",v); k++;
+    } else if (a == "-f") {
+      opt.fillLimit = (int64_t)numberArg("-f",v); k++;
+    } else if (a == "-v") {
+      opt.conditions.airSpeed = numberArg("-v",v); k++;
+    } else if (a == "-m") {
+      opt.conditions.met = numberArg("-m",v); k++;
+    } else if (a == "-l") {
+      opt.conditions.clo = numberArg("-l",v); k++;
+    } else if (a == "-d") {
+      opt.conditions.globeDiameter = numberArg("-d",v); k++;
+    } else if (a == "-F") {
+      opt.fahrenheit = true;
+    } else if (a == "-z") {
+      opt.utcOffset = (int64_t)(3600 * numberArg("-z",v)); k++;
+    } else if (a == "-j") {
+      opt.threads = (unsigned)std::max(1.0,numberArg("-j",v)); k++;
+    } else if (a == "-q") {
+      opt.quiet = true;
+    } else if ((a.size() > 1) && (a[0] == '-')) {
+      fprintf(stderr,"podd_comfort: unknown option %s\n",a.c_str());
+      usage();
+      return 2;
+    } else {
+      std::string error;
+      if (!addPodSource(a,pods,error)) {
+        fprintf(stderr,"podd_comfort: %s\n",error.c_str());
+        ok = false;
+      }
+    }
+  }
+  if (check) return selfCheck() ? 0 : 1;
+  if (bench > 0) {
+    benchmark(bench,opt.threads);
+    return 0;
+  }
+  const ComfortConditions &c = opt.conditions;
+  if (pods.empty() || (opt.step <= 0) || (opt.fillLimit < 0) || (c.airSpeed < 0) ||
+      (c.met <= 0) || (c.clo < 0) || (c.globeDiameter <= 0)) {
+    usage();
+    return 2;
+  }
+
+  // Load and grid pods in parallel, then compute all samples in
+  // parallel blocks
+  const auto start = std::chrono::steady_clock::now();
+  std::vector<ComfortData> podData(pods.size());
+  std::vector<ParseStats> stats(pods.size(),ParseStats{});
+  std::vector<std::string> errors(pods.size());
+  parallelFor(pods.size(),opt.threads,[&](size_t p) {
+    loadPodSamples(pods[p],opt,podData[p],stats[p],errors[p]);
+  });
+  std::vector<size_t> offset(pods.size() + 1,0);
+  for (size_t p = 0; p < pods.size(); p++) offset[p+1] = offset[p] + podData[p].t.size();
+  ComfortData data;
+  data.resize(offset.back());
+  for (size_t p = 0; p < pods.size(); p++) {
+    ComfortData &d = podData[p];
+    std::copy(d.t.begin(),d.t.end(),data.t.begin() + offset[p]);
+    std::copy(d.ta.begin(),d.ta.end(),data.ta.begin() + offset[p]);
+    std::copy(d.tg.begin(),d.tg.end(),data.tg.begin() + offset[p]);
+    std::copy(d.rh.begin(),d.rh.end(),data.rh.begin() + offset[p]);
+    d = ComfortData();
+  }
+  const auto computeStart = std::chrono::steady_clock::now();
+  computeAll(c,data,opt.threads,false);
+  const double computeTime = elapsedSeconds(computeStart);
+
+  CsvWriter out;
+  if (!out.open(opt.output)) {
+    fprintf(stderr,"podd_comfort: cannot write %s\n",opt.output.c_str());
+    return 1;
+  }
+  const char *unit = opt.fahrenheit ? "F" : "C";
+  char buff[160];
+  snprintf(buff,sizeof(buff),"Pod, Timestamp, Date/Time (UTC), Air Temp (%s), Globe Temp (%s), RH, "
+           "Mean Radiant Temp (%s), Operative Temp (%s), PMV, PPD (%%)",unit,unit,unit,unit);
+  out.put(buff);
+  out.endLine();
+  size_t unconverged = 0;
+  for (size_t p = 0; p < pods.size(); p++) {
+    for (size_t i = offset[p]; i < offset[p+1]; i++) {
+      out.put(pods[p].name);
+      out.put(", ");
+      out.putInt(data.t[i]);
+      out.put(", ");
+      out.put(formatDateTime(buff,data.t[i]));
+      writeTemperature(out,data.ta[i],opt.fahrenheit);
+      writeTemperature(out,data.tg[i],opt.fahrenheit);
+      out.put(", ");
+      out.putFixed(data.rh[i],1);
+      writeTemperature(out,data.tr[i],opt.fahrenheit);
+      writeTemperature(out,data.to[i],opt.fahrenheit);
+      out.put(", ");
+      if (!std::isnan(data.pmv[i])) {
+        out.putFixed(data.pmv[i],2);
+        out.put(", ");
+        out.putFixed(data.ppd[i],1);
+      } else {
+        out.put(", ");
+        unconverged++;
+      }
+      out.endLine();
+    }
+  }
+  if (!out.close()) {
+    fprintf(stderr,"podd_comfort: error writing %s\n",opt.output.c_str());
+    ok = false;
+  }
+
+  for (size_t p = 0; p < pods.size(); p++) {
+    if (!errors[p].empty()) {
+      fprintf(stderr,"podd_comfort: %s\n",errors[p].c_str());
+      ok = false;
+    }
+  }
+  if (!opt.quiet) {
+    for (size_t p = 0; p < pods.size(); p++) {
+      double sum = 0;
+      size_t count = 0;
+      for (size_t i = offset[p]; i < offset[p+1]; i++) {
+        if (std::isnan(data.pmv[i])) continue;
+        sum += data.pmv[i];
+        count++;
+      }
+      fprintf(stderr,"%-20s %8zu samples, mean PMV %+.2f, %llu bad lines\n",pods[p].name.c_str(),
+              offset[p+1] - offset[p],count ? sum / count : NAN,(unsigned long long)stats[p].badLines);
+    }
+    if (unconverged > 0) fprintf(stderr,"%zu samples without PMV (no convergence)\n",unconverged);
+    fprintf(stderr,"%zu samples in %.2f s (indices %.3f s), %u threads\n",
+            data.t.size(),elapsedSeconds(start),computeTime,opt.threads);
+  }
+  return ok ? 0 : 1;
+}
+
+
+//==============================================================================
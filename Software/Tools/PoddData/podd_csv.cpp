@@ -0,0 +1,480 @@
+/*==============================================================================
+  Parsing of PODD SD card CSV logs (data and settings files).
+
+  This file is part of the LMN PODD distribution:
+    https://github.com/lmnts/PODD
+
+  CONTRIBUTORS:
+    PODD contributors (2026)
+
+  COPYRIGHT/LICENSE:
+  Copyright (c) 2026 LMN Architects
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Affero General Public License as
+  published by the Free Software Foundation, either version 3 of the
+  License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Affero General Public License for more details.
+
+  You should have received a copy of the GNU Affero General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+==============================================================================*/
+
+#include "podd_csv.h"
+
+#include <cmath>
+#include <cstring>
+
+
+// Global variables ============================================================
+
+const char * const COLUMN_NAMES[COL_COUNT] = {
+  "Light", "RH", "Air Temp (F)", "Globe Temp", "Sound (dB)", "CO2 (PPM)",
+  "PM 2.5", "PM 10", "CO_SpecSensor"
+};
+
+const char * const SETTINGS_HEADER =
+  "Timestamp, Date/Time (UTC), Device ID, Project, Location, Coordinator?, "
+  "Network Code, Setup Date, Teardown Date, Upload Rate, Light, RH, "
+  "Globe Temp, Sound, CO2, Particle, CO";
+
+// Times before this (2000-01-01) come from a pod whose RTC was never
+// set and are treated as invalid.
+static const int64_t MIN_VALID_TIME = 946684800;
+
+static const double POW10[] = {
+  1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+  1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+
+// Functions ===================================================================
+
+static inline bool isDigit(const char c) {
+  return (c >= '0') && (c <= '9');
+}
+
+static inline bool isBlank(const char c) {
+  return (c == ' ') || (c == '\t') || (c == '\r');
+}
+
+/* Narrows [b,e) to exclude surrounding whitespace. */
+static inline void trimField(const char *&b, const char *&e) {
+  while ((b < e) && isBlank(*b)) b++;
+  while ((e > b) && isBlank(e[-1])) e--;
+}
+
+/* Indicates if the (trimmed) field [b,e) equals the given text. */
+static bool fieldIs(const char *b, const char *e, const char *text) {
+  const size_t n = strlen(text);
+  return ((size_t)(e - b) == n) && (memcmp(b,text,n) == 0);
+}
+
+/* Parses an unsigned integer from the start of [p,e), advancing p.
+   Returns false if there are no digits or too many of them. */
+static bool parseUInt(const char *&p, const char *e, int64_t &v) {
+  const char *start = p;
+  v = 0;
+  while ((p < e) && isDigit(*p)) {
+    if (p - start >= 12) return false;
+    v = 10*v + (*p - '0');
+    p++;
+  }
+  return p > start;
+}
+
+
+bool parseUnixTime(const char *b, const char *e, int64_t &t) {
+  return parseUInt(b,e,t) && (b == e);
+}
+
+
+bool parseDate(const char *b, const char *e, int64_t &days) {
+  int64_t a, m, d;
+  if (!parseUInt(b,e,a) || (b == e)) return false;
+  const char sep = *b++;
+  if ((sep != '-') && (sep != '/')) return false;
+  if (!parseUInt(b,e,m) || (b == e) || (*b++ != sep)) return false;
+  if (!parseUInt(b,e,d) || (b != e)) return false;
+  int64_t y;
+  if (sep == '-') {
+    // YY-M-D or YYYY-M-D
+    y = (a < 100) ? 2000 + a : a;
+  } else {
+    // M/D/YYYY or M/D/YY
+    y = (d < 100) ? 2000 + d : d;
+    d = m;
+    m = a;
+  }
+  static const uint8_t MONTH_DAYS[12] = {31,29,31,30,31,30,31,31,30,31,30,31};
+  if ((y < 1970) || (y > 2199) || (m < 1) || (m > 12)) return false;
+  if ((d < 1) || (d > MONTH_DAYS[m-1])) return false;
+  if ((m == 2) && (d == 29) && !((y % 4 == 0) && ((y % 100 != 0) || (y % 400 == 0)))) return false;
+  days = daysFromCivil(y,(unsigned)m,(unsigned)d);
+  return true;
+}
+
+
+bool parseTimeOfDay(const char *b, const char *e, int32_t &secs) {
+  int64_t h, m, s;
+  if (!parseUInt(b,e,h) || (b == e) || (*b++ != ':')) return false;
+  if (!parseUInt(b,e,m) || (b == e) || (*b++ != ':')) return false;
+  if (!parseUInt(b,e,s) || (b != e)) return false;
+  if ((h > 23) || (m > 59) || (s > 60)) return false;
+  secs = (int32_t)(3600*h + 60*m + s);
+  return true;
+}
+
+
+bool parseValue(const char *b, const char *e, float &v) {
+  const char *p = b;
+  bool negative = false;
+  if ((p < e) && ((*p == '-') || (*p == '+'))) {
+    negative = (*p == '-');
+    p++;
+  }
+  // Up to 19 significant digits are kept in an integer mantissa;
+  // any further integer digits only scale it.
+  uint64_t mantissa = 0;
+  int digits = 0;
+  int exponent = 0;
+  bool any = false;
+  for (; (p < e) && isDigit(*p); p++) {
+    any = true;
+    if (digits < 19) {
+      mantissa = 10*mantissa + (*p - '0');
+      if (mantissa > 0) digits++;
+    } else {
+      exponent++;
+    }
+  }
+  if ((p < e) && (*p == '.')) {
+    for (p++; (p < e) && isDigit(*p); p++) {
+      any = true;
+      if (digits < 19) {
+        mantissa = 10*mantissa + (*p - '0');
+        if (mantissa > 0) digits++;
+        exponent--;
+      }
+    }
+  }
+  if (!any) return false;
+  if ((p < e) && ((*p == 'e') || (*p == 'E'))) {
+    p++;
+    bool negExp = false;
+    if ((p < e) && ((*p == '-') || (*p == '+'))) {
+      negExp = (*p == '-');
+      p++;
+    }
+    int64_t x;
+    if (!parseUInt(p,e,x) || (x > 400)) return false;
+    exponent += negExp ? -(int)x : (int)x;
+  }
+  if (p != e) return false;
+
+  double d = (double)mantissa;
+  if (exponent < 0) {
+    d = (exponent >= -22) ? d / POW10[-exponent] : d * pow(10.0,exponent);
+  } else if (exponent > 0) {
+    d = (exponent <= 22) ? d * POW10[exponent] : d * pow(10.0,exponent);
+  }
+  v = (float)(negative ? -d : d);
+  return true;
+}
+
+
+int64_t daysFromCivil(int64_t y, unsigned m, unsigned d) {
+  // See H. Hinnant, "chrono-Compatible Low-Level Date Algorithms".
+  y -= (m <= 2);
+  const int64_t era = (y >= 0 ? y : y - 399) / 400;
+  const unsigned yoe = (unsigned)(y - era * 400);
+  const unsigned doy = (153*(m > 2 ? m - 3 : m + 9) + 2)/5 + d - 1;
+  const unsigned doe = yoe * 365 + yoe/4 - yoe/100 + doy;
+  return era * 146097 + (int64_t)doe - 719468;
+}
+
+
+/* Writes a two-digit number and returns the following position. */
+static inline char* put2(char *p, const unsigned v) {
+  p[0] = '0' + v / 10;
+  p[1] = '0' + v % 10;
+  return p + 2;
+}
+
+
+char* formatDateTime(char *buff, int64_t t) {
+  int64_t days = t / 86400;
+  int64_t secs = t % 86400;
+  if (secs < 0) {
+    secs += 86400;
+    days--;
+  }
+  // Inverse of daysFromCivil()
+  const int64_t z = days + 719468;
+  const int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+  const unsigned doe = (unsigned)(z - era * 146097);
+  const unsigned yoe = (doe - doe/1460 + doe/36524 - doe/146096) / 365;
+  const unsigned doy = doe - (365*yoe + yoe/4 - yoe/100);
+  const unsigned mp = (5*doy + 2)/153;
+  const unsigned d = doy - (153*mp + 2)/5 + 1;
+  const unsigned m = mp < 10 ? mp + 3 : mp - 9;
+  const int64_t y = (int64_t)yoe + era * 400 + (m <= 2);
+  // Written digit by digit: this is called for every output row.
+  const unsigned yy = (y < 0) ? 0 : (y > 9999) ? 9999 : (unsigned)y;
+  const unsigned hh = (unsigned)(secs / 3600), mm = (unsigned)((secs / 60) % 60), ss = (unsigned)(secs % 60);
+  char *p = buff;
+  *p++ = '0' + yy / 1000;
+  *p++ = '0' + (yy / 100) % 10;
+  p = put2(p,yy % 100);
+  *p++ = '-';
+  p = put2(p,m);
+  *p++ = '-';
+  p = put2(p,d);
+  *p++ = ' ';
+  p = put2(p,hh);
+  *p++ = ':';
+  p = put2(p,mm);
+  *p++ = ':';
+  p = put2(p,ss);
+  *p = '\0';
+  return buff;
+}
+
+
+LogLayout detectLogFormat(const char *data, size_t len) {
+  LogLayout layout;
+  memset(&layout,0,sizeof(layout));
+  layout.format = FORMAT_UNKNOWN;
+
+  const char *nl = (const char*)memchr(data,'\n',len);
+  const char *end = nl ? nl : data + len;
+  layout.headerLength = nl ? (size_t)(nl - data) + 1 : len;
+  const char *p = data;
+  // UTF-8 byte order mark (from files re-saved by spreadsheets)
+  if ((end - p >= 3) && (memcmp(p,"\xEF\xBB\xBF",3) == 0)) p += 3;
+
+  bool timestamp = false, legacy = false, settings = false, columns = false;
+  uint8_t k = 0;
+  for (;; k++) {
+    const char *fe = (const char*)memchr(p,',',end - p);
+    if (fe == NULL) fe = end;
+    if (k >= LOG_MAX_FIELDS) return layout;
+    const char *b = p, *e = fe;
+    trimField(b,e);
+    if (k == 0) {
+      if (fieldIs(b,e,"Timestamp")) {
+        timestamp = true;
+        layout.role[k] = FIELD_TIMESTAMP;
+      } else if (fieldIs(b,e,"Date")) {
+        legacy = true;
+        layout.role[k] = FIELD_DATE;
+      }
+    } else if ((k == 1) && legacy && fieldIs(b,e,"Time")) {
+      layout.role[k] = FIELD_TIME;
+    } else if (fieldIs(b,e,"Device ID")) {
+      settings = true;
+    } else {
+      for (uint8_t c = 0; c < COL_COUNT; c++) {
+        if (fieldIs(b,e,COLUMN_NAMES[c])) {
+          layout.role[k] = FIELD_COLUMN + c;
+          columns = true;
+          break;
+        }
+      }
+    }
+    if (fe == end) break;
+    p = fe + 1;
+  }
+  layout.fieldCount = k + 1;
+
+  if (legacy && (layout.role[1] != FIELD_TIME)) legacy = false;
+  if (settings) {
+    if (timestamp) layout.format = FORMAT_SETTINGS_UNIX;
+    else if (legacy) layout.format = FORMAT_SETTINGS_LEGACY;
+  } else if (columns) {
+    if (timestamp) layout.format = FORMAT_DATA_UNIX;
+    else if (legacy) layout.format = FORMAT_DATA_LEGACY;
+  }
+  return layout;
+}
+
+
+bool isDataFormat(const LogFormat format) {
+  return (format == FORMAT_DATA_LEGACY) || (format == FORMAT_DATA_UNIX);
+}
+
+bool isSettingsFormat(const LogFormat format) {
+  return (format == FORMAT_SETTINGS_LEGACY) || (format == FORMAT_SETTINGS_UNIX);
+}
+
+const char* formatName(const LogFormat format) {
+  switch (format) {
+    case FORMAT_DATA_LEGACY:     return "data (date/time)";
+    case FORMAT_DATA_UNIX:       return "data (timestamp)";
+    case FORMAT_SETTINGS_LEGACY: return "settings (date/time)";
+    case FORMAT_SETTINGS_UNIX:   return "settings (timestamp)";
+    default:                     return "unknown";
+  }
+}
+
+
+/* Parses the time of a row from its first fields: either a unix
+   timestamp or a legacy local date and time (shifted by utcOffset).
+   Returns false if the time is missing, malformed or unset (see
+   MIN_VALID_TIME). */
+static bool parseRowTime(const LogLayout &layout, const char *b0, const char *e0,
+                         const char *b1, const char *e1, int64_t utcOffset, int64_t &t) {
+  if (layout.role[0] == FIELD_TIMESTAMP) {
+    if (!parseUnixTime(b0,e0,t)) return false;
+  } else {
+    int64_t days;
+    int32_t secs;
+    if (!parseDate(b0,e0,days) || !parseTimeOfDay(b1,e1,secs)) return false;
+    t = 86400*days + secs - utcOffset;
+  }
+  return t >= MIN_VALID_TIME;
+}
+
+
+/* Parses a single data line [line,end) (without its newline). */
+static void parseDataLine(const LogLayout &layout, const char *line, const char *end,
+                          int64_t utcOffset, std::vector<Sample> &out, ParseStats &stats) {
+  const char *b0 = line, *e0 = end;
+  trimField(b0,e0);
+  if (b0 == e0) return;
+  stats.lines++;
+  // Repeated header (e.g. files concatenated by hand)
+  if (((*b0 >= 'A') && (*b0 <= 'Z')) || ((*b0 >= 'a') && (*b0 <= 'z'))) return;
+
+  const char *fb[2] = {NULL, NULL}, *fe[2] = {NULL, NULL};
+  float values[COL_COUNT];
+  uint8_t columns[COL_COUNT];
+  uint8_t n = 0;
+  uint8_t k = 0;
+  const char *p = line;
+  for (;; k++) {
+    const char *sep = (const char*)memchr(p,',',end - p);
+    const char *e = sep ? sep : end;
+    if (k >= layout.fieldCount) {
+      stats.badLines++;
+      return;
+    }
+    const char *b = p;
+    trimField(b,e);
+    if (k < 2) {
+      fb[k] = b;
+      fe[k] = e;
+    }
+    const uint8_t role = layout.role[k];
+    if ((role >= FIELD_COLUMN) && (b < e)) {
+      float v;
+      if (parseValue(b,e,v)) {
+        values[n] = v;
+        columns[n] = role - FIELD_COLUMN;
+        n++;
+      }
+    }
+    if (sep == NULL) break;
+    p = sep + 1;
+  }
+  // Lines cut short (e.g. by power loss while writing) have fewer
+  // fields; their last value may be truncated, so the line is dropped.
+  int64_t t;
+  if ((k + 1 != layout.fieldCount) || (fb[1] == NULL)
+      || !parseRowTime(layout,fb[0],fe[0],fb[1],fe[1],utcOffset,t)) {
+    stats.badLines++;
+    return;
+  }
+  stats.rows++;
+  stats.samples += n;
+  for (uint8_t j = 0; j < n; j++) {
+    out.push_back(Sample{t,values[j],columns[j]});
+  }
+}
+
+
+void parseDataRows(const LogLayout &layout, const char *data, size_t len,
+                   size_t begin, size_t end, int64_t utcOffset,
+                   std::vector<Sample> &out, ParseStats &stats) {
+  if (end > len) end = len;
+  if (begin >= end) return;
+  stats.bytes += end - begin;
+  size_t pos = begin;
+  if (pos < layout.headerLength) {
+    pos = layout.headerLength;
+  } else if (data[pos-1] != '\n') {
+    // Line belongs to the previous chunk
+    const char *nl = (const char*)memchr(data + pos,'\n',len - pos);
+    if (nl == NULL) return;
+    pos = (size_t)(nl - data) + 1;
+  }
+  while (pos < end) {
+    const char *line = data + pos;
+    const char *nl = (const char*)memchr(line,'\n',len - pos);
+    const char *lineEnd = nl ? nl : data + len;
+    parseDataLine(layout,line,lineEnd,utcOffset,out,stats);
+    pos = (size_t)(lineEnd - data) + 1;
+  }
+}
+
+
+void parseSettingsRows(const LogLayout &layout, const char *data, size_t len,
+                       int64_t utcOffset, std::vector<std::string> &out,
+                       ParseStats &stats) {
+  stats.bytes += len;
+  size_t pos = layout.headerLength;
+  while (pos < len) {
+    const char *line = data + pos;
+    const char *nl = (const char*)memchr(line,'\n',len - pos);
+    const char *end = nl ? nl : data + len;
+    pos = (size_t)(end - data) + 1;
+
+    const char *b = line, *e = end;
+    trimField(b,e);
+    if (b == e) continue;
+    stats.lines++;
+    if (!isDigit(*b)) continue;
+
+    // Time from the first two fields; everything after is kept.
+    const char *fb[2], *fe[2];
+    const char *p = line;
+    bool ok = true;
+    for (int k = 0; k < 2; k++) {
+      const char *sep = (const char*)memchr(p,',',end - p);
+      if (sep == NULL) {
+        ok = false;
+        break;
+      }
+      fb[k] = p;
+      fe[k] = sep;
+      trimField(fb[k],fe[k]);
+      p = sep + 1;
+    }
+    int64_t t;
+    if (!ok || !parseRowTime(layout,fb[0],fe[0],fb[1],fe[1],utcOffset,t)) {
+      stats.badLines++;
+      continue;
+    }
+    char buff[DATETIME_LEN];
+    std::string row = std::to_string(t) + ", " + formatDateTime(buff,t);
+    for (;;) {
+      const char *sep = (const char*)memchr(p,',',end - p);
+      const char *fb2 = p, *fe2 = sep ? sep : end;
+      trimField(fb2,fe2);
+      row += ", ";
+      row.append(fb2,fe2 - fb2);
+      if (sep == NULL) break;
+      p = sep + 1;
+    }
+    out.push_back(row);
+    stats.rows++;
+  }
+}
+
+
+//==============================================================================
@@ -0,0 +1,149 @@
+/*==============================================================================
+  Parsing of PODD SD card CSV logs (data and settings files).
+
+  This file is part of the LMN PODD distribution:
+    https://github.com/lmnts/PODD
+
+  CONTRIBUTORS:
+    PODD contributors (2026)
+
+  COPYRIGHT/LICENSE:
+  Copyright (c) 2026 LMN Architects
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Affero General Public License as
+  published by the Free Software Foundation, either version 3 of the
+  License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Affero General Public License for more details.
+
+  You should have received a copy of the GNU Affero General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+==============================================================================*/
+
+#pragma once
+
+// Standard libraries
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+
+// Constants/global variables ==================================================
+
+// Sensor data columns, in the order the firmware writes them (same as
+// ReadingType in the firmware's pod_network.h).
+enum SensorColumn : uint8_t {
+  COL_LIGHT, COL_RH, COL_AIRTEMP, COL_GLOBETEMP, COL_SOUND, COL_CO2,
+  COL_PM2_5, COL_PM10, COL_CO,
+  COL_COUNT
+};
+
+// Column headers as written by the firmware.
+extern const char * const COLUMN_NAMES[COL_COUNT];
+
+// Log file layouts.  The firmware has written two generations of each
+// file: older ones start with a local "Date, Time" pair (dates as
+// YY-M-D or M/D/YYYY, times as H:M:S), newer ones with a unix
+// "Timestamp" followed by a local "Date/Time" string.  Newer data files
+// may also end with "Interval (s)" and "Quality" columns.
+enum LogFormat : uint8_t {
+  FORMAT_UNKNOWN,
+  FORMAT_DATA_LEGACY,       // Date, Time, Light, RH, ...
+  FORMAT_DATA_UNIX,         // Timestamp, Date/Time, Light, RH, ...
+  FORMAT_SETTINGS_LEGACY,   // Date, Time, Device ID, Project, ... (PODSET.CSV)
+  FORMAT_SETTINGS_UNIX      // Timestamp, Date/Time, Device ID, ...
+};
+
+// Maximum number of fields per line handled by the scanner.
+#define LOG_MAX_FIELDS 32
+
+// Meaning of each field in a line, determined from the file's header.
+enum FieldRole : uint8_t {
+  FIELD_IGNORED,
+  FIELD_TIMESTAMP,          // unix time [s]
+  FIELD_DATE,               // legacy local date
+  FIELD_TIME,               // legacy local time of day
+  FIELD_COLUMN              // FIELD_COLUMN + k: sensor column k
+};
+
+struct LogLayout {
+  LogFormat format;
+  uint8_t fieldCount;       // fields in the header (and every valid row)
+  uint8_t role[LOG_MAX_FIELDS];
+  size_t headerLength;      // bytes up to and including the header's newline
+};
+
+// A single sensor reading.  Times are unix times [s]; for legacy files
+// they are local times shifted by the caller's UTC offset.
+struct Sample {
+  int64_t t;
+  float value;
+  uint8_t column;           // SensorColumn
+};
+
+// Line counts from parsing.
+struct ParseStats {
+  uint64_t bytes;
+  uint64_t lines;           // non-empty lines, including headers
+  uint64_t rows;            // lines with a valid time
+  uint64_t samples;
+  uint64_t badLines;        // unparseable time, wrong field count, etc.
+};
+
+
+// Functions ===================================================================
+
+// Determines the layout of a log file from its first line.  Unknown or
+// diagnostic files (PODMEM.CSV, PODSTATS.CSV, ...) give FORMAT_UNKNOWN.
+LogLayout detectLogFormat(const char *data, size_t len);
+// Indicates if the format is a sensor data or settings layout.
+bool isDataFormat(const LogFormat format);
+bool isSettingsFormat(const LogFormat format);
+const char* formatName(const LogFormat format);
+
+// Parses the data rows in [begin,end) of a file with the given layout,
+// appending one sample per populated sensor field.  Only lines that
+// start within the range are parsed (the line containing 'begin' is
+// skipped unless 'begin' is the start of a line), so a file can be
+// split into arbitrary chunks that are parsed independently.  Lines
+// are scanned in place; nothing is allocated apart from the output
+// vector's growth.  utcOffset [s] is subtracted from legacy local times.
+void parseDataRows(const LogLayout &layout, const char *data, size_t len,
+                   size_t begin, size_t end, int64_t utcOffset,
+                   std::vector<Sample> &out, ParseStats &stats);
+
+// Parses the settings rows of a PODSET file, converting the leading
+// time field(s) to "unix time, YYYY-MM-DD hh:mm:ss" (UTC) and keeping
+// the remaining fields as-is (trimmed, comma-separated).
+void parseSettingsRows(const LogLayout &layout, const char *data, size_t len,
+                       int64_t utcOffset, std::vector<std::string> &out,
+                       ParseStats &stats);
+// Header for the settings rows above.
+extern const char * const SETTINGS_HEADER;
+
+// Field parsers for the range [b,e) (already trimmed).  Return false
+// if the field is empty or malformed.
+bool parseUnixTime(const char *b, const char *e, int64_t &t);
+// Dates as YY-M-D, YYYY-M-D or M/D/YYYY (M/D/YY); days since 1970-01-01.
+bool parseDate(const char *b, const char *e, int64_t &days);
+// Times of day as H:M:S [s].
+bool parseTimeOfDay(const char *b, const char *e, int32_t &secs);
+// Decimal values with optional sign, fraction and exponent ("nan",
+// which the firmware writes for invalid readings, is rejected).
+bool parseValue(const char *b, const char *e, float &v);
+
+// Days since 1970-01-01 for the given (proleptic Gregorian) date.
+int64_t daysFromCivil(int64_t y, unsigned m, unsigned d);
+// Buffer size (including terminating null) for formatDateTime().
+#define DATETIME_LEN 20
+// Formats a unix time as "YYYY-MM-DD hh:mm:ss" and returns the buffer.
+char* formatDateTime(char *buff, int64_t t);
+
+
+//==============================================================================
@@ -0,0 +1,434 @@
+/*==============================================================================
+  podd_ingest: converts PODD SD card logs into dense per-pod tables.
+
+  This file is part of the LMN PODD distribution:
+    https://github.com/lmnts/PODD
+
+  CONTRIBUTORS:
+    PODD contributors (2026)
+
+  COPYRIGHT/LICENSE:
+  Copyright (c) 2026 LMN Architects
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Affero General Public License as
+  published by the Free Software Foundation, either version 3 of the
+  License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Affero General Public License for more details.
+
+  You should have received a copy of the GNU Affero General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+==============================================================================*/
+
+// Usage: podd_ingest [options] SOURCE...
+// See addPodSource() for the sources and README.md for the output.
+
+#include "csv_writer.h"
+#include "mapped_file.h"
+#include "parallel.h"
+#include "podd_csv.h"
+#include "podd_sources.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+
+// Constants/global variables ==================================================
+
+// Files larger than this are split into chunks parsed in parallel.
+#ifndef CHUNK_SIZE
+#define CHUNK_SIZE (32UL << 20)
+#endif
+
+struct Options {
+  std::string outDir = ".";
+  int64_t step = 60;          // output grid step [s] (0: every reading time)
+  int64_t maxAge = 3600;      // forward-fill limit [s] (0: no limit)
+  int64_t utcOffset = 0;      // legacy local time - UTC [s]
+  unsigned threads = defaultThreadCount();
+  bool quiet = false;
+};
+
+struct Pod {
+  std::string name;
+  std::vector<std::string> files;
+  // Merged results
+  std::vector<Sample> samples;
+  std::vector<std::string> settings;
+  ParseStats stats = {};
+  size_t legacyFiles = 0;
+  size_t skippedFiles = 0;
+};
+
+// A whole file, or one chunk of a large file.
+struct Job {
+  size_t pod;
+  size_t file;                // index into the pod's files
+  size_t begin, end;          // byte range
+  LogFormat format = FORMAT_UNKNOWN;
+  std::vector<Sample> samples;
+  std::vector<std::string> settings;
+  ParseStats stats = {};
+  std::string error;
+};
+
+
+// Functions ===================================================================
+
+static void usage() {
+  fprintf(stderr,
+    "Usage: podd_ingest [options] SOURCE...\n"
+    "Converts PODD SD card logs into one dense, time-aligned CSV table per pod.\n"
+    "SOURCE is a log file, a directory searched for *.CSV files, or NAME=PATH.\n"
+    "\n"
+    "Options:\n"
+    "  -o DIR       output directory (default: current directory)\n"
+    "  -s SECONDS   output time step; 0 for a row at every reading time (default: 60)\n"
+    "  -a SECONDS   longest time a reading is carried forward; 0 for no limit\n"
+    "               (default: 3600)\n"
+    "  -z HOURS     UTC offset of the local times in older (Date, Time) files,\n"
+    "               e.g. -8 for PST (default: 0, i.e. times are kept as-is)\n"
+    "  -j THREADS   worker threads (default: number of cores)\n"
+    "  -q           only report errors\n");
+}
+
+
+/* Parses a numeric option argument; exits on error. */
+static double numberArg(const char *opt, const char *arg) {
+  char *end;
+  const double v = arg ? strtod(arg,&end) : 0;
+  if ((arg == nullptr) || (end == arg) || (*end != '\0')) {
+    fprintf(stderr,"podd_ingest: option %s needs a number\n",opt);
+    exit(2);
+  }
+  return v;
+}
+
+
+/* Maps and parses the file range of the given job. */
+static void runJob(Job &job, const std::vector<Pod> &pods, const Options &opt) {
+  const std::string &path = pods[job.pod].files[job.file];
+  MappedFile file;
+  if (!file.open(path)) {
+    job.error = file.error();
+    return;
+  }
+  const LogLayout layout = detectLogFormat(file.data(),file.size());
+  job.format = layout.format;
+  if (isDataFormat(layout.format)) {
+    // Rows average ~50 bytes with a single reading each
+    job.samples.reserve((job.end - job.begin) / 48);
+    parseDataRows(layout,file.data(),file.size(),job.begin,job.end,
+                  opt.utcOffset,job.samples,job.stats);
+  } else if (isSettingsFormat(layout.format) && (job.begin == 0)) {
+    parseSettingsRows(layout,file.data(),file.size(),opt.utcOffset,job.settings,job.stats);
+  }
+}
+
+
+/* Sorts the pod's samples by time and removes duplicates (the same
+   column at the same time, e.g. from overlapping copies of a file),
+   keeping the one from the last file. */
+static void mergeSamples(std::vector<Sample> &s) {
+  auto before = [](const Sample &a, const Sample &b) {
+    return (a.t < b.t) || ((a.t == b.t) && (a.column < b.column));
+  };
+  if (!std::is_sorted(s.begin(),s.end(),before)) {
+    std::stable_sort(s.begin(),s.end(),before);
+  }
+  size_t n = 0;
+  for (size_t k = 0; k < s.size(); k++) {
+    if ((n > 0) && (s[n-1].t == s[k].t) && (s[n-1].column == s[k].column)) {
+      s[n-1] = s[k];
+    } else {
+      s[n++] = s[k];
+    }
+  }
+  s.resize(n);
+}
+
+
+static void writeHeader(CsvWriter &out) {
+  out.put("Timestamp, Date/Time (UTC)");
+  for (uint8_t c = 0; c < COL_COUNT; c++) {
+    out.put(", ");
+    out.put(COLUMN_NAMES[c]);
+  }
+  out.endLine();
+}
+
+
+/* Writes the pod's (time-sorted) samples as a dense table: one row per
+   grid time (multiples of step) holding the latest reading of each
+   column at or before that time, if no older than maxAge.  Rows with
+   no current readings (e.g. while the pod was off) are omitted.  With
+   a step of 0, rows are written at every reading time instead.
+   Returns the number of rows written. */
+static uint64_t writeDenseTable(CsvWriter &out, const std::vector<Sample> &s,
+                                const int64_t step, const int64_t maxAge) {
+  writeHeader(out);
+  if (s.empty()) return 0;
+  float last[COL_COUNT];
+  int64_t lastT[COL_COUNT];
+  bool have[COL_COUNT] = {};
+  uint64_t rows = 0;
+  char buff[DATETIME_LEN];
+  const int64_t age = (maxAge > 0) ? maxAge : INT64_MAX;
+
+  auto ceilStep = [step](int64_t t) {
+    const int64_t q = (t >= 0) ? (t + step - 1) / step : t / step;
+    return q * step;
+  };
+  size_t i = 0;
+  int64_t t = (step > 0) ? ceilStep(s[0].t) : s[0].t;
+  while (true) {
+    for (; (i < s.size()) && (s[i].t <= t); i++) {
+      last[s[i].column] = s[i].value;
+      lastT[s[i].column] = s[i].t;
+      have[s[i].column] = true;
+    }
+    bool current = false;
+    for (uint8_t c = 0; c < COL_COUNT; c++) {
+      if (have[c] && (t - lastT[c] > age)) have[c] = false;
+      current = current || have[c];
+    }
+    if (current) {
+      out.putInt(t);
+      out.put(", ");
+      out.put(formatDateTime(buff,t));
+      for (uint8_t c = 0; c < COL_COUNT; c++) {
+        out.put(", ");
+        if (have[c]) out.putFloat(last[c]);
+      }
+      out.endLine();
+      rows++;
+    }
+    if (i >= s.size()) {
+      // Carry the final readings forward until they expire
+      if ((step == 0) || !current) break;
+      t += step;
+      continue;
+    }
+    if (step == 0) {
+      t = s[i].t;
+    } else if (!current) {
+      // Skip over gaps with nothing to report
+      t = std::max(t + step,ceilStep(s[i].t));
+    } else {
+      t += step;
+    }
+  }
+  return rows;
+}
+
+
+static double elapsedSeconds(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+
+int main(int argc, char **argv) {
+  Options opt;
+  std::vector<PodSource> sources;
+  bool ok = true;
+  for (int k = 1; k < argc; k++) {
+    const std::string a = argv[k];
+    const char *next = (k + 1 < argc) ? argv[k+1] : nullptr;
+    if ((a == "-h") || (a == "--help")) {
+      usage();
+      return 0;
+    } else if (a == "-o") {
+      if (next == nullptr) {
+        usage();
+        return 2;
+      }
+      opt.outDir = next;
+      k++;
+    } else if (a == "-s") {
+      opt.step = (int64_t)numberArg("-s",next);
+      k++;
+    } else if (a == "-a") {
+      opt.maxAge = (int64_t)numberArg("-a",next);
+      k++;
+    } else if (a == "-z") {
+      opt.utcOffset = (int64_t)(3600 * numberArg("-z",next));
+      k++;
+    } else if (a == "-j") {
+      opt.threads = (unsigned)std::max(1.0,numberArg("-j",next));
+      k++;
+    } else if (a == "-q") {
+      opt.quiet = true;
+    } else if ((a.size() > 1) && (a[0] == '-')) {
+      fprintf(stderr,"podd_ingest: unknown option %s\n",a.c_str());
+      usage();
+      return 2;
+    } else {
+      std::string error;
+      if (!addPodSource(a,sources,error)) {
+        fprintf(stderr,"podd_ingest: %s\n",error.c_str());
+        ok = false;
+      }
+    }
+  }
+  if (sources.empty() || (opt.step < 0) || (opt.maxAge < 0)) {
+    usage();
+    return 2;
+  }
+  std::vector<Pod> pods(sources.size());
+  for (size_t p = 0; p < sources.size(); p++) {
+    pods[p].name = sources[p].name;
+    pods[p].files.swap(sources[p].files);
+  }
+  std::error_code ec;
+  fs::create_directories(opt.outDir,ec);
+
+  // Split the files into jobs, largest first so big files do not
+  // finish last on a single thread.
+  const auto start = std::chrono::steady_clock::now();
+  std::vector<Job> jobs;
+  for (size_t p = 0; p < pods.size(); p++) {
+    for (size_t f = 0; f < pods[p].files.size(); f++) {
+      const size_t size = (size_t)fs::file_size(pods[p].files[f],ec);
+      const size_t chunks = std::max<size_t>(1,(size + CHUNK_SIZE - 1) / CHUNK_SIZE);
+      for (size_t c = 0; c < chunks; c++) {
+        Job job;
+        job.pod = p;
+        job.file = f;
+        job.begin = size * c / chunks;
+        job.end = size * (c + 1) / chunks;
+        jobs.push_back(std::move(job));
+      }
+    }
+  }
+  std::vector<size_t> order(jobs.size());
+  for (size_t k = 0; k < order.size(); k++) order[k] = k;
+  std::stable_sort(order.begin(),order.end(),[&jobs](size_t a, size_t b) {
+    return jobs[a].end - jobs[a].begin > jobs[b].end - jobs[b].begin;
+  });
+  parallelFor(jobs.size(),opt.threads,[&](size_t k) {
+    runJob(jobs[order[k]],pods,opt);
+  });
+
+  // Collect each pod's results in file/chunk order, then merge and
+  // write the pods in parallel.
+  for (Job &job : jobs) {
+    Pod &pod = pods[job.pod];
+    if (!job.error.empty()) {
+      fprintf(stderr,"podd_ingest: %s\n",job.error.c_str());
+      ok = false;
+      continue;
+    }
+    if (job.begin == 0) {
+      if (job.format == FORMAT_UNKNOWN) {
+        pod.skippedFiles++;
+        if (!opt.quiet) {
+          fprintf(stderr,"Skipping %s (not a data or settings log)\n",pod.files[job.file].c_str());
+        }
+      }
+      if ((job.format == FORMAT_DATA_LEGACY) || (job.format == FORMAT_SETTINGS_LEGACY)) {
+        pod.legacyFiles++;
+      }
+    }
+    pod.stats.bytes += job.stats.bytes;
+    pod.stats.lines += job.stats.lines;
+    pod.stats.rows += job.stats.rows;
+    pod.stats.samples += job.stats.samples;
+    pod.stats.badLines += job.stats.badLines;
+    if (pod.samples.empty()) {
+      pod.samples.swap(job.samples);
+    } else {
+      pod.samples.insert(pod.samples.end(),job.samples.begin(),job.samples.end());
+    }
+    std::vector<Sample>().swap(job.samples);
+    pod.settings.insert(pod.settings.end(),job.settings.begin(),job.settings.end());
+  }
+  const double parseTime = elapsedSeconds(start);
+
+  std::vector<uint64_t> rowsOut(pods.size(),0);
+  std::vector<char> written(pods.size(),1);
+  parallelFor(pods.size(),opt.threads,[&](size_t p) {
+    Pod &pod = pods[p];
+    mergeSamples(pod.samples);
+    std::sort(pod.settings.begin(),pod.settings.end(),[](const std::string &a, const std::string &b) {
+      return strtoll(a.c_str(),nullptr,10) < strtoll(b.c_str(),nullptr,10);
+    });
+    CsvWriter out;
+    if (!pod.samples.empty()) {
+      const std::string path = (fs::path(opt.outDir) / (pod.name + ".csv")).string();
+      if (!out.open(path)) {
+        written[p] = 0;
+        return;
+      }
+      rowsOut[p] = writeDenseTable(out,pod.samples,opt.step,opt.maxAge);
+      if (!out.close()) written[p] = 0;
+    }
+    if (!pod.settings.empty()) {
+      const std::string path = (fs::path(opt.outDir) / (pod.name + "_settings.csv")).string();
+      if (!out.open(path)) {
+        written[p] = 0;
+        return;
+      }
+      out.put(SETTINGS_HEADER);
+      out.endLine();
+      for (const std::string &row : pod.settings) {
+        out.put(row);
+        out.endLine();
+      }
+      if (!out.close()) written[p] = 0;
+    }
+  });
+  const double totalTime = elapsedSeconds(start);
+
+  // Summary
+  uint64_t bytes = 0, files = 0;
+  bool legacy = false;
+  if (!opt.quiet) {
+    fprintf(stderr,"%-20s %6s %10s %10s %8s %10s  %-19s  %-19s\n",
+            "Pod","Files","Rows","Samples","Bad","Out rows","First (UTC)","Last (UTC)");
+  }
+  for (size_t p = 0; p < pods.size(); p++) {
+    const Pod &pod = pods[p];
+    bytes += pod.stats.bytes;
+    files += pod.files.size();
+    legacy = legacy || (pod.legacyFiles > 0);
+    if (!written[p]) {
+      fprintf(stderr,"podd_ingest: could not write output for %s\n",pod.name.c_str());
+      ok = false;
+    }
+    if (opt.quiet) continue;
+    char first[DATETIME_LEN] = "", last[DATETIME_LEN] = "";
+    if (!pod.samples.empty()) {
+      formatDateTime(first,pod.samples.front().t);
+      formatDateTime(last,pod.samples.back().t);
+    }
+    fprintf(stderr,"%-20s %6zu %10llu %10zu %8llu %10llu  %-19s  %-19s\n",
+            pod.name.c_str(),pod.files.size() - pod.skippedFiles,
+            (unsigned long long)pod.stats.rows,pod.samples.size(),
+            (unsigned long long)pod.stats.badLines,(unsigned long long)rowsOut[p],
+            first,last);
+  }
+  if (!opt.quiet) {
+    fprintf(stderr,"%llu files, %.1f MB parsed in %.2f s (%.0f MB/s), %.2f s total, %u threads\n",
+            (unsigned long long)files,bytes / 1e6,parseTime,
+            (parseTime > 0) ? bytes / 1e6 / parseTime : 0.0,totalTime,opt.threads);
+    if (legacy && (opt.utcOffset == 0)) {
+      fprintf(stderr,"Note: older logs only have local times; use -z to convert them to UTC.\n");
+    }
+  }
+  return ok ? 0 : 1;
+}
+
+
+//==============================================================================
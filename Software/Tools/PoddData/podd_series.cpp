@@ -0,0 +1,219 @@
+/*==============================================================================
+  Per-sensor time series: loading, resampling and as-of lookups.
+
+  This file is part of the LMN PODD distribution:
+    https://github.com/lmnts/PODD
+
+  CONTRIBUTORS:
+    PODD contributors (2026)
+
+  COPYRIGHT/LICENSE:
+  Copyright (c) 2026 LMN Architects
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Affero General Public License as
+  published by the Free Software Foundation, either version 3 of the
+  License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Affero General Public License for more details.
+
+  You should have received a copy of the GNU Affero General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+==============================================================================*/
+
+#include "podd_series.h"
+#include "mapped_file.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+
+// Global variables ============================================================
+
+const char * const COLUMN_KEYS[COL_COUNT] = {
+  "light", "rh", "airtemp", "globetemp", "sound", "co2", "pm2.5", "pm10", "co"
+};
+
+static const char * const AGGREGATION_NAMES[AGGREGATION_COUNT] = {
+  "mean", "last", "min", "max", "count"
+};
+
+
+// Functions ===================================================================
+
+/* Case-insensitive string comparison. */
+static bool equalsIgnoreCase(const std::string &a, const char *b) {
+  size_t k = 0;
+  for (; (k < a.size()) && (b[k] != '\0'); k++) {
+    if (tolower((unsigned char)a[k]) != tolower((unsigned char)b[k])) return false;
+  }
+  return (k == a.size()) && (b[k] == '\0');
+}
+
+
+bool parseAggregation(const std::string &s, Aggregation &agg) {
+  for (uint8_t k = 0; k < AGGREGATION_COUNT; k++) {
+    if (equalsIgnoreCase(s,AGGREGATION_NAMES[k])) {
+      agg = (Aggregation)k;
+      return true;
+    }
+  }
+  return false;
+}
+
+const char* aggregationName(const Aggregation agg) {
+  return (agg < AGGREGATION_COUNT) ? AGGREGATION_NAMES[agg] : "?";
+}
+
+SensorColumn parseColumn(const std::string &s) {
+  for (uint8_t c = 0; c < COL_COUNT; c++) {
+    if (equalsIgnoreCase(s,COLUMN_KEYS[c]) || equalsIgnoreCase(s,COLUMN_NAMES[c])) {
+      return (SensorColumn)c;
+    }
+  }
+  return COL_COUNT;
+}
+
+
+bool loadPodData(const std::vector<std::string> &files, const int64_t utcOffset,
+                 const uint16_t columnMask, PodData &pod, std::string &error) {
+  // Readings are gathered per column as (time, value) pairs so they can
+  // be sorted together, then split into the series' separate arrays.
+  std::vector<std::pair<int64_t,float>> columns[COL_COUNT];
+  std::vector<Sample> samples;
+  for (const std::string &path : files) {
+    MappedFile file;
+    if (!file.open(path)) {
+      error = file.error();
+      return false;
+    }
+    const LogLayout layout = detectLogFormat(file.data(),file.size());
+    if (!isDataFormat(layout.format)) continue;
+    samples.clear();
+    parseDataRows(layout,file.data(),file.size(),0,file.size(),utcOffset,samples,pod.stats);
+    for (const Sample &s : samples) {
+      if (columnMask & (1U << s.column)) columns[s.column].emplace_back(s.t,s.value);
+    }
+  }
+  std::vector<Sample>().swap(samples);
+
+  for (uint8_t c = 0; c < COL_COUNT; c++) {
+    auto &col = columns[c];
+    auto before = [](const std::pair<int64_t,float> &a, const std::pair<int64_t,float> &b) {
+      return a.first < b.first;
+    };
+    if (!std::is_sorted(col.begin(),col.end(),before)) {
+      std::stable_sort(col.begin(),col.end(),before);
+    }
+    // One reading per time: keep the one from the last file
+    Series &s = pod.series[c];
+    s.t.clear();
+    s.v.clear();
+    s.t.reserve(col.size());
+    s.v.reserve(col.size());
+    for (const auto &r : col) {
+      if (!s.t.empty() && (s.t.back() == r.first)) {
+        s.v.back() = r.second;
+      } else {
+        s.t.push_back(r.first);
+        s.v.push_back(r.second);
+      }
+    }
+    std::vector<std::pair<int64_t,float>>().swap(col);
+  }
+  return true;
+}
+
+
+void correctClock(PodData &pod, const ClockCorrection &c) {
+  if ((c.offset == 0) && (c.ppm == 0)) return;
+  int64_t t0 = INT64_MAX;
+  for (const Series &s : pod.series) {
+    if (!s.t.empty()) t0 = std::min(t0,s.t.front());
+  }
+  for (Series &s : pod.series) {
+    for (int64_t &t : s.t) {
+      t -= llround(c.offset + 1e-6 * c.ppm * (double)(t - t0));
+    }
+  }
+}
+
+
+/* Start of the grid interval containing t. */
+static inline int64_t floorStep(const int64_t t, const int64_t step) {
+  const int64_t q = t / step;
+  return ((t % step < 0) ? q - 1 : q) * step;
+}
+
+
+GridSeries resampleSeries(const Series &s, const int64_t step, const Aggregation agg,
+                          const int64_t fillLimit) {
+  GridSeries g = {0, {}};
+  const size_t n = s.t.size();
+  if ((n == 0) || (step <= 0)) return g;
+  g.start = floorStep(s.t.front(),step);
+  const size_t bins = (size_t)((floorStep(s.t.back(),step) - g.start) / step) + 1;
+  g.v.assign(bins,NAN);
+
+  size_t i = 0;
+  size_t prevBin = 0;
+  while (i < n) {
+    const size_t bin = (size_t)((s.t[i] - g.start) / step);
+    // Carry the previous reading into empty intervals
+    if ((fillLimit > 0) && (i > 0) && (agg != AGG_SAMPLES)) {
+      for (size_t k = prevBin + 1; k < bin; k++) {
+        if (g.start + (int64_t)k * step - s.t[i-1] > fillLimit) break;
+        g.v[k] = s.v[i-1];
+      }
+    }
+    double sum = 0;
+    float lo = s.v[i], hi = s.v[i];
+    size_t count = 0;
+    const int64_t binEnd = g.start + (int64_t)(bin + 1) * step;
+    for (; (i < n) && (s.t[i] < binEnd); i++) {
+      sum += s.v[i];
+      lo = std::min(lo,s.v[i]);
+      hi = std::max(hi,s.v[i]);
+      count++;
+    }
+    switch (agg) {
+      case AGG_MEAN:    g.v[bin] = (float)(sum / count); break;
+      case AGG_LAST:    g.v[bin] = s.v[i-1]; break;
+      case AGG_MIN:     g.v[bin] = lo; break;
+      case AGG_MAX:     g.v[bin] = hi; break;
+      case AGG_SAMPLES: g.v[bin] = (float)count; break;
+      default:          break;
+    }
+    prevBin = bin;
+  }
+  return g;
+}
+
+
+bool AsOfCursor::lookup(const int64_t t, float &v) {
+  const size_t n = _s.t.size();
+  while ((_next < n) && (_s.t[_next] <= t)) _next++;
+  bool found = false;
+  int64_t best = 0;
+  if ((_next > 0) && (t - _s.t[_next-1] <= _tolerance)) {
+    v = _s.v[_next-1];
+    best = t - _s.t[_next-1];
+    found = true;
+  }
+  if (_nearest && (_next < n)) {
+    const int64_t d = _s.t[_next] - t;
+    if ((d <= _tolerance) && (!found || (d < best))) {
+      v = _s.v[_next];
+      found = true;
+    }
+  }
+  return found;
+}
+
+
+//==============================================================================
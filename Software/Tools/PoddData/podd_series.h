@@ -0,0 +1,126 @@
+/*==============================================================================
+  Per-sensor time series: loading, resampling and as-of lookups.
+
+  This file is part of the LMN PODD distribution:
+    https://github.com/lmnts/PODD
+
+  CONTRIBUTORS:
+    PODD contributors (2026)
+
+  COPYRIGHT/LICENSE:
+  Copyright (c) 2026 LMN Architects
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Affero General Public License as
+  published by the Free Software Foundation, either version 3 of the
+  License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Affero General Public License for more details.
+
+  You should have received a copy of the GNU Affero General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+==============================================================================*/
+
+#pragma once
+
+// Standard libraries
+#include <cstdint>
+#include <string>
+#include <vector>
+// Local headers
+#include "podd_csv.h"
+
+
+// Constants/global variables ==================================================
+
+// How the readings within each resampling interval are combined.
+enum Aggregation : uint8_t {
+  AGG_MEAN,
+  AGG_LAST,
+  AGG_MIN,
+  AGG_MAX,
+  AGG_SAMPLES,              // number of readings
+  AGGREGATION_COUNT
+};
+
+// Short column names for command-line use (light, rh, airtemp, ...).
+extern const char * const COLUMN_KEYS[COL_COUNT];
+
+// Readings of one sensor column, sorted by time, one per time.  Kept
+// as separate time and value arrays (12 bytes per reading).
+struct Series {
+  std::vector<int64_t> t;
+  std::vector<float> v;
+};
+
+// A pod's data, one series per sensor column.
+struct PodData {
+  std::string name;
+  Series series[COL_COUNT];
+  ParseStats stats;
+};
+
+// Clock correction for a pod whose clock ran 'offset' seconds ahead
+// at its first reading and gained 'ppm' (parts per million) since:
+//   t' = t - offset - ppm*1e-6*(t - t0)
+struct ClockCorrection {
+  double offset;
+  double ppm;
+};
+
+// Series resampled onto the grid of multiples of 'step': v[k] holds
+// the aggregate of the readings in [start + k*step, start + (k+1)*step),
+// NaN if there are none.
+struct GridSeries {
+  int64_t start;
+  std::vector<float> v;
+};
+
+
+// Functions ===================================================================
+
+bool parseAggregation(const std::string &s, Aggregation &agg);
+const char* aggregationName(const Aggregation agg);
+// Column for a short key or full header name; COL_COUNT if unknown.
+SensorColumn parseColumn(const std::string &s);
+
+// Loads the data logs among the given files into per-column series,
+// keeping only the columns in columnMask (bit k: SensorColumn k).
+// Other log types are skipped.  utcOffset [s] is subtracted from the
+// local times of older logs.  Returns false (see error) if a file
+// cannot be read.
+bool loadPodData(const std::vector<std::string> &files, const int64_t utcOffset,
+                 const uint16_t columnMask, PodData &pod, std::string &error);
+// Applies a clock correction to all of the pod's series.
+void correctClock(PodData &pod, const ClockCorrection &c);
+
+// Resamples a series onto the grid of the given step [s].  Intervals
+// without readings are filled with the last reading, if it is no more
+// than fillLimit [s] before the interval (0: no filling; reading
+// counts are never filled).
+GridSeries resampleSeries(const Series &s, const int64_t step, const Aggregation agg,
+                          const int64_t fillLimit);
+
+// Looks up values of a series at increasing times ("as-of" join):
+// the latest reading at or before the time, or the nearest reading
+// either side if 'nearest', in both cases within 'tolerance' [s].
+class AsOfCursor {
+  public:
+    AsOfCursor(const Series &s, const int64_t tolerance, const bool nearest)
+      : _s(s), _tolerance(tolerance), _nearest(nearest) {}
+    // Times must not decrease between calls.  Returns false if there
+    // is no reading within the tolerance.
+    bool lookup(const int64_t t, float &v);
+  private:
+    const Series &_s;
+    const int64_t _tolerance;
+    const bool _nearest;
+    size_t _next = 0;         // first reading after the last lookup time
+};
+
+
+//==============================================================================
@@ -0,0 +1,91 @@
+/*==============================================================================
+  Command-line pod sources (log files and SD card directories).
+
+  This file is part of the LMN PODD distribution:
+    https://github.com/lmnts/PODD
+
+  CONTRIBUTORS:
+    PODD contributors (2026)
+
+  COPYRIGHT/LICENSE:
+  Copyright (c) 2026 LMN Architects
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Affero General Public License as
+  published by the Free Software Foundation, either version 3 of the
+  License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Affero General Public License for more details.
+
+  You should have received a copy of the GNU Affero General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+==============================================================================*/
+
+#include "podd_sources.h"
+
+#include <algorithm>
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+
+// Functions ===================================================================
+
+static bool hasCSVExtension(const fs::path &p) {
+  std::string ext = p.extension().string();
+  std::transform(ext.begin(),ext.end(),ext.begin(),::tolower);
+  return ext == ".csv";
+}
+
+
+bool addPodSource(const std::string &arg, std::vector<PodSource> &pods, std::string &error) {
+  std::string name;
+  fs::path path = arg;
+  const size_t eq = arg.find('=');
+  if ((eq != std::string::npos) && !fs::exists(path)) {
+    name = arg.substr(0,eq);
+    path = arg.substr(eq + 1);
+  }
+  std::error_code ec;
+  const bool dir = fs::is_directory(path,ec);
+  if (!dir && !fs::is_regular_file(path,ec)) {
+    error = path.string() + ": no such file or directory";
+    return false;
+  }
+  if (name.empty()) {
+    const fs::path p = path.lexically_normal();
+    name = dir ? (p.has_filename() ? p.filename() : p.parent_path().filename()).string()
+               : p.stem().string();
+  }
+  auto it = std::find_if(pods.begin(),pods.end(),[&name](const PodSource &s) {
+    return s.name == name;
+  });
+  if (it == pods.end()) {
+    pods.emplace_back();
+    pods.back().name = name;
+    it = pods.end() - 1;
+  }
+  PodSource &pod = *it;
+  if (!dir) {
+    pod.files.push_back(path.string());
+    return true;
+  }
+  // SD card data files are named by date/time (/data/YYYY/MM/YYMMDDHH.CSV),
+  // so sorting the paths keeps a pod's files roughly in time order.
+  std::vector<std::string> files;
+  for (const auto &entry : fs::recursive_directory_iterator(path,ec)) {
+    if (entry.is_regular_file() && hasCSVExtension(entry.path())) {
+      files.push_back(entry.path().string());
+    }
+  }
+  std::sort(files.begin(),files.end());
+  pod.files.insert(pod.files.end(),files.begin(),files.end());
+  return true;
+}
+
+
+//==============================================================================
@@ -0,0 +1,56 @@
+/*==============================================================================
+  Command-line pod sources (log files and SD card directories).
+
+  This file is part of the LMN PODD distribution:
+    https://github.com/lmnts/PODD
+
+  CONTRIBUTORS:
+    PODD contributors (2026)
+
+  COPYRIGHT/LICENSE:
+  Copyright (c) 2026 LMN Architects
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Affero General Public License as
+  published by the Free Software Foundation, either version 3 of the
+  License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Affero General Public License for more details.
+
+  You should have received a copy of the GNU Affero General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+==============================================================================*/
+
+#pragma once
+
+// Standard libraries
+#include <string>
+#include <vector>
+
+
+// Constants/global variables ==================================================
+
+// Log files belonging to one pod.
+struct PodSource {
+  std::string name;
+  std::vector<std::string> files;
+};
+
+
+// Functions ===================================================================
+
+// Adds the files named by a command-line source argument to its pod,
+// creating the pod if new.  The argument is a log file, a directory
+// (e.g. a copy of a pod's SD card, searched recursively for *.CSV
+// files), or NAME=PATH to set the pod name; sources with the same name
+// are merged into one pod.  By default a file's pod is named after the
+// file and a directory's pod after the directory.  Returns false (see
+// error) if the path does not exist.
+bool addPodSource(const std::string &arg, std::vector<PodSource> &pods, std::string &error);
+
+
+//==============================================================================